@@ -1,7 +1,7 @@
 # -*- coding: utf-8 -*-
 
 #
-# Author: Tomi Jylhä-Ollila, Finland 2010-2016
+# Author: Tomi Jylhä-Ollila, Finland 2010-2018
 #
 # This file is part of Kunquat.
 #
@@ -21,6 +21,7 @@ becomes available in major distributions, this module will be removed.
 """
 
 
+from array import array
 import ctypes
 import ctypes.util
 
@@ -109,11 +110,12 @@ class Simple():
         if len(data) != self._channels:
             raise ValueError('Wrong number of output channel buffers')
         frame_count = len(data[0])
-        cdata = (ctypes.c_float * (frame_count * self._channels))()
+        interleaved = array('f', [0.0]) * (frame_count * self._channels)
         for channel in range(self._channels):
             if len(data[channel]) != frame_count:
                 raise ValueError('Output channel buffer lengths do not match')
-            cdata[channel::self._channels] = data[channel]
+            interleaved[channel::self._channels] = _get_float_array(data[channel])
+        cdata = (ctypes.c_float * len(interleaved)).from_buffer(interleaved)
         bytes_per_frame = 4 * self._channels
         error = ctypes.c_int(0)
         if _simple.pa_simple_write(self._connection,
@@ -139,6 +141,17 @@ class Simple():
         self._connection = None
 
 
+def _get_float_array(data):
+    if isinstance(data, array) and data.typecode == 'f':
+        return data
+    if isinstance(data, memoryview) and data.format == 'f' and data.contiguous:
+        # Copy the raw data without converting individual items
+        float_array = array('f')
+        float_array.frombytes(data.cast('B'))
+        return float_array
+    return array('f', data)
+
+
 _simple = ctypes.CDLL(ctypes.util.find_library('pulse-simple'))
 
 _pa_usec = ctypes.c_uint64
@@ -15,6 +15,7 @@
 
 """
 
+import ctypes
 import json
 import zipfile
 
@@ -265,3 +266,117 @@ class KunquatFileError(KunquatError):
     """Error indicating that a Kunquat file is invalid."""
 
 
+class _Render_options(ctypes.Structure):
+    _fields_ = [
+            ('bits', ctypes.c_int),
+            ('use_float', ctypes.c_int),
+            ('block_size', ctypes.c_long),
+            ('progress', ctypes.CFUNCTYPE(
+                None, ctypes.c_longlong, ctypes.c_longlong, ctypes.c_void_p)),
+            ('user_data', ctypes.c_void_p),
+        ]
+
+
+class _Render_stats(ctypes.Structure):
+    _fields_ = [
+            ('frames', ctypes.c_longlong),
+            ('peak', ctypes.c_double),
+            ('rms', ctypes.c_double),
+            ('clipped', ctypes.c_longlong),
+        ]
+
+
+_kunquatfile = None
+
+
+def _get_kunquatfile():
+    global _kunquatfile
+    if not _kunquatfile:
+        lib = ctypes.CDLL('libkunquatfile.so')
+        lib.kqtfile_render_track.argtypes = [
+                ctypes.c_int,
+                ctypes.c_int,
+                ctypes.c_char_p,
+                ctypes.c_char_p,
+                ctypes.POINTER(_Render_options),
+                ctypes.POINTER(_Render_stats)]
+        lib.kqtfile_render_track.restype = ctypes.c_int
+        lib.kqt_Module_get_error.argtypes = [ctypes.c_int]
+        lib.kqt_Module_get_error.restype = ctypes.c_char_p
+        lib.kqt_Module_clear_error.argtypes = [ctypes.c_int]
+        lib.kqt_Module_clear_error.restype = None
+        _kunquatfile = lib
+    return _kunquatfile
+
+
+def render_track(
+        handle,
+        track,
+        path,
+        format='wav',
+        bits=16,
+        use_float=False,
+        block_size=0,
+        progress=None):
+    """Render a track of a Kunquat instance into an audio file.
+
+    The rendering and encoding are done natively by libkunquatfile.
+
+    Arguments:
+    handle -- The Kunquat instance.
+    track  -- The track number, or None for all tracks.
+    path   -- The path of the output file.
+
+    Optional arguments:
+    format     -- Output file format: 'wav', 'au' or 'flac'.
+    bits       -- Bits per sample, ignored if use_float is True.
+    use_float  -- Use 32-bit floating-point samples.
+    block_size -- The number of frames rendered at a time, or 0 for
+                  the default.
+    progress   -- A function called with the playback position in
+                  nanoseconds and the number of clipped frames
+                  rendered so far after each rendered block.
+
+    Return value:
+    A dictionary containing the number of rendered frames ('frames'),
+    the peak amplitude ('peak'), the RMS level ('rms') and the number
+    of clipped frames ('clipped').
+
+    Exceptions:
+    OSError          -- libkunquatfile is not available.
+    KunquatFileError -- Rendering failed.
+
+    """
+    lib = _get_kunquatfile()
+
+    progress_cb_type = dict(_Render_options._fields_)['progress']
+    if progress:
+        progress_cb = progress_cb_type(lambda ns, clipped, _: progress(ns, clipped))
+    else:
+        progress_cb = progress_cb_type()
+
+    options = _Render_options(bits, int(use_float), block_size, progress_cb, None)
+    stats = _Render_stats()
+
+    if track is None:
+        track = -1
+
+    if not lib.kqtfile_render_track(
+            handle._handle,
+            track,
+            bytes(path, encoding='utf-8'),
+            bytes(format, encoding='utf-8'),
+            ctypes.byref(options),
+            ctypes.byref(stats)):
+        error_str = str(lib.kqt_Module_get_error(0), encoding='utf-8')
+        lib.kqt_Module_clear_error(0)
+        raise KunquatFileError(error_str)
+
+    return {
+        'frames': stats.frames,
+        'peak': stats.peak,
+        'rms': stats.rms,
+        'clipped': stats.clipped,
+    }
+
+
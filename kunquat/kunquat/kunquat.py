@@ -52,6 +52,8 @@ class Kunquat():
     get_duration -- Calculate the length of a track.
     play         -- Play audio.
     get_audio    -- Get audio data.
+    get_audio_views -- Get audio data without copying.
+    read_audio   -- Copy audio data into given buffers.
     fire         -- Fire an event.
 
     Public instance variables:
@@ -200,6 +202,33 @@ class Kunquat():
         """
         _kunquat.kqt_Handle_set_thread_count(self._handle, value)
 
+    def set_thread_scheduling(self, policy, priority=0):
+        """Set the scheduling policy of the audio rendering threads.
+
+        Arguments:
+        policy   -- The scheduling policy: 'default', 'fifo' or 'rr'.
+        priority -- The realtime priority in the range [1, 99], ignored
+                    with the default policy.
+
+        Realtime policies usually require additional privileges. If the
+        policy cannot be set, KunquatResourceError is raised and the
+        threads retain their previous scheduling.
+
+        """
+        _kunquat.kqt_Handle_set_thread_scheduling(
+                self._handle, bytes(policy, encoding='utf-8'), priority)
+
+    def set_thread_affinity(self, thread_index, cpu_mask):
+        """Set the CPU affinity of an audio rendering thread.
+
+        Arguments:
+        thread_index -- The index of the rendering thread.
+        cpu_mask     -- The set of allowed CPUs with bit n set for CPU n,
+                        or 0 for all CPUs.
+
+        """
+        _kunquat.kqt_Handle_set_thread_affinity(self._handle, thread_index, cpu_mask)
+
     @property
     def audio_rate(self):
         """Audio rate in frames per second."""
@@ -279,11 +308,125 @@ class Kunquat():
         the right output channel.  Buffers shorter than frame_count
         frames indicate that the end has been reached.
 
+        """
+        return tuple(view.tolist() for view in self.get_audio_views())
+
+    def get_audio_views(self):
+        """Get audio data without copying.
+
+        Returns:
+        A pair of memoryviews of 32-bit floats over the internal audio
+        buffers of, respectively, the left and the right output
+        channel.  The views are read-only in Python 3.8 and later, and
+        must not be written to in earlier versions.  The views are only
+        valid until the next call of a method that modifies the Kunquat
+        instance, such as play().  The views support the buffer protocol, so they can be
+        passed to e.g. array.frombytes() or numpy.frombuffer().
+
         """
         frames_available = _kunquat.kqt_Handle_get_frames_available(self._handle)
-        cbuf_left = _kunquat.kqt_Handle_get_audio(self._handle, 0)
-        cbuf_right = _kunquat.kqt_Handle_get_audio(self._handle, 1)
-        return cbuf_left[:frames_available], cbuf_right[:frames_available]
+        return tuple(self._get_audio_view(ch, frames_available) for ch in range(2))
+
+    def read_audio(self, left, right):
+        """Copy audio data into the given buffers.
+
+        Arguments:
+        left  -- A writable buffer of 32-bit floats, such as
+                 array.array('f') or a float32 NumPy array, for the
+                 left output channel.
+        right -- A writable buffer for the right output channel.
+
+        Returns:
+        The number of frames copied.  The buffers must have space for
+        at least that many frames.
+
+        """
+        views = self.get_audio_views()
+        frame_count = len(views[0])
+        byte_count = frame_count * views[0].itemsize
+        for (dest, view) in zip((left, right), views):
+            dest_bytes = memoryview(dest).cast('B')
+            if len(dest_bytes) < byte_count:
+                raise ValueError('Output buffer is too small for {} frames'.format(
+                    frame_count))
+            dest_bytes[:byte_count] = view.cast('B')
+        return frame_count
+
+    def set_stem(self, stem, source):
+        """Set the source of a stem rendered along with the main output.
+
+        Arguments:
+        stem   -- The stem number, >= 0 and < KQT_STEMS_MAX.
+        source -- 'au_XX' for the output of the top-level audio unit XX,
+                  'out_XX' for the master input ports XX and XX + 1, or
+                  None to disable the stem.  XX is a hexadecimal index.
+
+        """
+        csource = bytes(source, encoding='utf-8') if source else None
+        _kunquat.kqt_Handle_set_stem(self._handle, stem, csource)
+
+    def get_stem_audio_views(self, stem):
+        """Get the audio data of an enabled stem without copying.
+
+        Returns:
+        A pair of memoryviews of 32-bit floats with the same access
+        and validity rules as the views returned by get_audio_views().
+
+        """
+        frames_available = _kunquat.kqt_Handle_get_frames_available(self._handle)
+        return tuple(self._get_audio_view(ch, frames_available, stem)
+                for ch in range(2))
+
+    def get_audio_levels(self):
+        """Get the levels of the audio rendered by the last call of play().
+
+        Returns:
+        A pair containing the levels of, respectively, the left and
+        the right output channel.  The levels of each channel are
+        given as a dictionary that contains the peak absolute sample
+        value ('peak'), the RMS level ('rms') and the number of
+        samples outside the range [-1.0, 1.0] ('clipped').
+
+        """
+        return tuple(self._get_audio_levels(ch) for ch in range(2))
+
+    def get_stem_audio_levels(self, stem):
+        """Get the levels of an enabled stem.
+
+        Returns:
+        A pair of level dictionaries in the same format as returned by
+        get_audio_levels().
+
+        """
+        return tuple(self._get_audio_levels(ch, stem) for ch in range(2))
+
+    def _get_audio_levels(self, channel, stem=None):
+        levels = _kqt_Audio_levels()
+        if stem is None:
+            _kunquat.kqt_Handle_get_audio_levels(
+                    self._handle, channel, ctypes.byref(levels))
+        else:
+            _kunquat.kqt_Handle_get_stem_audio_levels(
+                    self._handle, stem, channel, ctypes.byref(levels))
+        return {
+            'peak': levels.peak,
+            'rms': levels.rms,
+            'clipped': levels.clipped,
+        }
+
+    def _get_audio_view(self, channel, frame_count, stem=None):
+        if frame_count == 0:
+            return memoryview(b'').cast('f')
+        if stem is None:
+            cbuf = _kunquat.kqt_Handle_get_audio(self._handle, channel)
+        else:
+            cbuf = _kunquat.kqt_Handle_get_stem_audio(self._handle, stem, channel)
+        carray = ctypes.cast(cbuf, ctypes.POINTER(ctypes.c_float * frame_count)).contents
+        view = memoryview(carray).cast('B').cast('f')
+        # Read-only views require Python 3.8
+        if hasattr(view, 'toreadonly'):
+            view = view.toreadonly()
+        return view
 
     def set_channel_mute(self, channel, mute):
         """Set channel mute.
@@ -312,6 +455,26 @@ class Kunquat():
         event_data = bytes(json.dumps(event), encoding='utf-8')
         _kunquat.kqt_Handle_fire_event(self._handle, channel, event_data)
 
+    def queue_event(self, channel, event, timestamp):
+        """Queue an event to be fired during playback.
+
+        Unlike fire_event, this method may be called from another
+        thread while the Handle is playing.  The event is fired at the
+        first audio frame at or after the given timestamp.
+
+        Arguments:
+        channel   -- The channel where the event takes place.  The
+                     channel number is >= 0 and < 64.
+        event     -- The event description, in the same format as in
+                     fire_event.
+        timestamp -- The absolute playback position of the event in
+                     nanoseconds, as returned by the nanoseconds
+                     property.
+
+        """
+        event_data = bytes(json.dumps(event), encoding='utf-8')
+        _kunquat.kqt_Handle_queue_event(self._handle, channel, event_data, timestamp)
+
     def receive_events(self):
         """Receive outgoing events.
 
@@ -329,6 +492,21 @@ class Kunquat():
             el = json.loads(str(raw_el_data, encoding='utf-8'))
         return all_events
 
+    def get_render_check_count(self, op_type):
+        """Get the number of operations that are not realtime-safe.
+
+        Arguments:
+        op_type -- The operation type: 'alloc', 'free' or 'lock'.
+
+        Return value:
+        The number of operations of the given type made during audio
+        rendering.  KunquatResourceError is raised if libkunquat is
+        built without render checks.
+
+        """
+        return _kunquat.kqt_Handle_get_render_check_count(
+                self._handle, bytes(op_type, encoding='utf-8'))
+
     def __del__(self):
         if self._handle:
             _kunquat.kqt_del_Handle(self._handle)
@@ -444,10 +622,30 @@ def get_version():
     return ret
 
 
+def set_global_thread_pool(thread_count):
+    """Set the number of render threads shared by all Kunquat Handles.
+
+    The thread pool can only be changed when no Handles exist. A Handle
+    created while the pool exists uses the pool for rendering if its
+    thread count is greater than 1. Setting the thread count to 0 removes
+    the thread pool.
+
+    """
+    if not _kunquat.kqt_set_global_thread_pool(thread_count):
+        error_str_raw = _kunquat.kqt_Handle_get_error(0)
+        _kunquat.kqt_Handle_clear_error(0)
+        error_str = str(error_str_raw, encoding='utf-8')
+        raise _get_error(json.loads(error_str))
+
+
 def fake_out_of_memory():
     _kunquat.kqt_fake_out_of_memory(0)
 
 
+def set_render_check_abort(enabled):
+    _kunquat.kqt_set_render_check_abort(int(enabled))
+
+
 class _ErrorHookRef():
 
     def __init__(self):
@@ -516,6 +714,15 @@ _kunquat = ctypes.CDLL('libkunquat.so')
 
 kqt_Handle = ctypes.c_int
 
+
+class _kqt_Audio_levels(ctypes.Structure):
+    _fields_ = [
+            ('peak', ctypes.c_double),
+            ('rms', ctypes.c_double),
+            ('clipped', ctypes.c_long),
+        ]
+
+
 _kunquat.kqt_new_Handle.argtypes = []
 _kunquat.kqt_new_Handle.restype = kqt_Handle
 _kunquat.kqt_del_Handle.argtypes = [kqt_Handle]
@@ -549,6 +756,23 @@ _kunquat.kqt_Handle_get_audio.argtypes = [kqt_Handle, ctypes.c_int]
 _kunquat.kqt_Handle_get_audio.restype = ctypes.POINTER(ctypes.c_float)
 _kunquat.kqt_Handle_get_audio.errcheck = _error_check
 
+_kunquat.kqt_Handle_get_audio_levels.argtypes = [
+        kqt_Handle, ctypes.c_int, ctypes.POINTER(_kqt_Audio_levels)]
+_kunquat.kqt_Handle_get_audio_levels.restype = ctypes.c_int
+_kunquat.kqt_Handle_get_audio_levels.errcheck = _error_check
+
+_kunquat.kqt_Handle_set_stem.argtypes = [kqt_Handle, ctypes.c_int, ctypes.c_char_p]
+_kunquat.kqt_Handle_set_stem.restype = ctypes.c_int
+_kunquat.kqt_Handle_set_stem.errcheck = _error_check
+_kunquat.kqt_Handle_get_stem_audio.argtypes = [kqt_Handle, ctypes.c_int, ctypes.c_int]
+_kunquat.kqt_Handle_get_stem_audio.restype = ctypes.POINTER(ctypes.c_float)
+_kunquat.kqt_Handle_get_stem_audio.errcheck = _error_check
+
+_kunquat.kqt_Handle_get_stem_audio_levels.argtypes = [
+        kqt_Handle, ctypes.c_int, ctypes.c_int, ctypes.POINTER(_kqt_Audio_levels)]
+_kunquat.kqt_Handle_get_stem_audio_levels.restype = ctypes.c_int
+_kunquat.kqt_Handle_get_stem_audio_levels.errcheck = _error_check
+
 _kunquat.kqt_Handle_set_thread_count.argtypes = [kqt_Handle, ctypes.c_int]
 _kunquat.kqt_Handle_set_thread_count.restype = ctypes.c_int
 _kunquat.kqt_Handle_set_thread_count.errcheck = _error_check
@@ -556,6 +780,18 @@ _kunquat.kqt_Handle_get_thread_count.argtypes = [kqt_Handle]
 _kunquat.kqt_Handle_get_thread_count.restype = ctypes.c_int
 _kunquat.kqt_Handle_get_thread_count.errcheck = _error_check
 
+_kunquat.kqt_Handle_set_thread_scheduling.argtypes = [
+        kqt_Handle, ctypes.c_char_p, ctypes.c_int]
+_kunquat.kqt_Handle_set_thread_scheduling.restype = ctypes.c_int
+_kunquat.kqt_Handle_set_thread_scheduling.errcheck = _error_check
+_kunquat.kqt_Handle_set_thread_affinity.argtypes = [
+        kqt_Handle, ctypes.c_int, ctypes.c_ulonglong]
+_kunquat.kqt_Handle_set_thread_affinity.restype = ctypes.c_int
+_kunquat.kqt_Handle_set_thread_affinity.errcheck = _error_check
+
+_kunquat.kqt_set_global_thread_pool.argtypes = [ctypes.c_int]
+_kunquat.kqt_set_global_thread_pool.restype = ctypes.c_int
+
 _kunquat.kqt_Handle_set_audio_rate.argtypes = [kqt_Handle, ctypes.c_long]
 _kunquat.kqt_Handle_set_audio_rate.restype = ctypes.c_int
 _kunquat.kqt_Handle_set_audio_rate.errcheck = _error_check
@@ -587,11 +823,19 @@ _kunquat.kqt_Handle_set_channel_mute.errcheck = _error_check
 _kunquat.kqt_Handle_fire_event.argtypes = [kqt_Handle, ctypes.c_int, ctypes.c_char_p]
 _kunquat.kqt_Handle_fire_event.restype = ctypes.c_int
 _kunquat.kqt_Handle_fire_event.errcheck = _error_check
+_kunquat.kqt_Handle_queue_event.argtypes = [
+        kqt_Handle, ctypes.c_int, ctypes.c_char_p, ctypes.c_longlong]
+_kunquat.kqt_Handle_queue_event.restype = ctypes.c_int
+_kunquat.kqt_Handle_queue_event.errcheck = _error_check
 
 _kunquat.kqt_Handle_receive_events.argtypes = [kqt_Handle]
 _kunquat.kqt_Handle_receive_events.restype = ctypes.c_char_p
 _kunquat.kqt_Handle_receive_events.errcheck = _error_check
 
+_kunquat.kqt_Handle_get_render_check_count.argtypes = [kqt_Handle, ctypes.c_char_p]
+_kunquat.kqt_Handle_get_render_check_count.restype = ctypes.c_longlong
+_kunquat.kqt_Handle_get_render_check_count.errcheck = _error_check
+
 _kunquat.kqt_get_event_names.argtypes = []
 _kunquat.kqt_get_event_names.restype = ctypes.POINTER(ctypes.c_char_p)
 _kunquat.kqt_get_event_arg_type.argtypes = [ctypes.c_char_p]
@@ -617,4 +861,7 @@ _kunquat.kqt_get_version.restype = ctypes.c_char_p
 _kunquat.kqt_fake_out_of_memory.argtypes = [ctypes.c_long]
 _kunquat.kqt_fake_out_of_memory.restype = None
 
+_kunquat.kqt_set_render_check_abort.argtypes = [ctypes.c_int]
+_kunquat.kqt_set_render_check_abort.restype = None
+
 
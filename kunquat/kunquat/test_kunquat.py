@@ -2,7 +2,7 @@
 
 #
 # Authors: Toni Ruottu, Finland 2013
-#          Tomi Jylhä-Ollila, Finland 2013-2016
+#          Tomi Jylhä-Ollila, Finland 2013-2018
 #
 # This file is part of Kunquat.
 #
@@ -12,6 +12,7 @@
 # copyright and related or neighboring rights to Kunquat.
 #
 
+from array import array
 import doctest
 import unittest
 
@@ -35,6 +36,53 @@ class TestKunquat(unittest.TestCase):
         self.assertRaises(MemoryError, Kunquat)
 
 
+class TestAudioAccess(unittest.TestCase):
+
+    def setUp(self):
+        self.handle = Kunquat()
+        self.handle.set_data('album/p_manifest.json', [0, {}])
+        self.handle.set_data('album/p_tracks.json', [0, [0]])
+        self.handle.set_data('song_00/p_manifest.json', [0, {}])
+        self.handle.set_data('song_00/p_order_list.json', [0, [ [0, 0] ]])
+        self.handle.set_data('pat_000/p_manifest.json', [0, {}])
+        self.handle.set_data('pat_000/p_pattern.json', [0, { 'length': [16, 0] }])
+        self.handle.set_data('pat_000/instance_000/p_manifest.json', [0, {}])
+        self.handle.validate()
+        self.handle.play(16)
+
+    def test_audio_views_match_audio_data(self):
+        views = self.handle.get_audio_views()
+        self.assertEqual(len(views), 2)
+        for (view, data) in zip(views, self.handle.get_audio()):
+            self.assertEqual(view.format, 'f')
+            if hasattr(view, 'toreadonly'):
+                self.assertTrue(view.readonly)
+            self.assertEqual(view.tolist(), data)
+
+    def test_read_audio_copies_audio_data(self):
+        left = array('f', [1.0] * 20)
+        right = array('f', [1.0] * 20)
+        frame_count = self.handle.read_audio(left, right)
+        self.assertEqual(frame_count, 16)
+        expected = self.handle.get_audio()
+        self.assertEqual(left[:16].tolist(), expected[0])
+        self.assertEqual(right[:16].tolist(), expected[1])
+        self.assertEqual(left[16:].tolist(), [1.0] * 4)
+
+    def test_read_audio_rejects_short_buffers(self):
+        left = array('f', [0.0] * 8)
+        right = array('f', [0.0] * 16)
+        self.assertRaises(ValueError, self.handle.read_audio, left, right)
+
+    def test_audio_levels_describe_audio_data(self):
+        levels = self.handle.get_audio_levels()
+        self.assertEqual(len(levels), 2)
+        for (ch_levels, data) in zip(levels, self.handle.get_audio()):
+            self.assertEqual(ch_levels['peak'], max(abs(x) for x in data))
+            self.assertEqual(ch_levels['rms'], 0.0)
+            self.assertEqual(ch_levels['clipped'], 0)
+
+
 if __name__ == '__main__':
     unittest.main()
 
@@ -2,7 +2,7 @@
 
 #
 # Authors: Toni Ruottu, Finland 2013-2014
-#          Tomi Jylhä-Ollila, Finland 2013-2017
+#          Tomi Jylhä-Ollila, Finland 2013-2018
 #
 # This file is part of Kunquat.
 #
@@ -12,6 +12,7 @@
 # copyright and related or neighboring rights to Kunquat.
 #
 
+from array import array
 import time
 import math
 from collections import deque
@@ -55,7 +56,7 @@ class AudioEngine():
         self._cycle_time = None
         self._ui_engine = None
         self._nframes = chunk_size
-        self._silence = ([0] * self._nframes, [0] * self._nframes)
+        self._silence = (array('f', [0.0]) * self._nframes,) * 2
         self._render_speed = 0
         self._post_actions = deque()
         self._send_voice_info = False
@@ -73,13 +74,13 @@ class AudioEngine():
     def set_audio_output(self, audio_output):
         self._audio_output = audio_output
 
-    def _get_audio_levels(self, audio_data):
-        levels = []
-        for ch in audio_data:
-            max_level = max(abs(item) for item in ch)
-            levels.append(max_level)
-        assert len(levels) == 2
-        return tuple(levels)
+    def _copy_audio(self, audio_views):
+        audio_data = []
+        for view in audio_views:
+            ch = array('f')
+            ch.frombytes(view.cast('B'))
+            audio_data.append(ch)
+        return tuple(audio_data)
 
     def _process_event(self, channel_number, event_type, event_value, context):
         self._ui_engine.update_event_log_with(
@@ -140,20 +141,23 @@ class AudioEngine():
         attempt_count = 16
         for _ in range(attempt_count):
             self._rendering_engine.play(nframes)
-            audio_data = self._rendering_engine.get_audio()
+            audio_data = self._copy_audio(self._rendering_engine.get_audio_views())
             event_data = self._rendering_engine.receive_events()
             self._process_events(event_data, CONTEXT_MIX)
             self._process_post_actions()
             frame_count = len(audio_data[0])
             if frame_count > 0:
                 self._push_amount = frame_count
+                self._audio_levels = tuple(
+                        levels['peak']
+                        for levels in self._rendering_engine.get_audio_levels())
                 break
         else:
             # We are not getting more audio, possibly due to heavy event spamming
             audio_data = self._silence
             self._push_amount = 0
+            self._audio_levels = (0, 0)
 
-        self._audio_levels = self._get_audio_levels(audio_data)
         return audio_data
 
     def _generate_audio(self, nframes):
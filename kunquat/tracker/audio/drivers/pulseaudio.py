@@ -1,7 +1,7 @@
 # -*- coding: utf-8 -*-
 
 #
-# Authors: Tomi Jylhä-Ollila, Finland 2013-2016
+# Authors: Tomi Jylhä-Ollila, Finland 2013-2018
 #          Toni Ruottu, Finland 2013
 #
 # This file is part of Kunquat.
@@ -12,6 +12,7 @@
 # copyright and related or neighboring rights to Kunquat.
 #
 
+from array import array
 import sys
 import time
 import queue
@@ -71,7 +72,7 @@ class Pulseaudio():
                 self._pa_callback)
         self._buffer = queue.Queue()
         self._acks = queue.Queue()
-        self._workspace = ([],[])
+        self._workspace = (array('f'), array('f'))
         self._pa.init()
 
     def set_audio_source(self, audio_source):
@@ -101,7 +102,7 @@ class Pulseaudio():
                 fresh_audio = self._buffer.get(True, 1.0)
                 self._acks.put('ack')
             except queue.Empty:
-                fresh_audio = ([0.0] * missing, [0.0] * missing)
+                fresh_audio = (array('f', [0.0]) * missing,) * 2
             self._add_audio_to_workspace(fresh_audio)
             missing = nframes - audio_len(self._workspace)
 
@@ -111,7 +112,7 @@ class Pulseaudio():
             (audio_data, remainder) = split_audio_at(self._workspace, nframes)
         elif frames == nframes:
             audio_data = self._workspace
-            remainder = ([],[])
+            remainder = (array('f'), array('f'))
         else:
             assert False
         self._workspace = remainder
@@ -15,6 +15,7 @@ from kunquat.kunquat.kunquat import get_default_value
 from .procparams.addparams import AddParams
 from .procparams.bitcrusherparams import BitcrusherParams
 from .procparams.compressparams import CompressParams
+from .procparams.convolutionparams import ConvolutionParams
 from .procparams.delayparams import DelayParams
 from .procparams.envgenparams import EnvgenParams
 from .procparams.filterparams import FilterParams
@@ -39,6 +40,7 @@ _proc_classes = {
     'add':          AddParams,
     'bitcrusher':   BitcrusherParams,
     'compress':     CompressParams,
+    'convolution':  ConvolutionParams,
     'delay':        DelayParams,
     'envgen':       EnvgenParams,
     'filter':       FilterParams,
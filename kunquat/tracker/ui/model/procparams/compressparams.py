@@ -1,7 +1,7 @@
 # -*- coding: utf-8 -*-
 
 #
-# Author: Tomi Jylhä-Ollila, Finland 2016
+# Author: Tomi Jylhä-Ollila, Finland 2016-2018
 #
 # This file is part of Kunquat.
 #
@@ -32,6 +32,7 @@ class CompressParams(ProcParams):
 
     _DEFAULT_ATTACK = 1.0
     _DEFAULT_RELEASE = 100.0
+    _DEFAULT_LOOKAHEAD = 0.0
 
     _DEFAULT_UPWARD_THRESHOLD = -60.0
     _DEFAULT_UPWARD_RANGE = 12.0
@@ -58,6 +59,16 @@ class CompressParams(ProcParams):
     def set_release(self, value):
         self._set_value('p_f_release.json', value)
 
+    @staticmethod
+    def get_lookahead_range():
+        return (0.0, 20.0)
+
+    def get_lookahead(self):
+        return self._get_value('p_f_lookahead.json', self._DEFAULT_LOOKAHEAD)
+
+    def set_lookahead(self, value):
+        self._set_value('p_f_lookahead.json', value)
+
     @staticmethod
     def get_threshold_range():
         return (CompressParams._DEFAULT_UPWARD_THRESHOLD,
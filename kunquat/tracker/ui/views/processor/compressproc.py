@@ -1,7 +1,7 @@
 # -*- coding: utf-8 -*-
 
 #
-# Author: Tomi Jylhä-Ollila, Finland 2016-2017
+# Author: Tomi Jylhä-Ollila, Finland 2016-2018
 #
 # This file is part of Kunquat.
 #
@@ -31,18 +31,24 @@ class CompressProc(QWidget, ProcessorUpdater):
 
         self._attack = Attack()
         self._release = Release()
+        self._lookahead = Lookahead()
 
         self._upward_config = CompressConfig('upward')
         self._downward_config = CompressConfig('downward')
 
         self.add_to_updaters(
-                self._attack, self._release, self._upward_config, self._downward_config)
+                self._attack,
+                self._release,
+                self._lookahead,
+                self._upward_config,
+                self._downward_config)
 
         rl = QHBoxLayout()
         rl.setContentsMargins(0, 0, 0, 0)
         rl.setSpacing(10)
         rl.addWidget(self._attack)
         rl.addWidget(self._release)
+        rl.addWidget(self._lookahead)
 
         v = QVBoxLayout()
         v.setSpacing(10)
@@ -100,6 +106,25 @@ class Release(CompressSlider):
         self._updater.signal_update(self._get_update_signal_type())
 
 
+class Lookahead(CompressSlider):
+
+    def __init__(self):
+        min_value, max_value = CompressParams.get_lookahead_range()
+        super().__init__(1, min_value, max_value, 'Lookahead:')
+
+    def _get_update_signal_type(self):
+        return 'signal_compress_lookahead_{}'.format(self._proc_id)
+
+    def _update_value(self):
+        params = self._get_compress_params()
+        self.set_number(params.get_lookahead())
+
+    def _value_changed(self, value):
+        params = self._get_compress_params()
+        params.set_lookahead(value)
+        self._updater.signal_update(self._get_update_signal_type())
+
+
 class CompressConfig(QWidget, ProcessorUpdater):
 
     def __init__(self, mode):
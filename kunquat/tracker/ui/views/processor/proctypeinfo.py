@@ -14,6 +14,7 @@
 from .addproc import AddProc
 from .bitcrusherproc import BitcrusherProc
 from .compressproc import CompressProc
+from .convolutionproc import ConvolutionProc
 from .delayproc import DelayProc
 from .envgenproc import EnvgenProc
 from .filterproc import FilterProc
@@ -39,6 +40,7 @@ _proc_classes = {
     'add':          AddProc,
     'bitcrusher':   BitcrusherProc,
     'compress':     CompressProc,
+    'convolution':  ConvolutionProc,
     'delay':        DelayProc,
     'envgen':       EnvgenProc,
     'filter':       FilterProc,
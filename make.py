@@ -166,6 +166,9 @@ def build():
     if options.enable_debug_asserts:
         cc.add_define('ENABLE_DEBUG_ASSERTS')
 
+    if options.enable_render_checks:
+        cc.add_define('ENABLE_RENDER_CHECKS')
+
     #if options.enable_profiling:
     #    compile_flags.append('-pg')
     #    link_flags.append('-pg')
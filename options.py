@@ -9,6 +9,9 @@ enable_debug = True
 # enable debug asserts
 enable_debug_asserts = False
 
+# count memory management and locking during audio rendering
+enable_render_checks = False
+
 # enable libkunquat
 enable_libkunquat = True
 
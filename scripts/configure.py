@@ -128,6 +128,19 @@ def test_add_libkunquatfile_external_deps(builder, options, cc):
         if not _test_add_lib_with_header(builder, cc, 'zip', 'zip.h'):
             conf_errors.append('libzip was not found.')
 
+    if options.enable_threads and options.with_pthread:
+        if _test_header(builder, cc, 'pthread.h'):
+            cc.add_compile_flag('-pthread')
+            cc.add_define('_XOPEN_SOURCE', 700)
+            cc.add_define('WITH_PTHREAD')
+
+    if options.with_sndfile:
+        if _test_add_lib_with_header(builder, cc, 'sndfile', 'sndfile.h'):
+            cc.add_define('WITH_SNDFILE')
+        else:
+            conf_errors.append(
+                    'libsndfile support was requested but libsndfile was not found.')
+
     if options.enable_libkunquatfile:
         if not options.with_zip:
             conf_errors.append('libkunquatfile was requested without libzip.')
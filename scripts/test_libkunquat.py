@@ -55,6 +55,7 @@ def test_libkunquat(builder, options, cc):
     # Define which tests depend on others
     deps = defaultdict(lambda: [], {
             'handle': ['streader', 'tstamp'],
+            'expr': ['streader'],
             'player': ['handle', 'streader', 'fast_sin', 'fast_exp2', 'fast_log2'],
             'memory': ['handle'],
             'fft': ['memory'],
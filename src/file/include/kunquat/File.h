@@ -31,7 +31,8 @@ extern "C" {
  * \{
  *
  * \brief
- * This module contains a simple interface for accessing Kunquat files.
+ * This module contains a simple interface for accessing Kunquat files and
+ * rendering Kunquat modules into audio files.
  *
  * The header \c Handle.h contains an API for accessing Kunquat Handles.
  */
@@ -82,6 +83,77 @@ const char* kqt_Module_get_error(kqt_Module module);
 void kqt_Module_clear_error(kqt_Module module);
 
 
+/**
+ * Options for rendering a track into an audio file.
+ */
+typedef struct kqtfile_Render_options
+{
+    /// The number of bits per sample: \c 8, \c 16, \c 24 or \c 32.
+    /// Ignored if \a use_float is set.
+    int bits;
+
+    /// Non-zero for 32-bit floating-point samples.
+    int use_float;
+
+    /// The number of frames rendered at a time, or \c 0 for the default.
+    long block_size;
+
+    /// Function called after each rendered block with the current playback
+    /// position in nanoseconds and the number of clipped frames rendered so
+    /// far, or \c NULL.
+    void (*progress)(long long nanoseconds, long long clipped, void* user_data);
+
+    /// User data passed to \a progress.
+    void* user_data;
+} kqtfile_Render_options;
+
+
+/**
+ * Statistics of a rendered track.
+ */
+typedef struct kqtfile_Render_stats
+{
+    long long frames;  ///< The number of frames rendered.
+    double peak;       ///< The peak absolute sample value.
+    double rms;        ///< The RMS level of all samples.
+    long long clipped; ///< The number of frames with samples outside [-1, 1].
+} kqtfile_Render_stats;
+
+
+/**
+ * Render a track of a Kunquat Handle into an audio file.
+ *
+ * The Handle is rendered from the beginning of \a track until the end of
+ * playback in the calling thread while a separate thread encodes the rendered
+ * audio. The audio rate and the number of rendering threads are taken from
+ * \a handle, and its audio buffer size is set to the block size for the
+ * duration of the call. The output contains the first two audio buffers of
+ * \a handle.
+ *
+ * NOTE: This function is only supported if libkunquatfile is built with
+ *       libsndfile support.
+ *
+ * \param handle    The Kunquat Handle -- should be valid.
+ * \param track     The track number -- should be >= \c -1 and
+ *                  < \c KQT_TRACKS_MAX. \c -1 renders all tracks.
+ * \param path      The path of the output file -- should not be \c NULL.
+ * \param format    The output file format: "wav", "au" or "flac".
+ * \param options   The render options, or \c NULL for 16-bit output with
+ *                  default settings.
+ * \param stats     Destination for the render statistics, or \c NULL.
+ *
+ * \return   \c 1 if successful. Otherwise, \c 0 is returned and the Kunquat
+ *           file error is set accordingly.
+ */
+int kqtfile_render_track(
+        kqt_Handle handle,
+        int track,
+        const char* path,
+        const char* format,
+        const kqtfile_Render_options* options,
+        kqtfile_Render_stats* stats);
+
+
 /* \} */
 
 
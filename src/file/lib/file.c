@@ -15,11 +15,21 @@
 #include <kunquat/File.h>
 
 #include <kunquat/Handle.h>
+#include <kunquat/Player.h>
+
+#ifdef WITH_SNDFILE
+#include <sndfile.h>
+#endif
 
 #include <zip.h>
 
+#ifdef WITH_PTHREAD
+#include <pthread.h>
+#endif
+
 #include <assert.h>
 #include <limits.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -317,3 +327,568 @@ kqt_Handle kqtfile_load_module(const char* path)
 }
 
 
+#ifdef WITH_SNDFILE
+
+#define RENDER_CHANNELS 2
+#define RENDER_BLOCK_SIZE_DEFAULT 4096
+#define RENDER_QUEUE_LENGTH 4
+
+
+typedef struct Encoder
+{
+    SNDFILE* sf;
+    long block_size;
+    float* blocks[RENDER_QUEUE_LENGTH];
+    long block_frames[RENDER_QUEUE_LENGTH];
+    int read_pos;
+    int write_pos;
+    int queued;
+    bool finished;
+    bool failed;
+#ifdef WITH_PTHREAD
+    bool thread_started;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+} Encoder;
+
+
+typedef struct Render_levels
+{
+    long long frames;
+    long long clipped;
+    double peak;
+    double sum_squares;
+} Render_levels;
+
+
+static bool Encoder_init(Encoder* encoder, SNDFILE* sf, long block_size)
+{
+    assert(encoder != NULL);
+    assert(sf != NULL);
+    assert(block_size > 0);
+
+    encoder->sf = sf;
+    encoder->block_size = block_size;
+    encoder->read_pos = 0;
+    encoder->write_pos = 0;
+    encoder->queued = 0;
+    encoder->finished = false;
+    encoder->failed = false;
+
+    for (int i = 0; i < RENDER_QUEUE_LENGTH; ++i)
+    {
+        encoder->block_frames[i] = 0;
+        encoder->blocks[i] = malloc(
+                sizeof(float) * (size_t)(block_size * RENDER_CHANNELS));
+        if (encoder->blocks[i] == NULL)
+        {
+            for (int k = i - 1; k >= 0; --k)
+                free(encoder->blocks[k]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static void Encoder_deinit(Encoder* encoder)
+{
+    assert(encoder != NULL);
+
+    for (int i = 0; i < RENDER_QUEUE_LENGTH; ++i)
+    {
+        free(encoder->blocks[i]);
+        encoder->blocks[i] = NULL;
+    }
+
+    return;
+}
+
+
+static bool Encoder_write_block(Encoder* encoder, const float* block, long frames)
+{
+    assert(encoder != NULL);
+    assert(block != NULL);
+    assert(frames >= 0);
+
+    return (sf_writef_float(encoder->sf, block, frames) == frames);
+}
+
+
+#ifdef WITH_PTHREAD
+static void* encoder_thread_func(void* arg)
+{
+    assert(arg != NULL);
+
+    Encoder* encoder = arg;
+
+    pthread_mutex_lock(&encoder->lock);
+
+    while (true)
+    {
+        while ((encoder->queued == 0) && !encoder->finished)
+            pthread_cond_wait(&encoder->cond, &encoder->lock);
+
+        if (encoder->queued == 0)
+            break;
+
+        const int pos = encoder->read_pos;
+        pthread_mutex_unlock(&encoder->lock);
+
+        const bool success = Encoder_write_block(
+                encoder, encoder->blocks[pos], encoder->block_frames[pos]);
+
+        pthread_mutex_lock(&encoder->lock);
+
+        encoder->read_pos = (pos + 1) % RENDER_QUEUE_LENGTH;
+        --encoder->queued;
+        pthread_cond_signal(&encoder->cond);
+
+        if (!success)
+        {
+            encoder->failed = true;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&encoder->lock);
+
+    return NULL;
+}
+#endif
+
+
+static bool Encoder_start(Encoder* encoder)
+{
+    assert(encoder != NULL);
+
+#ifdef WITH_PTHREAD
+    encoder->thread_started = false;
+
+    if (pthread_mutex_init(&encoder->lock, NULL) != 0)
+        return false;
+
+    if (pthread_cond_init(&encoder->cond, NULL) != 0)
+    {
+        pthread_mutex_destroy(&encoder->lock);
+        return false;
+    }
+
+    if (pthread_create(&encoder->thread, NULL, encoder_thread_func, encoder) != 0)
+    {
+        pthread_cond_destroy(&encoder->cond);
+        pthread_mutex_destroy(&encoder->lock);
+        return false;
+    }
+
+    encoder->thread_started = true;
+#endif
+
+    return true;
+}
+
+
+/**
+ * Get the next free block, or \c NULL if encoding has failed.
+ */
+static float* Encoder_acquire_block(Encoder* encoder)
+{
+    assert(encoder != NULL);
+
+#ifdef WITH_PTHREAD
+    pthread_mutex_lock(&encoder->lock);
+    while ((encoder->queued == RENDER_QUEUE_LENGTH) && !encoder->failed)
+        pthread_cond_wait(&encoder->cond, &encoder->lock);
+    const bool failed = encoder->failed;
+    pthread_mutex_unlock(&encoder->lock);
+
+    if (failed)
+        return NULL;
+#else
+    if (encoder->failed)
+        return NULL;
+#endif
+
+    return encoder->blocks[encoder->write_pos];
+}
+
+
+static void Encoder_commit_block(Encoder* encoder, long frames)
+{
+    assert(encoder != NULL);
+    assert(frames >= 0);
+    assert(frames <= encoder->block_size);
+
+    const int pos = encoder->write_pos;
+    encoder->block_frames[pos] = frames;
+
+#ifdef WITH_PTHREAD
+    pthread_mutex_lock(&encoder->lock);
+    encoder->write_pos = (pos + 1) % RENDER_QUEUE_LENGTH;
+    ++encoder->queued;
+    pthread_cond_signal(&encoder->cond);
+    pthread_mutex_unlock(&encoder->lock);
+#else
+    if (!Encoder_write_block(encoder, encoder->blocks[pos], frames))
+        encoder->failed = true;
+#endif
+
+    return;
+}
+
+
+/**
+ * Wait until all committed blocks have been encoded.
+ *
+ * \return   \c true if encoding succeeded, otherwise \c false.
+ */
+static bool Encoder_finish(Encoder* encoder)
+{
+    assert(encoder != NULL);
+
+#ifdef WITH_PTHREAD
+    if (encoder->thread_started)
+    {
+        pthread_mutex_lock(&encoder->lock);
+        encoder->finished = true;
+        pthread_cond_broadcast(&encoder->cond);
+        pthread_mutex_unlock(&encoder->lock);
+
+        pthread_join(encoder->thread, NULL);
+        encoder->thread_started = false;
+
+        pthread_cond_destroy(&encoder->cond);
+        pthread_mutex_destroy(&encoder->lock);
+    }
+#endif
+
+    encoder->finished = true;
+
+    return !encoder->failed;
+}
+
+
+static bool get_sf_format(const char* format, int bits, bool use_float, int* sf_format)
+{
+    assert(format != NULL);
+    assert(sf_format != NULL);
+
+    static const struct
+    {
+        const char* name;
+        int format;
+    } formats[] =
+    {
+        { "wav",    SF_FORMAT_WAV },
+        { "au",     SF_FORMAT_AU },
+        { "flac",   SF_FORMAT_FLAC },
+    };
+
+    int major = 0;
+    for (int i = 0; i < (int)(sizeof(formats) / sizeof(*formats)); ++i)
+    {
+        if (strcmp(format, formats[i].name) == 0)
+        {
+            major = formats[i].format;
+            break;
+        }
+    }
+
+    if (major == 0)
+        return false;
+
+    if (use_float)
+    {
+        *sf_format = major | SF_FORMAT_FLOAT;
+        return true;
+    }
+
+    switch (bits)
+    {
+        case 8:
+            *sf_format = major |
+                ((major == SF_FORMAT_WAV) ? SF_FORMAT_PCM_U8 : SF_FORMAT_PCM_S8);
+            break;
+
+        case 16: *sf_format = major | SF_FORMAT_PCM_16; break;
+        case 24: *sf_format = major | SF_FORMAT_PCM_24; break;
+        case 32: *sf_format = major | SF_FORMAT_PCM_32; break;
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+
+static void Render_levels_update(Render_levels* levels, const float* block, long frames)
+{
+    assert(levels != NULL);
+    assert(block != NULL);
+    assert(frames >= 0);
+
+    double peak = levels->peak;
+    double sum_squares = 0;
+    long long clipped = 0;
+
+    for (long i = 0; i < frames; ++i)
+    {
+        bool is_clipped = false;
+        for (int ch = 0; ch < RENDER_CHANNELS; ++ch)
+        {
+            const double value = block[i * RENDER_CHANNELS + ch];
+            const double abs_value = fabs(value);
+            peak = (abs_value > peak) ? abs_value : peak;
+            sum_squares += value * value;
+            is_clipped |= (abs_value > 1.0);
+        }
+
+        clipped += is_clipped ? 1 : 0;
+    }
+
+    levels->peak = peak;
+    levels->sum_squares += sum_squares;
+    levels->clipped += clipped;
+    levels->frames += frames;
+
+    return;
+}
+
+
+static bool render_blocks(
+        kqt_Handle handle,
+        Encoder* encoder,
+        long block_size,
+        const kqtfile_Render_options* options,
+        Render_levels* levels)
+{
+    assert(handle != 0);
+    assert(encoder != NULL);
+    assert(block_size > 0);
+    assert(options != NULL);
+    assert(levels != NULL);
+
+    while (true)
+    {
+        if (!kqt_Handle_play(handle, block_size))
+        {
+            set_error(NULL, "Could not render audio: %s",
+                    kqt_Handle_get_error_message(handle));
+            kqt_Handle_clear_error(handle);
+            return false;
+        }
+
+        // The last block may contain frames rendered before the end of playback
+        const long frames = kqt_Handle_get_frames_available(handle);
+        assert(frames <= block_size);
+        if (frames == 0)
+            break;
+
+        float* block = Encoder_acquire_block(encoder);
+        if (block == NULL)
+        {
+            set_error(NULL, "Could not write audio: %s", sf_strerror(encoder->sf));
+            return false;
+        }
+
+        for (int ch = 0; ch < RENDER_CHANNELS; ++ch)
+        {
+            const float* buf = kqt_Handle_get_audio(handle, ch);
+            for (long i = 0; i < frames; ++i)
+                block[i * RENDER_CHANNELS + ch] = buf[i];
+        }
+
+        Render_levels_update(levels, block, frames);
+        Encoder_commit_block(encoder, frames);
+
+        if (options->progress != NULL)
+            options->progress(
+                    kqt_Handle_get_position(handle), levels->clipped, options->user_data);
+
+        if (kqt_Handle_has_stopped(handle))
+            break;
+    }
+
+    return true;
+}
+
+
+static bool render_to_file(
+        kqt_Handle handle,
+        const char* path,
+        const char* format,
+        int sf_format,
+        long block_size,
+        const kqtfile_Render_options* options,
+        kqtfile_Render_stats* stats)
+{
+    assert(handle != 0);
+    assert(path != NULL);
+    assert(format != NULL);
+    assert(block_size > 0);
+    assert(options != NULL);
+
+    SF_INFO info =
+    {
+        .frames = 0,
+        .samplerate = (int)kqt_Handle_get_audio_rate(handle),
+        .channels = RENDER_CHANNELS,
+        .format = sf_format,
+    };
+    if (!sf_format_check(&info))
+    {
+        set_error(NULL, "Unsupported output format: %s, %d bits", format, options->bits);
+        return false;
+    }
+
+    SNDFILE* sf = sf_open(path, SFM_WRITE, &info);
+    if (sf == NULL)
+    {
+        set_error(NULL, "Could not create file %s: %s", path, sf_strerror(NULL));
+        return false;
+    }
+
+    if (!options->use_float)
+        sf_command(sf, SFC_SET_CLIPPING, NULL, SF_TRUE);
+
+    Encoder* encoder = &(Encoder){ .sf = NULL };
+    if (!Encoder_init(encoder, sf, block_size))
+    {
+        set_error(NULL, "Could not allocate memory for audio blocks");
+        sf_close(sf);
+        return false;
+    }
+
+    if (!Encoder_start(encoder))
+    {
+        set_error(NULL, "Could not start encoder thread");
+        Encoder_deinit(encoder);
+        sf_close(sf);
+        return false;
+    }
+
+    Render_levels* levels =
+        &(Render_levels){ .frames = 0, .clipped = 0, .peak = 0, .sum_squares = 0 };
+
+    const bool rendered = render_blocks(handle, encoder, block_size, options, levels);
+    const bool encoded = Encoder_finish(encoder);
+    if (rendered && !encoded)
+        set_error(NULL, "Could not write audio: %s", sf_strerror(sf));
+
+    if (stats != NULL)
+    {
+        const long long sample_count = levels->frames * RENDER_CHANNELS;
+        stats->frames = levels->frames;
+        stats->peak = levels->peak;
+        stats->rms = (sample_count > 0)
+            ? sqrt(levels->sum_squares / (double)sample_count) : 0.0;
+        stats->clipped = levels->clipped;
+    }
+
+    Encoder_deinit(encoder);
+
+    if (sf_close(sf) != 0 && rendered && encoded)
+    {
+        set_error(NULL, "Could not finish writing file %s", path);
+        return false;
+    }
+
+    return rendered && encoded;
+}
+
+#endif // WITH_SNDFILE
+
+
+int kqtfile_render_track(
+        kqt_Handle handle,
+        int track,
+        const char* path,
+        const char* format,
+        const kqtfile_Render_options* options,
+        kqtfile_Render_stats* stats)
+{
+    if (path == NULL)
+    {
+        set_error(NULL, "path must not be NULL");
+        return 0;
+    }
+
+    if (format == NULL)
+    {
+        set_error(NULL, "format must not be NULL");
+        return 0;
+    }
+
+#ifdef WITH_SNDFILE
+    const kqtfile_Render_options default_options =
+    {
+        .bits = 16,
+        .use_float = 0,
+        .block_size = 0,
+        .progress = NULL,
+        .user_data = NULL,
+    };
+    if (options == NULL)
+        options = &default_options;
+
+    const long block_size =
+        (options->block_size > 0) ? options->block_size : RENDER_BLOCK_SIZE_DEFAULT;
+
+    int sf_format = 0;
+    if (!get_sf_format(format, options->bits, options->use_float != 0, &sf_format))
+    {
+        set_error(NULL, "Unsupported output format: %s, %d bits", format, options->bits);
+        return 0;
+    }
+
+    const long orig_buffer_size = kqt_Handle_get_audio_buffer_size(handle);
+    if (orig_buffer_size <= 0)
+    {
+        set_error(NULL, "Could not prepare Kunquat Handle for rendering: %s",
+                kqt_Handle_get_error_message(handle));
+        kqt_Handle_clear_error(handle);
+        return 0;
+    }
+
+    bool success = false;
+    if (kqt_Handle_set_audio_buffer_size(handle, block_size) &&
+            kqt_Handle_set_position(handle, track, 0))
+    {
+        success = render_to_file(
+                handle, path, format, sf_format, block_size, options, stats);
+    }
+    else
+    {
+        set_error(NULL, "Could not prepare Kunquat Handle for rendering: %s",
+                kqt_Handle_get_error_message(handle));
+        kqt_Handle_clear_error(handle);
+    }
+
+    if (!kqt_Handle_set_audio_buffer_size(handle, orig_buffer_size))
+    {
+        if (success)
+        {
+            set_error(NULL, "Could not restore the audio buffer size: %s",
+                    kqt_Handle_get_error_message(handle));
+            success = false;
+        }
+        kqt_Handle_clear_error(handle);
+    }
+
+    return success ? 1 : 0;
+
+#else
+    (void)handle;
+    (void)track;
+    (void)options;
+    (void)stats;
+    set_error(NULL, "libkunquatfile was built without libsndfile support");
+    return 0;
+#endif
+}
+
+
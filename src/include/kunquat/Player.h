@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -68,6 +68,10 @@ extern "C" {
  * If this function is called after the end of the composition is reached,
  * more audio is produced as if the composition were paused indefinitely.
  *
+ * Denormal floating-point values are flushed to zero in all rendering threads,
+ * including the calling thread. The floating-point state of the calling thread
+ * is restored before this function returns.
+ *
  * \param handle    The Handle -- should be valid.
  * \param nframes   The number of frames to be rendered -- should be > \c 0.
  *
@@ -122,6 +126,104 @@ long kqt_Handle_get_frames_available(kqt_Handle handle);
 const float* kqt_Handle_get_audio(kqt_Handle handle, int index);
 
 
+/**
+ * Set the source of a stem rendered by the Kunquat Handle.
+ *
+ * Stems are additional stereo outputs that are filled during the same call
+ * of kqt_Handle_play as the main output, so rendering several stems does not
+ * require rendering the composition several times. The source is given as
+ * one of the following:
+ *
+ * \li "au_XX" -- The output ports \c 0 and \c 1 of the top-level audio unit
+ *     with index \c XX. The signal is taken before the master volume and
+ *     the DC blocker are applied.
+ * \li "out_XX" -- The master input ports \c XX and \c XX + 1. The signal
+ *     is identical to the main output if \c XX is \c 00.
+ * \li \c NULL or "" -- Disable the stem.
+ *
+ * The index \c XX is given in hexadecimal, as in the composition keys. A
+ * stem with a source that does not produce any signal is filled with zeros.
+ *
+ * \param handle   The Handle -- should be valid.
+ * \param stem     The stem number -- should be >= \c 0 and
+ *                 < \c KQT_STEMS_MAX.
+ * \param source   The stem source, see above.
+ *
+ * \return   \c 1 if successful, otherwise \c 0.
+ */
+int kqt_Handle_set_stem(kqt_Handle handle, int stem, const char* source);
+
+
+/**
+ * Get a stem buffer from the Kunquat Handle.
+ *
+ * The stem buffers contain the same number of frames as the buffers returned
+ * by kqt_Handle_get_audio.
+ *
+ * \param handle   The Handle -- should be valid.
+ * \param stem     The number of an enabled stem -- should be >= \c 0 and
+ *                 < \c KQT_STEMS_MAX.
+ * \param index    The output channel number. \c 0 is the left
+ *                 buffer and \c 1 is the right one.
+ *
+ * \return   The buffer, or \c NULL if \a handle is not valid, \a stem is
+ *           not enabled or \a index is out of range.
+ *           Note: Do not cache the returned value! The location of the buffer
+ *           may change in memory.
+ */
+const float* kqt_Handle_get_stem_audio(kqt_Handle handle, int stem, int index);
+
+
+/**
+ * Audio levels of one output channel.
+ */
+typedef struct kqt_Audio_levels
+{
+    double peak;    ///< The peak absolute sample value.
+    double rms;     ///< The RMS level of the samples.
+    long clipped;   ///< The number of samples outside the range [-1.0, 1.0].
+} kqt_Audio_levels;
+
+
+/**
+ * Get the audio levels of an output buffer of the Kunquat Handle.
+ *
+ * The levels are measured by libkunquat while the buffers are filled in
+ * kqt_Handle_play, and they describe the frames in the buffer returned by
+ * kqt_Handle_get_audio. This allows applications to display level meters
+ * and detect clipping without processing the audio data themselves.
+ *
+ * \param handle   The Handle -- should be valid.
+ * \param index    The output channel number. \c 0 is the left
+ *                 mixing buffer and \c 1 is the right one.
+ * \param levels   The destination of the audio levels -- should not be
+ *                 \c NULL.
+ *
+ * \return   \c 1 if successful, otherwise \c 0.
+ */
+int kqt_Handle_get_audio_levels(kqt_Handle handle, int index, kqt_Audio_levels* levels);
+
+
+/**
+ * Get the audio levels of a stem buffer of the Kunquat Handle.
+ *
+ * Combined with stems that have audio units as their sources, this function
+ * can be used to meter the output of each audio unit.
+ *
+ * \param handle   The Handle -- should be valid.
+ * \param stem     The number of an enabled stem -- should be >= \c 0 and
+ *                 < \c KQT_STEMS_MAX.
+ * \param index    The output channel number. \c 0 is the left
+ *                 buffer and \c 1 is the right one.
+ * \param levels   The destination of the audio levels -- should not be
+ *                 \c NULL.
+ *
+ * \return   \c 1 if successful, otherwise \c 0.
+ */
+int kqt_Handle_get_stem_audio_levels(
+        kqt_Handle handle, int stem, int index, kqt_Audio_levels* levels);
+
+
 /**
  * Set the number of threads used in audio rendering by the Kunquat Handle.
  *
@@ -147,6 +249,76 @@ int kqt_Handle_set_thread_count(kqt_Handle handle, int count);
 int kqt_Handle_get_thread_count(kqt_Handle handle);
 
 
+/**
+ * Set up a render thread pool shared by all Kunquat Handles.
+ *
+ * By default, each Kunquat Handle with a thread count greater than \c 1
+ * creates threads of its own. When the global thread pool is set, Handles
+ * created afterwards execute their rendering tasks in the shared pool instead,
+ * and their thread count sets the number of tasks that can run in parallel.
+ * Handles that are not rendering do not occupy any threads.
+ *
+ * This function can only be called when no Kunquat Handles exist.
+ *
+ * NOTE: If libkunquat is built without thread support, this function will have
+ *       no effect.
+ *
+ * \param thread_count   The number of threads in the pool -- should be
+ *                       >= \c 0 and <= \c KQT_THREAD_POOL_SIZE_MAX. \c 0
+ *                       removes the current pool.
+ *
+ * \return   \c 1 if successful, otherwise \c 0 (check
+ *           kqt_Handle_get_error(\c 0) for the error message).
+ */
+int kqt_set_global_thread_pool(int thread_count);
+
+
+/**
+ * Set the scheduling policy of the rendering threads of the Kunquat Handle.
+ *
+ * The supported policies are "default", "fifo" and "rr". Realtime policies
+ * usually require privileges that ordinary processes do not have. If the
+ * policy cannot be set, the rendering threads retain their previous scheduling
+ * and the Handle remains usable. The policy is also applied to threads created
+ * later by kqt_Handle_set_thread_count if possible. The policy does not affect
+ * the global thread pool or the thread that calls kqt_Handle_play.
+ *
+ * NOTE: If libkunquat is built without thread support, this function will have
+ *       no effect.
+ *
+ * \param handle     The Handle -- should be valid.
+ * \param policy     The scheduling policy -- should be one of the above.
+ * \param priority   The realtime priority -- should be >= \c 1 and <= \c 99
+ *                   with a realtime \a policy. Ignored with "default".
+ *
+ * \return   \c 1 if successful, otherwise \c 0.
+ */
+int kqt_Handle_set_thread_scheduling(
+        kqt_Handle handle, const char* policy, int priority);
+
+
+/**
+ * Set the CPU affinity of a rendering thread of the Kunquat Handle.
+ *
+ * The affinity of a thread that does not exist yet is applied when the thread
+ * is created by kqt_Handle_set_thread_count. The affinity does not affect the
+ * global thread pool or the thread that calls kqt_Handle_play.
+ *
+ * NOTE: If libkunquat is built without thread support, this function will have
+ *       no effect.
+ *
+ * \param handle         The Handle -- should be valid.
+ * \param thread_index   The index of the rendering thread -- should be
+ *                       >= \c 0 and < \c KQT_THREADS_MAX.
+ * \param cpu_mask       The set of allowed CPUs with bit \a n set for CPU
+ *                       \a n, or \c 0 for all CPUs.
+ *
+ * \return   \c 1 if successful, otherwise \c 0.
+ */
+int kqt_Handle_set_thread_affinity(
+        kqt_Handle handle, int thread_index, unsigned long long cpu_mask);
+
+
 /**
  * Set the audio rate of the Kunquat Handle.
  *
@@ -282,6 +454,36 @@ int kqt_Handle_set_channel_mute(kqt_Handle handle, int channel, int mute);
 int kqt_Handle_fire_event(kqt_Handle handle, int channel, const char* event);
 
 
+/**
+ * Queue an event to be fired during playback.
+ *
+ * Unlike \a kqt_Handle_fire_event, this function may be called from another
+ * thread while \a kqt_Handle_play is being called. The event is fired inside
+ * \a kqt_Handle_play at the first audio frame at or after \a timestamp, so
+ * it does not need to wait for a block boundary. Events with a timestamp in
+ * the past are fired at the start of the next rendered block. Events are
+ * fired in the order they are queued, so the timestamps of consecutive
+ * events should not decrease.
+ *
+ * This function must not be called concurrently with functions that modify
+ * the composition data or the playback position. Pending events are removed
+ * when the playback position is reset with \a kqt_Handle_set_position.
+ *
+ * \param handle      The Handle -- should be valid.
+ * \param channel     The channel where the event takes place -- should be
+ *                    >= \c 0 and < \c KQT_CHANNELS_MAX.
+ * \param event       The event description in JSON format -- should not be
+ *                    \c NULL. The format is the same as in
+ *                    \a kqt_Handle_fire_event.
+ * \param timestamp   The playback time of the event in nanoseconds, in the
+ *                    same time base as \a kqt_Handle_get_position.
+ *
+ * \return   \c 1 if the event was successfully queued, otherwise \c 0.
+ */
+int kqt_Handle_queue_event(
+        kqt_Handle handle, int channel, const char* event, long long timestamp);
+
+
 /**
  * Return a JSON list of events.
  *
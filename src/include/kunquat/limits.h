@@ -45,6 +45,13 @@ extern "C" {
 #define KQT_BUFFERS_MAX 2
 
 
+/**
+ * Maximum number of stems a Kunquat Handle can render in addition to the
+ * main output. Each stem contains \c KQT_BUFFERS_MAX output buffers.
+ */
+#define KQT_STEMS_MAX 16
+
+
 /**
  * Maximum size of an output buffer in frames.
  *
@@ -60,6 +67,12 @@ extern "C" {
 #define KQT_THREADS_MAX 32
 
 
+/**
+ * Maximum number of threads in the global render thread pool.
+ */
+#define KQT_THREAD_POOL_SIZE_MAX 256
+
+
 /**
  * Maximum calculated length of a Kunquat composition.
  *
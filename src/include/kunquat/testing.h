@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2013-2014
+ * Author: Tomi Jylhä-Ollila, Finland 2013-2018
  *
  * This file is part of Kunquat.
  *
@@ -21,6 +21,9 @@ extern "C" {
 #endif
 
 
+#include <kunquat/Handle.h>
+
+
 /**
  * \defgroup Testing Testing support functions
  * \{
@@ -56,6 +59,40 @@ long kqt_get_memory_alloc_count(void);
 void kqt_suppress_assert_messages(void);
 
 
+/**
+ * Get the number of operations that are not realtime-safe made during audio
+ * rendering by the Kunquat Handle.
+ *
+ * The operations are counted inside kqt_Handle_play, including the work done
+ * by the rendering threads, if libkunquat is built with render checks
+ * enabled. The supported operation types are:
+ *
+ * \li "alloc" -- Memory allocation or reallocation.
+ * \li "free" -- Memory deallocation.
+ * \li "lock" -- Mutex locking.
+ *
+ * \param handle   The Handle -- should be valid.
+ * \param type     The operation type -- should be one of the above.
+ *
+ * \return   The number of operations made since the creation of \a handle,
+ *           or \c -1 if an error occurred or libkunquat is built without
+ *           render checks.
+ */
+long long kqt_Handle_get_render_check_count(kqt_Handle handle, const char* type);
+
+
+/**
+ * Set whether operations that are not realtime-safe abort the program.
+ *
+ * If enabled, an operation counted by kqt_Handle_get_render_check_count
+ * prints a backtrace (if supported) and aborts the program instead. This
+ * function has no effect if libkunquat is built without render checks.
+ *
+ * \param enabled   \c 1 to abort, or \c 0 to count the operations.
+ */
+void kqt_set_render_check_abort(int enabled);
+
+
 /* \} */
 
 
@@ -22,6 +22,7 @@
 #include <kunquat/limits.h>
 #include <memory.h>
 #include <string/common.h>
+#include <threads/Thread_pool.h>
 
 #include <stdlib.h>
 #include <stdbool.h>
@@ -39,6 +40,9 @@ static Handle* handles[KQT_HANDLES_MAX] = { NULL };
 // For errors without an associated Kunquat Handle.
 static Error null_error = { "", "", ERROR_COUNT_ };
 
+// Shared by the Players of all Handles if set
+static Thread_pool* global_thread_pool = NULL;
+
 
 static bool remove_handle(kqt_Handle handle);
 
@@ -199,6 +203,8 @@ bool Handle_init(Handle* handle)
         return false;
     }
 
+    Player_set_thread_pool(handle->player, global_thread_pool);
+
     Player_reset(handle->player, -1);
 
     return true;
@@ -753,6 +759,55 @@ void kqt_del_Handle(kqt_Handle handle)
 }
 
 
+int kqt_set_global_thread_pool(int thread_count)
+{
+    if (thread_count < 0)
+    {
+        Handle_set_error(NULL, ERROR_ARGUMENT, "Thread count must not be negative");
+        return 0;
+    }
+    if (thread_count > KQT_THREAD_POOL_SIZE_MAX)
+    {
+        Handle_set_error(
+                NULL,
+                ERROR_ARGUMENT,
+                "Thread count must not exceed %d",
+                KQT_THREAD_POOL_SIZE_MAX);
+        return 0;
+    }
+
+    for (int i = 0; i < KQT_HANDLES_MAX; ++i)
+    {
+        if (handles[i] != NULL)
+        {
+            Handle_set_error(
+                    NULL,
+                    ERROR_ARGUMENT,
+                    "Global thread pool cannot be changed while Kunquat Handles exist");
+            return 0;
+        }
+    }
+
+    del_Thread_pool(global_thread_pool);
+    global_thread_pool = NULL;
+
+#ifdef ENABLE_THREADS
+    if (thread_count > 0)
+    {
+        Error* error = ERROR_AUTO;
+        global_thread_pool = new_Thread_pool(thread_count, error);
+        if (global_thread_pool == NULL)
+        {
+            Handle_set_error_from_Error(NULL, error);
+            return 0;
+        }
+    }
+#endif
+
+    return 1;
+}
+
+
 bool kqt_Handle_is_valid(kqt_Handle handle)
 {
     if (handle <= 0)
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -15,13 +15,16 @@
 #include <Handle_private.h>
 
 #include <debug/assert.h>
+#include <debug/Render_checks.h>
 #include <Error.h>
 #include <init/Env_var.h>
 #include <init/Module.h>
 #include <kunquat/Player.h>
 #include <kunquat/limits.h>
+#include <kunquat/testing.h>
 #include <mathnum/common.h>
 #include <string/common.h>
+#include <threads/Thread.h>
 
 #include <inttypes.h>
 #include <limits.h>
@@ -163,6 +166,94 @@ int kqt_Handle_get_thread_count(kqt_Handle handle)
 }
 
 
+int kqt_Handle_set_thread_scheduling(
+        kqt_Handle handle, const char* policy, int priority)
+{
+    check_handle(handle, 0);
+
+    Handle* h = get_handle(handle);
+    check_data_is_valid(h, 0);
+    check_data_is_validated(h, 0);
+
+    if (policy == NULL)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Scheduling policy must not be NULL");
+        return 0;
+    }
+
+    static const char* policy_names[] = { "default", "fifo", "rr" };
+    static const Thread_sched_policy policies[] =
+    {
+        THREAD_SCHED_DEFAULT, THREAD_SCHED_FIFO, THREAD_SCHED_RR,
+    };
+
+    int policy_index = -1;
+    for (int i = 0; i < (int)(sizeof(policies) / sizeof(*policies)); ++i)
+    {
+        if (string_eq(policy, policy_names[i]))
+        {
+            policy_index = i;
+            break;
+        }
+    }
+
+    if (policy_index < 0)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Unsupported scheduling policy: %s", policy);
+        return 0;
+    }
+
+    const Thread_sched_policy sched_policy = policies[policy_index];
+    if ((sched_policy != THREAD_SCHED_DEFAULT) && ((priority < 1) || (priority > 99)))
+    {
+        Handle_set_error(
+                h, ERROR_ARGUMENT, "Realtime thread priority must be within [1, 99]");
+        return 0;
+    }
+
+    Error* error = ERROR_AUTO;
+
+    if (!Player_set_thread_scheduling(h->player, sched_policy, priority, error))
+    {
+        Handle_set_error_from_Error(h, error);
+        return 0;
+    }
+
+    return 1;
+}
+
+
+int kqt_Handle_set_thread_affinity(
+        kqt_Handle handle, int thread_index, unsigned long long cpu_mask)
+{
+    check_handle(handle, 0);
+
+    Handle* h = get_handle(handle);
+    check_data_is_valid(h, 0);
+    check_data_is_validated(h, 0);
+
+    if ((thread_index < 0) || (thread_index >= KQT_THREADS_MAX))
+    {
+        Handle_set_error(
+                h,
+                ERROR_ARGUMENT,
+                "Thread index must be within [0, %d)",
+                KQT_THREADS_MAX);
+        return 0;
+    }
+
+    Error* error = ERROR_AUTO;
+
+    if (!Player_set_thread_affinity(h->player, thread_index, (uint64_t)cpu_mask, error))
+    {
+        Handle_set_error_from_Error(h, error);
+        return 0;
+    }
+
+    return 1;
+}
+
+
 int kqt_Handle_set_audio_buffer_size(kqt_Handle handle, long size)
 {
     check_handle(handle, 0);
@@ -240,6 +331,163 @@ const float* kqt_Handle_get_audio(kqt_Handle handle, int index)
 }
 
 
+int kqt_Handle_set_stem(kqt_Handle handle, int stem, const char* source)
+{
+    check_handle(handle, 0);
+
+    Handle* h = get_handle(handle);
+    check_data_is_valid(h, 0);
+    check_data_is_validated(h, 0);
+
+    if (stem < 0 || stem >= KQT_STEMS_MAX)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Stem #%d does not exist", stem);
+        return 0;
+    }
+
+    Player_stem_source stem_source = PLAYER_STEM_NONE;
+    int index = 0;
+
+    if ((source != NULL) && !string_eq(source, ""))
+    {
+        index = string_extract_index(source, "au_", 2, "");
+        if (index >= 0)
+        {
+            stem_source = PLAYER_STEM_AUDIO_UNIT;
+        }
+        else
+        {
+            index = string_extract_index(source, "out_", 2, "");
+            if (index < 0 || index >= KQT_DEVICE_PORTS_MAX - 1)
+            {
+                Handle_set_error(h, ERROR_ARGUMENT, "Invalid stem source: %s", source);
+                return 0;
+            }
+
+            stem_source = PLAYER_STEM_MASTER_PORTS;
+        }
+    }
+
+    if (!Player_set_stem(h->player, stem, stem_source, index))
+    {
+        Handle_set_error(h, ERROR_MEMORY, "Couldn't allocate memory for stem buffers");
+        return 0;
+    }
+
+    return 1;
+}
+
+
+const float* kqt_Handle_get_stem_audio(kqt_Handle handle, int stem, int index)
+{
+    check_handle(handle, NULL);
+
+    Handle* h = get_handle(handle);
+    check_data_is_valid(h, NULL);
+    check_data_is_validated(h, NULL);
+
+    if (stem < 0 || stem >= KQT_STEMS_MAX)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Stem #%d does not exist", stem);
+        return NULL;
+    }
+
+    if (index < 0 || index >= KQT_BUFFERS_MAX)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Buffer #%d does not exist", index);
+        return NULL;
+    }
+
+    const float* buffer = Player_get_stem_audio(h->player, stem, index);
+    if (buffer == NULL)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Stem #%d is not enabled", stem);
+        return NULL;
+    }
+
+    return buffer;
+}
+
+
+static void copy_levels(kqt_Audio_levels* dest, const Player_levels* src)
+{
+    rassert(dest != NULL);
+    rassert(src != NULL);
+
+    dest->peak = src->peak;
+    dest->rms = src->rms;
+    dest->clipped = src->clipped;
+
+    return;
+}
+
+
+int kqt_Handle_get_audio_levels(kqt_Handle handle, int index, kqt_Audio_levels* levels)
+{
+    check_handle(handle, 0);
+
+    Handle* h = get_handle(handle);
+    check_data_is_valid(h, 0);
+    check_data_is_validated(h, 0);
+
+    if (index < 0 || index >= KQT_BUFFERS_MAX)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Buffer #%d does not exist", index);
+        return 0;
+    }
+
+    if (levels == NULL)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "No destination for audio levels");
+        return 0;
+    }
+
+    copy_levels(levels, Player_get_levels(h->player, index));
+
+    return 1;
+}
+
+
+int kqt_Handle_get_stem_audio_levels(
+        kqt_Handle handle, int stem, int index, kqt_Audio_levels* levels)
+{
+    check_handle(handle, 0);
+
+    Handle* h = get_handle(handle);
+    check_data_is_valid(h, 0);
+    check_data_is_validated(h, 0);
+
+    if (stem < 0 || stem >= KQT_STEMS_MAX)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Stem #%d does not exist", stem);
+        return 0;
+    }
+
+    if (index < 0 || index >= KQT_BUFFERS_MAX)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Buffer #%d does not exist", index);
+        return 0;
+    }
+
+    if (levels == NULL)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "No destination for audio levels");
+        return 0;
+    }
+
+    const Player_levels* stem_levels = Player_get_stem_levels(h->player, stem, index);
+    if (stem_levels == NULL)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Stem #%d is not enabled", stem);
+        return 0;
+    }
+
+    copy_levels(levels, stem_levels);
+
+    return 1;
+}
+
+
 long long kqt_Handle_get_duration(kqt_Handle handle, int track)
 {
     check_handle(handle, -1);
@@ -372,6 +620,52 @@ int kqt_Handle_fire_event(kqt_Handle handle, int channel, const char* event)
 }
 
 
+int kqt_Handle_queue_event(
+        kqt_Handle handle, int channel, const char* event, long long timestamp)
+{
+    check_handle(handle, 0);
+
+    Handle* h = get_handle(handle);
+    check_data_is_valid(h, 0);
+    check_data_is_validated(h, 0);
+
+    if (channel < 0 || channel >= KQT_COLUMNS_MAX)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Invalid channel number: %d", channel);
+        return 0;
+    }
+    if (event == NULL)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "No event description given");
+        return 0;
+    }
+
+    const size_t length = strlen(event);
+    if (length > 4096)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Event description is too long");
+        return 0;
+    }
+
+    Streader* sr = Streader_init(STREADER_AUTO, event, (int64_t)length);
+    if (!Player_queue_event(h->player, channel, sr, timestamp))
+    {
+        if (Streader_is_error_set(sr))
+            Handle_set_error(
+                    h,
+                    ERROR_ARGUMENT,
+                    "Invalid event description `%s`: %s",
+                    event, Streader_get_error_desc(sr));
+        else
+            Handle_set_error(h, ERROR_RESOURCE, "Event queue is full");
+
+        return 0;
+    }
+
+    return 1;
+}
+
+
 const char* kqt_Handle_receive_events(kqt_Handle handle)
 {
     check_handle(handle, 0);
@@ -384,3 +678,45 @@ const char* kqt_Handle_receive_events(kqt_Handle handle)
 }
 
 
+long long kqt_Handle_get_render_check_count(kqt_Handle handle, const char* type)
+{
+    check_handle(handle, -1);
+
+    Handle* h = get_handle(handle);
+    check_data_is_valid(h, -1);
+    check_data_is_validated(h, -1);
+
+    if (type == NULL)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Operation type must not be NULL");
+        return -1;
+    }
+
+    static const char* type_names[RENDER_CHECK_TYPES] = { "alloc", "free", "lock" };
+
+    int type_index = -1;
+    for (int i = 0; i < RENDER_CHECK_TYPES; ++i)
+    {
+        if (string_eq(type, type_names[i]))
+        {
+            type_index = i;
+            break;
+        }
+    }
+
+    if (type_index < 0)
+    {
+        Handle_set_error(h, ERROR_ARGUMENT, "Unsupported operation type: %s", type);
+        return -1;
+    }
+
+#ifdef ENABLE_RENDER_CHECKS
+    return Render_checks_get_count(
+            Player_get_render_checks(h->player), (Render_check_type)type_index);
+#else
+    Handle_set_error(h, ERROR_RESOURCE, "libkunquat was built without render checks");
+    return -1;
+#endif
+}
+
+
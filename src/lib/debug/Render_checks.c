@@ -0,0 +1,107 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <debug/Render_checks.h>
+
+#include <debug/assert.h>
+#include <threads/Atomic.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+// C99 has no thread-local storage, so we rely on the extension of GCC and Clang
+static __thread Render_checks* scope_checks = NULL;
+
+static int64_t abort_enabled = 0;
+
+
+void Render_checks_init(Render_checks* checks)
+{
+    rassert(checks != NULL);
+
+    for (int i = 0; i < RENDER_CHECK_TYPES; ++i)
+        checks->counts[i] = 0;
+
+    return;
+}
+
+
+Render_checks* Render_checks_enter_scope(Render_checks* checks)
+{
+    rassert(checks != NULL);
+
+    Render_checks* prev_checks = scope_checks;
+    scope_checks = checks;
+
+    return prev_checks;
+}
+
+
+void Render_checks_leave_scope(Render_checks* prev_checks)
+{
+    scope_checks = prev_checks;
+    return;
+}
+
+
+void Render_checks_report(Render_check_type type)
+{
+    rassert(type >= 0);
+    rassert(type < RENDER_CHECK_TYPES);
+
+    Render_checks* checks = scope_checks;
+    if (checks == NULL)
+        return;
+
+    if (atomic_load_i64(&abort_enabled) != 0)
+    {
+        static const char* type_names[] =
+        {
+            "Memory allocation", "Memory deallocation", "Mutex locking",
+        };
+
+        // Leave the scope so that printing the backtrace is not reported
+        scope_checks = NULL;
+
+        fprintf(stderr, "libkunquat: %s during audio rendering\n", type_names[type]);
+        assert_print_backtrace();
+        abort();
+    }
+
+    atomic_add_i64(&checks->counts[type], 1);
+
+    return;
+}
+
+
+void Render_checks_set_abort(bool enabled)
+{
+    atomic_store_i64(&abort_enabled, enabled ? 1 : 0);
+    return;
+}
+
+
+int64_t Render_checks_get_count(const Render_checks* checks, Render_check_type type)
+{
+    rassert(checks != NULL);
+    rassert(type >= 0);
+    rassert(type < RENDER_CHECK_TYPES);
+
+    return atomic_load_i64(&checks->counts[type]);
+}
+
+
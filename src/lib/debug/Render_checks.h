@@ -0,0 +1,111 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#ifndef KQT_RENDER_CHECKS_H
+#define KQT_RENDER_CHECKS_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * Detection of operations that are not realtime-safe during audio rendering.
+ *
+ * The rendering code marks its scope on each participating thread, and memory
+ * management and locking functions report themselves through
+ * \a Render_checks_report. The reports are only made if libkunquat is built
+ * with ENABLE_RENDER_CHECKS; otherwise the counts stay at zero.
+ */
+
+
+typedef enum
+{
+    RENDER_CHECK_ALLOC = 0,
+    RENDER_CHECK_FREE,
+    RENDER_CHECK_LOCK,
+    RENDER_CHECK_TYPES
+} Render_check_type;
+
+
+typedef struct Render_checks
+{
+    int64_t counts[RENDER_CHECK_TYPES];
+} Render_checks;
+
+
+/**
+ * Initialise the Render checks.
+ *
+ * \param checks   The Render checks -- must not be \c NULL.
+ */
+void Render_checks_init(Render_checks* checks);
+
+
+/**
+ * Mark the start of a render scope on the calling thread.
+ *
+ * \param checks   The Render checks that receive the reports made in the
+ *                 scope -- must not be \c NULL.
+ *
+ * \return   The Render checks of the enclosing scope, or \c NULL if the
+ *           calling thread was not in a render scope. This must be passed
+ *           to \a Render_checks_leave_scope.
+ */
+Render_checks* Render_checks_enter_scope(Render_checks* checks);
+
+
+/**
+ * Mark the end of a render scope on the calling thread.
+ *
+ * \param prev_checks   The return value of the matching call of
+ *                      \a Render_checks_enter_scope.
+ */
+void Render_checks_leave_scope(Render_checks* prev_checks);
+
+
+/**
+ * Report an operation made by the calling thread.
+ *
+ * The operation is ignored outside render scopes. Inside a render scope it is
+ * counted, or the program is aborted with a backtrace if aborting has been
+ * enabled with \a Render_checks_set_abort.
+ *
+ * \param type   The type of the operation -- must be valid.
+ */
+void Render_checks_report(Render_check_type type);
+
+
+/**
+ * Set whether operations reported in render scopes abort the program.
+ *
+ * \param enabled   \c true to abort, or \c false to count the operations.
+ */
+void Render_checks_set_abort(bool enabled);
+
+
+/**
+ * Get the number of operations reported.
+ *
+ * \param checks   The Render checks -- must not be \c NULL.
+ * \param type     The type of the operation -- must be valid.
+ *
+ * \return   The number of operations of type \a type.
+ */
+int64_t Render_checks_get_count(const Render_checks* checks, Render_check_type type);
+
+
+#endif // KQT_RENDER_CHECKS_H
+
+
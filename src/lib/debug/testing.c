@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2013-2016
+ * Author: Tomi Jylhä-Ollila, Finland 2013-2018
  *
  * This file is part of Kunquat.
  *
@@ -15,6 +15,7 @@
 #include <kunquat/testing.h>
 
 #include <debug/assert.h>
+#include <debug/Render_checks.h>
 #include <mathnum/common.h>
 #include <memory.h>
 
@@ -41,3 +42,10 @@ void kqt_suppress_assert_messages(void)
 }
 
 
+void kqt_set_render_check_abort(int enabled)
+{
+    Render_checks_set_abort(enabled != 0);
+    return;
+}
+
+
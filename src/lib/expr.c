@@ -16,6 +16,7 @@
 
 #include <debug/assert.h>
 #include <mathnum/common.h>
+#include <memory.h>
 #include <Pat_inst_ref.h>
 #include <string/common.h>
 
@@ -482,6 +483,622 @@ static bool evaluate_expr_(
 #undef check_stack
 
 
+typedef enum
+{
+    INSTR_CONST,
+    INSTR_META,
+    INSTR_VAR,
+    INSTR_NOT,
+    INSTR_MINUS,
+    INSTR_OP,
+    INSTR_FUNC,
+} Instr_type;
+
+
+typedef struct Instr
+{
+    uint8_t type;
+    uint8_t arg_count;
+    int16_t index;
+} Instr;
+
+
+typedef char Var_name[KQT_VAR_NAME_MAX + 1];
+
+
+struct Compiled_expr
+{
+    int instr_count;
+    Instr* instrs;
+    int const_count;
+    Value* consts;
+    int var_count;
+    Var_name* var_names;
+};
+
+
+static int get_func_index(const char* token)
+{
+    rassert(token != NULL);
+
+    for (int i = 0; funcs[i].name != NULL; ++i)
+    {
+        if (string_eq(funcs[i].name, token))
+            return i;
+    }
+
+    return -1;
+}
+
+
+static int get_operator_index(const char* token)
+{
+    rassert(token != NULL);
+
+    for (int i = 0; operators[i].name != NULL; ++i)
+    {
+        if (string_eq(operators[i].name, token))
+            return i;
+    }
+
+    return -1;
+}
+
+
+static bool Compiled_expr_add_instr(
+        Compiled_expr* cexpr, Instr_type type, int index, int arg_count, Streader* sr)
+{
+    rassert(cexpr != NULL);
+    rassert(index >= 0);
+    rassert(index <= INT16_MAX);
+    rassert(arg_count >= 0);
+    rassert(arg_count <= FUNC_ARGS_MAX);
+    rassert(sr != NULL);
+
+    Instr* new_instrs =
+        memory_realloc_items(Instr, cexpr->instr_count + 1, cexpr->instrs);
+    if (new_instrs == NULL)
+    {
+        Streader_set_memory_error(sr, "Could not allocate memory for expression");
+        return false;
+    }
+    cexpr->instrs = new_instrs;
+
+    Instr* instr = &cexpr->instrs[cexpr->instr_count];
+    instr->type = (uint8_t)type;
+    instr->arg_count = (uint8_t)arg_count;
+    instr->index = (int16_t)index;
+    ++cexpr->instr_count;
+
+    return true;
+}
+
+
+static bool Compiled_expr_add_const(Compiled_expr* cexpr, const Value* value, Streader* sr)
+{
+    rassert(cexpr != NULL);
+    rassert(value != NULL);
+    rassert(sr != NULL);
+
+    if (cexpr->const_count >= INT16_MAX)
+    {
+        Streader_set_error(sr, "Too many constants in expression");
+        return false;
+    }
+
+    Value* new_consts =
+        memory_realloc_items(Value, cexpr->const_count + 1, cexpr->consts);
+    if (new_consts == NULL)
+    {
+        Streader_set_memory_error(sr, "Could not allocate memory for expression");
+        return false;
+    }
+    cexpr->consts = new_consts;
+
+    Value_copy(&cexpr->consts[cexpr->const_count], value);
+    ++cexpr->const_count;
+
+    return Compiled_expr_add_instr(cexpr, INSTR_CONST, cexpr->const_count - 1, 0, sr);
+}
+
+
+static bool Compiled_expr_add_var(Compiled_expr* cexpr, const char* name, Streader* sr)
+{
+    rassert(cexpr != NULL);
+    rassert(name != NULL);
+    rassert(strlen(name) <= KQT_VAR_NAME_MAX);
+    rassert(sr != NULL);
+
+    if (cexpr->var_count >= INT16_MAX)
+    {
+        Streader_set_error(sr, "Too many variables in expression");
+        return false;
+    }
+
+    Var_name* new_var_names =
+        memory_realloc_items(Var_name, cexpr->var_count + 1, cexpr->var_names);
+    if (new_var_names == NULL)
+    {
+        Streader_set_memory_error(sr, "Could not allocate memory for expression");
+        return false;
+    }
+    cexpr->var_names = new_var_names;
+
+    strcpy(cexpr->var_names[cexpr->var_count], name);
+    ++cexpr->var_count;
+
+    return Compiled_expr_add_instr(cexpr, INSTR_VAR, cexpr->var_count - 1, 0, sr);
+}
+
+
+static bool Compiled_expr_add_unary(
+        Compiled_expr* cexpr, bool found_not, bool found_minus, Streader* sr)
+{
+    rassert(cexpr != NULL);
+    rassert(sr != NULL);
+
+    if (found_not && found_minus)
+    {
+        Streader_set_error(sr, "Conflicting unary operators");
+        return false;
+    }
+
+    if (found_not)
+        return Compiled_expr_add_instr(cexpr, INSTR_NOT, 0, 0, sr);
+    else if (found_minus)
+        return Compiled_expr_add_instr(cexpr, INSTR_MINUS, 0, 0, sr);
+
+    return true;
+}
+
+
+static bool Compiled_expr_add_operand(Compiled_expr* cexpr, char* token, Streader* sr)
+{
+    rassert(cexpr != NULL);
+    rassert(token != NULL);
+    rassert(sr != NULL);
+
+    if (string_eq(token, "$"))
+        return Compiled_expr_add_instr(cexpr, INSTR_META, 0, 0, sr);
+
+    if (strchr(KQT_VAR_INIT_CHARS, token[0]) != NULL &&
+            !string_eq(token, "true") &&
+            !string_eq(token, "false"))
+        return Compiled_expr_add_var(cexpr, token, sr);
+
+    // Literals do not depend on the environment or the meta variable
+    Value* value = VALUE_AUTO;
+    if (!Value_from_token(value, token, NULL, VALUE_AUTO))
+    {
+        Streader_set_error(sr, "Unrecognised token");
+        return false;
+    }
+
+    return Compiled_expr_add_const(cexpr, value, sr);
+}
+
+
+static bool is_operand_token(const char* token)
+{
+    rassert(token != NULL);
+
+    return isdigit(token[0]) ||
+        (token[0] == '.') ||
+        (token[0] == '\'') ||
+        string_has_prefix(token, "\\\"") ||
+        string_eq(token, "$") ||
+        (strchr(KQT_VAR_INIT_CHARS, token[0]) != NULL);
+}
+
+
+#define check_stack(si) if (true)                     \
+    {                                                 \
+        if ((si) >= STACK_SIZE)                       \
+        {                                             \
+            rassert((si) == STACK_SIZE);              \
+            Streader_set_error(sr, "Stack overflow"); \
+            return false;                             \
+        }                                             \
+    } else ignore(0)
+
+static bool compile_expr_(
+        Streader* sr,
+        Compiled_expr* cexpr,
+        int vsi,
+        int* op_stack,
+        int osi,
+        int depth,
+        bool func_arg)
+{
+    rassert(sr != NULL);
+    rassert(cexpr != NULL);
+    rassert(vsi >= 0);
+    rassert(vsi <= STACK_SIZE);
+    rassert(op_stack != NULL);
+    rassert(osi >= 0);
+    rassert(osi <= STACK_SIZE);
+    rassert(depth >= 0);
+
+    // This mirrors the structure of evaluate_expr_ but emits instructions
+    // instead of calculating the result
+
+    if (Streader_is_error_set(sr))
+        return false;
+
+    if (depth >= STACK_SIZE)
+    {
+        Streader_set_error(sr, "Maximum recursion depth exceeded");
+        return false;
+    }
+
+    const int orig_vsi = vsi;
+    const int orig_osi = osi;
+    char token[KQT_VAR_NAME_MAX + 1 + 4] = ""; // + 4 for delimiting \"s
+    bool expect_operand = true;
+    bool found_not = false;
+    bool found_minus = false;
+
+    int64_t prev_pos = sr->pos;
+    while (get_token(sr, token) &&
+            !string_eq(token, "") &&
+            !string_eq(token, ")") &&
+            (!func_arg || !string_eq(token, ",")))
+    {
+        const int func_index = get_func_index(token);
+        const int op_index = get_operator_index(token);
+
+        if (string_eq(token, "("))
+        {
+            if (!expect_operand)
+            {
+                Streader_set_error(sr, "Unexpected operand");
+                return false;
+            }
+
+            check_stack(vsi);
+            if (!compile_expr_(sr, cexpr, vsi, op_stack, osi, depth + 1, false) ||
+                    !Compiled_expr_add_unary(cexpr, found_not, found_minus, sr))
+                return false;
+
+            found_not = found_minus = false;
+            ++vsi;
+            expect_operand = false;
+        }
+        else if (func_index >= 0)
+        {
+            if (!expect_operand)
+            {
+                Streader_set_error(sr, "Unexpected function");
+                return false;
+            }
+
+            check_stack(vsi);
+            if (!Streader_match_char(sr, '('))
+                return false;
+
+            int i = 0;
+            if (!Streader_try_match_char(sr, ')'))
+            {
+                for (i = 0; i < FUNC_ARGS_MAX; ++i)
+                {
+                    if (!compile_expr_(
+                                sr, cexpr, vsi + i, op_stack, osi, depth + 1, true))
+                        return false;
+
+                    if (Streader_try_match_char(sr, ')'))
+                    {
+                        ++i;
+                        break;
+                    }
+
+                    if (!Streader_match_char(sr, ','))
+                        return false;
+                }
+            }
+
+            if (!Compiled_expr_add_instr(cexpr, INSTR_FUNC, func_index, i, sr))
+                return false;
+
+            // Unary operators are not applied to function results
+            found_not = found_minus = false;
+            ++vsi;
+            expect_operand = false;
+        }
+        else if ((op_index < 0) && is_operand_token(token))
+        {
+            if (!expect_operand)
+            {
+                Streader_set_error(sr, "Unexpected operand");
+                return false;
+            }
+
+            if (!Compiled_expr_add_operand(cexpr, token, sr) ||
+                    !Compiled_expr_add_unary(cexpr, found_not, found_minus, sr))
+                return false;
+
+            found_not = found_minus = false;
+            check_stack(vsi);
+            ++vsi;
+            expect_operand = false;
+        }
+        else if (op_index >= 0)
+        {
+            const Operator* op = &operators[op_index];
+            if (expect_operand)
+            {
+                if (string_eq(op->name, "!"))
+                {
+                    found_not = true;
+                }
+                else if (string_eq(op->name, "-"))
+                {
+                    found_minus = true;
+                }
+                else
+                {
+                    Streader_set_error(sr, "Unexpected binary operator");
+                    return false;
+                }
+
+                prev_pos = sr->pos;
+                continue;
+            }
+
+            if (string_eq(op->name, "!"))
+            {
+                Streader_set_error(sr, "Unexpected boolean not");
+                return false;
+            }
+
+            while (osi > orig_osi && op->preced <= operators[op_stack[osi - 1]].preced)
+            {
+                if (vsi - orig_vsi < 2)
+                {
+                    Streader_set_error(sr, "Not enough operands");
+                    return false;
+                }
+
+                if (!Compiled_expr_add_instr(cexpr, INSTR_OP, op_stack[osi - 1], 0, sr))
+                    return false;
+
+                --vsi;
+                --osi;
+            }
+
+            check_stack(osi);
+            op_stack[osi] = op_index;
+            ++osi;
+            expect_operand = true;
+        }
+        else
+        {
+            Streader_set_error(sr, "Unrecognised token");
+            return false;
+        }
+
+        prev_pos = sr->pos;
+    }
+
+    if (Streader_is_error_set(sr))
+        return false;
+
+    if (vsi <= orig_vsi)
+    {
+        Streader_set_error(sr, "Empty expression");
+        return false;
+    }
+
+    if ((depth == 0) != string_eq(token, ""))
+    {
+        Streader_set_error(
+                sr,
+                "Unmatched %s parenthesis",
+                (depth == 0) ? "right" : "left");
+        return false;
+    }
+
+    while (osi > orig_osi)
+    {
+        if (vsi - orig_vsi < 2)
+        {
+            Streader_set_error(sr, "Not enough operands");
+            return false;
+        }
+
+        if (!Compiled_expr_add_instr(cexpr, INSTR_OP, op_stack[osi - 1], 0, sr))
+            return false;
+
+        --vsi;
+        --osi;
+    }
+
+    if (vsi - orig_vsi != 1)
+    {
+        Streader_set_error(sr, "Unexpected operand");
+        return false;
+    }
+
+    if (func_arg)
+        sr->pos = prev_pos;
+
+    return true;
+}
+
+#undef check_stack
+
+
+Compiled_expr* new_Compiled_expr(Streader* sr)
+{
+    rassert(sr != NULL);
+
+    if (Streader_is_error_set(sr))
+        return NULL;
+
+    if (!Streader_match_char(sr, '"'))
+        return NULL;
+
+    Compiled_expr* cexpr = memory_alloc_item(Compiled_expr);
+    if (cexpr == NULL)
+    {
+        Streader_set_memory_error(sr, "Could not allocate memory for expression");
+        return NULL;
+    }
+
+    cexpr->instr_count = 0;
+    cexpr->instrs = NULL;
+    cexpr->const_count = 0;
+    cexpr->consts = NULL;
+    cexpr->var_count = 0;
+    cexpr->var_names = NULL;
+
+    int op_stack[STACK_SIZE] = { 0 };
+    if (!compile_expr_(sr, cexpr, 0, op_stack, 0, 0, false))
+    {
+        del_Compiled_expr(cexpr);
+        return NULL;
+    }
+
+    return cexpr;
+}
+
+
+bool Compiled_expr_evaluate(
+        const Compiled_expr* cexpr,
+        Env_state* estate,
+        const Value* meta,
+        Value* res,
+        Random* rand)
+{
+    rassert(cexpr != NULL);
+    rassert(res != NULL);
+    rassert(rand != NULL);
+
+    const Value* no_meta = VALUE_AUTO;
+    if (meta == NULL)
+        meta = no_meta;
+
+    // Operators and functions report their errors through a Streader
+    Streader* sr = Streader_init(STREADER_AUTO, "", 0);
+
+    Value stack[STACK_SIZE];
+    int si = 0;
+
+    for (int i = 0; i < cexpr->instr_count; ++i)
+    {
+        const Instr* instr = &cexpr->instrs[i];
+
+        switch (instr->type)
+        {
+            case INSTR_CONST:
+            {
+                dassert(si < STACK_SIZE);
+                Value_copy(&stack[si], &cexpr->consts[instr->index]);
+                ++si;
+            }
+            break;
+
+            case INSTR_META:
+            {
+                dassert(si < STACK_SIZE);
+                if (meta->type == VALUE_TYPE_NONE)
+                    return false;
+
+                Value_copy(&stack[si], meta);
+                ++si;
+            }
+            break;
+
+            case INSTR_VAR:
+            {
+                dassert(si < STACK_SIZE);
+                const Env_var* ev = (estate != NULL)
+                    ? Env_state_get_var(estate, cexpr->var_names[instr->index])
+                    : NULL;
+                if (ev == NULL)
+                    return false;
+
+                Value_copy(&stack[si], Env_var_get_value(ev));
+                ++si;
+            }
+            break;
+
+            case INSTR_NOT:
+            {
+                dassert(si >= 1);
+                if (!handle_unary(&stack[si - 1], true, false, sr))
+                    return false;
+            }
+            break;
+
+            case INSTR_MINUS:
+            {
+                dassert(si >= 1);
+                if (!handle_unary(&stack[si - 1], false, true, sr))
+                    return false;
+            }
+            break;
+
+            case INSTR_OP:
+            {
+                dassert(si >= 2);
+                Value* result = VALUE_AUTO;
+                if (!operators[instr->index].func(
+                            &stack[si - 2], &stack[si - 1], result, sr))
+                    return false;
+
+                --si;
+                Value_copy(&stack[si - 1], result);
+            }
+            break;
+
+            case INSTR_FUNC:
+            {
+                const int arg_count = instr->arg_count;
+                dassert(si >= arg_count);
+                dassert(si - arg_count < STACK_SIZE);
+
+                Value args[FUNC_ARGS_MAX] = { { .type = VALUE_TYPE_NONE } };
+                for (int ai = 0; ai < arg_count; ++ai)
+                    Value_copy(&args[ai], &stack[si - arg_count + ai]);
+                if (arg_count < FUNC_ARGS_MAX)
+                    args[arg_count].type = VALUE_TYPE_NONE;
+
+                si -= arg_count;
+                if (!funcs[instr->index].func(args, &stack[si], rand, sr))
+                    return false;
+
+                ++si;
+            }
+            break;
+
+            default:
+                rassert(false);
+        }
+    }
+
+    if (si != 1)
+        return false;
+
+    Value_copy(res, &stack[0]);
+
+    return true;
+}
+
+
+void del_Compiled_expr(Compiled_expr* cexpr)
+{
+    if (cexpr == NULL)
+        return;
+
+    memory_free(cexpr->instrs);
+    memory_free(cexpr->consts);
+    memory_free(cexpr->var_names);
+    memory_free(cexpr);
+
+    return;
+}
+
+
 static bool token_is_func(const char* token, Func* res)
 {
     rassert(token != NULL);
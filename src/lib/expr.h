@@ -21,6 +21,8 @@
 #include <string/Streader.h>
 #include <Value.h>
 
+#include <stdbool.h>
+
 
 /**
  * Evaluate an expression.
@@ -38,6 +40,55 @@ bool evaluate_expr(
         Streader* sr, Env_state* estate, const Value* meta, Value* res, Random* rand);
 
 
+/**
+ * An expression compiled into a compact instruction sequence.
+ */
+typedef struct Compiled_expr Compiled_expr;
+
+
+/**
+ * Create a new Compiled expression.
+ *
+ * The expression is parsed in the same way as in \a evaluate_expr, but the
+ * tokens are translated into instructions that can be evaluated repeatedly
+ * without parsing. Environment variables are resolved during evaluation.
+ *
+ * \param sr   The expression reader -- must not be \c NULL. The reader is
+ *             left at the closing double quote of the expression.
+ *
+ * \return   The new Compiled expression if successful, otherwise \c NULL.
+ */
+Compiled_expr* new_Compiled_expr(Streader* sr);
+
+
+/**
+ * Evaluate a Compiled expression.
+ *
+ * \param cexpr    The Compiled expression -- must not be \c NULL.
+ * \param estate   The Environment state, or \c NULL if environment is not used.
+ * \param meta     The meta variable, or \c NULL if not used.
+ * \param res      A memory location for the result Value --
+ *                 must not be \c NULL.
+ * \param rand     A Random source -- must not be \c NULL.
+ *
+ * \return   \c true if successful, or \c false if evaluation failed.
+ */
+bool Compiled_expr_evaluate(
+        const Compiled_expr* cexpr,
+        Env_state* estate,
+        const Value* meta,
+        Value* res,
+        Random* rand);
+
+
+/**
+ * Destroy an existing Compiled expression.
+ *
+ * \param cexpr   The Compiled expression, or \c NULL.
+ */
+void del_Compiled_expr(Compiled_expr* cexpr);
+
+
 #endif // KQT_EXPR_H
 
 
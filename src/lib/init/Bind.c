@@ -14,44 +14,41 @@
 
 #include <init/Bind.h>
 
-#include <containers/AAtree.h>
 #include <debug/assert.h>
+#include <Error.h>
 #include <expr.h>
 #include <kunquat/limits.h>
 #include <memory.h>
 #include <player/Event_cache.h>
 #include <player/Event_names.h>
 #include <player/Event_type.h>
+#include <string/common.h>
 #include <Value.h>
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 
-struct Bind
-{
-    AAtree* cblists;
-};
-
-
 typedef struct Constraint
 {
-    char event_name[KQT_EVENT_NAME_MAX + 1];
+    int cache_index;
+    Compiled_expr* cexpr;
     char* expr;
-    struct Constraint* next;
 } Constraint;
 
 
-static Constraint* new_Constraint(Streader* sr);
+static bool read_Constraint(
+        Streader* sr, Constraint* c, Bind* map, const Event_names* names);
 
 
 static bool Constraint_match(
-        Constraint* constraint, Event_cache* cache, Env_state* estate, Random* rand);
+        const Constraint* constraint, Event_cache* cache, Env_state* estate, Random* rand);
 
 
-static void del_Constraint(Constraint* constraint);
+static void Constraint_deinit(Constraint* constraint);
 
 
 static Target_event* new_Target_event(Streader* sr, const Event_names* names);
@@ -62,17 +59,17 @@ static void del_Target_event(Target_event* event);
 
 typedef struct Cblist_item
 {
+    int constraint_count;
     Constraint* constraints;
     Target_event* first_event;
     Target_event* last_event;
-    struct Cblist_item* next;
 } Cblist_item;
 
 
-static Cblist_item* new_Cblist_item(void);
+static void Cblist_item_init(Cblist_item* item);
 
 
-static void del_Cblist_item(Cblist_item* item);
+static void Cblist_item_deinit(Cblist_item* item);
 
 
 typedef enum
@@ -85,29 +82,63 @@ typedef enum
 
 typedef struct Cblist
 {
-    char event_name[KQT_EVENT_NAME_MAX + 1];
     Source_state source_state;
-    Cblist_item* first;
-    Cblist_item* last;
+    int item_count;
+    Cblist_item* items;
 } Cblist;
 
 
-static Cblist* new_Cblist(char* event_name);
+static Cblist* new_Cblist(void);
 
 
-static void Cblist_append(Cblist* list, Cblist_item* item);
+static Cblist_item* Cblist_add_item(Cblist* list);
 
 
 static void del_Cblist(Cblist* list);
 
 
-static bool read_constraints(Streader* sr, Bind* map, Cblist_item* item);
+/**
+ * The bind rules are indexed by the type of the triggering event, and
+ * the constraints refer to their event values through Event cache indices.
+ * Event names with a quote suffix are kept separate from their base names.
+ */
+#define RULE_INDEX_COUNT (Event_STOP * 2)
+
+struct Bind
+{
+    Cblist* cblists[RULE_INDEX_COUNT];
+    int cache_indices[RULE_INDEX_COUNT];
+    int cache_size;
+};
+
+
+static int get_rule_index(Event_type type, bool has_quote_suffix)
+{
+    rassert(type >= Event_NONE);
+    rassert(type < Event_STOP);
+
+    return has_quote_suffix ? (int)type + Event_STOP : (int)type;
+}
+
+
+static int get_rule_index_by_name(const Event_names* names, const char* event_name)
+{
+    rassert(names != NULL);
+    rassert(event_name != NULL);
+
+    return get_rule_index(
+            Event_names_get(names, event_name), string_has_suffix(event_name, "\""));
+}
+
+
+static bool read_constraints(
+        Streader* sr, Bind* map, Cblist_item* item, const Event_names* names);
 
 
 static bool read_events(Streader* sr, Cblist_item* item, const Event_names* names);
 
 
-static bool Bind_is_cyclic(const Bind* map);
+static bool Bind_is_cyclic(Bind* map);
 
 
 typedef struct bedata
@@ -128,34 +159,51 @@ static bool read_bind_entry(Streader* sr, int32_t index, void* userdata)
     if (!Streader_readf(sr, "[%s,", READF_STR(KQT_EVENT_NAME_MAX + 1, event_name)))
         return false;
 
-    Cblist* cblist = AAtree_get_exact(bd->map->cblists, event_name);
-    if (cblist == NULL)
+    const Event_type type = Event_names_get(bd->names, event_name);
+    const int rule_index = get_rule_index_by_name(bd->names, event_name);
+
+    Cblist_item* item = NULL;
+    Cblist_item* unused_item = &(Cblist_item){ .constraints = NULL };
+
+    if (type != Event_NONE)
     {
-        cblist = new_Cblist(event_name);
-        if (cblist == NULL || !AAtree_ins(bd->map->cblists, cblist))
+        Cblist* cblist = bd->map->cblists[rule_index];
+        if (cblist == NULL)
+        {
+            cblist = new_Cblist();
+            if (cblist == NULL)
+            {
+                Streader_set_memory_error(sr, "Could not allocate memory for bind");
+                return false;
+            }
+
+            bd->map->cblists[rule_index] = cblist;
+        }
+
+        item = Cblist_add_item(cblist);
+        if (item == NULL)
         {
-            del_Cblist(cblist);
-            Streader_set_memory_error(
-                    sr, "Could not allocate memory for bind");
+            Streader_set_memory_error(sr, "Could not allocate memory for bind");
             return false;
         }
     }
-
-    Cblist_item* item = new_Cblist_item();
-    if (item == NULL)
+    else
     {
-        Streader_set_memory_error(sr, "Could not allocate memory for bind");
-        return false;
+        // Unknown events are never fired, but we still check the rule syntax
+        item = unused_item;
+        Cblist_item_init(item);
     }
-    Cblist_append(cblist, item);
 
-    if (!(read_constraints(sr, bd->map, item) &&
-                Streader_match_char(sr, ',') &&
-                read_events(sr, item, bd->names))
-       )
-        return false;
+    const bool success =
+        read_constraints(sr, bd->map, item, bd->names) &&
+        Streader_match_char(sr, ',') &&
+        read_events(sr, item, bd->names) &&
+        Streader_match_char(sr, ']');
+
+    if (item == unused_item)
+        Cblist_item_deinit(item);
 
-    return Streader_match_char(sr, ']');
+    return success;
 }
 
 Bind* new_Bind(Streader* sr, const Event_names* names)
@@ -173,14 +221,12 @@ Bind* new_Bind(Streader* sr, const Event_names* names)
         return NULL;
     }
 
-    map->cblists = new_AAtree(
-            (AAtree_item_cmp*)strcmp, (AAtree_item_destroy*)del_Cblist);
-    if (map->cblists == NULL)
+    for (int i = 0; i < RULE_INDEX_COUNT; ++i)
     {
-        del_Bind(map);
-        Streader_set_memory_error(sr, "Could not allocate memory for bind");
-        return NULL;
+        map->cblists[i] = NULL;
+        map->cache_indices[i] = -1;
     }
+    map->cache_size = 0;
 
     if (!Streader_has_data(sr))
         return map;
@@ -208,33 +254,7 @@ Event_cache* Bind_create_cache(const Bind* map)
 {
     rassert(map != NULL);
 
-    Event_cache* cache = new_Event_cache();
-    if (cache == NULL)
-        return NULL;
-
-    AAiter* iter = AAiter_init(AAITER_AUTO, map->cblists);
-    Cblist* cblist = AAiter_get_at_least(iter, "");
-    while (cblist != NULL)
-    {
-        Cblist_item* item = cblist->first;
-        while (item != NULL)
-        {
-            Constraint* constraint = item->constraints;
-            while (constraint != NULL)
-            {
-                if (!Event_cache_add_event(cache, constraint->event_name))
-                {
-                    del_Event_cache(cache);
-                    return NULL;
-                }
-                constraint = constraint->next;
-            }
-            item = item->next;
-        }
-        cblist = AAiter_get_next(iter);
-    }
-
-    return cache;
+    return new_Event_cache(map->cache_size);
 }
 
 
@@ -242,41 +262,43 @@ Target_event* Bind_get_first(
         const Bind* map,
         Event_cache* cache,
         Env_state* estate,
-        const char* event_name,
+        Event_type event_type,
+        bool has_quote_suffix,
         const Value* value,
         Random* rand)
 {
     rassert(map != NULL);
     rassert(cache != NULL);
-    rassert(event_name != NULL);
+    rassert(Event_is_valid(event_type));
     rassert(value != NULL);
 
-    Event_cache_update(cache, event_name, value);
+    const int rule_index = get_rule_index(event_type, has_quote_suffix);
+
+    const int cache_index = map->cache_indices[rule_index];
+    if (cache_index >= 0)
+        Event_cache_update(cache, cache_index, value);
 
-    Cblist* list = AAtree_get_exact(map->cblists, event_name);
+    const Cblist* list = map->cblists[rule_index];
     if (list == NULL)
         return NULL;
 
-    Cblist_item* item = list->first;
-    while (item != NULL)
+    for (int item_index = 0; item_index < list->item_count; ++item_index)
     {
-        //fprintf(stderr, "%d\n", __LINE__);
-        Constraint* constraint = item->constraints;
-        while (constraint != NULL)
+        const Cblist_item* item = &list->items[item_index];
+
+        // Constraints are checked in reverse order of definition
+        bool match = true;
+        for (int ci = item->constraint_count - 1; ci >= 0; --ci)
         {
-            if (!Constraint_match(constraint, cache, estate, rand))
+            if (!Constraint_match(&item->constraints[ci], cache, estate, rand))
+            {
+                match = false;
                 break;
-
-            constraint = constraint->next;
+            }
         }
-        //fprintf(stderr, "%d\n", __LINE__);
-        if (constraint == NULL)
-        {
-            //fprintf(stderr, "item->events: %s\n", item->events->desc);
+
+        if (match)
             return item->first_event;
-        }
-        //fprintf(stderr, "%d\n", __LINE__);
-        item = item->next;
     }
 
     return NULL;
@@ -288,48 +310,48 @@ void del_Bind(Bind* map)
     if (map == NULL)
         return;
 
-    del_AAtree(map->cblists);
+    for (int i = 0; i < RULE_INDEX_COUNT; ++i)
+        del_Cblist(map->cblists[i]);
+
     memory_free(map);
 
     return;
 }
 
 
-static bool Bind_dfs(const Bind* map, char* name);
+static bool Bind_dfs(Bind* map, int rule_index);
 
 
-static bool Bind_is_cyclic(const Bind* map)
+static bool Bind_is_cyclic(Bind* map)
 {
     rassert(map != NULL);
 
-    AAiter* iter = AAiter_init(AAITER_AUTO, map->cblists);
-    Cblist* cblist = AAiter_get_at_least(iter, "");
-    while (cblist != NULL)
+    for (int i = 0; i < RULE_INDEX_COUNT; ++i)
     {
+        Cblist* cblist = map->cblists[i];
+        if (cblist == NULL)
+            continue;
+
         rassert(cblist->source_state != SOURCE_STATE_REACHED);
         if (cblist->source_state == SOURCE_STATE_VISITED)
-        {
-            cblist = AAiter_get_next(iter);
             continue;
-        }
 
         rassert(cblist->source_state == SOURCE_STATE_NEW);
-        if (Bind_dfs(map, cblist->event_name))
+        if (Bind_dfs(map, i))
             return true;
-
-        cblist = AAiter_get_next(iter);
     }
 
     return false;
 }
 
 
-static bool Bind_dfs(const Bind* map, char* name)
+static bool Bind_dfs(Bind* map, int rule_index)
 {
     rassert(map != NULL);
-    rassert(name != NULL);
+    rassert(rule_index >= 0);
+    rassert(rule_index < RULE_INDEX_COUNT);
 
-    Cblist* cblist = AAtree_get_exact(map->cblists, name);
+    Cblist* cblist = map->cblists[rule_index];
     if (cblist == NULL || cblist->source_state == SOURCE_STATE_VISITED)
         return false;
 
@@ -339,25 +361,18 @@ static bool Bind_dfs(const Bind* map, char* name)
     rassert(cblist->source_state == SOURCE_STATE_NEW);
     cblist->source_state = SOURCE_STATE_REACHED;
 
-    Cblist_item* item = cblist->first;
-    while (item != NULL)
+    for (int item_index = 0; item_index < cblist->item_count; ++item_index)
     {
-        Target_event* event = item->first_event;
+        const Target_event* event = cblist->items[item_index].first_event;
         while (event != NULL)
         {
-            Streader* sr = Streader_init(
-                    STREADER_AUTO, event->desc, (int64_t)strlen(event->desc));
-            char next_name[KQT_EVENT_NAME_MAX + 1] = "";
-            Streader_readf(sr, "[%s", READF_STR(KQT_EVENT_NAME_MAX, next_name));
-            rassert(!Streader_is_error_set(sr));
-
-            if (Bind_dfs(map, next_name))
+            const int next_index = get_rule_index(
+                    event->type, string_has_suffix(event->event_name, "\""));
+            if (Bind_dfs(map, next_index))
                 return true;
 
             event = event->next;
         }
-
-        item = item->next;
     }
 
     cblist->source_state = SOURCE_STATE_VISITED;
@@ -366,31 +381,51 @@ static bool Bind_dfs(const Bind* map, char* name)
 }
 
 
+typedef struct cdata
+{
+    Bind* map;
+    Cblist_item* item;
+    const Event_names* names;
+} cdata;
+
 static bool read_constraint(Streader* sr, int32_t index, void* userdata)
 {
     rassert(sr != NULL);
     rassert(userdata != NULL);
     ignore(index);
 
-    Cblist_item* item = userdata;
+    cdata* cd = userdata;
+    Cblist_item* item = cd->item;
+
+    Constraint* new_constraints = memory_realloc_items(
+            Constraint, item->constraint_count + 1, item->constraints);
+    if (new_constraints == NULL)
+    {
+        Streader_set_memory_error(sr, "Could not allocate memory for bind");
+        return false;
+    }
+    item->constraints = new_constraints;
 
-    Constraint* constraint = new_Constraint(sr);
-    if (constraint == NULL)
+    Constraint* constraint = &item->constraints[item->constraint_count];
+    if (!read_Constraint(sr, constraint, cd->map, cd->names))
         return false;
 
-    constraint->next = item->constraints;
-    item->constraints = constraint;
+    ++item->constraint_count;
 
     return true;
 }
 
-static bool read_constraints(Streader* sr, Bind* map, Cblist_item* item)
+static bool read_constraints(
+        Streader* sr, Bind* map, Cblist_item* item, const Event_names* names)
 {
     rassert(sr != NULL);
     rassert(map != NULL);
     rassert(item != NULL);
+    rassert(names != NULL);
 
-    return Streader_read_list(sr, read_constraint, item);
+    cdata* cd = &(cdata){ .map = map, .item = item, .names = names, };
+
+    return Streader_read_list(sr, read_constraint, cd);
 }
 
 
@@ -440,39 +475,36 @@ static bool read_events(
 }
 
 
-static Cblist* new_Cblist(char* event_name)
+static Cblist* new_Cblist(void)
 {
-    rassert(event_name != NULL);
-
     Cblist* list = memory_alloc_item(Cblist);
     if (list == NULL)
         return NULL;
 
     list->source_state = SOURCE_STATE_NEW;
-    list->first = list->last = NULL;
-    strncpy(list->event_name, event_name, KQT_EVENT_NAME_MAX);
-    list->event_name[KQT_EVENT_NAME_MAX] = '\0';
+    list->item_count = 0;
+    list->items = NULL;
 
     return list;
 }
 
 
-static void Cblist_append(Cblist* list, Cblist_item* item)
+static Cblist_item* Cblist_add_item(Cblist* list)
 {
     rassert(list != NULL);
-    rassert(item != NULL);
 
-    if (list->last == NULL)
-    {
-        rassert(list->first == NULL);
-        list->first = list->last = item;
-        return;
-    }
+    Cblist_item* new_items =
+        memory_realloc_items(Cblist_item, list->item_count + 1, list->items);
+    if (new_items == NULL)
+        return NULL;
 
-    list->last->next = item;
-    list->last = item;
+    list->items = new_items;
 
-    return;
+    Cblist_item* item = &list->items[list->item_count];
+    Cblist_item_init(item);
+    ++list->item_count;
+
+    return item;
 }
 
 
@@ -481,47 +513,39 @@ static void del_Cblist(Cblist* list)
     if (list == NULL)
         return;
 
-    Cblist_item* cur = list->first;
-    while (cur != NULL)
-    {
-        Cblist_item* next = cur->next;
-        del_Cblist_item(cur);
-        cur = next;
-    }
+    for (int i = 0; i < list->item_count; ++i)
+        Cblist_item_deinit(&list->items[i]);
 
+    memory_free(list->items);
     memory_free(list);
 
     return;
 }
 
 
-static Cblist_item* new_Cblist_item(void)
+static void Cblist_item_init(Cblist_item* item)
 {
-    Cblist_item* item = memory_alloc_item(Cblist_item);
-    if (item == NULL)
-        return NULL;
+    rassert(item != NULL);
 
+    item->constraint_count = 0;
     item->constraints = NULL;
     item->first_event = NULL;
     item->last_event = NULL;
-    item->next = NULL;
 
-    return item;
+    return;
 }
 
 
-static void del_Cblist_item(Cblist_item* item)
+static void Cblist_item_deinit(Cblist_item* item)
 {
-    if (item == NULL)
-        return;
+    rassert(item != NULL);
 
-    Constraint* curc = item->constraints;
-    while (curc != NULL)
-    {
-        Constraint* nextc = curc->next;
-        del_Constraint(curc);
-        curc = nextc;
-    }
+    for (int i = 0; i < item->constraint_count; ++i)
+        Constraint_deinit(&item->constraints[i]);
+
+    memory_free(item->constraints);
+    item->constraints = NULL;
+    item->constraint_count = 0;
 
     Target_event* curt = item->first_event;
     while (curt != NULL)
@@ -531,50 +555,41 @@ static void del_Cblist_item(Cblist_item* item)
         curt = nextt;
     }
 
-    memory_free(item);
+    item->first_event = NULL;
+    item->last_event = NULL;
 
     return;
 }
 
 
-static Constraint* new_Constraint(Streader* sr)
+static bool read_Constraint(
+        Streader* sr, Constraint* c, Bind* map, const Event_names* names)
 {
     rassert(sr != NULL);
+    rassert(c != NULL);
+    rassert(map != NULL);
+    rassert(names != NULL);
 
     if (Streader_is_error_set(sr))
-        return NULL;
-
-    Constraint* c = memory_alloc_item(Constraint);
-    if (c == NULL)
-    {
-        Streader_set_memory_error(sr, "Could not allocate memory for bind");
-        return NULL;
-    }
+        return false;
 
+    c->cache_index = -1;
+    c->cexpr = NULL;
     c->expr = NULL;
-    c->next = NULL;
 
-    if (!Streader_readf(sr, "[%s,", READF_STR(KQT_EVENT_NAME_MAX + 1, c->event_name)))
-    {
-        del_Constraint(c);
-        return NULL;
-    }
+    char event_name[KQT_EVENT_NAME_MAX + 1] = "";
+    if (!Streader_readf(sr, "[%s,", READF_STR(KQT_EVENT_NAME_MAX + 1, event_name)))
+        return false;
 
     Streader_skip_whitespace(sr);
     const char* const expr = Streader_get_remaining_data(sr);
     if (!Streader_read_string(sr, 0, NULL))
-    {
-        del_Constraint(c);
-        return NULL;
-    }
+        return false;
 
     const char* const expr_end = Streader_get_remaining_data(sr);
 
     if (!Streader_match_char(sr, ']'))
-    {
-        del_Constraint(c);
-        return NULL;
-    }
+        return false;
 
     rassert(expr_end != NULL);
     rassert(expr_end > expr);
@@ -583,54 +598,133 @@ static Constraint* new_Constraint(Streader* sr)
     c->expr = memory_calloc_items(char, len + 1);
     if (c->expr == NULL)
     {
-        del_Constraint(c);
         Streader_set_memory_error(sr, "Could not allocate memory for bind");
-        return NULL;
+        return false;
     }
 
     strncpy(c->expr, expr, (size_t)len);
     c->expr[len] = '\0';
 
-    return c;
+    // Get the Event cache slot of the constrained event,
+    // unknown events share a slot that is never updated
+    const int rule_index = get_rule_index_by_name(names, event_name);
+    if (map->cache_indices[rule_index] < 0)
+    {
+        map->cache_indices[rule_index] = map->cache_size;
+        ++map->cache_size;
+    }
+    c->cache_index = map->cache_indices[rule_index];
+
+    // Compile the expression, we fall back to interpreting
+    // if the expression is not valid
+    Streader* expr_sr = Streader_init(STREADER_AUTO, c->expr, len);
+    c->cexpr = new_Compiled_expr(expr_sr);
+    if ((c->cexpr != NULL) && !Streader_match_char(expr_sr, '"'))
+    {
+        del_Compiled_expr(c->cexpr);
+        c->cexpr = NULL;
+    }
+
+    if ((c->cexpr == NULL) && Streader_is_error_set(expr_sr) &&
+            (Error_get_type(&expr_sr->error) == ERROR_MEMORY))
+    {
+        Streader_set_memory_error(sr, "Could not allocate memory for bind");
+        return false;
+    }
+
+    return true;
 }
 
 
 static bool Constraint_match(
-        Constraint* constraint, Event_cache* cache, Env_state* estate, Random* rand)
+        const Constraint* constraint, Event_cache* cache, Env_state* estate, Random* rand)
 {
     rassert(constraint != NULL);
     rassert(cache != NULL);
     rassert(estate != NULL);
     rassert(rand != NULL);
 
-    const Value* value = Event_cache_get_value(cache, constraint->event_name);
+    const Value* value = Event_cache_get_value(cache, constraint->cache_index);
     rassert(value != NULL);
 
     Value* result = VALUE_AUTO;
-    Streader* sr = Streader_init(
-            STREADER_AUTO, constraint->expr, (int64_t)strlen(constraint->expr));
-    //fprintf(stderr, "%s, %s", constraint->event_name, constraint->expr);
-    evaluate_expr(sr, estate, value, result, rand);
-    //fprintf(stderr, ", %s", state->message);
-    //fprintf(stderr, " -> %d %s\n", (int)result->type,
-    //                               result->value.bool_type ? "true" : "false");
+    if (constraint->cexpr != NULL)
+    {
+        if (!Compiled_expr_evaluate(constraint->cexpr, estate, value, result, rand))
+            return false;
+    }
+    else
+    {
+        Streader* sr = Streader_init(
+                STREADER_AUTO, constraint->expr, (int64_t)strlen(constraint->expr));
+        evaluate_expr(sr, estate, value, result, rand);
+    }
 
     return (result->type == VALUE_TYPE_BOOL) && result->value.bool_type;
 }
 
 
-static void del_Constraint(Constraint* constraint)
+static void Constraint_deinit(Constraint* constraint)
 {
-    if (constraint == NULL)
-        return;
+    rassert(constraint != NULL);
 
+    del_Compiled_expr(constraint->cexpr);
+    constraint->cexpr = NULL;
     memory_free(constraint->expr);
-    memory_free(constraint);
+    constraint->expr = NULL;
 
     return;
 }
 
 
+static bool compile_target_arg(Target_event* event, const char* arg_desc, Streader* sr)
+{
+    rassert(event != NULL);
+    rassert(arg_desc != NULL);
+    rassert(sr != NULL);
+
+    Streader* arg_sr =
+        Streader_init(STREADER_AUTO, arg_desc, (int64_t)strlen(arg_desc));
+
+    if (string_has_suffix(event->event_name, "\""))
+    {
+        // String arguments are used as is
+        if (event->arg_type != VALUE_TYPE_STRING)
+            return true;
+
+        event->literal_arg.type = VALUE_TYPE_STRING;
+        if (Streader_read_string(
+                    arg_sr, KQT_VAR_NAME_MAX + 1, event->literal_arg.value.string_type))
+            event->has_literal_arg = true;
+
+        return true;
+    }
+
+    if (event->arg_type == VALUE_TYPE_NONE)
+    {
+        event->literal_arg.type = VALUE_TYPE_NONE;
+        event->has_literal_arg = true;
+        return true;
+    }
+
+    event->arg_expr = new_Compiled_expr(arg_sr);
+    if ((event->arg_expr != NULL) && !Streader_match_char(arg_sr, '"'))
+    {
+        del_Compiled_expr(event->arg_expr);
+        event->arg_expr = NULL;
+    }
+
+    if ((event->arg_expr == NULL) && Streader_is_error_set(arg_sr) &&
+            (Error_get_type(&arg_sr->error) == ERROR_MEMORY))
+    {
+        Streader_set_memory_error(sr, "Could not allocate memory for bind");
+        return false;
+    }
+
+    return true;
+}
+
+
 static Target_event* new_Target_event(Streader* sr, const Event_names* names)
 {
     rassert(sr != NULL);
@@ -648,6 +742,12 @@ static Target_event* new_Target_event(Streader* sr, const Event_names* names)
 
     event->ch_offset = 0;
     event->desc = NULL;
+    event->type = Event_NONE;
+    event->event_name[0] = '\0';
+    event->arg_type = VALUE_TYPE_NONE;
+    event->has_literal_arg = false;
+    event->literal_arg.type = VALUE_TYPE_NONE;
+    event->arg_expr = NULL;
     event->next = NULL;
 
     int64_t ch_offset = 0;
@@ -667,22 +767,26 @@ static Target_event* new_Target_event(Streader* sr, const Event_names* names)
     Streader_skip_whitespace(sr);
     const char* const desc = Streader_get_remaining_data(sr);
 
-    char event_name[KQT_EVENT_NAME_MAX + 1] = "";
-    if (!Streader_readf(sr, "[%s,", READF_STR(KQT_EVENT_NAME_MAX + 1, event_name)))
+    if (!Streader_readf(
+                sr, "[%s,", READF_STR(KQT_EVENT_NAME_MAX + 1, event->event_name)))
     {
         del_Target_event(event);
         return NULL;
     }
 
-    if (Event_names_get(names, event_name) == Event_NONE)
+    event->type = Event_names_get(names, event->event_name);
+    if (event->type == Event_NONE)
     {
-        Streader_set_error(sr, "Unsupported event type: %s", event_name);
+        Streader_set_error(sr, "Unsupported event type: %s", event->event_name);
         del_Target_event(event);
         return NULL;
     }
 
-    Value_type type = Event_names_get_param_type(names, event_name);
-    if (type == VALUE_TYPE_NONE)
+    Streader_skip_whitespace(sr);
+    const char* const arg_desc = Streader_get_remaining_data(sr);
+
+    event->arg_type = Event_names_get_param_type(names, event->event_name);
+    if (event->arg_type == VALUE_TYPE_NONE)
         Streader_read_null(sr);
     else
         Streader_read_string(sr, 0, NULL);
@@ -715,6 +819,14 @@ static Target_event* new_Target_event(Streader* sr, const Event_names* names)
     memcpy(event->desc, desc, (size_t)len);
     event->desc[len] = '\0';
 
+    rassert(arg_desc >= desc);
+    rassert(arg_desc < desc_end);
+    if (!compile_target_arg(event, &event->desc[arg_desc - desc], sr))
+    {
+        del_Target_event(event);
+        return NULL;
+    }
+
     return event;
 }
 
@@ -724,6 +836,7 @@ static void del_Target_event(Target_event* event)
     if (event == NULL)
         return;
 
+    del_Compiled_expr(event->arg_expr);
     memory_free(event->desc);
     memory_free(event);
 
@@ -16,14 +16,17 @@
 #define KQT_BIND_H
 
 
+#include <expr.h>
 #include <kunquat/limits.h>
 #include <mathnum/Random.h>
 #include <player/Env_state.h>
 #include <player/Event_cache.h>
 #include <player/Event_names.h>
+#include <player/Event_type.h>
 #include <string/Streader.h>
 #include <Value.h>
 
+#include <stdbool.h>
 #include <stdlib.h>
 
 
@@ -35,11 +38,21 @@ typedef struct Bind Bind;
 
 /**
  * A list node returned by the Call map.
+ *
+ * The event type and argument are resolved when the Bind is loaded. If the
+ * argument could not be compiled, \a has_literal_arg is \c false and
+ * \a arg_expr is \c NULL, and the caller should interpret \a desc instead.
  */
 typedef struct Target_event
 {
     int ch_offset;
     char* desc;
+    Event_type type;
+    char event_name[KQT_EVENT_NAME_MAX + 1];
+    Value_type arg_type;
+    bool has_literal_arg;
+    Value literal_arg;
+    Compiled_expr* arg_expr;
     struct Target_event* next;
 } Target_event;
 
@@ -69,12 +82,14 @@ Event_cache* Bind_create_cache(const Bind* map);
 /**
  * Get the first event that is a result from binding.
  *
- * \param map          The Bind -- must not be \c NULL.
- * \param cache        The Event cache -- must not be \c NULL.
- * \param estate       The Environment state -- must not be \c NULL.
- * \param event_name   The name of the fired event -- must not be \c NULL.
- * \param value        The event parameter -- must not be \c NULL.
- * \param rand         The random source -- must not be \c NULL.
+ * \param map                The Bind -- must not be \c NULL.
+ * \param cache              The Event cache -- must not be \c NULL.
+ * \param estate             The Environment state -- must not be \c NULL.
+ * \param event_type         The type of the fired event -- must be valid.
+ * \param has_quote_suffix   \c true if the name of the fired event has a
+ *                           quote suffix, otherwise \c false.
+ * \param value              The event parameter -- must not be \c NULL.
+ * \param rand               The random source -- must not be \c NULL.
  *
  * \return   The first Target event if any calls are triggered,
  *           otherwise \c NULL.
@@ -83,7 +98,8 @@ Target_event* Bind_get_first(
         const Bind* map,
         Event_cache* cache,
         Env_state* estate,
-        const char* event_name,
+        Event_type event_type,
+        bool has_quote_suffix,
         const Value* value,
         Random* rand);
 
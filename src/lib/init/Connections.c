@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -281,12 +281,24 @@ static bool Connections_is_cyclic(const Connections* graph)
 }
 
 
-int Connections_get_depth(const Connections* graph)
+int Connections_get_depth(Connections* graph)
 {
     rassert(graph != NULL);
     rassert(!Connections_is_cyclic(graph));
 
-    const Device_node* master = AAtree_get_exact(graph->nodes, "");
+    // Reset cached depths
+    {
+        AAiter* iter = AAiter_init(AAITER_AUTO, graph->nodes);
+
+        Device_node* node = AAiter_get_at_least(iter, "");
+        while (node != NULL)
+        {
+            Device_node_reset_subgraph_depth(node);
+            node = AAiter_get_next(iter);
+        }
+    }
+
+    Device_node* master = AAtree_get_exact(graph->nodes, "");
     rassert(master != NULL);
 
     return Device_node_get_subgraph_depth(master);
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -84,11 +84,14 @@ const Device_node* Connections_get_master(const Connections* graph);
 /**
  * Get the maximum number of Devices connected in chain inside the Connections.
  *
+ * This function updates the cached subgraph depths of the Device nodes in
+ * \a graph and the Connections of any contained Audio units.
+ *
  * \param graph   The Connections -- must not be \c NULL.
  *
  * \return   The maximum number of Devices in a single connection chain.
  */
-int Connections_get_depth(const Connections* graph);
+int Connections_get_depth(Connections* graph);
 
 
 /**
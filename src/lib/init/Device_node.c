@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -37,6 +37,7 @@ struct Device_node
     char name[KQT_DEVICE_NODE_NAME_MAX];
 
     Device_node_state cycle_test_state;
+    int subgraph_depth; ///< Cached result of the depth search, or \c -1
 
     // These fields are required for adaptation to changes
     Au_table* au_table;
@@ -97,6 +98,7 @@ Device_node* new_Device_node(const char* name, Au_table* au_table, const Device*
     }
 
     node->cycle_test_state = DEVICE_NODE_STATE_NEW;
+    node->subgraph_depth = -1;
     node->au_table = au_table;
     node->master = master;
     //node->device = NULL;
@@ -342,19 +344,34 @@ bool Device_node_cycle_in_path(Device_node* node)
 }
 
 
-int Device_node_get_subgraph_depth(const Device_node* node)
+void Device_node_reset_subgraph_depth(Device_node* node)
 {
     rassert(node != NULL);
+    node->subgraph_depth = -1;
+    return;
+}
+
+
+int Device_node_get_subgraph_depth(Device_node* node)
+{
+    rassert(node != NULL);
+
+    // Nodes reachable through several paths are only searched once
+    if (node->subgraph_depth >= 0)
+        return node->subgraph_depth;
 
     const Device* node_device = Device_node_get_device(node);
     if ((node_device == NULL) || !Device_is_existent(node_device))
+    {
+        node->subgraph_depth = 0;
         return 0;
+    }
 
     int cur_depth = 1;
     if (node->type == DEVICE_NODE_TYPE_AU)
     {
-        const Connections* au_conns =
-            Audio_unit_get_connections((const Audio_unit*)node_device);
+        Connections* au_conns =
+            Audio_unit_get_connections_mut((const Audio_unit*)node_device);
         if (au_conns != NULL)
             cur_depth = Connections_get_depth(au_conns) + 2; // incl. interfaces
     }
@@ -373,7 +390,9 @@ int Device_node_get_subgraph_depth(const Device_node* node)
         }
     }
 
-    return cur_depth + max_sub_level;
+    node->subgraph_depth = cur_depth + max_sub_level;
+
+    return node->subgraph_depth;
 }
 
 
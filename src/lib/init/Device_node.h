@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -215,16 +215,29 @@ void Device_node_reset_cycle_test_state(Device_node* node);
 bool Device_node_cycle_in_path(Device_node* node);
 
 
+/**
+ * Reset the cached subgraph depth of the Device node.
+ *
+ * This function does not recurse to connected nodes.
+ *
+ * \param node   The Device node -- must not be \c NULL.
+ */
+void Device_node_reset_subgraph_depth(Device_node* node);
+
+
 /**
  * Get the maximum number of Device nodes connected in chain from the Device node.
  *
- * The depth includes any subgraphs of contained Audio units.
+ * The depth includes any subgraphs of contained Audio units. The depths of
+ * the searched nodes are cached, so the caller must reset the cached depths
+ * of all nodes in the graph with \a Device_node_reset_subgraph_depth before
+ * the search.
  *
  * \param node   The Device node -- must not be \c NULL.
  *
  * \return   The maximum number of Device nodes in a single connection chain.
  */
-int Device_node_get_subgraph_depth(const Device_node* node);
+int Device_node_get_subgraph_depth(Device_node* node);
 
 
 /**
@@ -60,6 +60,7 @@ Module* new_Module(void)
     module->force_shift = 0;
     module->env = NULL;
     module->bind = NULL;
+    module->data_version = 0;
     for (int i = 0; i < KQT_SONGS_MAX; ++i)
         module->order_lists[i] = NULL;
     for (int i = 0; i < KQT_TUNING_TABLES_MAX; ++i)
@@ -58,6 +58,7 @@ struct Module
     double force_shift;                 ///< Force shift.
     Environment* env;                   ///< Environment variables.
     Bind* bind;
+    uint64_t data_version;              ///< Data change counter.
 };
 
 
@@ -227,6 +227,9 @@ bool parse_data(Handle* handle, const char* key, const void* data, long length)
         data = NULL;
     }
 
+    // Notify players of possible changes in the sheet
+    ++handle->module->data_version;
+
     // Get key pattern info
     char key_pattern[KQT_KEY_LENGTH_MAX] = "";
     Key_indices key_indices = { 0 };
@@ -1224,18 +1227,12 @@ static bool read_any_proc_manifest(Reader_params* params, Au_table* au_table, in
     // Allocate Voice work buffers
     {
         const int32_t audio_rate = Player_get_audio_rate(params->handle->player);
-        const int32_t cur_size =
-            Player_get_voice_work_buffer_size(params->handle->player);
         const int32_t req_size = Device_impl_get_voice_wb_size(proc_impl, audio_rate);
-        if (req_size > cur_size)
+        if (!Player_reserve_voice_work_buffer_space(params->handle->player, req_size))
         {
-            if (!Player_reserve_voice_work_buffer_space(
-                        params->handle->player, req_size))
-            {
-                Handle_set_error(params->handle, ERROR_MEMORY,
-                        "Could not allocate memory for voice work buffers");
-                return false;
-            }
+            Handle_set_error(params->handle, ERROR_MEMORY,
+                    "Could not allocate memory for voice work buffers");
+            return false;
         }
     }
 
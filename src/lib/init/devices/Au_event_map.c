@@ -37,6 +37,15 @@ struct Au_event_map
 };
 
 
+typedef enum
+{
+    ARG_SOURCE_NONE,
+    ARG_SOURCE_META,
+    ARG_SOURCE_CONST,
+    ARG_SOURCE_EXPR,
+} Arg_source;
+
+
 struct Au_event_bind_entry
 {
     Au_event_target_dev_type target_dev_type;
@@ -45,19 +54,21 @@ struct Au_event_bind_entry
     char target_event_name[KQT_DEVICE_EVENT_NAME_MAX + 1];
 
     Value_type target_arg_type;
+    Arg_source arg_source;
+    Value const_arg;
     char* expression;
-
-    struct Au_event_bind_entry* next;
+    Compiled_expr* cexpr;
 };
 
 
-static void del_Bind_entry(Au_event_bind_entry* entry)
+static void Bind_entry_deinit(Au_event_bind_entry* entry)
 {
-    if (entry == NULL)
-        return;
+    rassert(entry != NULL);
 
+    del_Compiled_expr(entry->cexpr);
+    entry->cexpr = NULL;
     memory_free(entry->expression);
-    memory_free(entry);
+    entry->expression = NULL;
 
     return;
 }
@@ -101,12 +112,100 @@ static const char* mem_error_str =
     "Could not allocate memory for audio unit event map";
 
 
-static Au_event_bind_entry* new_Bind_entry(Streader* sr)
+static bool is_meta_expression(const char* expr)
+{
+    rassert(expr != NULL);
+
+    // Check for an expression that consists of a single $ (ignoring whitespace)
+    Streader* sr = Streader_init(STREADER_AUTO, expr, (int64_t)strlen(expr));
+    return Streader_match_char(sr, '"') &&
+        Streader_match_char(sr, '$') &&
+        Streader_match_char(sr, '"') &&
+        !Streader_has_data(sr);
+}
+
+
+static bool is_const_expression(const char* expr)
+{
+    rassert(expr != NULL);
+
+    // Without an environment, only the meta variable and random functions
+    // make the expression result vary between evaluations
+    return (strchr(expr, '$') == NULL) && (strstr(expr, "rand") == NULL);
+}
+
+
+static void evaluate_arg(
+        const char* expr,
+        Value_type arg_type,
+        const Value* meta,
+        Value* result,
+        Random* rand)
+{
+    rassert(expr != NULL);
+    rassert(result != NULL);
+    rassert(rand != NULL);
+
+    Streader* sr = Streader_init(STREADER_AUTO, expr, (int64_t)strlen(expr));
+    if (evaluate_expr(sr, NULL, meta, result, rand))
+    {
+        if (!Value_convert(result, result, arg_type))
+            result->type = VALUE_TYPE_NONE;
+    }
+    else
+    {
+        result->type = VALUE_TYPE_NONE;
+    }
+
+    return;
+}
+
+
+static void Bind_entry_compile_arg(Au_event_bind_entry* entry)
+{
+    rassert(entry != NULL);
+
+    entry->const_arg.type = VALUE_TYPE_NONE;
+
+    if (entry->target_arg_type == VALUE_TYPE_NONE)
+    {
+        entry->arg_source = ARG_SOURCE_NONE;
+    }
+    else if (is_meta_expression(entry->expression))
+    {
+        entry->arg_source = ARG_SOURCE_META;
+    }
+    else if (is_const_expression(entry->expression))
+    {
+        entry->arg_source = ARG_SOURCE_CONST;
+        evaluate_arg(
+                entry->expression,
+                entry->target_arg_type,
+                NULL,
+                &entry->const_arg,
+                Random_init(RANDOM_AUTO, ""));
+    }
+    else
+    {
+        entry->arg_source = ARG_SOURCE_EXPR;
+
+        // Invalid expressions are left for the interpreter to reject at firing time
+        Streader* sr = Streader_init(
+                STREADER_AUTO, entry->expression, (int64_t)strlen(entry->expression));
+        entry->cexpr = new_Compiled_expr(sr);
+    }
+
+    return;
+}
+
+
+static bool read_Bind_entry(Streader* sr, Au_event_bind_entry* bind_entry)
 {
     rassert(sr != NULL);
+    rassert(bind_entry != NULL);
 
     if (Streader_is_error_set(sr))
-        return NULL;
+        return false;
 
     char target_dev_name[16] = "";
     char target_event_name[KQT_DEVICE_EVENT_NAME_MAX + 2] = "";
@@ -118,7 +217,7 @@ static Au_event_bind_entry* new_Bind_entry(Streader* sr)
                 READF_STR(16, target_dev_name),
                 READF_STR(KQT_DEVICE_EVENT_NAME_MAX + 2, target_event_name),
                 READF_STR(16, target_event_arg_type_name)))
-        return NULL;
+        return false;
 
     // Get target device information
     Au_event_target_dev_type target_dev_type = AU_EVENT_TARGET_DEV_AU;
@@ -153,7 +252,7 @@ static Au_event_bind_entry* new_Bind_entry(Streader* sr)
     if (target_dev_index < 0)
     {
         Streader_set_error(sr, "Invalid target device name: %s", target_dev_name);
-        return NULL;
+        return false;
     }
 
     // Validate target event name
@@ -166,7 +265,7 @@ static Au_event_bind_entry* new_Bind_entry(Streader* sr)
                 " and may only contain lower-case letters)",
                 target_event_name,
                 KQT_DEVICE_EVENT_NAME_MAX);
-        return NULL;
+        return false;
     }
 
     // Validate target event argument type
@@ -226,22 +325,15 @@ static Au_event_bind_entry* new_Bind_entry(Streader* sr)
         expression[expr_length] = '\0';
     }
 
-    Au_event_bind_entry* bind_entry = memory_alloc_item(Au_event_bind_entry);
-    if (bind_entry == NULL)
-    {
-        memory_free(expression);
-        Streader_set_memory_error(sr, mem_error_str);
-        return NULL;
-    }
-
     bind_entry->target_dev_type = target_dev_type;
     bind_entry->target_dev_index = target_dev_index;
     strcpy(bind_entry->target_event_name, target_event_name);
     bind_entry->target_arg_type = target_arg_type;
     bind_entry->expression = expression;
-    bind_entry->next = NULL;
 
-    return bind_entry;
+    Bind_entry_compile_arg(bind_entry);
+
+    return true;
 }
 
 
@@ -250,8 +342,8 @@ typedef struct Event_entry
     char event_name[KQT_DEVICE_EVENT_NAME_MAX + 1];
     Value_type event_arg_type;
 
-    Au_event_bind_entry* first_bind_entry;
-    Au_event_bind_entry* last_bind_entry;
+    int bind_entry_count;
+    Au_event_bind_entry* bind_entries;
 } Event_entry;
 
 
@@ -260,14 +352,10 @@ static void del_Event_entry(Event_entry* entry)
     if (entry == NULL)
         return;
 
-    Au_event_bind_entry* cur = entry->first_bind_entry;
-    while (cur != NULL)
-    {
-        Au_event_bind_entry* next = cur->next;
-        del_Bind_entry(cur);
-        cur = next;
-    }
+    for (int i = 0; i < entry->bind_entry_count; ++i)
+        Bind_entry_deinit(&entry->bind_entries[i]);
 
+    memory_free(entry->bind_entries);
     memory_free(entry);
 
     return;
@@ -282,23 +370,29 @@ static bool read_bind_targets(Streader* sr, int32_t index, void* userdata)
     Event_entry* event_entry = userdata;
     rassert(event_entry != NULL);
 
-    // Read and attach new bind entry
-    Au_event_bind_entry* bind_entry = new_Bind_entry(sr);
-    if (bind_entry == NULL)
-        return false;
-
-    if (event_entry->last_bind_entry == NULL)
+    // Bind entries are stored contiguously to keep event firing cache-friendly
+    Au_event_bind_entry* new_entries = memory_realloc_items(
+            Au_event_bind_entry,
+            event_entry->bind_entry_count + 1,
+            event_entry->bind_entries);
+    if (new_entries == NULL)
     {
-        rassert(event_entry->first_bind_entry == NULL);
-        event_entry->first_bind_entry = bind_entry;
-        event_entry->last_bind_entry = bind_entry;
+        Streader_set_memory_error(sr, mem_error_str);
+        return false;
     }
-    else
+    event_entry->bind_entries = new_entries;
+
+    Au_event_bind_entry* bind_entry = &new_entries[event_entry->bind_entry_count];
+    bind_entry->expression = NULL;
+    bind_entry->cexpr = NULL;
+    if (!read_Bind_entry(sr, bind_entry))
     {
-        event_entry->last_bind_entry->next = bind_entry;
-        event_entry->last_bind_entry = bind_entry;
+        Bind_entry_deinit(bind_entry);
+        return false;
     }
 
+    ++event_entry->bind_entry_count;
+
     return true;
 }
 
@@ -355,8 +449,8 @@ static bool read_event_entry(Streader* sr, int32_t index, void* userdata)
 
     strcpy(entry->event_name, event_name);
     entry->event_arg_type = arg_type;
-    entry->first_bind_entry = NULL;
-    entry->last_bind_entry = NULL;
+    entry->bind_entry_count = 0;
+    entry->bind_entries = NULL;
 
     if (!AAtree_ins(map->tree, entry))
     {
@@ -380,25 +474,53 @@ static void fill_iter_result(Au_event_iter* iter)
     iter->result.dev_index = entry->target_dev_index;
     iter->result.event_name = entry->target_event_name;
 
-    if (entry->target_arg_type != VALUE_TYPE_NONE)
+    Value* result = &iter->result.arg;
+
+    switch (entry->arg_source)
     {
-        Streader* sr = Streader_init(
-                STREADER_AUTO, entry->expression, (int64_t)strlen(entry->expression));
-        Value* meta = (iter->src_value.type != VALUE_TYPE_NONE) ? &iter->src_value : NULL;
-        Value* result = &iter->result.arg;
-        if (evaluate_expr(sr, NULL, meta, result, iter->rand))
+        case ARG_SOURCE_NONE:
         {
-            if (!Value_convert(result, result, entry->target_arg_type))
+            result->type = VALUE_TYPE_NONE;
+        }
+        break;
+
+        case ARG_SOURCE_META:
+        {
+            if (!Value_convert(result, &iter->src_value, entry->target_arg_type))
                 result->type = VALUE_TYPE_NONE;
         }
-        else
+        break;
+
+        case ARG_SOURCE_CONST:
         {
-            result->type = VALUE_TYPE_NONE;
+            Value_copy(result, &entry->const_arg);
         }
-    }
-    else
-    {
-        iter->result.arg.type = VALUE_TYPE_NONE;
+        break;
+
+        case ARG_SOURCE_EXPR:
+        {
+            const Value* meta =
+                (iter->src_value.type != VALUE_TYPE_NONE) ? &iter->src_value : NULL;
+            if (entry->cexpr != NULL)
+            {
+                if (!Compiled_expr_evaluate(entry->cexpr, NULL, meta, result, iter->rand) ||
+                        !Value_convert(result, result, entry->target_arg_type))
+                    result->type = VALUE_TYPE_NONE;
+            }
+            else
+            {
+                evaluate_arg(
+                        entry->expression,
+                        entry->target_arg_type,
+                        meta,
+                        result,
+                        iter->rand);
+            }
+        }
+        break;
+
+        default:
+            rassert(false);
     }
 
     return;
@@ -419,7 +541,7 @@ Au_event_iter_result* Au_event_iter_init(
     rassert(rand != NULL);
 
     const Event_entry* entry = AAtree_get_exact(map->tree, event_name);
-    if (entry == NULL)
+    if ((entry == NULL) || (entry->bind_entry_count == 0))
     {
         iter->bind_entry = NULL;
         return NULL;
@@ -431,7 +553,10 @@ Au_event_iter_result* Au_event_iter_init(
         if (entry->event_arg_type != arg->type)
         {
             if (!Value_convert(&iter->src_value, arg, entry->event_arg_type))
+            {
+                iter->bind_entry = NULL;
                 return NULL;
+            }
         }
         else
         {
@@ -443,7 +568,8 @@ Au_event_iter_result* Au_event_iter_init(
         iter->src_value.type = VALUE_TYPE_NONE;
     }
 
-    iter->bind_entry = entry->first_bind_entry;
+    iter->bind_entry = entry->bind_entries;
+    iter->bind_entry_end = entry->bind_entries + entry->bind_entry_count;
     iter->rand = rand;
 
     fill_iter_result(iter);
@@ -459,9 +585,12 @@ Au_event_iter_result* Au_event_iter_get_next(Au_event_iter* iter)
     if (iter->bind_entry == NULL)
         return NULL;
 
-    iter->bind_entry = iter->bind_entry->next;
-    if (iter->bind_entry == NULL)
+    ++iter->bind_entry;
+    if (iter->bind_entry == iter->bind_entry_end)
+    {
+        iter->bind_entry = NULL;
         return NULL;
+    }
 
     fill_iter_result(iter);
 
@@ -44,11 +44,13 @@ typedef struct Au_event_iter
 {
     Au_event_iter_result result;
     const Au_event_bind_entry* bind_entry;
+    const Au_event_bind_entry* bind_entry_end;
     Value src_value;
     Random* rand;
 } Au_event_iter;
 
-#define AU_EVENT_ITER_AUTO (&(Au_event_iter){ .bind_entry = NULL, .rand = NULL })
+#define AU_EVENT_ITER_AUTO \
+    (&(Au_event_iter){ .bind_entry = NULL, .bind_entry_end = NULL, .rand = NULL })
 
 
 /**
@@ -294,6 +294,14 @@ bool Device_field_change(Device_field* field, int version, Streader* sr)
                     del_Sample(sample);
                     return false;
                 }
+
+                if (!Sample_build_mip_levels(sample))
+                {
+                    Streader_set_memory_error(
+                            sr, "Could not allocate memory for sample levels");
+                    del_Sample(sample);
+                    return false;
+                }
             }
 
             rassert(!Streader_is_error_set(sr));
@@ -318,6 +326,14 @@ bool Device_field_change(Device_field* field, int version, Streader* sr)
                     del_Sample(sample);
                     return false;
                 }
+
+                if (!Sample_build_mip_levels(sample))
+                {
+                    Streader_set_memory_error(
+                            sr, "Could not allocate memory for sample levels");
+                    del_Sample(sample);
+                    return false;
+                }
             }
 
             rassert(!Streader_is_error_set(sr));
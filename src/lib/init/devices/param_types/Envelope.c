@@ -15,6 +15,7 @@
 #include <init/devices/param_types/Envelope.h>
 
 #include <debug/assert.h>
+#include <mathnum/common.h>
 #include <memory.h>
 #include <string/common.h>
 
@@ -42,12 +43,25 @@ struct Envelope
     int nodes_res;
     int marks[ENVELOPE_MARKS_MAX];
     double* nodes;
+
+    // Lookup of the node segment at uniformly spaced x coordinates
+    bool is_lookup_valid;
+    int lookup_size;
+    double lookup_scale;
+    int* lookup_segments;
+    double* slopes;
 };
 
 
+#define LOOKUP_CELLS_PER_NODE 4
+
+
 static bool Envelope_read_nodes(Envelope* env, Streader* sr);
 
 
+static void Envelope_update_lookup(Envelope* env);
+
+
 Envelope* new_Envelope(int nodes_max,
         double min_x, double max_x, double step_x,
         double min_y, double max_y, double step_y)
@@ -64,10 +78,16 @@ Envelope* new_Envelope(int nodes_max,
     if (env == NULL)
         return NULL;
 
+    env->is_lookup_valid = false;
+    env->lookup_size = nodes_max * LOOKUP_CELLS_PER_NODE;
+    env->lookup_scale = 0;
+
     env->nodes = memory_alloc_items(double, nodes_max * 2);
-    if (env->nodes == NULL)
+    env->lookup_segments = memory_alloc_items(int, env->lookup_size);
+    env->slopes = memory_alloc_items(double, nodes_max - 1);
+    if ((env->nodes == NULL) || (env->lookup_segments == NULL) || (env->slopes == NULL))
     {
-        memory_free(env);
+        del_Envelope(env);
         return NULL;
     }
 
@@ -177,7 +197,12 @@ bool Envelope_read(Envelope* env, Streader* sr)
 
     Envelope_set_interp(env, ENVELOPE_INT_LINEAR);
 
-    return Streader_read_dict(sr, read_env_item, env);
+    if (!Streader_read_dict(sr, read_env_item, env))
+        return false;
+
+    Envelope_update_lookup(env);
+
+    return true;
 }
 
 
@@ -331,6 +356,8 @@ int Envelope_set_node(Envelope* env, double x, double y)
         return -1;
     }
 
+    env->is_lookup_valid = false;
+
     if (env->node_count > 0)
     {
         if (x < env->nodes[0] && (env->first_x_locked || env->first_y_locked))
@@ -388,6 +415,8 @@ bool Envelope_del_node(Envelope* env, int index)
             && (env->last_x_locked || env->last_y_locked))
         return false;
 
+    env->is_lookup_valid = false;
+
     for (int i = index * 2; i < env->node_count * 2 - 2; i += 2)
     {
         env->nodes[i] = env->nodes[i + 2];
@@ -428,6 +457,8 @@ double* Envelope_move_node(Envelope* env, int index, double x, double y)
     if (index >= env->node_count)
         return NULL;
 
+    env->is_lookup_valid = false;
+
     double max_x = env->max_x;
     double max_y = env->max_y;
     double min_x = env->min_x;
@@ -486,6 +517,86 @@ double* Envelope_move_node(Envelope* env, int index, double x, double y)
 }
 
 
+static void Envelope_update_lookup(Envelope* env)
+{
+    rassert(env != NULL);
+
+    env->is_lookup_valid = false;
+
+    if (env->node_count < 2)
+        return;
+
+    const double first_x = env->nodes[0];
+    const double last_x = env->nodes[env->node_count * 2 - 2];
+    const double range = last_x - first_x;
+    if (!isfinite(range) || (range <= 0))
+        return;
+
+    env->lookup_scale = env->lookup_size / range;
+    if (!isfinite(env->lookup_scale))
+        return;
+
+    // Precompute the slopes used in linear interpolation
+    const int segment_count = env->node_count - 1;
+    for (int i = 0; i < segment_count; ++i)
+    {
+        const double* node = env->nodes + i * 2;
+        env->slopes[i] = (node[3] - node[1]) / (node[2] - node[0]);
+    }
+
+    // Find the segment at the start of each cell
+    int segment = 0;
+    for (int i = 0; i < env->lookup_size; ++i)
+    {
+        const double cell_x = first_x + i / env->lookup_scale;
+        while ((segment < segment_count - 1) && (env->nodes[segment * 2 + 2] <= cell_x))
+            ++segment;
+
+        env->lookup_segments[i] = segment;
+    }
+
+    env->is_lookup_valid = true;
+
+    return;
+}
+
+
+static double Envelope_get_value_from_lookup(const Envelope* env, double x)
+{
+    rassert(env != NULL);
+    rassert(env->is_lookup_valid);
+    rassert(x >= env->nodes[0]);
+    rassert(x <= env->nodes[env->node_count * 2 - 2]);
+
+    const int segment_count = env->node_count - 1;
+
+    const int cell = clamp(
+            (int)((x - env->nodes[0]) * env->lookup_scale), 0, env->lookup_size - 1);
+    int segment = env->lookup_segments[cell];
+
+    // Adjust for the rounding of cell boundaries
+    while ((segment > 0) && (env->nodes[segment * 2] > x))
+        --segment;
+    while ((segment < segment_count - 1) && (env->nodes[segment * 2 + 2] <= x))
+        ++segment;
+
+    const double* prev = env->nodes + segment * 2;
+    const double* next = prev + 2;
+
+    // Return exact node values at node positions
+    if (x == prev[0])
+        return prev[1];
+    if (x == next[0])
+        return next[1];
+
+    if (env->interp == ENVELOPE_INT_NEAREST)
+        return (x - prev[0] < next[0] - x) ? prev[1] : next[1];
+
+    rassert(env->interp == ENVELOPE_INT_LINEAR);
+    return prev[1] + (x - prev[0]) * env->slopes[segment];
+}
+
+
 double Envelope_get_value(const Envelope* env, double x)
 {
     rassert(env != NULL);
@@ -496,6 +607,9 @@ double Envelope_get_value(const Envelope* env, double x)
             || x > env->nodes[env->node_count * 2 - 2])
         return NAN;
 
+    if (env->is_lookup_valid)
+        return Envelope_get_value_from_lookup(env, x);
+
     // Binary search the markers surrounding x
     int start = 0;
     int end = env->node_count - 1;
@@ -577,6 +691,8 @@ void del_Envelope(Envelope* env)
         return;
 
     memory_free(env->nodes);
+    memory_free(env->lookup_segments);
+    memory_free(env->slopes);
     memory_free(env);
 
     return;
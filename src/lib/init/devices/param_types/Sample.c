@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2016
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -15,8 +15,10 @@
 #include <init/devices/param_types/Sample.h>
 
 #include <debug/assert.h>
+#include <mathnum/common.h>
 #include <memory.h>
 
+#include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -39,6 +41,12 @@ Sample* new_Sample(void)
     sample->len = 0;
     sample->data[0] = NULL;
     sample->data[1] = NULL;
+    sample->mip_level_count = 0;
+    for (int level = 0; level < SAMPLE_MIP_LEVELS_MAX; ++level)
+    {
+        sample->mip_levels[level][0] = NULL;
+        sample->mip_levels[level][1] = NULL;
+    }
 
     return sample;
 }
@@ -86,11 +94,260 @@ int64_t Sample_get_len(const Sample* sample)
 }
 
 
+#define MIP_FILTER_HALF_LENGTH 16
+#define MIP_FILTER_LENGTH (MIP_FILTER_HALF_LENGTH * 2 + 1)
+#define MIP_LEVEL_LEN_MIN 4
+
+
+static void Sample_clear_mip_levels(Sample* sample)
+{
+    rassert(sample != NULL);
+
+    for (int level = 0; level < SAMPLE_MIP_LEVELS_MAX; ++level)
+    {
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            memory_free(sample->mip_levels[level][ch]);
+            sample->mip_levels[level][ch] = NULL;
+        }
+    }
+
+    sample->mip_level_count = 0;
+
+    return;
+}
+
+
+static void get_normalised_data(const Sample* sample, int ch, float* dest)
+{
+    rassert(sample != NULL);
+    rassert(ch >= 0);
+    rassert(ch < sample->channels);
+    rassert(dest != NULL);
+
+    switch (sample->bits)
+    {
+        case 8:
+        {
+            const int8_t* data = sample->data[ch];
+            const float scale = 1.0f / 0x80;
+            for (int64_t i = 0; i < sample->len; ++i)
+                dest[i] = (float)data[i] * scale;
+        }
+        break;
+
+        case 16:
+        {
+            const int16_t* data = sample->data[ch];
+            const float scale = 1.0f / 0x8000UL;
+            for (int64_t i = 0; i < sample->len; ++i)
+                dest[i] = (float)data[i] * scale;
+        }
+        break;
+
+        case 32:
+        {
+            const int32_t* data = sample->data[ch];
+            const double scale = 1.0 / 0x80000000UL;
+            for (int64_t i = 0; i < sample->len; ++i)
+                dest[i] = (float)(data[i] * scale);
+        }
+        break;
+
+        default:
+            rassert(false);
+    }
+
+    return;
+}
+
+
+void Sample_get_float_data(const Sample* sample, int ch, float* dest)
+{
+    rassert(sample != NULL);
+    rassert(ch >= 0);
+    rassert(ch < sample->channels);
+    rassert(dest != NULL);
+
+    if (sample->is_float)
+    {
+        const float* data = sample->data[ch];
+        for (int64_t i = 0; i < sample->len; ++i)
+            dest[i] = data[i];
+    }
+    else
+    {
+        get_normalised_data(sample, ch, dest);
+    }
+
+    return;
+}
+
+
+static void filter_and_decimate(
+        const float* filter, const float* src, int64_t src_len, float* dest)
+{
+    rassert(filter != NULL);
+    rassert(src != NULL);
+    rassert(src_len > 0);
+    rassert(dest != NULL);
+
+    const int64_t dest_len = (src_len + 1) / 2;
+
+    for (int64_t i = 0; i < dest_len; ++i)
+    {
+        const int64_t src_centre = i * 2;
+
+        // Treat the signal as silent outside the sample boundaries
+        const int64_t first = max(-MIP_FILTER_HALF_LENGTH, -src_centre);
+        const int64_t last = min(MIP_FILTER_HALF_LENGTH, src_len - 1 - src_centre);
+
+        double sum = 0;
+        for (int64_t k = first; k <= last; ++k)
+            sum += filter[k + MIP_FILTER_HALF_LENGTH] * src[src_centre + k];
+
+        dest[i] = (float)sum;
+    }
+
+    return;
+}
+
+
+bool Sample_build_mip_levels(Sample* sample)
+{
+    rassert(sample != NULL);
+
+    Sample_clear_mip_levels(sample);
+
+    if ((sample->len == 0) || (sample->data[0] == NULL))
+        return true;
+
+    // Create a Blackman-windowed half-band lowpass filter
+    float filter[MIP_FILTER_LENGTH] = { 0 };
+    double filter_sum = 0;
+    for (int i = 0; i < MIP_FILTER_LENGTH; ++i)
+    {
+        const int offset = i - MIP_FILTER_HALF_LENGTH;
+        const double x = PI * offset * 0.5;
+        const double sinc = (offset == 0) ? 1.0 : (sin(x) / x);
+        const double window_pos = (double)i / (MIP_FILTER_LENGTH - 1);
+        const double window =
+            0.42 - 0.5 * cos(2 * PI * window_pos) + 0.08 * cos(4 * PI * window_pos);
+
+        filter[i] = (float)(sinc * window);
+        filter_sum += filter[i];
+    }
+
+    for (int i = 0; i < MIP_FILTER_LENGTH; ++i)
+        filter[i] = (float)(filter[i] / filter_sum);
+
+    // Get the original data in floating-point format
+    float* orig_data[2] = { NULL };
+    for (int ch = 0; ch < sample->channels; ++ch)
+    {
+        if (sample->is_float)
+        {
+            orig_data[ch] = sample->data[ch];
+            continue;
+        }
+
+        orig_data[ch] = memory_alloc_items(float, sample->len);
+        if (orig_data[ch] == NULL)
+        {
+            memory_free(orig_data[0]);
+            return false;
+        }
+
+        get_normalised_data(sample, ch, orig_data[ch]);
+    }
+
+    bool success = true;
+
+    int64_t src_len = sample->len;
+    for (int level = 1; level <= SAMPLE_MIP_LEVELS_MAX; ++level)
+    {
+        const int64_t level_len = (src_len + 1) / 2;
+        if (level_len < MIP_LEVEL_LEN_MIN)
+            break;
+
+        for (int ch = 0; ch < sample->channels; ++ch)
+        {
+            float* level_data = memory_alloc_items(float, level_len);
+            if (level_data == NULL)
+            {
+                success = false;
+                break;
+            }
+
+            const float* src =
+                (level == 1) ? orig_data[ch] : sample->mip_levels[level - 2][ch];
+            filter_and_decimate(filter, src, src_len, level_data);
+
+            sample->mip_levels[level - 1][ch] = level_data;
+        }
+
+        if (!success)
+            break;
+
+        sample->mip_level_count = level;
+        src_len = level_len;
+    }
+
+    if (!sample->is_float)
+    {
+        memory_free(orig_data[0]);
+        memory_free(orig_data[1]);
+    }
+
+    if (!success)
+    {
+        Sample_clear_mip_levels(sample);
+        return false;
+    }
+
+    return true;
+}
+
+
+int Sample_get_mip_level_count(const Sample* sample)
+{
+    rassert(sample != NULL);
+    return sample->mip_level_count;
+}
+
+
+int64_t Sample_get_mip_level_len(const Sample* sample, int level)
+{
+    rassert(sample != NULL);
+    rassert(level >= 1);
+    rassert(level <= sample->mip_level_count);
+
+    int64_t level_len = sample->len;
+    for (int i = 0; i < level; ++i)
+        level_len = (level_len + 1) / 2;
+
+    return level_len;
+}
+
+
+const float* Sample_get_mip_level_buffer(const Sample* sample, int level, int ch)
+{
+    rassert(sample != NULL);
+    rassert(level >= 1);
+    rassert(level <= sample->mip_level_count);
+    rassert(ch >= 0);
+    rassert(ch < sample->channels);
+
+    return sample->mip_levels[level - 1][ch];
+}
+
+
 void del_Sample(Sample* sample)
 {
     if (sample == NULL)
         return;
 
+    Sample_clear_mip_levels(sample);
     memory_free(sample->data[0]);
     memory_free(sample->data[1]);
     memory_free(sample);
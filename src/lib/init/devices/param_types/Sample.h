@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2016
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -24,6 +24,12 @@
 #include <stdlib.h>
 
 
+/**
+ * The maximum number of decimated levels stored in a Sample.
+ */
+#define SAMPLE_MIP_LEVELS_MAX 8
+
+
 /**
  * Sample contains a digital sound sample.
  */
@@ -38,6 +44,8 @@ struct Sample
     bool is_float;        ///< Whether this sample is in floating point format.
     int64_t len;          ///< The length of the sample (in amplitude values per channel).
     void* data[2];        ///< The sample data.
+    int mip_level_count;  ///< The number of band-limited decimated levels.
+    float* mip_levels[SAMPLE_MIP_LEVELS_MAX][2]; ///< The mip level data.
 };
 
 
@@ -90,6 +98,70 @@ int64_t Sample_get_len(const Sample* sample);
 void* Sample_get_buffer(Sample* sample, int ch);
 
 
+/**
+ * Get the contents of a channel of the Sample in normalised floating-point format.
+ *
+ * \param sample   The Sample -- must not be \c NULL.
+ * \param ch       The channel number -- must be >= \c 0 and less than the
+ *                 number of channels in the Sample.
+ * \param dest     The destination buffer -- must not be \c NULL and must have
+ *                 space for at least the length of the Sample.
+ */
+void Sample_get_float_data(const Sample* sample, int ch, float* dest);
+
+
+/**
+ * Build band-limited decimated copies of the Sample data.
+ *
+ * Level \c 1 contains the sample data lowpass filtered and decimated to half
+ * of the original rate, level \c 2 to a quarter and so on. The levels are
+ * used for rendering the Sample at high pitches without aliasing.
+ *
+ * \param sample   The Sample -- must not be \c NULL.
+ *
+ * \return   \c true if successful, or \c false if memory allocation failed.
+ */
+bool Sample_build_mip_levels(Sample* sample);
+
+
+/**
+ * Get the number of decimated levels in the Sample.
+ *
+ * \param sample   The Sample -- must not be \c NULL.
+ *
+ * \return   The number of levels, excluding the original sample data.
+ */
+int Sample_get_mip_level_count(const Sample* sample);
+
+
+/**
+ * Get the length of a decimated level in the Sample.
+ *
+ * \param sample   The Sample -- must not be \c NULL.
+ * \param level    The level -- must be >= \c 1 and not greater than the
+ *                 number of levels in the Sample.
+ *
+ * \return   The length of the level in frames/buffer.
+ */
+int64_t Sample_get_mip_level_len(const Sample* sample, int level);
+
+
+/**
+ * Get a buffer of a decimated level in the Sample.
+ *
+ * The values are normalised to the range used by floating-point samples.
+ *
+ * \param sample   The Sample -- must not be \c NULL.
+ * \param level    The level -- must be >= \c 1 and not greater than the
+ *                 number of levels in the Sample.
+ * \param ch       The channel number -- must be >= \c 0 and less than the
+ *                 number of channels in the Sample.
+ *
+ * \return   The buffer.
+ */
+const float* Sample_get_mip_level_buffer(const Sample* sample, int level, int ch);
+
+
 /**
  * Destroy a Sample.
  *
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2011-2016
+ * Author: Tomi Jylhä-Ollila, Finland 2011-2018
  *
  * This file is part of Kunquat.
  *
@@ -25,7 +25,8 @@
 
 
 #define ADD_TONES_MAX 32
-#define ADD_BASE_FUNC_SIZE 4096
+#define ADD_BASE_FUNC_SIZE_EXP 12
+#define ADD_BASE_FUNC_SIZE (1 << ADD_BASE_FUNC_SIZE_EXP)
 
 
 typedef struct Add_tone
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -27,6 +27,7 @@
 
 #define DEFAULT_ATTACK 1.0
 #define DEFAULT_RELEASE 100.0
+#define DEFAULT_LOOKAHEAD 0.0
 
 #define DEFAULT_UPWARD_THRESHOLD -60.0
 #define DEFAULT_UPWARD_RANGE 12.0
@@ -37,6 +38,7 @@
 
 static Set_float_func   Proc_compress_set_attack;
 static Set_float_func   Proc_compress_set_release;
+static Set_float_func   Proc_compress_set_lookahead;
 
 static Set_bool_func    Proc_compress_set_upward_enabled;
 static Set_float_func   Proc_compress_set_upward_threshold;
@@ -59,6 +61,7 @@ Device_impl* new_Proc_compress(void)
 
     compress->attack = DEFAULT_ATTACK;
     compress->release = DEFAULT_RELEASE;
+    compress->lookahead = DEFAULT_LOOKAHEAD;
 
     compress->upward_enabled = false;
     compress->upward_threshold = DEFAULT_UPWARD_THRESHOLD;
@@ -83,6 +86,13 @@ Device_impl* new_Proc_compress(void)
 
     if (!(REG_KEY(float, attack, "p_f_attack.json", DEFAULT_ATTACK) &&
             REG_KEY(float, release, "p_f_release.json", DEFAULT_RELEASE) &&
+            REGISTER_SET_WITH_STATE_CB(
+                compress,
+                float,
+                lookahead,
+                "p_f_lookahead.json",
+                DEFAULT_LOOKAHEAD,
+                Compress_pstate_set_lookahead) &&
             REG_KEY_BOOL(upward_enabled, "p_b_upward_enabled.json", false) &&
             REG_KEY(float, upward_threshold,
                 "p_f_upward_threshold.json", DEFAULT_UPWARD_THRESHOLD) &&
@@ -145,6 +155,21 @@ static bool Proc_compress_set_release(
 }
 
 
+static bool Proc_compress_set_lookahead(
+        Device_impl* dimpl, const Key_indices indices, double value)
+{
+    rassert(dimpl != NULL);
+    ignore(indices);
+
+    Proc_compress* compress = (Proc_compress*)dimpl;
+    compress->lookahead =
+        (isfinite(value) && (value >= 0.0) && (value <= COMPRESS_LOOKAHEAD_MAX))
+        ? value : DEFAULT_LOOKAHEAD;
+
+    return true;
+}
+
+
 static bool Proc_compress_set_upward_enabled(
         Device_impl* dimpl, const Key_indices indices, bool enabled)
 {
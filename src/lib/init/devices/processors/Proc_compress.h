@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -19,12 +19,16 @@
 #include <init/devices/Device_impl.h>
 
 
+#define COMPRESS_LOOKAHEAD_MAX 20.0
+
+
 typedef struct Proc_compress
 {
     Device_impl parent;
 
     double attack;
     double release;
+    double lookahead;
 
     bool upward_enabled;
     double upward_threshold;
@@ -0,0 +1,107 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <init/devices/processors/Proc_convolution.h>
+
+#include <debug/assert.h>
+#include <init/devices/Device_impl.h>
+#include <init/devices/Proc_cons.h>
+#include <init/devices/Processor.h>
+#include <init/devices/processors/Proc_init_utils.h>
+#include <memory.h>
+#include <player/devices/processors/Convolution_state.h>
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+
+static Set_sample_func Proc_convolution_set_ir;
+static Set_float_func Proc_convolution_set_volume;
+
+static void del_Proc_convolution(Device_impl* dimpl);
+
+
+Device_impl* new_Proc_convolution(void)
+{
+    Proc_convolution* convolution = memory_alloc_item(Proc_convolution);
+    if (convolution == NULL)
+        return NULL;
+
+    convolution->volume = 0.0;
+
+    if (!Device_impl_init(&convolution->parent, del_Proc_convolution))
+    {
+        del_Device_impl(&convolution->parent);
+        return NULL;
+    }
+
+    convolution->parent.create_pstate = new_Convolution_pstate;
+
+    // Register key handlers
+#define REG_KEY(type, name, keyp, def_value, state_cb) \
+    REGISTER_SET_WITH_STATE_CB(convolution, type, name, keyp, def_value, state_cb)
+
+    if (!(REG_KEY(sample, ir, "p_ir.wav", NULL, Convolution_pstate_set_ir) &&
+            REG_KEY(sample, ir, "p_ir.wv", NULL, Convolution_pstate_set_ir) &&
+            REG_KEY(float, volume, "p_f_volume.json", 0.0, Convolution_pstate_set_volume)
+         ))
+    {
+        del_Device_impl(&convolution->parent);
+        return NULL;
+    }
+
+#undef REG_KEY
+
+    return &convolution->parent;
+}
+
+
+static bool Proc_convolution_set_ir(
+        Device_impl* dimpl, const Key_indices indices, const Sample* sample)
+{
+    rassert(dimpl != NULL);
+    rassert(indices != NULL);
+    ignore(sample);
+
+    // The impulse response is stored in the Device parameters
+    return true;
+}
+
+
+static bool Proc_convolution_set_volume(
+        Device_impl* dimpl, const Key_indices indices, double value)
+{
+    rassert(dimpl != NULL);
+    rassert(indices != NULL);
+
+    Proc_convolution* convolution = (Proc_convolution*)dimpl;
+    convolution->volume = isfinite(value) ? value : 0.0;
+
+    return true;
+}
+
+
+static void del_Proc_convolution(Device_impl* dimpl)
+{
+    if (dimpl == NULL)
+        return;
+
+    Proc_convolution* convolution = (Proc_convolution*)dimpl;
+    memory_free(convolution);
+
+    return;
+}
+
+
@@ -0,0 +1,34 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#ifndef KQT_PROC_CONVOLUTION_H
+#define KQT_PROC_CONVOLUTION_H
+
+
+#include <init/devices/Device_impl.h>
+
+#include <stdlib.h>
+
+
+typedef struct Proc_convolution
+{
+    Device_impl parent;
+
+    double volume;
+} Proc_convolution;
+
+
+#endif // KQT_PROC_CONVOLUTION_H
+
+
@@ -33,6 +33,13 @@ struct Column
     uint32_t version;
     Column_iter* edit_iter;
     AAtree* triggers;
+
+    // Trigger rows in playback order, rebuilt by Column_update_rows
+    uint32_t rows_version;
+    int row_count;
+    Trigger_row* rows;
+    Event_type* trigger_types;
+    const Trigger** row_triggers;
 };
 
 
@@ -249,6 +256,12 @@ Column* new_Column(const Tstamp* len)
         return NULL;
 
     col->version = 1;
+    col->rows_version = col->version;
+    col->row_count = 0;
+    col->rows = NULL;
+    col->trigger_types = NULL;
+    col->row_triggers = NULL;
+
     col->triggers = new_AAtree(
             (AAtree_item_cmp*)Trigger_list_cmp, (AAtree_item_destroy*)del_Trigger_list);
     if (col->triggers == NULL)
@@ -293,6 +306,13 @@ Column* new_Column_from_string(
         return NULL;
     }
 
+    if (!Column_update_rows(col))
+    {
+        Streader_set_memory_error(sr, "Could not allocate memory for column");
+        del_Column(col);
+        return NULL;
+    }
+
     return col;
 }
 
@@ -404,11 +424,136 @@ bool Column_ins(Column* col, Trigger* trigger)
 }
 
 
+bool Column_update_rows(Column* col)
+{
+    rassert(col != NULL);
+
+    if (col->rows_version == col->version)
+        return true;
+
+    // Count rows and triggers
+    int row_count = 0;
+    int trigger_count = 0;
+
+    Trigger* first = &(Trigger){ .type = Event_NONE };
+    Tstamp_set(&first->pos, INT64_MIN, 0);
+    Trigger_list* key = Trigger_list_init(&(Trigger_list){ .trigger = first });
+
+    AAiter* iter = AAiter_init(AAITER_AUTO, col->triggers);
+
+    Trigger_list* row = AAiter_get_at_least(iter, key);
+    while (row != NULL)
+    {
+        ++row_count;
+        for (Trigger_list* cur = row->next; cur->trigger != NULL; cur = cur->next)
+            ++trigger_count;
+
+        row = AAiter_get_next(iter);
+    }
+
+    // Allocate new storage
+    Trigger_row* rows = NULL;
+    Event_type* types = NULL;
+    const Trigger** triggers = NULL;
+    if (row_count > 0)
+    {
+        rows = memory_alloc_items(Trigger_row, row_count);
+        types = memory_alloc_items(Event_type, trigger_count);
+        triggers = memory_alloc_items(const Trigger*, trigger_count);
+        if ((rows == NULL) || (types == NULL) || (triggers == NULL))
+        {
+            memory_free(rows);
+            memory_free(types);
+            memory_free(triggers);
+            return false;
+        }
+    }
+
+    // Fill in the trigger data
+    int row_index = 0;
+    int trigger_index = 0;
+
+    AAiter_init(iter, col->triggers);
+    row = AAiter_get_at_least(iter, key);
+    while (row != NULL)
+    {
+        rassert(row_index < row_count);
+        Trigger_row* tr = &rows[row_index];
+        Tstamp_copy(&tr->pos, Trigger_get_pos(row->next->trigger));
+        tr->trigger_count = 0;
+        tr->types = &types[trigger_index];
+        tr->triggers = &triggers[trigger_index];
+
+        for (Trigger_list* cur = row->next; cur->trigger != NULL; cur = cur->next)
+        {
+            rassert(trigger_index < trigger_count);
+            types[trigger_index] = Trigger_get_type(cur->trigger);
+            triggers[trigger_index] = cur->trigger;
+            ++trigger_index;
+            ++tr->trigger_count;
+        }
+
+        ++row_index;
+        row = AAiter_get_next(iter);
+    }
+
+    memory_free(col->rows);
+    memory_free(col->trigger_types);
+    memory_free(col->row_triggers);
+
+    col->row_count = row_count;
+    col->rows = rows;
+    col->trigger_types = types;
+    col->row_triggers = triggers;
+    col->rows_version = col->version;
+
+    return true;
+}
+
+
+int Column_find_row(const Column* col, const Tstamp* pos)
+{
+    rassert(col != NULL);
+    rassert(col->rows_version == col->version);
+    rassert(pos != NULL);
+
+    int low = 0;
+    int high = col->row_count;
+    while (low < high)
+    {
+        const int mid = low + (high - low) / 2;
+        if (Tstamp_cmp(&col->rows[mid].pos, pos) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low >= col->row_count)
+        return -1;
+
+    return low;
+}
+
+
+const Trigger_row* Column_get_row(const Column* col, int index)
+{
+    rassert(col != NULL);
+    rassert(col->rows_version == col->version);
+    rassert(index >= 0);
+    rassert(index < col->row_count);
+
+    return &col->rows[index];
+}
+
+
 void del_Column(Column* col)
 {
     if (col == NULL)
         return;
 
+    memory_free(col->rows);
+    memory_free(col->trigger_types);
+    memory_free(col->row_triggers);
     del_AAtree(col->triggers);
     del_Column_iter(col->edit_iter);
     memory_free(col);
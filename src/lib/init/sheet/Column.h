@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2016
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -20,6 +20,7 @@
 #include <init/sheet/Trigger.h>
 #include <mathnum/Tstamp.h>
 #include <player/Event_names.h>
+#include <player/Event_type.h>
 #include <string/Streader.h>
 
 #include <stdbool.h>
@@ -35,6 +36,19 @@ typedef struct Trigger_list
 } Trigger_list;
 
 
+/**
+ * A read-only view of the Triggers located at the same position in a Column.
+ * The trigger data is stored as parallel arrays in order of insertion.
+ */
+typedef struct Trigger_row
+{
+    Tstamp pos;
+    int trigger_count;
+    const Event_type* types;
+    const Trigger* const* triggers;
+} Trigger_row;
+
+
 /**
  * Column is a container for Triggers in a Pattern. It contains a
  * "monophonic" section of music.
@@ -161,6 +175,46 @@ Column* new_Column_from_string(
 bool Column_ins(Column* col, Trigger* trigger);
 
 
+/**
+ * Update the trigger rows of the Column used in playback.
+ *
+ * This must be called after inserting Triggers with Column_ins() before
+ * accessing the trigger rows. Columns created with new_Column_from_string()
+ * are already up to date.
+ *
+ * \param col   The Column -- must not be \c NULL.
+ *
+ * \return   \c true if successful, or \c false if memory allocation failed.
+ */
+bool Column_update_rows(Column* col);
+
+
+/**
+ * Find a trigger row in the Column.
+ *
+ * \param col   The Column -- must not be \c NULL and must have up-to-date
+ *              trigger rows.
+ * \param pos   The minimum position of the row -- must not be \c NULL.
+ *
+ * \return   The index of the first trigger row located at or after \a pos,
+ *           or \c -1 if no such row exists.
+ */
+int Column_find_row(const Column* col, const Tstamp* pos);
+
+
+/**
+ * Get a trigger row in the Column.
+ *
+ * \param col     The Column -- must not be \c NULL and must have up-to-date
+ *                trigger rows.
+ * \param index   The row index -- must be >= \c 0 and less than the number
+ *                of trigger rows in \a col.
+ *
+ * \return   The trigger row.
+ */
+const Trigger_row* Column_get_row(const Column* col, int index);
+
+
 /**
  * Destroy an existing Column.
  *
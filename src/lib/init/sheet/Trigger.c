@@ -15,9 +15,13 @@
 #include <init/sheet/Trigger.h>
 
 #include <debug/assert.h>
+#include <Error.h>
+#include <expr.h>
 #include <kunquat/limits.h>
 #include <memory.h>
+#include <string/common.h>
 #include <string/Streader.h>
+#include <Value.h>
 
 #include <stdbool.h>
 #include <stdio.h>
@@ -64,11 +68,92 @@ Trigger* new_Trigger(Event_type type, Tstamp* pos)
     trigger->type = type;
     Tstamp_copy(&trigger->pos, pos);
     trigger->desc = NULL;
+    trigger->event_name[0] = '\0';
+    trigger->arg_type = VALUE_TYPE_NONE;
+    trigger->has_literal_arg = false;
+    trigger->literal_arg.type = VALUE_TYPE_NONE;
+    trigger->arg_expr = NULL;
 
     return trigger;
 }
 
 
+static bool Trigger_compile_arg(Trigger* trigger, const Event_names* names, Streader* sr)
+{
+    rassert(trigger != NULL);
+    rassert(trigger->desc != NULL);
+    rassert(names != NULL);
+    rassert(sr != NULL);
+
+    Streader* desc_sr = Streader_init(
+            STREADER_AUTO, trigger->desc, (int64_t)strlen(trigger->desc));
+
+    // Unresolved descriptions are left for interpretation during playback
+    if (!Streader_readf(
+                desc_sr,
+                "[%s,",
+                READF_STR(KQT_EVENT_NAME_MAX + 1, trigger->event_name)))
+    {
+        trigger->event_name[0] = '\0';
+        return true;
+    }
+
+    Streader_skip_whitespace(desc_sr);
+
+    trigger->arg_type = Event_names_get_param_type(names, trigger->event_name);
+
+    if (string_has_suffix(trigger->event_name, "\""))
+    {
+        // String arguments are used as is
+        if (trigger->arg_type != VALUE_TYPE_STRING)
+            return true;
+
+        trigger->literal_arg.type = VALUE_TYPE_STRING;
+        if (Streader_read_string(
+                    desc_sr, KQT_VAR_NAME_MAX + 1, trigger->literal_arg.value.string_type))
+            trigger->has_literal_arg = true;
+
+        return true;
+    }
+
+    if (trigger->arg_type == VALUE_TYPE_NONE)
+    {
+        trigger->literal_arg.type = VALUE_TYPE_NONE;
+        trigger->has_literal_arg = true;
+        return true;
+    }
+
+    if ((trigger->arg_type == VALUE_TYPE_MAYBE_STRING) ||
+            (trigger->arg_type == VALUE_TYPE_MAYBE_REALTIME))
+    {
+        if (Streader_read_null(desc_sr))
+        {
+            trigger->literal_arg.type = VALUE_TYPE_NONE;
+            trigger->has_literal_arg = true;
+            return true;
+        }
+
+        Streader_clear_error(desc_sr);
+    }
+
+    trigger->arg_expr = new_Compiled_expr(desc_sr);
+    if ((trigger->arg_expr != NULL) && !Streader_match_char(desc_sr, '"'))
+    {
+        del_Compiled_expr(trigger->arg_expr);
+        trigger->arg_expr = NULL;
+    }
+
+    if ((trigger->arg_expr == NULL) && Streader_is_error_set(desc_sr) &&
+            (Error_get_type(&desc_sr->error) == ERROR_MEMORY))
+    {
+        Streader_set_memory_error(sr, "Could not allocate memory for a trigger");
+        return false;
+    }
+
+    return true;
+}
+
+
 Trigger* new_Trigger_from_string(Streader* sr, const Event_names* names)
 {
     rassert(sr != NULL);
@@ -179,6 +264,12 @@ Trigger* new_Trigger_from_string(Streader* sr, const Event_names* names)
         return NULL;
     }
 
+    if (!Trigger_compile_arg(trigger, names, sr))
+    {
+        del_Trigger(trigger);
+        return NULL;
+    }
+
     return trigger;
 }
 
@@ -272,6 +363,12 @@ Trigger* new_Trigger_of_name_spec_from_string(Streader* sr, const Event_names* n
 
     strcpy(trigger->desc, event_desc);
 
+    if (!Trigger_compile_arg(trigger, names, sr))
+    {
+        del_Trigger(trigger);
+        return NULL;
+    }
+
     return trigger;
 }
 
@@ -303,6 +400,7 @@ void del_Trigger(Trigger* trigger)
         return;
 
     rassert(Event_is_valid(trigger->type));
+    del_Compiled_expr(trigger->arg_expr);
     memory_free(trigger->desc);
     memory_free(trigger);
 
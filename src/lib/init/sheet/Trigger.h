@@ -16,11 +16,13 @@
 #define KQT_TRIGGER_H
 
 
+#include <expr.h>
 #include <kunquat/limits.h>
 #include <mathnum/Tstamp.h>
 #include <player/Event_names.h>
 #include <player/Event_type.h>
 #include <string/Streader.h>
+#include <Value.h>
 
 #include <stdbool.h>
 #include <stdlib.h>
@@ -28,6 +30,10 @@
 
 /**
  * Trigger causes firing of an event at a specified location.
+ *
+ * The event name and argument are resolved when the Trigger is loaded. If the
+ * argument could not be compiled, \a has_literal_arg is \c false and
+ * \a arg_expr is \c NULL, and the caller should interpret \a desc instead.
  */
 typedef struct Trigger
 {
@@ -35,6 +41,11 @@ typedef struct Trigger
     int ch_index;       ///< Channel number.
     Event_type type;    ///< The event type.
     char* desc;         ///< Trigger description in JSON format.
+    char event_name[KQT_EVENT_NAME_MAX + 1]; ///< The event name.
+    Value_type arg_type;        ///< The parameter type of the event.
+    bool has_literal_arg;       ///< Whether \a literal_arg is used.
+    Value literal_arg;          ///< The argument that needs no evaluation.
+    Compiled_expr* arg_expr;    ///< The compiled argument expression, or \c NULL.
 } Trigger;
 
 
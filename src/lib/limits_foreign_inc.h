@@ -23,8 +23,10 @@
 
 KQT_LIMIT_INT(HANDLES_MAX)
 KQT_LIMIT_INT(KEY_LENGTH_MAX)
+KQT_LIMIT_INT(STEMS_MAX)
 KQT_LIMIT_INT(AUDIO_BUFFER_SIZE_MAX)
 KQT_LIMIT_INT(THREADS_MAX)
+KQT_LIMIT_INT(THREAD_POOL_SIZE_MAX)
 KQT_LIMIT_INT(CALC_DURATION_MAX)
 KQT_LIMIT_INT(VOICES_MAX)
 KQT_LIMIT_INT(SONGS_MAX)
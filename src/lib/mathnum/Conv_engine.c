@@ -0,0 +1,310 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <mathnum/Conv_engine.h>
+
+#include <debug/assert.h>
+#include <mathnum/common.h>
+#include <mathnum/fft.h>
+#include <memory.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+struct Conv_engine
+{
+    int32_t part_size;
+    int32_t fft_size;
+    int32_t part_count;
+
+    FFT_worker fft_worker;
+
+    // Spectra of the impulse response partitions, scaled for the inverse FFT
+    float* ir_spectra;
+
+    // Frequency-domain delay line of input spectra, newest at input_pos
+    float* input_spectra;
+    int32_t input_pos;
+
+    float* in_block;
+    float* out_block;
+    float* accum;
+    int32_t block_pos;
+};
+
+
+Conv_engine* new_Conv_engine(int32_t part_size)
+{
+    rassert(part_size >= CONV_ENGINE_PART_SIZE_MIN);
+    rassert(part_size <= CONV_ENGINE_PART_SIZE_MAX);
+    rassert((part_size & (part_size - 1)) == 0);
+
+    Conv_engine* engine = memory_alloc_item(Conv_engine);
+    if (engine == NULL)
+        return NULL;
+
+    engine->part_size = part_size;
+    engine->fft_size = part_size * 2;
+    engine->part_count = 0;
+    engine->fft_worker = *FFT_WORKER_AUTO;
+    engine->ir_spectra = NULL;
+    engine->input_spectra = NULL;
+    engine->input_pos = 0;
+    engine->in_block = NULL;
+    engine->out_block = NULL;
+    engine->accum = NULL;
+    engine->block_pos = 0;
+
+    engine->in_block = memory_calloc_items(float, engine->fft_size);
+    engine->out_block = memory_calloc_items(float, engine->part_size);
+    engine->accum = memory_calloc_items(float, engine->fft_size);
+    if ((engine->in_block == NULL) ||
+            (engine->out_block == NULL) ||
+            (engine->accum == NULL) ||
+            (FFT_worker_init(&engine->fft_worker, engine->fft_size) == NULL))
+    {
+        del_Conv_engine(engine);
+        return NULL;
+    }
+
+    return engine;
+}
+
+
+int32_t Conv_engine_get_part_size(const Conv_engine* engine)
+{
+    rassert(engine != NULL);
+    return engine->part_size;
+}
+
+
+bool Conv_engine_set_ir(Conv_engine* engine, const float* ir, int32_t length)
+{
+    rassert(engine != NULL);
+    rassert(implies(length > 0, ir != NULL));
+    rassert(length >= 0);
+    rassert(length <= CONV_ENGINE_IR_LENGTH_MAX);
+
+    engine->part_count = 0;
+    memory_free(engine->ir_spectra);
+    engine->ir_spectra = NULL;
+    memory_free(engine->input_spectra);
+    engine->input_spectra = NULL;
+
+    Conv_engine_reset(engine);
+
+    if (length == 0)
+        return true;
+
+    const int32_t part_size = engine->part_size;
+    const int32_t fft_size = engine->fft_size;
+    const int32_t part_count = (length + part_size - 1) / part_size;
+
+    float* ir_spectra = memory_calloc_items(float, part_count * fft_size);
+    float* input_spectra = memory_calloc_items(float, part_count * fft_size);
+    if ((ir_spectra == NULL) || (input_spectra == NULL))
+    {
+        memory_free(ir_spectra);
+        memory_free(input_spectra);
+        return false;
+    }
+
+    const float scale = 1.0f / (float)fft_size;
+
+    for (int32_t part = 0; part < part_count; ++part)
+    {
+        float* spectrum = ir_spectra + (part * fft_size);
+
+        const int32_t ir_start = part * part_size;
+        const int32_t ir_count = min(part_size, length - ir_start);
+        for (int32_t i = 0; i < ir_count; ++i)
+            spectrum[i] = ir[ir_start + i] * scale;
+
+        FFT_worker_rfft(&engine->fft_worker, spectrum, fft_size);
+    }
+
+    engine->ir_spectra = ir_spectra;
+    engine->input_spectra = input_spectra;
+    engine->part_count = part_count;
+
+    return true;
+}
+
+
+static void multiply_add_spectrum(
+        float* restrict accum,
+        const float* restrict x,
+        const float* restrict h,
+        int32_t fft_size)
+{
+    rassert(accum != NULL);
+    rassert(x != NULL);
+    rassert(h != NULL);
+    rassert(fft_size >= 2);
+
+    // The DC and Nyquist components are real
+    accum[0] += x[0] * h[0];
+    accum[fft_size - 1] += x[fft_size - 1] * h[fft_size - 1];
+
+    for (int32_t i = 1; i < fft_size - 1; i += 2)
+    {
+        const float x_re = x[i];
+        const float x_im = x[i + 1];
+        const float h_re = h[i];
+        const float h_im = h[i + 1];
+
+        accum[i] += x_re * h_re - x_im * h_im;
+        accum[i + 1] += x_re * h_im + x_im * h_re;
+    }
+
+    return;
+}
+
+
+static void Conv_engine_process_block(Conv_engine* engine)
+{
+    rassert(engine != NULL);
+    rassert(engine->part_count > 0);
+
+    const int32_t part_size = engine->part_size;
+    const int32_t fft_size = engine->fft_size;
+    const int32_t part_count = engine->part_count;
+
+    // Add the spectrum of the two latest input blocks to the delay line
+    engine->input_pos = (engine->input_pos + 1) % part_count;
+    float* new_spectrum = engine->input_spectra + (engine->input_pos * fft_size);
+    memcpy(new_spectrum, engine->in_block, sizeof(float) * (size_t)fft_size);
+    FFT_worker_rfft(&engine->fft_worker, new_spectrum, fft_size);
+
+    memmove(engine->in_block,
+            engine->in_block + part_size,
+            sizeof(float) * (size_t)part_size);
+
+    // Convolve each input spectrum with the matching impulse response partition
+    float* accum = engine->accum;
+    for (int32_t i = 0; i < fft_size; ++i)
+        accum[i] = 0;
+
+    for (int32_t part = 0; part < part_count; ++part)
+    {
+        const int32_t input_index =
+            (engine->input_pos + part_count - part) % part_count;
+
+        multiply_add_spectrum(
+                accum,
+                engine->input_spectra + (input_index * fft_size),
+                engine->ir_spectra + (part * fft_size),
+                fft_size);
+    }
+
+    FFT_worker_irfft(&engine->fft_worker, accum, fft_size);
+
+    // The first half contains the circular wrap-around, so we only keep the last
+    memcpy(engine->out_block, accum + part_size, sizeof(float) * (size_t)part_size);
+
+    return;
+}
+
+
+void Conv_engine_process(
+        Conv_engine* engine, const float* in, float* out, int32_t count)
+{
+    rassert(engine != NULL);
+    rassert(in != NULL);
+    rassert(out != NULL);
+    rassert(count >= 0);
+
+    if (engine->part_count == 0)
+    {
+        for (int32_t i = 0; i < count; ++i)
+            out[i] = 0;
+        return;
+    }
+
+    const int32_t part_size = engine->part_size;
+
+    int32_t done = 0;
+    while (done < count)
+    {
+        const int32_t chunk_size = min(count - done, part_size - engine->block_pos);
+
+        float* in_dest = engine->in_block + part_size + engine->block_pos;
+        const float* out_src = engine->out_block + engine->block_pos;
+
+        // Input is read before output is written as the buffers may be shared
+        for (int32_t i = 0; i < chunk_size; ++i)
+        {
+            in_dest[i] = in[done + i];
+            out[done + i] = out_src[i];
+        }
+
+        done += chunk_size;
+        engine->block_pos += chunk_size;
+
+        if (engine->block_pos == part_size)
+        {
+            Conv_engine_process_block(engine);
+            engine->block_pos = 0;
+        }
+    }
+
+    return;
+}
+
+
+void Conv_engine_reset(Conv_engine* engine)
+{
+    rassert(engine != NULL);
+
+    for (int32_t i = 0; i < engine->fft_size; ++i)
+        engine->in_block[i] = 0;
+
+    for (int32_t i = 0; i < engine->part_size; ++i)
+        engine->out_block[i] = 0;
+
+    if (engine->input_spectra != NULL)
+    {
+        const int32_t total_size = engine->part_count * engine->fft_size;
+        for (int32_t i = 0; i < total_size; ++i)
+            engine->input_spectra[i] = 0;
+    }
+
+    engine->input_pos = 0;
+    engine->block_pos = 0;
+
+    return;
+}
+
+
+void del_Conv_engine(Conv_engine* engine)
+{
+    if (engine == NULL)
+        return;
+
+    FFT_worker_deinit(&engine->fft_worker);
+
+    memory_free(engine->ir_spectra);
+    memory_free(engine->input_spectra);
+    memory_free(engine->in_block);
+    memory_free(engine->out_block);
+    memory_free(engine->accum);
+    memory_free(engine);
+
+    return;
+}
+
+
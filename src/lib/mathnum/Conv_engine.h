@@ -0,0 +1,108 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#ifndef KQT_CONV_ENGINE_H
+#define KQT_CONV_ENGINE_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+#define CONV_ENGINE_PART_SIZE_MIN 16
+#define CONV_ENGINE_PART_SIZE_MAX 16384
+#define CONV_ENGINE_IR_LENGTH_MAX 1048576
+
+
+/**
+ * Conv_engine convolves a signal with a long impulse response using uniformly
+ * partitioned FFT convolution. The output is delayed by one partition.
+ */
+typedef struct Conv_engine Conv_engine;
+
+
+/**
+ * Create a new Convolution engine.
+ *
+ * \param part_size   The partition size -- must be a power of two >=
+ *                    \c CONV_ENGINE_PART_SIZE_MIN and <=
+ *                    \c CONV_ENGINE_PART_SIZE_MAX.
+ *
+ * \return   The new Convolution engine if successful, or \c NULL if memory
+ *           allocation failed.
+ */
+Conv_engine* new_Conv_engine(int32_t part_size);
+
+
+/**
+ * Get the partition size of the Convolution engine.
+ *
+ * \param engine   The Convolution engine -- must not be \c NULL.
+ *
+ * \return   The partition size, which is also the latency of the engine.
+ */
+int32_t Conv_engine_get_part_size(const Conv_engine* engine);
+
+
+/**
+ * Set the impulse response of the Convolution engine.
+ *
+ * This function also clears the signal history.
+ *
+ * \param engine   The Convolution engine -- must not be \c NULL.
+ * \param ir       The impulse response -- must not be \c NULL if
+ *                 \a length > \c 0.
+ * \param length   The length of the impulse response -- must be >= \c 0 and
+ *                 <= \c CONV_ENGINE_IR_LENGTH_MAX. If \c 0, the engine
+ *                 produces silence.
+ *
+ * \return   \c true if successful, or \c false if memory allocation failed.
+ *           The engine produces silence after a failure.
+ */
+bool Conv_engine_set_ir(Conv_engine* engine, const float* ir, int32_t length);
+
+
+/**
+ * Process a signal with the Convolution engine.
+ *
+ * \param engine   The Convolution engine -- must not be \c NULL.
+ * \param in       The input signal -- must not be \c NULL.
+ * \param out      The output buffer -- must not be \c NULL. This may be the
+ *                 same buffer as \a in.
+ * \param count    The number of frames to process -- must be >= \c 0.
+ */
+void Conv_engine_process(
+        Conv_engine* engine, const float* in, float* out, int32_t count);
+
+
+/**
+ * Clear the signal history of the Convolution engine.
+ *
+ * \param engine   The Convolution engine -- must not be \c NULL.
+ */
+void Conv_engine_reset(Conv_engine* engine);
+
+
+/**
+ * Destroy an existing Convolution engine.
+ *
+ * \param engine   The Convolution engine, or \c NULL.
+ */
+void del_Conv_engine(Conv_engine* engine);
+
+
+#endif // KQT_CONV_ENGINE_H
+
+
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2016
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -27,6 +27,14 @@
 #define DOUBLE_LIMIT ((int64_t)1 << DBL_MANT_DIG)
 
 
+// multiplier and increment from Knuth
+#define LCG_MUL 6364136223846793005ULL
+#define LCG_INC 1442695040888963407ULL
+
+
+#define LANE_COUNT 8
+
+
 Random* Random_init(Random* random, const char* context)
 {
     rassert(random != NULL);
@@ -67,9 +75,7 @@ uint64_t Random_get_uint64(Random* random)
 {
     rassert(random != NULL);
 
-    // multiplier and increment from Knuth
-    random->state = 6364136223846793005ULL * random->state +
-                    1442695040888963407ULL;
+    random->state = LCG_MUL * random->state + LCG_INC;
 
     return random->state;
 }
@@ -108,14 +114,12 @@ double Random_get_float_scale(Random* random)
 }
 
 
-double Random_get_float_signal(Random* random)
+static double get_signal_from_state(uint64_t state)
 {
-    rassert(random != NULL);
-
     static const int64_t max_val_abs = (DOUBLE_LIMIT >> 1) - 1;
 
     // Get random value in range [-max_val_abs, max_val_abs]
-    int64_t bits = (int64_t)(Random_get_uint64(random) >> EXCESS_DOUBLE_BITS);
+    int64_t bits = (int64_t)(state >> EXCESS_DOUBLE_BITS);
     bits &= ~(int64_t)1;
     bits -= max_val_abs;
 
@@ -123,3 +127,112 @@ double Random_get_float_signal(Random* random)
 }
 
 
+double Random_get_float_signal(Random* random)
+{
+    rassert(random != NULL);
+    return get_signal_from_state(Random_get_uint64(random));
+}
+
+
+// Get the step that advances the state by LANE_COUNT values at once
+static void get_lane_step(uint64_t* lane_mul, uint64_t* lane_inc)
+{
+    rassert(lane_mul != NULL);
+    rassert(lane_inc != NULL);
+
+    *lane_mul = 1;
+    *lane_inc = 0;
+    for (int k = 0; k < LANE_COUNT; ++k)
+    {
+        *lane_mul *= LCG_MUL;
+        *lane_inc = LCG_MUL * *lane_inc + LCG_INC;
+    }
+
+    return;
+}
+
+
+void Random_fill_float_signal(Random* random, float* dest, int32_t count)
+{
+    rassert(random != NULL);
+    rassert(dest != NULL);
+    rassert(count >= 0);
+
+    int32_t i = 0;
+
+    if (count >= LANE_COUNT)
+    {
+        uint64_t lane_mul = 1;
+        uint64_t lane_inc = 0;
+        get_lane_step(&lane_mul, &lane_inc);
+
+        uint64_t lanes[LANE_COUNT];
+        for (int k = 0; k < LANE_COUNT; ++k)
+            lanes[k] = Random_get_uint64(random);
+
+        const int32_t lanes_stop = count - (count % LANE_COUNT);
+        for (;;)
+        {
+            for (int k = 0; k < LANE_COUNT; ++k)
+                dest[i + k] = (float)get_signal_from_state(lanes[k]);
+
+            i += LANE_COUNT;
+            if (i >= lanes_stop)
+                break;
+
+            for (int k = 0; k < LANE_COUNT; ++k)
+                lanes[k] = lane_mul * lanes[k] + lane_inc;
+        }
+
+        random->state = lanes[LANE_COUNT - 1];
+    }
+
+    for (; i < count; ++i)
+        dest[i] = (float)Random_get_float_signal(random);
+
+    return;
+}
+
+
+void Random_fill_double_signal(Random* random, double* dest, int32_t count)
+{
+    rassert(random != NULL);
+    rassert(dest != NULL);
+    rassert(count >= 0);
+
+    int32_t i = 0;
+
+    if (count >= LANE_COUNT)
+    {
+        uint64_t lane_mul = 1;
+        uint64_t lane_inc = 0;
+        get_lane_step(&lane_mul, &lane_inc);
+
+        uint64_t lanes[LANE_COUNT];
+        for (int k = 0; k < LANE_COUNT; ++k)
+            lanes[k] = Random_get_uint64(random);
+
+        const int32_t lanes_stop = count - (count % LANE_COUNT);
+        for (;;)
+        {
+            for (int k = 0; k < LANE_COUNT; ++k)
+                dest[i + k] = get_signal_from_state(lanes[k]);
+
+            i += LANE_COUNT;
+            if (i >= lanes_stop)
+                break;
+
+            for (int k = 0; k < LANE_COUNT; ++k)
+                lanes[k] = lane_mul * lanes[k] + lane_inc;
+        }
+
+        random->state = lanes[LANE_COUNT - 1];
+    }
+
+    for (; i < count; ++i)
+        dest[i] = Random_get_float_signal(random);
+
+    return;
+}
+
+
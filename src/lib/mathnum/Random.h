@@ -154,6 +154,33 @@ double Random_get_float_scale(Random* random);
 double Random_get_float_signal(Random* random);
 
 
+/**
+ * Fill a buffer with floating point numbers in the range [-1.0, 1.0].
+ *
+ * The generated sequence is identical to that of calling
+ * \a Random_get_float_signal \a count times, but the values are produced
+ * in several interleaved lanes that the compiler can vectorise.
+ *
+ * \param random   The Random generator -- must not be \c NULL.
+ * \param dest     The destination buffer -- must not be \c NULL.
+ * \param count    The number of values to generate -- must be >= \c 0.
+ */
+void Random_fill_float_signal(Random* random, float* dest, int32_t count);
+
+
+/**
+ * Fill a buffer with double precision numbers in the range [-1.0, 1.0].
+ *
+ * Same as \a Random_fill_float_signal but without rounding the values to
+ * single precision.
+ *
+ * \param random   The Random generator -- must not be \c NULL.
+ * \param dest     The destination buffer -- must not be \c NULL.
+ * \param count    The number of values to generate -- must be >= \c 0.
+ */
+void Random_fill_double_signal(Random* random, double* dest, int32_t count);
+
+
 #endif // KQT_RANDOM_H
 
 
@@ -0,0 +1,58 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <mathnum/denormals.h>
+
+#include <common.h>
+#include <intrinsics.h>
+
+
+#if defined(KQT_SSE) && defined(__x86_64__)
+// MXCSR bit that treats denormal inputs as zero, not declared in <xmmintrin.h>
+#define DENORMALS_ZERO_ON 0x0040u
+#endif
+
+
+unsigned int denormals_flush_enable(void)
+{
+#ifdef KQT_SSE
+    const unsigned int old_state = _mm_getcsr();
+    unsigned int new_state = old_state | _MM_FLUSH_ZERO_ON;
+#ifdef DENORMALS_ZERO_ON
+    // DAZ is supported by all x86-64 processors but not by some older ones
+    new_state |= DENORMALS_ZERO_ON;
+#endif
+    if (new_state != old_state)
+        _mm_setcsr(new_state);
+
+    return old_state;
+#else
+    return 0;
+#endif
+}
+
+
+void denormals_flush_restore(unsigned int state)
+{
+#ifdef KQT_SSE
+    if (_mm_getcsr() != state)
+        _mm_setcsr(state);
+#else
+    ignore(state);
+#endif
+
+    return;
+}
+
+
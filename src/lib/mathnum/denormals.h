@@ -0,0 +1,40 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#ifndef KQT_DENORMALS_H
+#define KQT_DENORMALS_H
+
+
+/**
+ * Enable flushing of denormal values to zero in the calling thread.
+ *
+ * With SSE, both the results (FTZ) and the inputs (DAZ) of floating-point
+ * operations are flushed. On other platforms this function has no effect.
+ *
+ * \return   The previous floating-point control state of the calling thread.
+ */
+unsigned int denormals_flush_enable(void);
+
+
+/**
+ * Restore the floating-point control state of the calling thread.
+ *
+ * \param state   The state returned by \a denormals_flush_enable.
+ */
+void denormals_flush_restore(unsigned int state);
+
+
+#endif // KQT_DENORMALS_H
+
+
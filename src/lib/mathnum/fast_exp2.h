@@ -2,7 +2,7 @@
 
 /*
  * Authors: Ossi Saresoja, Finland 2016
- *          Tomi Jylhä-Ollila, Finland 2016
+ *          Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -67,6 +67,40 @@ static inline double fast_exp2(double x)
 }
 
 
+/**
+ * Calculate a fast approximation of base-2 exponential function in single
+ * precision.
+ *
+ * Unlike \a fast_exp2, this function does not call any library functions and
+ * can therefore be vectorised when used inside a loop. The input is clamped
+ * to the range [-126, 126] so that the result is always a normal number.
+ *
+ * \param x   The input value -- must be finite.
+ *
+ * \return   Roughly 2 ^ \a x.
+ */
+static inline float fast_exp2f(float x)
+{
+    dassert(isfinite(x));
+
+    x = (x < -126.0f) ? -126.0f : x;
+    x = (x > 126.0f) ? 126.0f : x;
+
+    // Split x into an integer part and a fraction in range [-0.5, 0.5)
+    const float rx = x + 0.5f;
+    int32_t i = (int32_t)rx;
+    i -= (rx < (float)i) ? 1 : 0;
+    const float f = x - (float)i;
+
+    const float p = 1.0f + f * (0.6931471806f + f * (0.2402265070f +
+            f * (0.0555041087f + f * (0.0096181291f + f * 0.0013333558f))));
+
+    union { uint32_t u; float f; } bits = { (uint32_t)(i + 127) << 23 };
+
+    return p * bits.f;
+}
+
+
 #endif // KQT_FAST_EXP2_H
 
 
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -19,6 +19,8 @@
 #include <debug/assert.h>
 
 #include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 
 /**
@@ -53,6 +55,40 @@ static inline double fast_log2(double x)
 }
 
 
+/**
+ * Calculate a fast approximation of base-2 logarithm function in single precision.
+ *
+ * Unlike \a fast_log2, this function does not call any library functions and
+ * can therefore be vectorised when used inside a loop.
+ *
+ * \param x   The input value -- must be finite, normal and > \c 0.
+ *
+ * \return   Roughly log2(\a x).
+ */
+static inline float fast_log2f(float x)
+{
+    dassert(isfinite(x));
+    dassert(x > 0);
+
+    union { float f; uint32_t u; } bits = { x };
+
+    // Shift x to range [sqrt(1/2), sqrt(2))
+    int32_t exp = (int32_t)((bits.u >> 23) & 0xff) - 127;
+    bits.u = (bits.u & 0x007fffff) | 0x3f800000;
+    const bool is_high = (bits.f > 1.41421356f);
+    const float sx = is_high ? bits.f * 0.5f : bits.f;
+    exp += is_high ? 1 : 0;
+
+    const float sxmp1 = (sx - 1) / (sx + 1);
+    const float sxmp1_2 = sxmp1 * sxmp1;
+
+    const float l2sx = sxmp1 * (2.8853900817779268f + sxmp1_2 *
+            (0.9617966939259756f + (0.5770780163555854f * sxmp1_2)));
+
+    return l2sx + (float)exp;
+}
+
+
 #endif // KQT_FAST_LOG2_H
 
 
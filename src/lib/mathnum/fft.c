@@ -4,7 +4,7 @@
  * This is a modified version of the FFTPACK C implementation released
  * to the public domain, source: http://www.netlib.org/fftpack/fft.c
  *
- * Modifications for Kunquat by Tomi Jylhä-Ollila, Finland 2016
+ * Modifications for Kunquat by Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
  *
@@ -18,10 +18,13 @@
 #include <debug/assert.h>
 #include <mathnum/common.h>
 #include <memory.h>
+#include <threads/Mutex.h>
 
 #include <math.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 static void drfti1(int32_t n, float* wa, int32_t* ifac);
@@ -29,6 +32,284 @@ static void drftf1(int32_t n, float* c, float* ch, float* wa, const int32_t* ifa
 static void drftb1(int32_t n, float* c, float* ch, const float* wa, const int32_t* ifac);
 
 
+// Power-of-two lengths starting from this are transformed with split kernels
+#define FFT_SPLIT_LENGTH_MIN 16
+
+// Number of complex values processed together in the early split stages
+#define FFT_SPLIT_BLOCK_SIZE 4096
+
+#define FFT_PLAN_CACHE_SIZE 8
+
+
+struct FFT_plan
+{
+    int32_t length;
+    int ref_count;
+    bool is_cached;
+    uint64_t last_use;
+    int32_t ifac[32];
+
+    // FFTPACK twiddle factors, or NULL if split kernels are used
+    float* wa;
+
+    // Split kernel data, contents are split into real and imaginary halves
+    int32_t* perm;
+    float* stage_tw;
+    float* post_tw;
+};
+
+
+// Cached plans are only freed when evicted by another plan, so at most
+// FFT_PLAN_CACHE_SIZE plans remain allocated until the process exits
+static Mutex plan_cache_lock = MUTEX_STATIC_INIT;
+static FFT_plan* plan_cache[FFT_PLAN_CACHE_SIZE] = { NULL };
+static uint64_t plan_cache_use_count = 0;
+
+
+static bool is_split_length(int32_t length)
+{
+    rassert(length > 0);
+    return (length >= FFT_SPLIT_LENGTH_MIN) && ((length & (length - 1)) == 0);
+}
+
+
+static void del_FFT_plan(FFT_plan* plan)
+{
+    if (plan == NULL)
+        return;
+
+    memory_free(plan->wa);
+    memory_free(plan->perm);
+    memory_free(plan->stage_tw);
+    memory_free(plan->post_tw);
+    memory_free(plan);
+
+    return;
+}
+
+
+static bool FFT_plan_init_split(FFT_plan* plan)
+{
+    rassert(plan != NULL);
+
+    const int32_t half_length = plan->length / 2;
+
+    plan->perm = memory_alloc_items(int32_t, half_length);
+    plan->stage_tw = memory_alloc_items(float, half_length * 2);
+    plan->post_tw = memory_alloc_items(float, (half_length / 2 + 1) * 2);
+    if ((plan->perm == NULL) || (plan->stage_tw == NULL) || (plan->post_tw == NULL))
+        return false;
+
+    // Bit-reversal permutation of the complex input
+    plan->perm[0] = 0;
+    for (int32_t i = 1, rev = 0; i < half_length; ++i)
+    {
+        int32_t bit = half_length >> 1;
+        while ((rev & bit) != 0)
+        {
+            rev ^= bit;
+            bit >>= 1;
+        }
+        rev |= bit;
+        plan->perm[i] = rev;
+    }
+
+    // Twiddle factors of each radix-2 stage, stored at offset of the stage half
+    // size; the smaller stages use a subset of the factors of the last stage
+    float* stage_tw_re = plan->stage_tw;
+    float* stage_tw_im = plan->stage_tw + half_length;
+    stage_tw_re[0] = 1;
+    stage_tw_im[0] = 0;
+
+    const int32_t last_half_size = half_length / 2;
+    for (int32_t i = 0; i < last_half_size; ++i)
+    {
+        const double angle = PI * (double)i / (double)last_half_size;
+        stage_tw_re[last_half_size + i] = (float)cos(angle);
+        stage_tw_im[last_half_size + i] = (float)-sin(angle);
+    }
+
+    for (int32_t half_size = last_half_size / 2; half_size >= 1; half_size /= 2)
+    {
+        const int32_t stride = last_half_size / half_size;
+        for (int32_t i = 0; i < half_size; ++i)
+        {
+            stage_tw_re[half_size + i] = stage_tw_re[last_half_size + i * stride];
+            stage_tw_im[half_size + i] = stage_tw_im[last_half_size + i * stride];
+        }
+    }
+
+    // Twiddle factors for separating the real spectrum from the complex one
+    const int32_t post_count = half_length / 2 + 1;
+    float* post_tw_re = plan->post_tw;
+    float* post_tw_im = plan->post_tw + post_count;
+    for (int32_t i = 0; i < post_count; ++i)
+    {
+        const double angle = PI2 * (double)i / (double)plan->length;
+        post_tw_re[i] = (float)cos(angle);
+        post_tw_im[i] = (float)-sin(angle);
+    }
+
+    return true;
+}
+
+
+static FFT_plan* new_FFT_plan(int32_t length)
+{
+    rassert(length > 0);
+
+    FFT_plan* plan = memory_alloc_item(FFT_plan);
+    if (plan == NULL)
+        return NULL;
+
+    plan->length = length;
+    plan->ref_count = 0;
+    plan->is_cached = false;
+    plan->last_use = 0;
+    for (int i = 0; i < 32; ++i)
+        plan->ifac[i] = 0;
+    plan->wa = NULL;
+    plan->perm = NULL;
+    plan->stage_tw = NULL;
+    plan->post_tw = NULL;
+
+    if (is_split_length(length))
+    {
+        // We only need the factorisation from FFTPACK
+        drfti1(length, NULL, plan->ifac);
+
+        if (!FFT_plan_init_split(plan))
+        {
+            del_FFT_plan(plan);
+            return NULL;
+        }
+
+        return plan;
+    }
+
+    plan->wa = memory_calloc_items(float, length);
+    if (plan->wa == NULL)
+    {
+        del_FFT_plan(plan);
+        return NULL;
+    }
+
+    if (length > 1)
+        drfti1(length, plan->wa, plan->ifac);
+
+    return plan;
+}
+
+
+static FFT_plan* find_cached_plan(int32_t length)
+{
+    rassert(length > 0);
+
+    for (int i = 0; i < FFT_PLAN_CACHE_SIZE; ++i)
+    {
+        FFT_plan* plan = plan_cache[i];
+        if ((plan != NULL) && (plan->length == length))
+            return plan;
+    }
+
+    return NULL;
+}
+
+
+static void add_plan_to_cache(FFT_plan* plan)
+{
+    rassert(plan != NULL);
+
+    // Find an empty slot or the least recently used unreferenced plan
+    int slot = -1;
+    for (int i = 0; i < FFT_PLAN_CACHE_SIZE; ++i)
+    {
+        const FFT_plan* cur_plan = plan_cache[i];
+        if (cur_plan == NULL)
+        {
+            slot = i;
+            break;
+        }
+
+        if ((cur_plan->ref_count == 0) &&
+                ((slot < 0) || (cur_plan->last_use < plan_cache[slot]->last_use)))
+            slot = i;
+    }
+
+    if (slot < 0)
+        return;
+
+    del_FFT_plan(plan_cache[slot]);
+    plan_cache[slot] = plan;
+    plan->is_cached = true;
+
+    return;
+}
+
+
+static FFT_plan* acquire_FFT_plan(int32_t length)
+{
+    rassert(length > 0);
+
+    Mutex_lock(&plan_cache_lock);
+    FFT_plan* plan = find_cached_plan(length);
+    if (plan != NULL)
+    {
+        ++plan->ref_count;
+        plan->last_use = ++plan_cache_use_count;
+        Mutex_unlock(&plan_cache_lock);
+        return plan;
+    }
+    Mutex_unlock(&plan_cache_lock);
+
+    // Build the plan without holding the lock as this may take a while
+    FFT_plan* new_plan = new_FFT_plan(length);
+    if (new_plan == NULL)
+        return NULL;
+
+    Mutex_lock(&plan_cache_lock);
+
+    // Another thread may have added the same plan in the meantime
+    plan = find_cached_plan(length);
+    if (plan != NULL)
+    {
+        del_FFT_plan(new_plan);
+    }
+    else
+    {
+        plan = new_plan;
+        add_plan_to_cache(plan);
+    }
+
+    ++plan->ref_count;
+    plan->last_use = ++plan_cache_use_count;
+
+    Mutex_unlock(&plan_cache_lock);
+
+    return plan;
+}
+
+
+static void release_FFT_plan(FFT_plan* plan)
+{
+    if (plan == NULL)
+        return;
+
+    Mutex_lock(&plan_cache_lock);
+
+    rassert(plan->ref_count > 0);
+    --plan->ref_count;
+    const bool is_unused = (plan->ref_count == 0) && !plan->is_cached;
+
+    Mutex_unlock(&plan_cache_lock);
+
+    if (is_unused)
+        del_FFT_plan(plan);
+
+    return;
+}
+
+
 FFT_worker* FFT_worker_init(FFT_worker* worker, int32_t max_tlength)
 {
     rassert(worker != NULL);
@@ -40,6 +321,7 @@ FFT_worker* FFT_worker_init(FFT_worker* worker, int32_t max_tlength)
 
     worker->max_length = max_tlength;
     worker->cur_length = 0;
+    worker->plan = NULL;
 
     for (int i = 0; i < 32; ++i)
         worker->ifac[0] = 0;
@@ -63,23 +345,398 @@ static void rfft_init(int32_t n, float* wsave, int32_t* ifac)
 }
 
 
-void FFT_worker_rfft(FFT_worker* worker, float* data, int32_t length)
+static void FFT_worker_set_length(FFT_worker* worker, int32_t length)
 {
     rassert(worker != NULL);
-    rassert(data != NULL);
     rassert(length > 0);
     rassert(length <= worker->max_length);
 
-    if (length != worker->cur_length)
+    if (length == worker->cur_length)
+        return;
+
+    release_FFT_plan(worker->plan);
+    worker->plan = acquire_FFT_plan(length);
+
+    if (worker->plan != NULL)
+    {
+        memcpy(worker->ifac, worker->plan->ifac, sizeof(worker->ifac));
+    }
+    else
     {
+        // Fall back to an uncached setup stored in the worker
         rfft_init(length, worker->wsave, worker->ifac);
-        worker->cur_length = length;
     }
 
+    worker->cur_length = length;
+
+    return;
+}
+
+
+/**
+ * Split kernels
+ *
+ * A real transform of length N is calculated as a complex transform of length
+ * N/2 where the even and odd samples form the real and imaginary parts. The
+ * complex data is processed in separate real and imaginary arrays so that
+ * the compiler can vectorise the butterfly loops. The inverse transform is
+ * calculated by swapping the real and imaginary arrays.
+ *
+ * The work area of the FFT worker is used for the transform data and, in the
+ * inverse transform, for the complex spectrum before the bit-reversal.
+ */
+
+
+static void fft_split_pass_first(
+        int32_t count, float* restrict re, float* restrict im)
+{
+    rassert(count >= 4);
+    rassert(re != NULL);
+    rassert(im != NULL);
+
+    // Two radix-2 stages with trivial twiddle factors
+    for (int32_t i = 0; i < count; i += 4)
+    {
+        const float a0_re = re[i] + re[i + 1];
+        const float a0_im = im[i] + im[i + 1];
+        const float a1_re = re[i] - re[i + 1];
+        const float a1_im = im[i] - im[i + 1];
+        const float a2_re = re[i + 2] + re[i + 3];
+        const float a2_im = im[i + 2] + im[i + 3];
+        const float a3_re = re[i + 2] - re[i + 3];
+        const float a3_im = im[i + 2] - im[i + 3];
+
+        re[i] = a0_re + a2_re;
+        im[i] = a0_im + a2_im;
+        re[i + 2] = a0_re - a2_re;
+        im[i + 2] = a0_im - a2_im;
+        re[i + 1] = a1_re + a3_im;
+        im[i + 1] = a1_im - a3_re;
+        re[i + 3] = a1_re - a3_im;
+        im[i + 3] = a1_im + a3_re;
+    }
+
+    return;
+}
+
+
+static void fft_split_butterfly4(
+        int32_t half_size,
+        const float* restrict tw1_re,
+        const float* restrict tw1_im,
+        const float* restrict tw2_re,
+        const float* restrict tw2_im,
+        float* restrict re0,
+        float* restrict im0,
+        float* restrict re1,
+        float* restrict im1,
+        float* restrict re2,
+        float* restrict im2,
+        float* restrict re3,
+        float* restrict im3)
+{
+    for (int32_t i = 0; i < half_size; ++i)
+    {
+        const float w1_re = tw1_re[i];
+        const float w1_im = tw1_im[i];
+        const float w2a_re = tw2_re[i];
+        const float w2a_im = tw2_im[i];
+        const float w2b_re = tw2_re[i + half_size];
+        const float w2b_im = tw2_im[i + half_size];
+
+        const float t1_re = w1_re * re1[i] - w1_im * im1[i];
+        const float t1_im = w1_re * im1[i] + w1_im * re1[i];
+        const float t3_re = w1_re * re3[i] - w1_im * im3[i];
+        const float t3_im = w1_re * im3[i] + w1_im * re3[i];
+
+        const float a0_re = re0[i] + t1_re;
+        const float a0_im = im0[i] + t1_im;
+        const float a1_re = re0[i] - t1_re;
+        const float a1_im = im0[i] - t1_im;
+        const float a2_re = re2[i] + t3_re;
+        const float a2_im = im2[i] + t3_im;
+        const float a3_re = re2[i] - t3_re;
+        const float a3_im = im2[i] - t3_im;
+
+        const float u2_re = w2a_re * a2_re - w2a_im * a2_im;
+        const float u2_im = w2a_re * a2_im + w2a_im * a2_re;
+        const float u3_re = w2b_re * a3_re - w2b_im * a3_im;
+        const float u3_im = w2b_re * a3_im + w2b_im * a3_re;
+
+        re0[i] = a0_re + u2_re;
+        im0[i] = a0_im + u2_im;
+        re2[i] = a0_re - u2_re;
+        im2[i] = a0_im - u2_im;
+        re1[i] = a1_re + u3_re;
+        im1[i] = a1_im + u3_im;
+        re3[i] = a1_re - u3_re;
+        im3[i] = a1_im - u3_im;
+    }
+
+    return;
+}
+
+
+static void fft_split_pass4(
+        const FFT_plan* plan, int32_t half_size, int32_t count, float* re, float* im)
+{
+    rassert(plan != NULL);
+    rassert(half_size >= 1);
+    rassert(count >= half_size * 4);
+    rassert(re != NULL);
+    rassert(im != NULL);
+
+    const int32_t half_length = plan->length / 2;
+
+    const float* tw1_re = plan->stage_tw + half_size;
+    const float* tw1_im = plan->stage_tw + half_length + half_size;
+    const float* tw2_re = plan->stage_tw + half_size * 2;
+    const float* tw2_im = plan->stage_tw + half_length + half_size * 2;
+
+    // Two radix-2 stages of half sizes half_size and 2 * half_size
+    for (int32_t block = 0; block < count; block += half_size * 4)
+    {
+        float* re0 = re + block;
+        float* im0 = im + block;
+
+        fft_split_butterfly4(
+                half_size,
+                tw1_re,
+                tw1_im,
+                tw2_re,
+                tw2_im,
+                re0,
+                im0,
+                re0 + half_size,
+                im0 + half_size,
+                re0 + half_size * 2,
+                im0 + half_size * 2,
+                re0 + half_size * 3,
+                im0 + half_size * 3);
+    }
+
+    return;
+}
+
+
+static void fft_split_pass2(
+        const FFT_plan* plan,
+        int32_t half_size,
+        float* restrict re,
+        float* restrict im)
+{
+    rassert(plan != NULL);
+    rassert(half_size >= 1);
+    rassert(re != NULL);
+    rassert(im != NULL);
+
+    const int32_t half_length = plan->length / 2;
+
+    const float* tw_re = plan->stage_tw + half_size;
+    const float* tw_im = plan->stage_tw + half_length + half_size;
+
+    for (int32_t block = 0; block < half_length; block += half_size * 2)
+    {
+        float* restrict re0 = re + block;
+        float* restrict im0 = im + block;
+        float* restrict re1 = re0 + half_size;
+        float* restrict im1 = im0 + half_size;
+
+        for (int32_t i = 0; i < half_size; ++i)
+        {
+            const float t_re = tw_re[i] * re1[i] - tw_im[i] * im1[i];
+            const float t_im = tw_re[i] * im1[i] + tw_im[i] * re1[i];
+
+            re1[i] = re0[i] - t_re;
+            im1[i] = im0[i] - t_im;
+            re0[i] += t_re;
+            im0[i] += t_im;
+        }
+    }
+
+    return;
+}
+
+
+static void fft_split_transform(const FFT_plan* plan, float* re, float* im)
+{
+    rassert(plan != NULL);
+    rassert(re != NULL);
+    rassert(im != NULL);
+
+    const int32_t half_length = plan->length / 2;
+
+    // Perform the early stages one cache-sized block at a time
+    const int32_t block_size = min(half_length, (int32_t)FFT_SPLIT_BLOCK_SIZE);
+    int32_t half_size = 4;
+
+    for (int32_t block = 0; block < half_length; block += block_size)
+    {
+        float* block_re = re + block;
+        float* block_im = im + block;
+
+        fft_split_pass_first(block_size, block_re, block_im);
+
+        half_size = 4;
+        while (half_size * 4 <= block_size)
+        {
+            fft_split_pass4(plan, half_size, block_size, block_re, block_im);
+            half_size *= 4;
+        }
+    }
+
+    while (half_size * 4 <= half_length)
+    {
+        fft_split_pass4(plan, half_size, half_length, re, im);
+        half_size *= 4;
+    }
+
+    if (half_size < half_length)
+        fft_split_pass2(plan, half_size, re, im);
+
+    return;
+}
+
+
+static void rfft_split(const FFT_plan* plan, float* data, float* work)
+{
+    rassert(plan != NULL);
+    rassert(data != NULL);
+    rassert(work != NULL);
+
+    const int32_t length = plan->length;
+    const int32_t half_length = length / 2;
+    const int32_t post_count = half_length / 2 + 1;
+
+    float* re = work;
+    float* im = work + half_length;
+
+    // The bit-reversal permutation is its own inverse
+    for (int32_t i = 0; i < half_length; ++i)
+    {
+        const int32_t source = plan->perm[i];
+        re[i] = data[source * 2];
+        im[i] = data[source * 2 + 1];
+    }
+
+    fft_split_transform(plan, re, im);
+
+    // Separate the spectra of the even and odd samples and combine them
+    data[0] = re[0] + im[0];
+    data[length - 1] = re[0] - im[0];
+
+    const float* post_tw_re = plan->post_tw;
+    const float* post_tw_im = plan->post_tw + post_count;
+
+    for (int32_t k = 1; k < post_count; ++k)
+    {
+        const int32_t mk = half_length - k;
+
+        const float even_re = 0.5f * (re[k] + re[mk]);
+        const float even_im = 0.5f * (im[k] - im[mk]);
+        const float odd_re = 0.5f * (im[k] + im[mk]);
+        const float odd_im = -0.5f * (re[k] - re[mk]);
+
+        const float t_re = post_tw_re[k] * odd_re - post_tw_im[k] * odd_im;
+        const float t_im = post_tw_re[k] * odd_im + post_tw_im[k] * odd_re;
+
+        data[mk * 2 - 1] = even_re - t_re;
+        data[mk * 2] = t_im - even_im;
+        data[k * 2 - 1] = even_re + t_re;
+        data[k * 2] = even_im + t_im;
+    }
+
+    return;
+}
+
+
+static void irfft_split(const FFT_plan* plan, float* data, float* work)
+{
+    rassert(plan != NULL);
+    rassert(data != NULL);
+    rassert(work != NULL);
+
+    const int32_t length = plan->length;
+    const int32_t half_length = length / 2;
+    const int32_t post_count = half_length / 2 + 1;
+
+    // Rebuild the interleaved complex spectrum after the transform area
+    float* spec = work + length;
+
+    spec[0] = data[0] + data[length - 1];
+    spec[1] = data[0] - data[length - 1];
+
+    const float* post_tw_re = plan->post_tw;
+    const float* post_tw_im = plan->post_tw + post_count;
+
+    for (int32_t k = 1; k < post_count; ++k)
+    {
+        const int32_t mk = half_length - k;
+
+        const float xk_re = data[k * 2 - 1];
+        const float xk_im = data[k * 2];
+        const float xmk_re = data[mk * 2 - 1];
+        const float xmk_im = data[mk * 2];
+
+        const float sum_re = xk_re + xmk_re;
+        const float sum_im = xk_im - xmk_im;
+        const float diff_re = xk_re - xmk_re;
+        const float diff_im = xk_im + xmk_im;
+
+        // Rotate the difference by the conjugate twiddle factor
+        const float rot_re = post_tw_re[k] * diff_re + post_tw_im[k] * diff_im;
+        const float rot_im = post_tw_re[k] * diff_im - post_tw_im[k] * diff_re;
+
+        spec[mk * 2] = sum_re + rot_im;
+        spec[mk * 2 + 1] = rot_re - sum_im;
+        spec[k * 2] = sum_re - rot_im;
+        spec[k * 2 + 1] = sum_im + rot_re;
+    }
+
+    float* re = work;
+    float* im = work + half_length;
+
+    for (int32_t i = 0; i < half_length; ++i)
+    {
+        const int32_t source = plan->perm[i];
+        re[i] = spec[source * 2];
+        im[i] = spec[source * 2 + 1];
+    }
+
+    // Inverse transform by swapping the real and imaginary parts
+    fft_split_transform(plan, im, re);
+
+    for (int32_t i = 0; i < half_length; ++i)
+    {
+        data[i * 2] = re[i];
+        data[i * 2 + 1] = im[i];
+    }
+
+    return;
+}
+
+
+void FFT_worker_rfft(FFT_worker* worker, float* data, int32_t length)
+{
+    rassert(worker != NULL);
+    rassert(data != NULL);
+    rassert(length > 0);
+    rassert(length <= worker->max_length);
+
+    FFT_worker_set_length(worker, length);
+
     if (length == 1)
         return;
 
-    drftf1(length, data, worker->wsave, worker->wsave + length, worker->ifac);
+    const FFT_plan* plan = worker->plan;
+    if ((plan != NULL) && (plan->perm != NULL))
+    {
+        rfft_split(plan, data, worker->wsave);
+        return;
+    }
+
+    float* wa = (plan != NULL) ? plan->wa : worker->wsave + length;
+    drftf1(length, data, worker->wsave, wa, worker->ifac);
 
     return;
 }
@@ -92,16 +749,20 @@ void FFT_worker_irfft(FFT_worker* worker, float* data, int32_t length)
     rassert(length > 0);
     rassert(length <= worker->max_length);
 
-    if (length != worker->cur_length)
-    {
-        rfft_init(length, worker->wsave, worker->ifac);
-        worker->cur_length = length;
-    }
+    FFT_worker_set_length(worker, length);
 
     if (length == 1)
         return;
 
-    drftb1(length, data, worker->wsave, worker->wsave + length, worker->ifac);
+    const FFT_plan* plan = worker->plan;
+    if ((plan != NULL) && (plan->perm != NULL))
+    {
+        irfft_split(plan, data, worker->wsave);
+        return;
+    }
+
+    const float* wa = (plan != NULL) ? plan->wa : worker->wsave + length;
+    drftb1(length, data, worker->wsave, wa, worker->ifac);
 
     return;
 }
@@ -111,6 +772,10 @@ void FFT_worker_deinit(FFT_worker* worker)
 {
     rassert(worker != NULL);
 
+    release_FFT_plan(worker->plan);
+    worker->plan = NULL;
+    worker->cur_length = 0;
+
     memory_free(worker->wsave);
     worker->wsave = NULL;
 
@@ -160,7 +825,7 @@ static void drfti1(int32_t n, float* wa, int32_t* ifac)
     // Fill in complex roots of unity
     const int nfm1 = nf - 1;
 
-    if (nfm1 == 0)
+    if ((nfm1 == 0) || (wa == NULL))
         return;
 
     const float argh = (float)(PI2 / (double)n);
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -20,21 +20,35 @@
 #include <stdlib.h>
 
 
+/**
+ * An FFT plan contains the precalculated factors and twiddle coefficients for
+ * a single transform length. Plans are cached and shared between FFT workers.
+ * The cache is not freed at library teardown; a small number of plans remain
+ * allocated for the lifetime of the process.
+ */
+typedef struct FFT_plan FFT_plan;
+
+
 typedef struct FFT_worker
 {
     int32_t max_length;
     int32_t cur_length;
     float* wsave;
     int32_t ifac[32];
+    FFT_plan* plan;
 } FFT_worker;
 
 
-#define FFT_WORKER_AUTO (&(FFT_worker){ .max_length = 0, .cur_length = 0 })
+#define FFT_WORKER_AUTO \
+    (&(FFT_worker){ .max_length = 0, .cur_length = 0, .plan = NULL })
 
 
 /**
  * Initialise the FFT worker.
  *
+ * The worker may be used from one thread at a time. Workers in different
+ * threads may be used concurrently.
+ *
  * \param worker        The FFT worker -- must not be \c NULL.
  * \param max_tlength   Maximum length of Fourier Transform performed
  *                      -- must be positive.
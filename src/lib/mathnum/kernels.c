@@ -0,0 +1,391 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <mathnum/kernels.h>
+
+#include <debug/assert.h>
+#include <mathnum/common.h>
+#include <mathnum/fast_exp2.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+void kernel_fill(float* out, float value, int32_t count)
+{
+    rassert(out != NULL);
+    rassert(count >= 0);
+
+    for (int32_t i = 0; i < count; ++i)
+        out[i] = value;
+
+    return;
+}
+
+
+void kernel_scale(float* out, const float* in, float scale, int32_t count)
+{
+    rassert(out != NULL);
+    rassert(in != NULL);
+    rassert(count >= 0);
+
+    for (int32_t i = 0; i < count; ++i)
+        out[i] = in[i] * scale;
+
+    return;
+}
+
+
+void kernel_mul(float* out, const float* in1, const float* in2, int32_t count)
+{
+    rassert(out != NULL);
+    rassert(in1 != NULL);
+    rassert(in2 != NULL);
+    rassert(count >= 0);
+
+    for (int32_t i = 0; i < count; ++i)
+        out[i] = in1[i] * in2[i];
+
+    return;
+}
+
+
+void kernel_scale_mul(
+        float* out, const float* in, float scale, const float* mults, int32_t count)
+{
+    rassert(out != NULL);
+    rassert(in != NULL);
+    rassert(mults != NULL);
+    rassert(count >= 0);
+
+    for (int32_t i = 0; i < count; ++i)
+        out[i] = (in[i] * scale) * mults[i];
+
+    return;
+}
+
+
+#define MEASURE_LANES 8
+
+
+void kernel_scale_measure(
+        float* out,
+        const float* in,
+        float scale,
+        int32_t count,
+        float* inout_peak,
+        double* inout_sum_squares,
+        int32_t* inout_clipped)
+{
+    rassert(out != NULL);
+    rassert(in != NULL);
+    rassert(count >= 0);
+    rassert(inout_peak != NULL);
+    rassert(inout_sum_squares != NULL);
+    rassert(inout_clipped != NULL);
+
+    // Accumulate in separate lanes so that the reductions can be vectorised
+    float peaks[MEASURE_LANES] = { 0 };
+    double sums[MEASURE_LANES] = { 0 };
+    int32_t clips[MEASURE_LANES] = { 0 };
+
+    const int32_t lanes_stop = count - (count % MEASURE_LANES);
+
+    for (int32_t i = 0; i < lanes_stop; i += MEASURE_LANES)
+    {
+        for (int lane = 0; lane < MEASURE_LANES; ++lane)
+        {
+            const float value = in[i + lane] * scale;
+            out[i + lane] = value;
+
+            const float abs_value = fabsf(value);
+            peaks[lane] = (abs_value > peaks[lane]) ? abs_value : peaks[lane];
+            sums[lane] += isnan(value) ? 0.0 : (double)value * value;
+            clips[lane] += (abs_value > 1.0f) ? 1 : 0;
+        }
+    }
+
+    for (int32_t i = lanes_stop; i < count; ++i)
+    {
+        const float value = in[i] * scale;
+        out[i] = value;
+
+        const float abs_value = fabsf(value);
+        peaks[0] = (abs_value > peaks[0]) ? abs_value : peaks[0];
+        sums[0] += isnan(value) ? 0.0 : (double)value * value;
+        clips[0] += (abs_value > 1.0f) ? 1 : 0;
+    }
+
+    float peak = *inout_peak;
+    double sum_squares = *inout_sum_squares;
+    int32_t clipped = *inout_clipped;
+
+    for (int lane = 0; lane < MEASURE_LANES; ++lane)
+    {
+        peak = (peaks[lane] > peak) ? peaks[lane] : peak;
+        sum_squares += sums[lane];
+        clipped += clips[lane];
+    }
+
+    *inout_peak = peak;
+    *inout_sum_squares = sum_squares;
+    *inout_clipped = clipped;
+
+    return;
+}
+
+
+void kernel_clamp(
+        float* out, const float* in, float min_value, float max_value, int32_t count)
+{
+    rassert(out != NULL);
+    rassert(in != NULL);
+    rassert(!isnan(min_value));
+    rassert(!isnan(max_value));
+    rassert(min_value <= max_value);
+    rassert(count >= 0);
+
+    for (int32_t i = 0; i < count; ++i)
+        out[i] = clamp(in[i], min_value, max_value);
+
+    return;
+}
+
+
+void kernel_range_map(
+        float* out,
+        const float* in,
+        float mul,
+        float add,
+        float min_value,
+        float max_value,
+        int32_t count)
+{
+    rassert(out != NULL);
+    rassert(in != NULL);
+    rassert(isfinite(mul));
+    rassert(isfinite(add));
+    rassert(!isnan(min_value));
+    rassert(!isnan(max_value));
+    rassert(min_value <= max_value);
+    rassert(count >= 0);
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const float mapped = (mul * in[i]) + add;
+        out[i] = clamp(mapped, min_value, max_value);
+    }
+
+    return;
+}
+
+
+void kernel_pan(
+        float* out, const float* in, const float* pans, float side, int32_t count)
+{
+    rassert(out != NULL);
+    rassert(in != NULL);
+    rassert(pans != NULL);
+    rassert((side == -1) || (side == 1));
+    rassert(count >= 0);
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const float pan = clamp(pans[i], -1.0f, 1.0f);
+        out[i] = in[i] * (1 + (side * pan));
+    }
+
+    return;
+}
+
+
+void kernel_exp2(
+        float* out, const float* in, float in_mul, float out_mul, int32_t count)
+{
+    rassert(out != NULL);
+    rassert(in != NULL);
+    rassert(isfinite(in_mul));
+    rassert(isfinite(out_mul));
+    rassert(count >= 0);
+
+    for (int32_t i = 0; i < count; ++i)
+        out[i] = out_mul * fast_exp2f(in_mul * in[i]);
+
+    return;
+}
+
+
+static inline float lookup_linear(const float* table, int32_t last_index, float pos)
+{
+    dassert(table != NULL);
+    dassert(last_index > 0);
+    dassert(pos >= 0);
+    dassert(pos <= (float)last_index);
+
+    const int32_t index = min((int32_t)pos, last_index - 1);
+    const float frac = pos - (float)index;
+
+    return table[index] + frac * (table[index + 1] - table[index]);
+}
+
+
+void kernel_table_lookup(
+        float* out,
+        const float* in,
+        const float* table,
+        int32_t table_size,
+        float in_min,
+        float in_max,
+        int32_t count)
+{
+    rassert(out != NULL);
+    rassert(in != NULL);
+    rassert(table != NULL);
+    rassert(out != table);
+    rassert(table_size >= 2);
+    rassert(isfinite(in_min));
+    rassert(isfinite(in_max));
+    rassert(in_min < in_max);
+    rassert(count >= 0);
+
+    const int32_t last_index = table_size - 1;
+    const float pos_scale = (float)last_index / (in_max - in_min);
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        // NaN inputs are mapped to the start of the table
+        const float in_value = (in[i] >= in_min) ? min(in[i], in_max) : in_min;
+        const float pos = min((in_value - in_min) * pos_scale, (float)last_index);
+        out[i] = lookup_linear(table, last_index, pos);
+    }
+
+    return;
+}
+
+
+void kernel_table_lookup_odd(
+        float* out,
+        const float* in,
+        const float* table,
+        int32_t table_size,
+        int32_t count)
+{
+    rassert(out != NULL);
+    rassert(in != NULL);
+    rassert(table != NULL);
+    rassert(out != table);
+    rassert(table_size >= 2);
+    rassert(count >= 0);
+
+    const int32_t last_index = table_size - 1;
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const float in_value = in[i];
+        // NaN inputs are mapped to the end of the table
+        const float abs_value = min(fabsf(in_value), 1.0f);
+        const float pos = abs_value * (float)last_index;
+        const float out_value = lookup_linear(table, last_index, pos);
+        out[i] = (in_value < 0) ? -out_value : out_value;
+    }
+
+    return;
+}
+
+
+static inline float floor_exact(float x)
+{
+    // All floats with a magnitude of at least 2^23 are integers
+    static const float int_limit = 8388608.0f;
+
+    // NaN values are also clamped here to keep the conversion well-defined
+    const float cx = clamp(x, -int_limit, int_limit);
+    float floored = (float)(int32_t)cx;
+    floored -= (floored > cx) ? 1.0f : 0.0f;
+
+    return (fabsf(x) < int_limit) ? floored : x;
+}
+
+
+void kernel_quantise(
+        float* out, const float* in, const float* mults, float mult_limit, int32_t count)
+{
+    rassert(out != NULL);
+    rassert(in != NULL);
+    rassert(mults != NULL);
+    rassert(count >= 0);
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const float in_value = in[i];
+        const float mult = mults[i];
+
+        const float scaled = (((in_value + 1) * 0.5f) * mult);
+        const float quantised = ((floor_exact(scaled) / mult) * 2.0f) - 1;
+
+        out[i] = (mult < mult_limit) ? quantised : in_value;
+    }
+
+    return;
+}
+
+
+void kernel_sample_hold(
+        float* out,
+        const float* in,
+        const float* holds,
+        int32_t count,
+        double* inout_hold_timer,
+        float* inout_hold_value)
+{
+    rassert(out != NULL);
+    rassert(in != NULL);
+    rassert(holds != NULL);
+    rassert(count >= 0);
+    rassert(inout_hold_timer != NULL);
+    rassert(inout_hold_value != NULL);
+
+    double hold_timer = *inout_hold_timer;
+    float hold_value = *inout_hold_value;
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        hold_timer += 1.0;
+
+        const float hold = holds[i];
+        if (hold_timer >= hold)
+        {
+            double excess = hold_timer - hold;
+            excess = min(1.0, excess);
+
+            const float in_value = in[i];
+            out[i] = lerp(hold_value, in_value, (float)excess);
+
+            hold_value = in_value;
+            hold_timer = excess;
+
+            continue;
+        }
+
+        out[i] = hold_value;
+    }
+
+    *inout_hold_timer = hold_timer;
+    *inout_hold_value = hold_value;
+
+    return;
+}
+
+
@@ -0,0 +1,271 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#ifndef KQT_KERNELS_H
+#define KQT_KERNELS_H
+
+
+#include <stdint.h>
+#include <stdlib.h>
+
+
+/*
+ * Signal kernels for simple per-frame processing.
+ *
+ * The kernels operate on plain arrays of \a count frames, so the caller is
+ * expected to pass pointers offset by the buffer start index. Unless stated
+ * otherwise, the output array may be the same as an input array, but the
+ * arrays must not overlap partially. Apart from \a kernel_sample_hold, the
+ * kernels do not depend on the results of preceding frames and can be
+ * vectorised by the compiler.
+ */
+
+
+/**
+ * Fill a signal with a constant value.
+ *
+ * \param out     The output signal -- must not be \c NULL.
+ * \param value   The value to be written.
+ * \param count   The number of frames to process -- must be >= \c 0.
+ */
+void kernel_fill(float* out, float value, int32_t count);
+
+
+/**
+ * Scale a signal by a constant.
+ *
+ * \param out     The output signal -- must not be \c NULL.
+ * \param in      The input signal -- must not be \c NULL.
+ * \param scale   The scale factor.
+ * \param count   The number of frames to process -- must be >= \c 0.
+ */
+void kernel_scale(float* out, const float* in, float scale, int32_t count);
+
+
+/**
+ * Multiply two signals.
+ *
+ * \param out     The output signal -- must not be \c NULL.
+ * \param in1     The first input signal -- must not be \c NULL.
+ * \param in2     The second input signal -- must not be \c NULL.
+ * \param count   The number of frames to process -- must be >= \c 0.
+ */
+void kernel_mul(float* out, const float* in1, const float* in2, int32_t count);
+
+
+/**
+ * Scale a signal by a constant and multiply it by another signal.
+ *
+ * The result equals \a kernel_scale followed by \a kernel_mul but is
+ * calculated in a single pass.
+ *
+ * \param out     The output signal -- must not be \c NULL.
+ * \param in      The input signal -- must not be \c NULL.
+ * \param scale   The scale factor applied to \a in.
+ * \param mults   The multiplier signal -- must not be \c NULL.
+ * \param count   The number of frames to process -- must be >= \c 0.
+ */
+void kernel_scale_mul(
+        float* out, const float* in, float scale, const float* mults, int32_t count);
+
+
+/**
+ * Scale a signal by a constant and measure the levels of the result.
+ *
+ * The measured values are accumulated into the existing values pointed to by
+ * the inout parameters. NaN values are ignored in the measurements.
+ *
+ * \param out                 The output signal -- must not be \c NULL.
+ * \param in                  The input signal -- must not be \c NULL.
+ * \param scale               The scale factor.
+ * \param count               The number of frames to process -- must be
+ *                            >= \c 0.
+ * \param inout_peak          The peak absolute value -- must not be \c NULL.
+ * \param inout_sum_squares   The sum of squared values -- must not be
+ *                            \c NULL.
+ * \param inout_clipped       The number of values outside [-1, 1] -- must
+ *                            not be \c NULL.
+ */
+void kernel_scale_measure(
+        float* out,
+        const float* in,
+        float scale,
+        int32_t count,
+        float* inout_peak,
+        double* inout_sum_squares,
+        int32_t* inout_clipped);
+
+
+/**
+ * Clamp a signal to a range.
+ *
+ * NaN values are passed through unchanged.
+ *
+ * \param out         The output signal -- must not be \c NULL.
+ * \param in          The input signal -- must not be \c NULL.
+ * \param min_value   The minimum value, or \c -INFINITY.
+ * \param max_value   The maximum value -- must be >= \a min_value.
+ * \param count       The number of frames to process -- must be >= \c 0.
+ */
+void kernel_clamp(
+        float* out, const float* in, float min_value, float max_value, int32_t count);
+
+
+/**
+ * Map a signal linearly and clamp the result.
+ *
+ * NaN values are passed through unchanged.
+ *
+ * \param out         The output signal -- must not be \c NULL.
+ * \param in          The input signal -- must not be \c NULL.
+ * \param mul         The multiplier -- must be finite.
+ * \param add         The offset added after multiplication -- must be finite.
+ * \param min_value   The minimum output value, or \c -INFINITY.
+ * \param max_value   The maximum output value -- must be >= \a min_value.
+ * \param count       The number of frames to process -- must be >= \c 0.
+ */
+void kernel_range_map(
+        float* out,
+        const float* in,
+        float mul,
+        float add,
+        float min_value,
+        float max_value,
+        int32_t count);
+
+
+/**
+ * Apply the linear pan law to one channel of a signal.
+ *
+ * The output is \a in * (1 + \a side * pan), where pan is clamped to the
+ * range [-1, 1].
+ *
+ * \param out     The output signal -- must not be \c NULL.
+ * \param in      The input signal -- must not be \c NULL.
+ * \param pans    The panning signal -- must not be \c NULL.
+ * \param side    The channel side, \c -1 for left or \c 1 for right.
+ * \param count   The number of frames to process -- must be >= \c 0.
+ */
+void kernel_pan(
+        float* out, const float* in, const float* pans, float side, int32_t count);
+
+
+/**
+ * Calculate scaled base-2 exponentials of a signal.
+ *
+ * The output is \a out_mul * 2 ^ (\a in_mul * \a in) as calculated by
+ * \a fast_exp2f.
+ *
+ * \param out       The output signal -- must not be \c NULL.
+ * \param in        The input signal -- must not be \c NULL and must contain
+ *                  finite values only.
+ * \param in_mul    The multiplier applied to the exponent -- must be finite.
+ * \param out_mul   The multiplier applied to the result -- must be finite.
+ * \param count     The number of frames to process -- must be >= \c 0.
+ */
+void kernel_exp2(
+        float* out, const float* in, float in_mul, float out_mul, int32_t count);
+
+
+/**
+ * Map a signal through a lookup table with linear interpolation.
+ *
+ * The input is clamped to the range [\a in_min, \a in_max] that is spread
+ * evenly over the table.
+ *
+ * \param out          The output signal -- must not be \c NULL and must not
+ *                     be \a table.
+ * \param in           The input signal -- must not be \c NULL.
+ * \param table        The lookup table -- must not be \c NULL.
+ * \param table_size   The number of entries in \a table -- must be >= \c 2.
+ * \param in_min       The input value of the first table entry -- must be
+ *                     finite.
+ * \param in_max       The input value of the last table entry -- must be
+ *                     finite and > \a in_min.
+ * \param count        The number of frames to process -- must be >= \c 0.
+ */
+void kernel_table_lookup(
+        float* out,
+        const float* in,
+        const float* table,
+        int32_t table_size,
+        float in_min,
+        float in_max,
+        int32_t count);
+
+
+/**
+ * Map a signal through an odd-symmetric lookup table with linear
+ * interpolation.
+ *
+ * The table covers the absolute input values in the range [0, 1], and the
+ * output has the sign of the input.
+ *
+ * \param out          The output signal -- must not be \c NULL and must not
+ *                     be \a table.
+ * \param in           The input signal -- must not be \c NULL.
+ * \param table        The lookup table -- must not be \c NULL.
+ * \param table_size   The number of entries in \a table -- must be >= \c 2.
+ * \param count        The number of frames to process -- must be >= \c 0.
+ */
+void kernel_table_lookup_odd(
+        float* out,
+        const float* in,
+        const float* table,
+        int32_t table_size,
+        int32_t count);
+
+
+/**
+ * Quantise a signal in the range [-1, 1] to a varying number of levels.
+ *
+ * Frames with a level count >= \a mult_limit are passed through unchanged.
+ *
+ * \param out          The output signal -- must not be \c NULL.
+ * \param in           The input signal -- must not be \c NULL.
+ * \param mults        The numbers of quantisation levels -- must not be
+ *                     \c NULL and must contain positive values only.
+ * \param mult_limit   The level count limit for quantisation.
+ * \param count        The number of frames to process -- must be >= \c 0.
+ */
+void kernel_quantise(
+        float* out, const float* in, const float* mults, float mult_limit, int32_t count);
+
+
+/**
+ * Hold a signal for varying durations.
+ *
+ * When a hold period ends, the output crossfades to the current input value
+ * by the fractional part of the elapsed time, and the input is held again.
+ *
+ * \param out                The output signal -- must not be \c NULL.
+ * \param in                 The input signal -- must not be \c NULL.
+ * \param holds              The hold durations in frames -- must not be
+ *                           \c NULL.
+ * \param count              The number of frames to process -- must be >= \c 0.
+ * \param inout_hold_timer   The elapsed hold time -- must not be \c NULL.
+ * \param inout_hold_value   The value being held -- must not be \c NULL.
+ */
+void kernel_sample_hold(
+        float* out,
+        const float* in,
+        const float* holds,
+        int32_t count,
+        double* inout_hold_timer,
+        float* inout_hold_value);
+
+
+#endif // KQT_KERNELS_H
+
+
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2013-2016
+ * Author: Tomi Jylhä-Ollila, Finland 2013-2018
  *
  * This file is part of Kunquat.
  *
@@ -15,6 +15,7 @@
 #include <memory.h>
 
 #include <debug/assert.h>
+#include <debug/Render_checks.h>
 
 #include <stdbool.h>
 
@@ -39,6 +40,13 @@ static int32_t out_of_memory_error_steps = -1;
 static int32_t total_alloc_count = 0;
 
 
+#ifdef ENABLE_RENDER_CHECKS
+#define report_render_check(type) Render_checks_report(type)
+#else
+#define report_render_check(type) ignore(type)
+#endif
+
+
 void* memory_alloc(int64_t size)
 {
     rassert(size >= 0);
@@ -46,6 +54,8 @@ void* memory_alloc(int64_t size)
     if (size == 0)
         return NULL;
 
+    report_render_check(RENDER_CHECK_ALLOC);
+
     update_out_of_memory_error();
 
     void* block = malloc((size_t)size);
@@ -64,6 +74,8 @@ void* memory_calloc(int64_t item_count, int64_t item_size)
     if (item_count == 0 || item_size == 0)
         return NULL;
 
+    report_render_check(RENDER_CHECK_ALLOC);
+
     update_out_of_memory_error();
 
     void* block = calloc((size_t)item_count, (size_t)item_size);
@@ -83,6 +95,8 @@ void* memory_realloc(void* ptr, int64_t size)
     else if (size == 0)
         return NULL;
 
+    report_render_check(RENDER_CHECK_ALLOC);
+
     update_out_of_memory_error();
 
     void* block = realloc(ptr, (size_t)size);
@@ -95,6 +109,9 @@ void* memory_realloc(void* ptr, int64_t size)
 
 void memory_free(void* ptr)
 {
+    if (ptr != NULL)
+        report_render_check(RENDER_CHECK_FREE);
+
     free(ptr);
     return;
 }
@@ -31,9 +31,6 @@ void Cgiter_init(Cgiter* cgiter, const Module* module, int col_index)
     cgiter->module = module;
     cgiter->col_index = col_index;
     Position_init(&cgiter->pos);
-    Column_iter_init(&cgiter->citer);
-
-    cgiter->cur_tr.head = NULL;
 
     cgiter->row_returned = false;
 
@@ -117,18 +114,10 @@ void Cgiter_reset(Cgiter* cgiter, const Position* start_pos)
 }
 
 
-const Trigger_row* Cgiter_get_trigger_row(Cgiter* cgiter)
+static const Column* Cgiter_get_column(Cgiter* cgiter, const Pattern** out_pattern)
 {
     rassert(cgiter != NULL);
 
-    if (Cgiter_has_finished(cgiter))
-        return NULL;
-
-    // Don't return a previously returned row
-    if (cgiter->row_returned)
-        return NULL;
-    cgiter->row_returned = true;
-
     // Find pattern
     const Pattern* pattern = NULL;
     const Pat_inst_ref* piref = NULL;
@@ -140,26 +129,73 @@ const Trigger_row* Cgiter_get_trigger_row(Cgiter* cgiter)
     if (piref != NULL)
         pattern = Module_get_pattern(cgiter->module, piref);
 
+    if (out_pattern != NULL)
+        *out_pattern = pattern;
+
     if (pattern == NULL)
         return NULL;
 
     // Store current pattern instance for reference
     cgiter->pos.piref = *piref;
 
-    Column* column = Pattern_get_column(pattern, cgiter->col_index);
+    return Pattern_get_column(pattern, cgiter->col_index);
+}
+
+
+const Trigger_row* Cgiter_get_trigger_row(Cgiter* cgiter)
+{
+    rassert(cgiter != NULL);
+
+    if (Cgiter_has_finished(cgiter))
+        return NULL;
+
+    // Don't return a previously returned row
+    if (cgiter->row_returned)
+        return NULL;
+    cgiter->row_returned = true;
+
+    const Column* column = Cgiter_get_column(cgiter, NULL);
     if (column == NULL)
         return NULL;
 
-    Column_iter_change_col(&cgiter->citer, column);
-    cgiter->cur_tr.head = Column_iter_get_row(&cgiter->citer, &cgiter->pos.pat_pos);
-    if (cgiter->cur_tr.head == NULL)
+    const int row_index = Column_find_row(column, &cgiter->pos.pat_pos);
+    if (row_index < 0)
         return NULL;
-    rassert(cgiter->cur_tr.head->next != NULL);
-    rassert(cgiter->cur_tr.head->next->trigger != NULL);
-    if (Tstamp_cmp(&cgiter->cur_tr.head->next->trigger->pos, &cgiter->pos.pat_pos) > 0)
+
+    const Trigger_row* row = Column_get_row(column, row_index);
+    if (Tstamp_cmp(&row->pos, &cgiter->pos.pat_pos) > 0)
         return NULL;
 
-    return &cgiter->cur_tr;
+    return row;
+}
+
+
+bool Cgiter_get_next_row_pos(Cgiter* cgiter, Tstamp* pos)
+{
+    rassert(cgiter != NULL);
+    rassert(pos != NULL);
+
+    if (Cgiter_has_finished(cgiter))
+        return false;
+
+    const Column* column = Cgiter_get_column(cgiter, NULL);
+    if (column == NULL)
+        return false;
+
+    const Tstamp* min_pos = &cgiter->pos.pat_pos;
+    if (cgiter->row_returned)
+    {
+        const Tstamp* epsilon = Tstamp_set(TSTAMP_AUTO, 0, 1);
+        min_pos = Tstamp_add(TSTAMP_AUTO, &cgiter->pos.pat_pos, epsilon);
+    }
+
+    const int row_index = Column_find_row(column, min_pos);
+    if (row_index < 0)
+        return false;
+
+    Tstamp_copy(pos, &Column_get_row(column, row_index)->pos);
+
+    return true;
 }
 
 
@@ -183,17 +219,33 @@ bool Cgiter_peek(Cgiter* cgiter, Tstamp* dist)
     if (Cgiter_has_finished(cgiter))
         return false;
 
-    // Find pattern
-    const Pattern* pattern = NULL;
-    const Pat_inst_ref* piref = NULL;
-    if (cgiter->is_pattern_playback_state)
-        piref = &cgiter->pos.piref;
-    else
-        piref = find_pat_inst_ref(cgiter->module, cgiter->pos.track, cgiter->pos.system);
+    const Column* column = Cgiter_get_column(cgiter, NULL);
+    if (column == NULL)
+        return false;
 
-    if (piref != NULL)
-        pattern = Module_get_pattern(cgiter->module, piref);
+    // Find next trigger row
+    const Tstamp* epsilon = Tstamp_set(TSTAMP_AUTO, 0, 1);
+    Tstamp* next_pos_min = Tstamp_add(TSTAMP_AUTO, &cgiter->pos.pat_pos, epsilon);
+    const int row_index = Column_find_row(column, next_pos_min);
+
+    const Tstamp* row_pos =
+        (row_index >= 0) ? &Column_get_row(column, row_index)->pos : NULL;
 
+    return Cgiter_peek_row(cgiter, row_pos, dist);
+}
+
+
+bool Cgiter_peek_row(Cgiter* cgiter, const Tstamp* row_pos, Tstamp* dist)
+{
+    rassert(cgiter != NULL);
+    rassert(dist != NULL);
+    rassert(Tstamp_cmp(dist, TSTAMP_AUTO) >= 0);
+
+    if (Cgiter_has_finished(cgiter))
+        return false;
+
+    const Pattern* pattern = NULL;
+    Cgiter_get_column(cgiter, &pattern);
     if (pattern == NULL)
         return false;
 
@@ -210,28 +262,14 @@ bool Cgiter_peek(Cgiter* cgiter, Tstamp* dist)
     }
 
     // Check next trigger row
-    Column* column = Pattern_get_column(pattern, cgiter->col_index);
-    rassert(column != NULL);
-    Column_iter_change_col(&cgiter->citer, column);
-
-    const Tstamp* epsilon = Tstamp_set(TSTAMP_AUTO, 0, 1);
-    Tstamp* next_pos_min = Tstamp_add(TSTAMP_AUTO, &cgiter->pos.pat_pos, epsilon);
-    Trigger_list* row = Column_iter_get_row(&cgiter->citer, next_pos_min);
-
-    if (row != NULL)
+    if ((row_pos != NULL) && (Tstamp_cmp(row_pos, pat_length) <= 0))
     {
-        rassert(row->next != NULL);
-        rassert(row->next->trigger != NULL);
-        if (Tstamp_cmp(&row->next->trigger->pos, pat_length) <= 0)
-        {
-            // Trigger row found inside this pattern
-            const Tstamp* dist_to_row = Tstamp_sub(
-                    TSTAMP_AUTO,
-                    &row->next->trigger->pos,
-                    &cgiter->pos.pat_pos);
-            Tstamp_mina(dist, dist_to_row);
-            return true;
-        }
+        rassert(Tstamp_cmp(row_pos, &cgiter->pos.pat_pos) > 0);
+
+        // Trigger row found inside this pattern
+        const Tstamp* dist_to_row = Tstamp_sub(TSTAMP_AUTO, row_pos, &cgiter->pos.pat_pos);
+        Tstamp_mina(dist, dist_to_row);
+        return true;
     }
 
     // No trigger row found
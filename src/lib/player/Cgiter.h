@@ -24,13 +24,6 @@
 #include <stdlib.h>
 
 
-// TODO: define proper interface in Column
-typedef struct Trigger_row
-{
-    Trigger_list* head;
-} Trigger_row;
-
-
 /**
  * Iterates over triggers in column groups.
  */
@@ -40,8 +33,6 @@ typedef struct Cgiter
     int col_index;
 
     Position pos;
-    Column_iter citer;
-    Trigger_row cur_tr; // TODO: remove
 
     bool row_returned;
 
@@ -82,6 +73,18 @@ void Cgiter_reset(Cgiter* cgiter, const Position* start_pos);
 const Trigger_row* Cgiter_get_trigger_row(Cgiter* cgiter);
 
 
+/**
+ * Get the position of the next trigger row that has not been returned.
+ *
+ * \param cgiter   The Cgiter -- must not be \c NULL.
+ * \param pos      Destination for the row position -- must not be \c NULL.
+ *
+ * \return   \c true if a trigger row was found in the current pattern,
+ *           otherwise \c false.
+ */
+bool Cgiter_get_next_row_pos(Cgiter* cgiter, Tstamp* pos);
+
+
 /**
  * Allow a previously returned trigger row to be returned again.
  *
@@ -104,6 +107,24 @@ void Cgiter_clear_returned_status(Cgiter* cgiter);
 bool Cgiter_peek(Cgiter* cgiter, Tstamp* dist);
 
 
+/**
+ * Get distance to a known breakpoint following the current Cgiter position.
+ *
+ * This is equivalent to Cgiter_peek() when \a row_pos is the position of
+ * the next trigger row in the Cgiter column.
+ *
+ * \param cgiter    The Cgiter -- must not be \c NULL.
+ * \param row_pos   The position of the next trigger row, or \c NULL if
+ *                  there is no trigger row ahead.
+ * \param dist      Address where the distance will be stored -- must be valid.
+ *                  NOTE: The passed value is used to determine maximum
+ *                  distance to be searched.
+ *
+ * \return   \c true if \a dist was modified, otherwise \c false.
+ */
+bool Cgiter_peek_row(Cgiter* cgiter, const Tstamp* row_pos, Tstamp* dist);
+
+
 /**
  * Move the iterator forwards.
  *
@@ -14,102 +14,67 @@
 
 #include <player/Event_cache.h>
 
-#include <containers/AAtree.h>
 #include <debug/assert.h>
-#include <kunquat/limits.h>
 #include <memory.h>
-#include <player/Event_names.h>
-#include <player/Event_type.h>
 #include <Value.h>
 
 #include <stdbool.h>
 #include <stdlib.h>
-#include <string.h>
 
 
 struct Event_cache
 {
-    AAtree* cache;
+    int slot_count;
+    Value* values;
 };
 
 
-typedef struct Event_state
+Event_cache* new_Event_cache(int slot_count)
 {
-    char event_name[KQT_EVENT_NAME_MAX + 1];
-    Value value;
-} Event_state;
+    rassert(slot_count >= 0);
 
-
-static Event_state* new_Event_state(const char* event_name);
-
-
-static void Event_state_reset(Event_state* es);
-
-
-static void del_Event_state(Event_state* es);
-
-
-Event_cache* new_Event_cache(void)
-{
     Event_cache* cache = memory_alloc_item(Event_cache);
     if (cache == NULL)
         return NULL;
 
-    cache->cache = new_AAtree(
-            (AAtree_item_cmp*)strcmp, (AAtree_item_destroy*)del_Event_state);
-    if (cache->cache == NULL)
-    {
-        del_Event_cache(cache);
-        return NULL;
-    }
+    cache->slot_count = slot_count;
+    cache->values = NULL;
 
-    return cache;
-}
-
-
-bool Event_cache_add_event(Event_cache* cache, char* event_name)
-{
-    rassert(cache != NULL);
-    rassert(event_name != NULL);
-
-    if (AAtree_get_exact(cache->cache, event_name) != NULL)
-        return true;
-
-    Event_state* es = new_Event_state(event_name);
-    if (es == NULL || !AAtree_ins(cache->cache, es))
+    if (slot_count > 0)
     {
-        del_Event_state(es);
-        return false;
+        cache->values = memory_alloc_items(Value, slot_count);
+        if (cache->values == NULL)
+        {
+            del_Event_cache(cache);
+            return NULL;
+        }
     }
 
-    return true;
+    Event_cache_reset(cache);
+
+    return cache;
 }
 
 
-void Event_cache_update(Event_cache* cache, const char* event_name, const Value* value)
+void Event_cache_update(Event_cache* cache, int slot, const Value* value)
 {
     rassert(cache != NULL);
-    rassert(event_name != NULL);
+    rassert(slot >= 0);
+    rassert(slot < cache->slot_count);
     rassert(value != NULL);
 
-    Event_state* state = AAtree_get_exact(cache->cache, event_name);
-    if (state == NULL)
-        return;
-
-    Value_copy(&state->value, value);
+    Value_copy(&cache->values[slot], value);
     return;
 }
 
 
-const Value* Event_cache_get_value(const Event_cache* cache, const char* event_name)
+const Value* Event_cache_get_value(const Event_cache* cache, int slot)
 {
     rassert(cache != NULL);
-    rassert(event_name != NULL);
+    rassert(slot >= 0);
+    rassert(slot < cache->slot_count);
 
-    Event_state* state = AAtree_get_exact(cache->cache, event_name);
-    rassert(state != NULL);
-
-    return &state->value;
+    return &cache->values[slot];
 }
 
 
@@ -117,13 +82,8 @@ void Event_cache_reset(Event_cache* cache)
 {
     rassert(cache != NULL);
 
-    AAiter* iter = AAiter_init(AAITER_AUTO, cache->cache);
-    Event_state* es = AAiter_get_at_least(iter, "");
-    while (es != NULL)
-    {
-        Event_state_reset(es);
-        es = AAiter_get_next(iter);
-    }
+    for (int i = 0; i < cache->slot_count; ++i)
+        cache->values[i].type = VALUE_TYPE_NONE;
 
     return;
 }
@@ -134,42 +94,9 @@ void del_Event_cache(Event_cache* cache)
     if (cache == NULL)
         return;
 
-    del_AAtree(cache->cache);
+    memory_free(cache->values);
     memory_free(cache);
     return;
 }
 
 
-static Event_state* new_Event_state(const char* event_name)
-{
-    rassert(event_name != NULL);
-    rassert(strlen(event_name) <= KQT_EVENT_NAME_MAX);
-
-    Event_state* es = memory_alloc_item(Event_state);
-    if (es == NULL)
-        return NULL;
-
-    strcpy(es->event_name, event_name);
-    es->value.type = VALUE_TYPE_NONE;
-    return es;
-}
-
-
-static void Event_state_reset(Event_state* es)
-{
-    rassert(es != NULL);
-    es->value.type = VALUE_TYPE_NONE;
-    return;
-}
-
-
-static void del_Event_state(Event_state* es)
-{
-    if (es == NULL)
-        return;
-
-    memory_free(es);
-    return;
-}
-
-
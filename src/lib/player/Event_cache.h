@@ -31,43 +31,35 @@ typedef struct Event_cache Event_cache;
 /**
  * Create a new Event cache.
  *
+ * \param slot_count   The number of cached event values -- must be >= \c 0.
+ *
  * \return   The new Event cache if successful, or \c NULL if memory
  *           allocation failed.
  */
-Event_cache* new_Event_cache(void);
-
-
-/**
- * Add an event to the Event cache.
- *
- * \param cache        The Event cache -- must not be \c NULL.
- * \param event_name   The name of the Event -- must not be \c NULL.
- *
- * \return   \c true if successful, or \c false if memory allocation failed.
- */
-bool Event_cache_add_event(Event_cache* cache, char* event_name);
+Event_cache* new_Event_cache(int slot_count);
 
 
 /**
  * Update the Event cache.
  *
- * \param cache        The Event cache -- must not be \c NULL.
- * \param event_name   The name of the Event -- must not be \c NULL.
- * \param value        The Event parameter -- must not be \c NULL.
+ * \param cache   The Event cache -- must not be \c NULL.
+ * \param slot    The slot index of the Event -- must be >= \c 0 and less than
+ *                the slot count of \a cache.
+ * \param value   The Event parameter -- must not be \c NULL.
  */
-void Event_cache_update(Event_cache* cache, const char* event_name, const Value* value);
+void Event_cache_update(Event_cache* cache, int slot, const Value* value);
 
 
 /**
  * Get a value from the Event cache.
  *
- * \param cache        The Event cache -- must not be \c NULL.
- * \param event_name   The name of the Event -- must not be \c NULL and
- *                     must be an event name found in \a cache.
+ * \param cache   The Event cache -- must not be \c NULL.
+ * \param slot    The slot index of the Event -- must be >= \c 0 and less than
+ *                the slot count of \a cache.
  *
- * \return   The value associated with \a event_name. This is never \c NULL.
+ * \return   The value stored in \a slot. This is never \c NULL.
  */
-const Value* Event_cache_get_value(const Event_cache* cache, const char* event_name);
+const Value* Event_cache_get_value(const Event_cache* cache, int slot);
 
 
 /**
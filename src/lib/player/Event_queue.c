@@ -0,0 +1,169 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <player/Event_queue.h>
+
+#include <debug/assert.h>
+#include <mathnum/common.h>
+#include <memory.h>
+#include <threads/Atomic.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+ * Each slot has a sequence number that tells whose turn it is to access the
+ * slot. A slot at write position pos is free when its sequence number equals
+ * pos and filled when the number equals pos + 1. Reading the slot advances
+ * the number by the queue size, making the slot free for the next round.
+ */
+
+
+typedef struct Event_slot
+{
+    int64_t seq;
+    Queued_event event;
+} Event_slot;
+
+
+struct Event_queue
+{
+    int64_t size;
+    int64_t write_pos;
+    int64_t read_pos;
+    Event_slot* slots;
+};
+
+
+Event_queue* new_Event_queue(int32_t size)
+{
+    rassert(size > 0);
+    rassert(is_p2(size));
+
+    Event_queue* queue = memory_alloc_item(Event_queue);
+    if (queue == NULL)
+        return NULL;
+
+    queue->size = size;
+    queue->write_pos = 0;
+    queue->read_pos = 0;
+    queue->slots = memory_alloc_items(Event_slot, size);
+    if (queue->slots == NULL)
+    {
+        del_Event_queue(queue);
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < size; ++i)
+    {
+        queue->slots[i].seq = i;
+        queue->slots[i].event.arg = *VALUE_AUTO;
+    }
+
+    return queue;
+}
+
+
+bool Event_queue_push(Event_queue* queue, const Queued_event* event)
+{
+    rassert(queue != NULL);
+    rassert(event != NULL);
+
+    // Reserve a slot
+    int64_t pos = atomic_load_i64(&queue->write_pos);
+    Event_slot* slot = NULL;
+    while (true)
+    {
+        slot = &queue->slots[pos & (queue->size - 1)];
+        const int64_t seq = atomic_load_i64(&slot->seq);
+
+        if (seq == pos)
+        {
+            if (atomic_cas_i64(&queue->write_pos, &pos, pos + 1))
+                break;
+        }
+        else if (seq < pos)
+        {
+            // The slot still contains an event from the previous round
+            return false;
+        }
+        else
+        {
+            pos = atomic_load_i64(&queue->write_pos);
+        }
+    }
+
+    slot->event.time = event->time;
+    slot->event.ch = event->ch;
+    strcpy(slot->event.name, event->name);
+    Value_copy(&slot->event.arg, &event->arg);
+
+    atomic_store_i64(&slot->seq, pos + 1);
+
+    return true;
+}
+
+
+const Queued_event* Event_queue_peek(const Event_queue* queue)
+{
+    rassert(queue != NULL);
+
+    const int64_t pos = queue->read_pos;
+    const Event_slot* slot = &queue->slots[pos & (queue->size - 1)];
+    if (atomic_load_i64(&slot->seq) != pos + 1)
+        return NULL;
+
+    return &slot->event;
+}
+
+
+void Event_queue_pop(Event_queue* queue)
+{
+    rassert(queue != NULL);
+    rassert(Event_queue_peek(queue) != NULL);
+
+    const int64_t pos = queue->read_pos;
+    Event_slot* slot = &queue->slots[pos & (queue->size - 1)];
+    queue->read_pos = pos + 1;
+    atomic_store_i64(&slot->seq, pos + queue->size);
+
+    return;
+}
+
+
+void Event_queue_clear(Event_queue* queue)
+{
+    rassert(queue != NULL);
+
+    while (Event_queue_peek(queue) != NULL)
+        Event_queue_pop(queue);
+
+    return;
+}
+
+
+void del_Event_queue(Event_queue* queue)
+{
+    if (queue == NULL)
+        return;
+
+    memory_free(queue->slots);
+    memory_free(queue);
+    return;
+}
+
+
@@ -0,0 +1,106 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#ifndef KQT_EVENT_QUEUE_H
+#define KQT_EVENT_QUEUE_H
+
+
+#include <kunquat/limits.h>
+#include <Value.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+/**
+ * A bounded lock-free queue of parsed events.
+ *
+ * Any number of threads may add events to the queue concurrently, but only
+ * one thread at a time may read and remove them.
+ */
+typedef struct Event_queue Event_queue;
+
+
+typedef struct Queued_event
+{
+    int64_t time;
+    int ch;
+    char name[KQT_EVENT_NAME_MAX + 1];
+    Value arg;
+} Queued_event;
+
+
+/**
+ * Create a new Event queue.
+ *
+ * \param size   The maximum number of events in the queue -- must be a
+ *               power of two.
+ *
+ * \return   The new Event queue if successful, or \c NULL if memory
+ *           allocation failed.
+ */
+Event_queue* new_Event_queue(int32_t size);
+
+
+/**
+ * Add an event to the end of the Event queue.
+ *
+ * \param queue   The Event queue -- must not be \c NULL.
+ * \param event   The event -- must not be \c NULL.
+ *
+ * \return   \c true if successful, or \c false if the Event queue is full.
+ */
+bool Event_queue_push(Event_queue* queue, const Queued_event* event);
+
+
+/**
+ * Get the first event in the Event queue.
+ *
+ * \param queue   The Event queue -- must not be \c NULL.
+ *
+ * \return   The first event, or \c NULL if the Event queue is empty. The
+ *           event remains valid until it is removed with
+ *           \a Event_queue_pop.
+ */
+const Queued_event* Event_queue_peek(const Event_queue* queue);
+
+
+/**
+ * Remove the first event from the Event queue.
+ *
+ * \param queue   The Event queue -- must not be \c NULL and must not be empty.
+ */
+void Event_queue_pop(Event_queue* queue);
+
+
+/**
+ * Remove all events currently in the Event queue.
+ *
+ * \param queue   The Event queue -- must not be \c NULL.
+ */
+void Event_queue_clear(Event_queue* queue);
+
+
+/**
+ * Destroy an existing Event queue.
+ *
+ * \param queue   The Event queue, or \c NULL.
+ */
+void del_Event_queue(Event_queue* queue);
+
+
+#endif // KQT_EVENT_QUEUE_H
+
+
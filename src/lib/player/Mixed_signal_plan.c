@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2017
+ * Author: Tomi Jylhä-Ollila, Finland 2017-2018
  *
  * This file is part of Kunquat.
  *
@@ -420,7 +420,7 @@ static bool Mixed_signal_plan_build_from_node(
     if (Device_node_get_type(node) == DEVICE_NODE_TYPE_AU)
     {
         const Audio_unit* au = (const Audio_unit*)node_device;
-        const Connections* au_conns = Audio_unit_get_connections(au);
+        Connections* au_conns = Audio_unit_get_connections_mut(au);
         if (au_conns == NULL)
             return true;
 
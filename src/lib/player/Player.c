@@ -15,12 +15,15 @@
 #include <player/Player.h>
 
 #include <debug/assert.h>
+#include <debug/Render_checks.h>
 #include <Error.h>
 #include <init/devices/Au_params.h>
 #include <init/devices/Audio_unit.h>
 #include <init/sheet/Channel_defaults.h>
 #include <kunquat/limits.h>
 #include <mathnum/common.h>
+#include <mathnum/denormals.h>
+#include <mathnum/kernels.h>
 #include <memory.h>
 #include <Pat_inst_ref.h>
 #include <player/devices/Device_thread_state.h>
@@ -38,7 +41,9 @@
 #include <threads/Condition.h>
 #include <threads/Mutex.h>
 #include <threads/Thread.h>
+#include <threads/Thread_pool.h>
 
+#include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -46,10 +51,15 @@
 #include <string.h>
 
 
+#define EVENT_QUEUE_SIZE 256
+
+
 #ifdef ENABLE_THREADS
 static void* render_thread_func(void* arg);
 #endif
 
+static void Player_reset_levels(Player* player);
+
 
 static void Player_thread_params_init(
         Player_thread_params* tp, Player* player, int thread_id)
@@ -132,6 +142,16 @@ Player* new_Player(
     for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
         player->audio_buffers[i] = NULL;
     player->audio_frames_available = 0;
+    for (int stem = 0; stem < KQT_STEMS_MAX; ++stem)
+    {
+        player->stems[stem].source = PLAYER_STEM_NONE;
+        player->stems[stem].index = 0;
+        for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
+            player->stems[stem].buffers[i] = NULL;
+    }
+    Player_reset_levels(player);
+
+    Render_checks_init(&player->render_checks);
 
     player->thread_count = 0;
     for (int i = 0; i < KQT_THREADS_MAX; ++i)
@@ -147,10 +167,17 @@ Player* new_Player(
     player->stop_threads = false;
     player->render_start = 0;
     player->render_stop = 0;
+    player->thread_pool = NULL;
+    player->render_level = -1;
+    player->sched_policy = THREAD_SCHED_DEFAULT;
+    player->sched_priority = 0;
+    for (int i = 0; i < KQT_THREADS_MAX; ++i)
+        player->thread_affinities[i] = 0;
 
     player->device_states = NULL;
     player->estate = NULL;
     player->event_buffer = NULL;
+    player->event_queue = NULL;
     player->voices = NULL;
     player->mixed_signal_plan = NULL;
     Master_params_preinit(&player->master_params);
@@ -163,6 +190,7 @@ Player* new_Player(
     player->cgiters_accessed = false;
     for (int i = 0; i < KQT_CHANNELS_MAX; ++i)
         Cgiter_init(&player->cgiters[i], player->module, i);
+    Trigger_row_queue_init(&player->row_queue);
 
     player->audio_frames_processed = 0;
     player->nanoseconds_history = 0;
@@ -177,10 +205,12 @@ Player* new_Player(
     player->device_states = new_Device_states();
     player->estate = new_Env_state(player->module->env);
     player->event_buffer = new_Event_buffer(event_buffer_size);
+    player->event_queue = new_Event_queue(EVENT_QUEUE_SIZE);
     player->voices = new_Voice_pool(voice_count);
     if (player->device_states == NULL ||
             player->estate == NULL ||
             player->event_buffer == NULL ||
+            player->event_queue == NULL ||
             player->voices == NULL ||
             !Voice_pool_reserve_state_space(
                 player->voices,
@@ -307,6 +337,43 @@ static bool Player_thread_params_create_buffers(
 }
 
 
+void Player_set_thread_pool(Player* player, Thread_pool* pool)
+{
+    rassert(player != NULL);
+    rassert(player->thread_count == 1);
+
+    player->thread_pool = pool;
+
+    return;
+}
+
+
+#ifdef ENABLE_THREADS
+static void Player_apply_thread_settings(Player* player, int thread_index)
+{
+    rassert(player != NULL);
+    rassert(thread_index >= 0);
+    rassert(thread_index < KQT_THREADS_MAX);
+
+    Thread* thread = &player->threads[thread_index];
+
+    // Failures leave the thread with default settings, which is fine for rendering
+    if ((player->sched_policy != THREAD_SCHED_DEFAULT) &&
+            !Thread_set_scheduling(
+                thread, player->sched_policy, player->sched_priority, ERROR_AUTO))
+    {
+        player->sched_policy = THREAD_SCHED_DEFAULT;
+        player->sched_priority = 0;
+    }
+
+    if (player->thread_affinities[thread_index] != 0)
+        Thread_set_affinity(thread, player->thread_affinities[thread_index], ERROR_AUTO);
+
+    return;
+}
+#endif
+
+
 bool Player_set_thread_count(Player* player, int new_count, Error* error)
 {
     rassert(player != NULL);
@@ -360,6 +427,13 @@ bool Player_set_thread_count(Player* player, int new_count, Error* error)
 
 #ifdef ENABLE_THREADS
 
+    if (player->thread_pool != NULL)
+    {
+        // Rendering tasks are executed in the shared pool
+        player->thread_count = new_count;
+        return true;
+    }
+
     const int threads_needed = (new_count > 1) ? new_count : 0;
 
     // Remove old threads (all of them so that we can replace our barriers)
@@ -427,6 +501,8 @@ bool Player_set_thread_count(Player* player, int new_count, Error* error)
 
             return false;
         }
+
+        Player_apply_thread_settings(player, i);
     }
 
     if (threads_needed > 0)
@@ -450,26 +526,85 @@ bool Player_set_thread_count(Player* player, int new_count, Error* error)
 }
 
 
-int Player_get_thread_count(const Player* player)
+bool Player_set_thread_scheduling(
+        Player* player, Thread_sched_policy policy, int priority, Error* error)
 {
     rassert(player != NULL);
-    return player->thread_count;
+    rassert(policy >= THREAD_SCHED_DEFAULT);
+    rassert(policy <= THREAD_SCHED_RR);
+    rassert(error != NULL);
+
+#ifdef ENABLE_THREADS
+    for (int i = 0; i < KQT_THREADS_MAX; ++i)
+    {
+        if (!Thread_is_initialised(&player->threads[i]))
+            continue;
+
+        if (!Thread_set_scheduling(&player->threads[i], policy, priority, error))
+        {
+            // Restore the previous scheduling of the threads already modified
+            for (int k = i - 1; k >= 0; --k)
+            {
+                if (Thread_is_initialised(&player->threads[k]))
+                    Thread_set_scheduling(
+                            &player->threads[k],
+                            player->sched_policy,
+                            player->sched_priority,
+                            ERROR_AUTO);
+            }
+
+            return false;
+        }
+    }
+#endif
+
+    player->sched_policy = policy;
+    player->sched_priority = priority;
+
+    return true;
 }
 
 
-bool Player_reserve_voice_state_space(Player* player, int32_t size)
+bool Player_set_thread_affinity(
+        Player* player, int thread_index, uint64_t cpu_mask, Error* error)
 {
     rassert(player != NULL);
-    rassert(size >= 0);
+    rassert(thread_index >= 0);
+    rassert(thread_index < KQT_THREADS_MAX);
+    rassert(error != NULL);
 
-    return Voice_pool_reserve_state_space(player->voices, size);
+#ifdef ENABLE_THREADS
+    Thread* thread = &player->threads[thread_index];
+    if (Thread_is_initialised(thread) && !Thread_set_affinity(thread, cpu_mask, error))
+        return false;
+#endif
+
+    player->thread_affinities[thread_index] = cpu_mask;
+
+    return true;
+}
+
+
+const Render_checks* Player_get_render_checks(const Player* player)
+{
+    rassert(player != NULL);
+    return &player->render_checks;
+}
+
+
+int Player_get_thread_count(const Player* player)
+{
+    rassert(player != NULL);
+    return player->thread_count;
 }
 
 
-int32_t Player_get_voice_work_buffer_size(const Player* player)
+bool Player_reserve_voice_state_space(Player* player, int32_t size)
 {
     rassert(player != NULL);
-    return Voice_pool_get_work_buffer_size(player->voices);
+    rassert(size >= 0);
+
+    return Voice_pool_reserve_state_space(player->voices, size);
 }
 
 
@@ -607,11 +742,15 @@ void Player_reset(Player* player, int track_num)
 
     for (int i = 0; i < KQT_CHANNELS_MAX; ++i)
         Cgiter_reset(&player->cgiters[i], &player->master_params.cur_pos);
+    Trigger_row_queue_invalidate(&player->row_queue);
 
     player->cgiters_accessed = false;
 
     Event_buffer_clear(player->event_buffer);
 
+    // Queued event times refer to the old playback position
+    Event_queue_clear(player->event_queue);
+
     player->audio_frames_processed = 0;
     player->nanoseconds_history = 0;
 
@@ -650,9 +789,11 @@ bool Player_set_audio_rate(Player* player, int32_t rate)
     if (!Device_states_set_audio_rate(player->device_states, rate))
         return false;
 
-    // Resize Voice work buffers
+    // Reserve Voice work buffers for the new audio rate
     {
-        int32_t voice_wb_size = 0;
+        // Buffers of the old sizes stay valid while Voices still hold them
+        Voice_pool_remove_unused_work_buffers(player->voices);
+
         Au_table* au_table = Module_get_au_table(player->module);
         for (int au_i = 0; au_i < KQT_AUDIO_UNITS_MAX; ++au_i)
         {
@@ -661,12 +802,11 @@ bool Player_set_audio_rate(Player* player, int32_t rate)
             {
                 const int32_t au_req_voice_wb_size =
                     Audio_unit_get_voice_wb_size(au, rate);
-                voice_wb_size = max(voice_wb_size, au_req_voice_wb_size);
+                if (!Player_reserve_voice_work_buffer_space(
+                            player, au_req_voice_wb_size))
+                    return false;
             }
         }
-
-        if (!Player_reserve_voice_work_buffer_space(player, voice_wb_size))
-            return false;
     }
 
     // Add current playback frame count to nanoseconds history
@@ -742,6 +882,30 @@ bool Player_set_audio_buffer_size(Player* player, int32_t size)
         }
     }
 
+    // Update stem buffers
+    for (int stem = 0; stem < KQT_STEMS_MAX; ++stem)
+    {
+        Player_stem* pstem = &player->stems[stem];
+        if (pstem->source == PLAYER_STEM_NONE)
+            continue;
+
+        for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
+        {
+            if (player->audio_buffer_size == 0)
+            {
+                memory_free(pstem->buffers[i]);
+                pstem->buffers[i] = NULL;
+                continue;
+            }
+
+            float* new_buffer = memory_realloc_items(float, size, pstem->buffers[i]);
+            if (new_buffer == NULL)
+                return false;
+
+            pstem->buffers[i] = new_buffer;
+        }
+    }
+
     // Update device state buffers
     if (!Device_states_set_audio_buffer_size(player->device_states, size))
         return false;
@@ -965,6 +1129,53 @@ static void Player_execute_mixed_signal_tasks_synced(
 }
 
 
+static void process_voice_groups_task(void* arg, int index)
+{
+    rassert(arg != NULL);
+    rassert(index >= 0);
+
+    Player* player = arg;
+    rassert(index < player->thread_count);
+
+    Render_checks* prev_checks = Render_checks_enter_scope(&player->render_checks);
+
+    Player_process_voice_groups_synced(
+            player,
+            &player->thread_params[index],
+            player->render_start,
+            player->render_stop);
+
+    Render_checks_leave_scope(prev_checks);
+
+    return;
+}
+
+
+static void execute_mixed_signal_level_task(void* arg, int index)
+{
+    rassert(arg != NULL);
+    rassert(index >= 0);
+
+    Player* player = arg;
+    rassert(index < player->thread_count);
+
+    Render_checks* prev_checks = Render_checks_enter_scope(&player->render_checks);
+
+    while (Mixed_signal_plan_execute_next_task(
+            player->mixed_signal_plan,
+            player->render_level,
+            player->thread_params[index].work_buffers,
+            player->render_start,
+            player->render_stop,
+            player->master_params.tempo))
+        ;
+
+    Render_checks_leave_scope(prev_checks);
+
+    return;
+}
+
+
 static void* render_thread_func(void* arg)
 {
     rassert(arg != NULL);
@@ -972,6 +1183,8 @@ static void* render_thread_func(void* arg)
     Player_thread_params* params = arg;
     Player* player = params->player;
 
+    denormals_flush_enable();
+
     // Wait for the initial starting call
     {
         Mutex* cond_mutex = Condition_get_mutex(&player->start_cond);
@@ -994,17 +1207,25 @@ static void* render_thread_func(void* arg)
         if (player->stop_threads)
             break;
 
+        Render_checks* prev_checks = Render_checks_enter_scope(&player->render_checks);
+
         Player_process_voice_groups_synced(
                 player, params, player->render_start, player->render_stop);
 
+        Render_checks_leave_scope(prev_checks);
+
         // Wait to indicate that we have finished processing voice groups
         Barrier_wait(&player->vgroups_finished_barrier);
 
         // Wait for our signal to start mixed signal processing
         Barrier_wait(&player->mixed_start_barrier);
 
+        prev_checks = Render_checks_enter_scope(&player->render_checks);
+
         Player_execute_mixed_signal_tasks_synced(
                 player, params, player->render_start, player->render_stop);
+
+        Render_checks_leave_scope(prev_checks);
     }
 
     return NULL;
@@ -1052,11 +1273,22 @@ static void Player_process_voices(
         player->render_start = render_start;
         player->render_stop = render_stop;
 
-        // Synchronise with all threads to start voice group processing
-        Barrier_wait(&player->vgroups_start_barrier);
+        if (player->thread_pool != NULL)
+        {
+            Thread_pool_run(
+                    player->thread_pool,
+                    process_voice_groups_task,
+                    player,
+                    player->thread_count);
+        }
+        else
+        {
+            // Synchronise with all threads to start voice group processing
+            Barrier_wait(&player->vgroups_start_barrier);
 
-        // Wait until all threads have finished
-        Barrier_wait(&player->vgroups_finished_barrier);
+            // Wait until all threads have finished
+            Barrier_wait(&player->vgroups_finished_barrier);
+        }
 
         // Calculate active voices
         for (int i = 0; i < player->thread_count; ++i)
@@ -1119,21 +1351,35 @@ static void Player_process_mixed_signals(
         player->render_start = render_start;
         player->render_stop = render_start + frame_count;
 
-        // Synchronise with all threads to start mixed task execution
-        Barrier_wait(&player->mixed_start_barrier);
+        const int level_count =
+            Mixed_signal_plan_get_level_count(player->mixed_signal_plan);
 
-        if (frame_count > 0)
+        if (player->thread_pool != NULL)
+        {
+            // Each batch returns when its level is finished
+            for (int level_i = level_count - 1; level_i >= 0; --level_i)
+            {
+                player->render_level = level_i;
+                Thread_pool_run(
+                        player->thread_pool,
+                        execute_mixed_signal_level_task,
+                        player,
+                        player->thread_count);
+            }
+        }
+        else
         {
-            const int level_count =
-                Mixed_signal_plan_get_level_count(player->mixed_signal_plan);
+            // Synchronise with all threads to start mixed task execution
+            Barrier_wait(&player->mixed_start_barrier);
+
             for (int level_i = level_count - 1; level_i >= 0; --level_i)
             {
                 // Wait for each level to be finished
                 Barrier_wait(&player->mixed_level_finished_barrier);
             }
-
-            Mixed_signal_plan_reset(player->mixed_signal_plan);
         }
+
+        Mixed_signal_plan_reset(player->mixed_signal_plan);
     }
     else
 #endif
@@ -1310,6 +1556,116 @@ static void Player_apply_dc_blocker(
 }
 
 
+static void Player_reset_levels(Player* player)
+{
+    rassert(player != NULL);
+
+    static const Player_levels zero_levels = { .peak = 0, .rms = 0, .clipped = 0 };
+
+    for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
+        player->audio_levels[i] = zero_levels;
+
+    for (int stem = 0; stem < KQT_STEMS_MAX; ++stem)
+    {
+        for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
+            player->stems[stem].levels[i] = zero_levels;
+    }
+
+    return;
+}
+
+
+static void write_output(
+        float* out_buf,
+        const float* in_buf,
+        float scale,
+        int32_t frame_count,
+        Player_levels* levels)
+{
+    rassert(frame_count >= 0);
+    rassert(implies(frame_count > 0, out_buf != NULL));
+    rassert(levels != NULL);
+
+    float peak = 0;
+    double sum_squares = 0;
+    int32_t clipped = 0;
+
+    if (frame_count > 0)
+    {
+        if (in_buf != NULL)
+            kernel_scale_measure(
+                    out_buf, in_buf, scale, frame_count, &peak, &sum_squares, &clipped);
+        else
+            kernel_fill(out_buf, 0, frame_count);
+    }
+
+    levels->peak = peak;
+    levels->rms = (frame_count > 0) ? (float)sqrt(sum_squares / frame_count) : 0.0f;
+    levels->clipped = clipped;
+
+    return;
+}
+
+
+static void Player_fill_stems(Player* player, int32_t frame_count)
+{
+    rassert(player != NULL);
+    rassert(frame_count >= 0);
+
+    const float mix_vol = (float)player->module->mix_vol;
+
+    for (int stem = 0; stem < KQT_STEMS_MAX; ++stem)
+    {
+        Player_stem* pstem = &player->stems[stem];
+        if (pstem->source == PLAYER_STEM_NONE)
+            continue;
+
+        // Find the mixed signal buffers of the source
+        const Device_thread_state* source_ts = NULL;
+        Device_port_type port_type = DEVICE_PORT_TYPE_RECV;
+        int first_port = 0;
+
+        if (pstem->source == PLAYER_STEM_AUDIO_UNIT)
+        {
+            const Audio_unit* au =
+                Au_table_get(Module_get_au_table(player->module), pstem->index);
+            if ((au != NULL) && Device_is_existent((const Device*)au))
+            {
+                source_ts = Device_states_get_thread_state(
+                        player->device_states, 0, Device_get_id((const Device*)au));
+                port_type = DEVICE_PORT_TYPE_SEND;
+            }
+        }
+        else
+        {
+            rassert(pstem->source == PLAYER_STEM_MASTER_PORTS);
+            source_ts = Device_states_get_thread_state(
+                    player->device_states,
+                    0,
+                    Device_get_id((const Device*)player->module));
+            first_port = pstem->index;
+        }
+
+        for (int ch = 0; ch < KQT_BUFFERS_MAX; ++ch)
+        {
+            const Work_buffer* buffer = (source_ts != NULL)
+                ? Device_thread_state_get_mixed_buffer(
+                        source_ts, port_type, first_port + ch)
+                : NULL;
+
+            write_output(
+                    pstem->buffers[ch],
+                    (buffer != NULL) ? Work_buffer_get_contents(buffer) : NULL,
+                    mix_vol,
+                    frame_count,
+                    &pstem->levels[ch]);
+        }
+    }
+
+    return;
+}
+
+
 static void Player_apply_master_volume(
         Player* player, int32_t buf_start, int32_t buf_stop)
 {
@@ -1360,6 +1716,169 @@ static void Player_apply_master_volume(
 }
 
 
+static bool read_event(
+        Streader* event_reader,
+        const Event_names* event_names,
+        char* event_name,
+        Value* value)
+{
+    rassert(event_reader != NULL);
+    rassert(event_names != NULL);
+    rassert(event_name != NULL);
+    rassert(value != NULL);
+
+    Event_type type = Event_NONE;
+
+    // Get event name
+    if (!get_event_type_info(event_reader, event_names, event_name, &type))
+        return false;
+
+    // Get event argument
+    value->type = Event_names_get_param_type(event_names, event_name);
+
+    switch (value->type)
+    {
+        case VALUE_TYPE_NONE:
+            Streader_read_null(event_reader);
+            break;
+
+        case VALUE_TYPE_BOOL:
+            Streader_read_bool(event_reader, &value->value.bool_type);
+            break;
+
+        case VALUE_TYPE_INT:
+            Streader_read_int(event_reader, &value->value.int_type);
+            break;
+
+        case VALUE_TYPE_FLOAT:
+            Streader_read_float(event_reader, &value->value.float_type);
+            break;
+
+        case VALUE_TYPE_TSTAMP:
+            Streader_read_tstamp(event_reader, &value->value.Tstamp_type);
+            break;
+
+        case VALUE_TYPE_STRING:
+            Streader_read_string(
+                    event_reader, KQT_VAR_NAME_MAX + 1, value->value.string_type);
+            break;
+
+        case VALUE_TYPE_PAT_INST_REF:
+            Streader_read_piref(event_reader, &value->value.Pat_inst_ref_type);
+            break;
+
+        case VALUE_TYPE_REALTIME:
+            Streader_read_finite_rt(event_reader, value);
+            break;
+
+        case VALUE_TYPE_MAYBE_STRING:
+        {
+            if (Streader_read_null(event_reader))
+            {
+                value->type = VALUE_TYPE_NONE;
+            }
+            else
+            {
+                value->type = VALUE_TYPE_STRING;
+                Streader_clear_error(event_reader);
+                Streader_read_string(
+                        event_reader, KQT_VAR_NAME_MAX + 1, value->value.string_type);
+            }
+        }
+        break;
+
+        case VALUE_TYPE_MAYBE_REALTIME:
+        {
+            if (Streader_read_null(event_reader))
+            {
+                value->type = VALUE_TYPE_NONE;
+            }
+            else
+            {
+                value->type = VALUE_TYPE_STRING;
+                Streader_clear_error(event_reader);
+                Streader_read_finite_rt(event_reader, value);
+            }
+        }
+        break;
+
+        default:
+            rassert(false);
+    }
+
+    return Streader_match_char(event_reader, ']');
+}
+
+
+static void Player_fire_parsed(
+        Player* player, int ch, const char* event_name, const Value* value)
+{
+    rassert(player != NULL);
+    rassert(ch >= 0);
+    rassert(ch < KQT_CHANNELS_MAX);
+    rassert(event_name != NULL);
+    rassert(value != NULL);
+
+    // Fire
+    const bool skip = false;
+    const bool external = true;
+    Player_process_event(player, ch, event_name, value, skip, external);
+
+    // Check and perform goto if needed
+    Player_check_perform_goto(player);
+
+    // Store event parameters if processing was suspended
+    if (Event_buffer_is_skipping(player->event_buffer))
+    {
+        player->susp_event_ch = ch;
+        strcpy(player->susp_event_name, event_name);
+        Value_copy(&player->susp_event_value, value);
+    }
+    else
+    {
+        Event_buffer_reset_add_counter(player->event_buffer);
+    }
+
+    player->events_returned = false;
+
+    return;
+}
+
+
+/**
+ * Fire queued events that are due at the current rendering position.
+ *
+ * \return   The buffer index of the next queued event, or \a nframes if no
+ *           event is due during the current call.
+ */
+static int32_t Player_fire_queued_events(
+        Player* player, int64_t buf_start_time, int32_t rendered, int32_t nframes)
+{
+    rassert(player != NULL);
+    rassert(rendered >= 0);
+    rassert(rendered < nframes);
+
+    static const double ns_second = 1000000000.0;
+
+    const Queued_event* event = Event_queue_peek(player->event_queue);
+    while ((event != NULL) && !Event_buffer_is_skipping(player->event_buffer))
+    {
+        const double offset = ceil(
+                (double)(event->time - buf_start_time) *
+                ((double)player->audio_rate / ns_second));
+        if (offset > rendered)
+            return (int32_t)min(offset, nframes);
+
+        Player_fire_parsed(player, event->ch, event->name, &event->arg);
+        Event_queue_pop(player->event_queue);
+
+        event = Event_queue_peek(player->event_queue);
+    }
+
+    return nframes;
+}
+
+
 static void Player_init_final(Player* player)
 {
     rassert(player != NULL);
@@ -1372,6 +1891,7 @@ static void Player_init_final(Player* player)
 
     for (int i = 0; i < KQT_CHANNELS_MAX; ++i)
         Cgiter_reset(&player->cgiters[i], &player->master_params.cur_pos);
+    Trigger_row_queue_invalidate(&player->row_queue);
 
     return;
 }
@@ -1383,6 +1903,10 @@ void Player_play(Player* player, int32_t nframes)
     rassert(player->audio_buffer_size > 0);
     rassert(nframes >= 0);
 
+    const unsigned int fp_state = denormals_flush_enable();
+
+    Render_checks* prev_checks = Render_checks_enter_scope(&player->render_checks);
+
     Player_flush_receive(player);
 
     Event_buffer_clear(player->event_buffer);
@@ -1408,11 +1932,18 @@ void Player_play(Player* player, int32_t nframes)
 
     // Composition-level progress
     const bool was_playing = !Player_has_stopped(player);
+    const int64_t buf_start_time = Player_get_nanoseconds(player);
     int32_t rendered = 0;
     while (rendered < nframes && !Event_buffer_is_full(player->event_buffer))
     {
+        // Fire queued events and stop at the next one
+        const int32_t next_event_pos = Player_fire_queued_events(
+                player, buf_start_time, rendered, nframes);
+        if (Event_buffer_is_full(player->event_buffer))
+            break;
+
         // Move forwards in composition
-        int32_t to_be_rendered = nframes - rendered;
+        int32_t to_be_rendered = next_event_pos - rendered;
         if (!player->master_params.parent.pause && !Player_has_stopped(player))
         {
             if (!player->cgiters_accessed)
@@ -1489,35 +2020,32 @@ void Player_play(Player* player, int32_t nframes)
         // Note: we only access as many ports as we can output
         for (int32_t port = 0; port < KQT_BUFFERS_MAX; ++port)
         {
-            float* out_buf = player->audio_buffers[port];
-
-            Work_buffer* buffer = Device_thread_state_get_mixed_buffer(
+            const Work_buffer* buffer = Device_thread_state_get_mixed_buffer(
                     master_ts, DEVICE_PORT_TYPE_RECV, port);
 
-            if (buffer != NULL)
-            {
-                // Apply render volume
-                const float* buf = Work_buffer_get_contents(buffer);
-
-                const float mix_vol = (float)player->module->mix_vol;
-                for (int32_t i = 0; i < rendered; ++i)
-                    out_buf[i] = buf[i] * mix_vol;
-            }
-            else
-            {
-                // Fill with zeroes if we haven't produced any sound
-                for (int32_t i = 0; i < rendered; ++i)
-                    player->audio_buffers[port][i] = 0;
-            }
+            // Apply render volume and measure the output levels, or fill with
+            // zeroes if we haven't produced any sound
+            write_output(
+                    player->audio_buffers[port],
+                    (buffer != NULL) ? Work_buffer_get_contents(buffer) : NULL,
+                    (float)player->module->mix_vol,
+                    rendered,
+                    &player->audio_levels[port]);
         }
     }
 
+    Player_fill_stems(player, rendered);
+
     player->audio_frames_available = rendered;
 
     player->audio_frames_processed += rendered;
 
     player->events_returned = false;
 
+    Render_checks_leave_scope(prev_checks);
+
+    denormals_flush_restore(fp_state);
+
     return;
 }
 
@@ -1530,6 +2058,7 @@ void Player_skip(Player* player, int64_t nframes)
     // Clear buffers as we're not providing meaningful output
     Event_buffer_clear(player->event_buffer);
     player->audio_frames_available = 0;
+    Player_reset_levels(player);
 
     if (Player_has_stopped(player) || player->master_params.parent.pause)
         return;
@@ -1589,6 +2118,90 @@ const float* Player_get_audio(const Player* player, int channel)
 }
 
 
+bool Player_set_stem(Player* player, int stem, Player_stem_source source, int index)
+{
+    rassert(player != NULL);
+    rassert(stem >= 0);
+    rassert(stem < KQT_STEMS_MAX);
+    rassert(implies(source == PLAYER_STEM_AUDIO_UNIT,
+                (index >= 0) && (index < KQT_AUDIO_UNITS_MAX)));
+    rassert(implies(source == PLAYER_STEM_MASTER_PORTS,
+                (index >= 0) && (index < KQT_DEVICE_PORTS_MAX - 1)));
+
+    Player_stem* pstem = &player->stems[stem];
+
+    if (source == PLAYER_STEM_NONE)
+    {
+        for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
+        {
+            memory_free(pstem->buffers[i]);
+            pstem->buffers[i] = NULL;
+        }
+
+        pstem->source = PLAYER_STEM_NONE;
+        pstem->index = 0;
+
+        return true;
+    }
+
+    if (player->audio_buffer_size > 0)
+    {
+        for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
+        {
+            if (pstem->buffers[i] != NULL)
+                continue;
+
+            pstem->buffers[i] = memory_calloc_items(float, player->audio_buffer_size);
+            if (pstem->buffers[i] == NULL)
+                return false;
+        }
+    }
+
+    pstem->source = source;
+    pstem->index = index;
+
+    return true;
+}
+
+
+const float* Player_get_stem_audio(const Player* player, int stem, int channel)
+{
+    rassert(player != NULL);
+    rassert(stem >= 0);
+    rassert(stem < KQT_STEMS_MAX);
+    rassert(channel == 0 || channel == 1);
+
+    const Player_stem* pstem = &player->stems[stem];
+    if (pstem->source == PLAYER_STEM_NONE)
+        return NULL;
+
+    return pstem->buffers[channel];
+}
+
+
+const Player_levels* Player_get_levels(const Player* player, int channel)
+{
+    rassert(player != NULL);
+    rassert(channel == 0 || channel == 1);
+    return &player->audio_levels[channel];
+}
+
+
+const Player_levels* Player_get_stem_levels(const Player* player, int stem, int channel)
+{
+    rassert(player != NULL);
+    rassert(stem >= 0);
+    rassert(stem < KQT_STEMS_MAX);
+    rassert(channel == 0 || channel == 1);
+
+    const Player_stem* pstem = &player->stems[stem];
+    if (pstem->source == PLAYER_STEM_NONE)
+        return NULL;
+
+    return &pstem->levels[channel];
+}
+
+
 const char* Player_get_events(Player* player)
 {
     rassert(player != NULL);
@@ -1641,112 +2254,34 @@ bool Player_fire(Player* player, int ch, Streader* event_reader)
     const Event_names* event_names = Event_handler_get_names(player->event_handler);
 
     char event_name[KQT_EVENT_NAME_MAX + 1] = "";
-    Event_type type = Event_NONE;
-
-    // Get event name
-    if (!get_event_type_info(event_reader, event_names, event_name, &type))
-        return false;
-
-    // Get event argument
     Value* value = VALUE_AUTO;
-    value->type = Event_names_get_param_type(event_names, event_name);
-
-    switch (value->type)
-    {
-        case VALUE_TYPE_NONE:
-            Streader_read_null(event_reader);
-            break;
-
-        case VALUE_TYPE_BOOL:
-            Streader_read_bool(event_reader, &value->value.bool_type);
-            break;
-
-        case VALUE_TYPE_INT:
-            Streader_read_int(event_reader, &value->value.int_type);
-            break;
-
-        case VALUE_TYPE_FLOAT:
-            Streader_read_float(event_reader, &value->value.float_type);
-            break;
-
-        case VALUE_TYPE_TSTAMP:
-            Streader_read_tstamp(event_reader, &value->value.Tstamp_type);
-            break;
-
-        case VALUE_TYPE_STRING:
-            Streader_read_string(
-                    event_reader, KQT_VAR_NAME_MAX + 1, value->value.string_type);
-            break;
+    if (!read_event(event_reader, event_names, event_name, value))
+        return false;
 
-        case VALUE_TYPE_PAT_INST_REF:
-            Streader_read_piref(event_reader, &value->value.Pat_inst_ref_type);
-            break;
+    Player_fire_parsed(player, ch, event_name, value);
 
-        case VALUE_TYPE_REALTIME:
-            Streader_read_finite_rt(event_reader, value);
-            break;
-
-        case VALUE_TYPE_MAYBE_STRING:
-        {
-            if (Streader_read_null(event_reader))
-            {
-                value->type = VALUE_TYPE_NONE;
-            }
-            else
-            {
-                value->type = VALUE_TYPE_STRING;
-                Streader_clear_error(event_reader);
-                Streader_read_string(
-                        event_reader, KQT_VAR_NAME_MAX + 1, value->value.string_type);
-            }
-        }
-        break;
+    return true;
+}
 
-        case VALUE_TYPE_MAYBE_REALTIME:
-        {
-            if (Streader_read_null(event_reader))
-            {
-                value->type = VALUE_TYPE_NONE;
-            }
-            else
-            {
-                value->type = VALUE_TYPE_STRING;
-                Streader_clear_error(event_reader);
-                Streader_read_finite_rt(event_reader, value);
-            }
-        }
-        break;
 
-        default:
-            rassert(false);
-    }
+bool Player_queue_event(Player* player, int ch, Streader* event_reader, int64_t time)
+{
+    rassert(player != NULL);
+    rassert(ch >= 0);
+    rassert(ch < KQT_CHANNELS_MAX);
+    rassert(event_reader != NULL);
 
-    if (!Streader_match_char(event_reader, ']'))
+    if (Streader_is_error_set(event_reader))
         return false;
 
-    // Fire
-    const bool skip = false;
-    const bool external = true;
-    Player_process_event(player, ch, event_name, value, skip, external);
-
-    // Check and perform goto if needed
-    Player_check_perform_goto(player);
-
-    // Store event parameters if processing was suspended
-    if (Event_buffer_is_skipping(player->event_buffer))
-    {
-        player->susp_event_ch = ch;
-        strcpy(player->susp_event_name, event_name);
-        Value_copy(&player->susp_event_value, value);
-    }
-    else
-    {
-        Event_buffer_reset_add_counter(player->event_buffer);
-    }
+    const Event_names* event_names = Event_handler_get_names(player->event_handler);
 
-    player->events_returned = false;
+    Queued_event* event = &(Queued_event){ .time = time, .ch = ch, .name = "" };
+    event->arg = *VALUE_AUTO;
+    if (!read_event(event_reader, event_names, event->name, &event->arg))
+        return false;
 
-    return true;
+    return Event_queue_push(player->event_queue, event);
 }
 
 
@@ -1755,7 +2290,7 @@ void del_Player(Player* player)
     if (player == NULL)
         return;
 
-    if (player->thread_count > 1)
+    if ((player->thread_count > 1) && (player->thread_pool == NULL))
     {
         // Initialised threads are waiting on vgroups_start_barrier
         player->stop_threads = true;
@@ -1784,6 +2319,7 @@ void del_Player(Player* player)
     Master_params_deinit(&player->master_params);
     for (int i = 0; i < KQT_THREADS_MAX; ++i)
         Player_thread_params_deinit(&player->thread_params[i]);
+    del_Event_queue(player->event_queue);
     del_Event_buffer(player->event_buffer);
     del_Env_state(player->estate);
     del_Device_states(player->device_states);
@@ -1791,6 +2327,12 @@ void del_Player(Player* player)
     for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
         memory_free(player->audio_buffers[i]);
 
+    for (int stem = 0; stem < KQT_STEMS_MAX; ++stem)
+    {
+        for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
+            memory_free(player->stems[stem].buffers[i]);
+    }
+
     memory_free(player);
     return;
 }
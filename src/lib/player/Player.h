@@ -16,12 +16,15 @@
 #define KQT_PLAYER_PLAYER_H
 
 
+#include <debug/Render_checks.h>
 #include <Error.h>
 #include <init/devices/Au_streams.h>
 #include <init/Module.h>
 #include <kunquat/limits.h>
 #include <player/Event_handler.h>
 #include <string/Streader.h>
+#include <threads/Thread.h>
+#include <threads/Thread_pool.h>
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -35,6 +38,28 @@
 typedef struct Player Player;
 
 
+/**
+ * Sources of stem output.
+ */
+typedef enum
+{
+    PLAYER_STEM_NONE = 0,       ///< The stem is disabled.
+    PLAYER_STEM_AUDIO_UNIT,     ///< The output of a top-level audio unit.
+    PLAYER_STEM_MASTER_PORTS,   ///< A pair of master input ports.
+} Player_stem_source;
+
+
+/**
+ * Audio levels of one output channel in the most recently rendered block.
+ */
+typedef struct Player_levels
+{
+    float peak;         ///< The peak absolute sample value.
+    float rms;          ///< The RMS level.
+    int32_t clipped;    ///< The number of samples outside [-1, 1].
+} Player_levels;
+
+
 /**
  * Create a new Player.
  *
@@ -73,9 +98,25 @@ const Event_handler* Player_get_event_handler(const Player* player);
 Device_states* Player_get_device_states(const Player* player);
 
 
+/**
+ * Set a shared Thread pool for audio rendering.
+ *
+ * When a Thread pool is set, the Player does not create threads of its own
+ * but executes its rendering tasks in \a pool.
+ *
+ * \param player   The Player -- must not be \c NULL and must use a single
+ *                 thread.
+ * \param pool     The Thread pool, or \c NULL for private threads.
+ */
+void Player_set_thread_pool(Player* player, Thread_pool* pool);
+
+
 /**
  * Set the number of threads used by the Player for audio rendering.
  *
+ * If the Player uses a Thread pool, \a new_count is the number of rendering
+ * tasks executed in parallel in the pool.
+ *
  * \param player      The Player -- must not be \c NULL.
  * \param new_count   The number of threads -- must be >= \c 1 and
  *                    < \c KQT_THREADS_MAX.
@@ -87,41 +128,83 @@ bool Player_set_thread_count(Player* player, int new_count, Error* error);
 
 
 /**
- * Get the number of threads used by the Player for audio rendering.
+ * Set the scheduling policy of the rendering threads of the Player.
+ *
+ * If setting the policy fails, the rendering threads retain their previous
+ * scheduling. Threads created later inherit the policy if possible, and
+ * remain at default scheduling otherwise. Threads of a shared Thread pool are
+ * not affected.
+ *
+ * \param player     The Player -- must not be \c NULL.
+ * \param policy     The scheduling policy -- must be valid.
+ * \param priority   The priority used with a realtime \a policy.
+ * \param error      Destination for error information -- must not be \c NULL.
+ *
+ * \return   \c true if successful, otherwise \c false.
+ */
+bool Player_set_thread_scheduling(
+        Player* player, Thread_sched_policy policy, int priority, Error* error);
+
+
+/**
+ * Set the CPU affinity of a rendering thread of the Player.
+ *
+ * The affinity is applied when the thread is created if it does not exist yet.
+ * Threads of a shared Thread pool are not affected.
+ *
+ * \param player         The Player -- must not be \c NULL.
+ * \param thread_index   The thread index -- must be >= \c 0 and
+ *                       < \c KQT_THREADS_MAX.
+ * \param cpu_mask       The set of allowed CPUs with bit \a n set for CPU
+ *                       \a n, or \c 0 for all CPUs.
+ * \param error          Destination for error information -- must not be
+ *                       \c NULL.
+ *
+ * \return   \c true if successful, otherwise \c false.
+ */
+bool Player_set_thread_affinity(
+        Player* player, int thread_index, uint64_t cpu_mask, Error* error);
+
+
+/**
+ * Get the Render checks of the Player.
+ *
+ * The Render checks contain the operations reported during audio rendering
+ * by the Player. See debug/Render_checks.h for details.
  *
  * \param player   The Player -- must not be \c NULL.
  *
- * \return   The number of threads.
+ * \return   The Render checks.
  */
-int Player_get_thread_count(const Player* player);
+const Render_checks* Player_get_render_checks(const Player* player);
 
 
 /**
- * Reserve state space for internal voice pool.
+ * Get the number of threads used by the Player for audio rendering.
  *
  * \param player   The Player -- must not be \c NULL.
- * \param size     The new size -- must be >= \c 0.
  *
- * \return   \c true if successful, or \c false if memory allocation failed.
+ * \return   The number of threads.
  */
-bool Player_reserve_voice_state_space(Player* player, int32_t size);
+int Player_get_thread_count(const Player* player);
 
 
 /**
- * Get the current Voice work buffer size in the Player.
+ * Reserve state space for internal voice pool.
  *
  * \param player   The Player -- must not be \c NULL.
+ * \param size     The new size -- must be >= \c 0.
  *
- * \return   The current buffer size.
+ * \return   \c true if successful, or \c false if memory allocation failed.
  */
-int32_t Player_get_voice_work_buffer_size(const Player* player);
+bool Player_reserve_voice_state_space(Player* player, int32_t size);
 
 
 /**
- * Reserve Work buffers for voices.
+ * Reserve Work buffers of a given size for voices.
  *
  * \param player   The Player -- must not be \c NULL.
- * \param size     The new size -- must be >= \c 0 and
+ * \param size     The buffer size -- must be >= \c 0 and
  *                 <= \c VOICE_WORK_BUFFER_SIZE_MAX.
  *
  * \return   \c true if successful, or \c false if memory allocation failed.
@@ -132,6 +215,11 @@ bool Player_reserve_voice_work_buffer_space(Player* player, int32_t size);
 /**
  * Prepare signal mixing in the Player.
  *
+ * The mixed signal plan is rebuilt synchronously on the calling thread. The
+ * previous plan is discarded first as it refers to the work buffers of the
+ * Device states, which are updated in place, so this must not be called
+ * while the Player is rendering.
+ *
  * \param player   The Player -- must not be \c NULL.
  *
  * \return   \c true if successful, or \c false if memory allocation failed.
@@ -295,6 +383,69 @@ int32_t Player_get_frames_available(const Player* player);
 const float* Player_get_audio(const Player* player, int channel);
 
 
+/**
+ * Set the source of a stem.
+ *
+ * The stem buffers are filled in Player_play from the mixed signal buffers
+ * of the source, so all stems are produced in the same rendering pass as
+ * the main output.
+ *
+ * \param player   The Player -- must not be \c NULL.
+ * \param stem     The stem number -- must be >= \c 0 and
+ *                 < \c KQT_STEMS_MAX.
+ * \param source   The type of the source.
+ * \param index    The audio unit index -- must be >= \c 0 and
+ *                 < \c KQT_AUDIO_UNITS_MAX with \c PLAYER_STEM_AUDIO_UNIT,
+ *                 or the first master port -- must be >= \c 0 and
+ *                 < \c KQT_DEVICE_PORTS_MAX - 1 with
+ *                 \c PLAYER_STEM_MASTER_PORTS. Ignored with
+ *                 \c PLAYER_STEM_NONE.
+ *
+ * \return   \c true if successful, or \c false if memory allocation failed.
+ */
+bool Player_set_stem(Player* player, int stem, Player_stem_source source, int index);
+
+
+/**
+ * Return an internal stem buffer.
+ *
+ * \param player    The Player -- must not be \c NULL.
+ * \param stem      The stem number -- must be >= \c 0 and
+ *                  < \c KQT_STEMS_MAX.
+ * \param channel   The channel number -- must be \c 0 or \c 1.
+ *
+ * \return   The stem buffer, or \c NULL if the stem is disabled.
+ */
+const float* Player_get_stem_audio(const Player* player, int stem, int channel);
+
+
+/**
+ * Return the audio levels of the most recently rendered output.
+ *
+ * The levels are measured while the output buffers are filled, and they
+ * describe the same frames as the buffers returned by \a Player_get_audio.
+ *
+ * \param player    The Player -- must not be \c NULL.
+ * \param channel   The channel number -- must be \c 0 or \c 1.
+ *
+ * \return   The audio levels.
+ */
+const Player_levels* Player_get_levels(const Player* player, int channel);
+
+
+/**
+ * Return the audio levels of the most recently rendered stem output.
+ *
+ * \param player    The Player -- must not be \c NULL.
+ * \param stem      The stem number -- must be >= \c 0 and
+ *                  < \c KQT_STEMS_MAX.
+ * \param channel   The channel number -- must be \c 0 or \c 1.
+ *
+ * \return   The audio levels, or \c NULL if the stem is disabled.
+ */
+const Player_levels* Player_get_stem_levels(const Player* player, int stem, int channel);
+
+
 /**
  * Return an internal event buffer.
  *
@@ -342,6 +493,29 @@ void Player_set_channel_mute(Player* player, int ch, bool mute);
 bool Player_fire(Player* player, int ch, Streader* event_reader);
 
 
+/**
+ * Queue an event to be fired during playback.
+ *
+ * This function may be called from any thread, also concurrently with
+ * \a Player_play. The event is fired in \a Player_play at the first frame at
+ * or after \a time. Events with a time in the past are fired at the start of
+ * the next rendered block. Events are fired in the order they are queued, so
+ * the times of subsequent events should not decrease.
+ *
+ * \param player         The Player -- must not be \c NULL.
+ * \param ch             The channel number -- must be >= \c 0 and
+ *                       < \c KQT_CHANNELS_MAX.
+ * \param event_reader   The event reader -- must not be \c NULL.
+ * \param time           The playback time of the event in nanoseconds, as
+ *                       returned by \a Player_get_nanoseconds.
+ *
+ * \return   \c true if successful, or \c false if the event was invalid or
+ *           the event queue is full. The error of \a event_reader is set
+ *           only in the former case.
+ */
+bool Player_queue_event(Player* player, int ch, Streader* event_reader, int64_t time);
+
+
 /**
  * Destroy the Player.
  *
@@ -16,6 +16,7 @@
 #define KQT_PLAYER_PRIVATE_H
 
 
+#include <debug/Render_checks.h>
 #include <decl.h>
 #include <init/Environment.h>
 #include <kunquat/limits.h>
@@ -25,14 +26,17 @@
 #include <player/Env_state.h>
 #include <player/Event_buffer.h>
 #include <player/Event_handler.h>
+#include <player/Event_queue.h>
 #include <player/Master_params.h>
 #include <player/Player.h>
+#include <player/Trigger_row_queue.h>
 #include <player/Voice_pool.h>
 #include <player/Work_buffer.h>
 #include <player/Work_buffers.h>
 #include <threads/Barrier.h>
 #include <threads/Condition.h>
 #include <threads/Thread.h>
+#include <threads/Thread_pool.h>
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -52,6 +56,15 @@ typedef struct Player_thread_params
 } Player_thread_params;
 
 
+typedef struct Player_stem
+{
+    Player_stem_source source;
+    int index;
+    float* buffers[KQT_BUFFERS_MAX];
+    Player_levels levels[KQT_BUFFERS_MAX];
+} Player_stem;
+
+
 struct Player
 {
     const Module* module;
@@ -59,7 +72,9 @@ struct Player
     int32_t audio_rate;
     int32_t audio_buffer_size;
     float*  audio_buffers[KQT_BUFFERS_MAX];
+    Player_levels audio_levels[KQT_BUFFERS_MAX];
     int32_t audio_frames_available;
+    Player_stem stems[KQT_STEMS_MAX];
 
     int thread_count;
     Player_thread_params thread_params[KQT_THREADS_MAX];
@@ -73,10 +88,17 @@ struct Player
     bool stop_threads;
     int32_t render_start;
     int32_t render_stop;
+    Thread_pool* thread_pool;
+    int render_level;
+    Thread_sched_policy sched_policy;
+    int sched_priority;
+    uint64_t thread_affinities[KQT_THREADS_MAX];
+    Render_checks render_checks;
 
     Device_states* device_states;
     Env_state*     estate;
     Event_buffer*  event_buffer;
+    Event_queue*   event_queue;
     Voice_pool*    voices;
     Mixed_signal_plan* mixed_signal_plan;
     Master_params  master_params;
@@ -87,6 +109,7 @@ struct Player
 
     bool cgiters_accessed;
     Cgiter cgiters[KQT_CHANNELS_MAX];
+    Trigger_row_queue row_queue;
 
     // Position tracking
     int64_t audio_frames_processed;
@@ -60,6 +60,21 @@ bool get_event_type_info(
 }
 
 
+static bool convert_expr_result(Value_type field_type, Value* value)
+{
+    rassert(value != NULL);
+
+    if (field_type == VALUE_TYPE_REALTIME)
+        return Value_type_is_realtime(value->type);
+    else if (field_type == VALUE_TYPE_MAYBE_STRING)
+        return (value->type == VALUE_TYPE_NONE) || (value->type == VALUE_TYPE_STRING);
+    else if (field_type == VALUE_TYPE_MAYBE_REALTIME)
+        return (value->type == VALUE_TYPE_NONE) || Value_type_is_realtime(value->type);
+
+    return Value_convert(value, value, field_type);
+}
+
+
 static bool process_expr(
         Streader* expr_reader,
         Value_type field_type,
@@ -106,33 +121,7 @@ static bool process_expr(
         if (Streader_is_error_set(expr_reader))
             return false;
 
-        if (field_type == VALUE_TYPE_REALTIME)
-        {
-            if (!Value_type_is_realtime(ret_value->type))
-            {
-                Streader_set_error(expr_reader, "Type mismatch");
-                return false;
-            }
-        }
-        else if (field_type == VALUE_TYPE_MAYBE_STRING)
-        {
-            if (ret_value->type != VALUE_TYPE_NONE &&
-                    ret_value->type != VALUE_TYPE_STRING)
-            {
-                Streader_set_error(expr_reader, "Type mismatch");
-                return false;
-            }
-        }
-        else if (field_type == VALUE_TYPE_MAYBE_REALTIME)
-        {
-            if (ret_value->type != VALUE_TYPE_NONE &&
-                    !Value_type_is_realtime(ret_value->type))
-            {
-                Streader_set_error(expr_reader, "Type mismatch");
-                return false;
-            }
-        }
-        else if (!Value_convert(ret_value, ret_value, field_type))
+        if (!convert_expr_result(field_type, ret_value))
         {
             Streader_set_error(expr_reader, "Type mismatch");
             return false;
@@ -152,6 +141,15 @@ static void Player_process_expr_event(
         bool external);
 
 
+static void Player_process_bound_event(
+        Player* player,
+        int ch_num,
+        const Target_event* bound,
+        const Value* meta,
+        bool skip,
+        bool external);
+
+
 void Player_process_event(
         Player* player,
         int ch_num,
@@ -191,7 +189,8 @@ void Player_process_event(
                 player->module->bind,
                 player->channels[ch_num]->event_cache,
                 player->estate,
-                event_name,
+                type,
+                string_has_suffix(event_name, "\""),
                 arg,
                 &player->channels[ch_num]->rand);
         while (bound != NULL)
@@ -204,10 +203,10 @@ void Player_process_event(
                 return;
             }
 
-            Player_process_expr_event(
+            Player_process_bound_event(
                     player,
                     (ch_num + bound->ch_offset + KQT_CHANNELS_MAX) % KQT_CHANNELS_MAX,
-                    bound->desc,
+                    bound,
                     arg,
                     skip,
                     external);
@@ -376,6 +375,97 @@ static void Player_process_expr_event(
 }
 
 
+static void Player_process_bound_event(
+        Player* player,
+        int ch_num,
+        const Target_event* bound,
+        const Value* meta,
+        bool skip,
+        bool external)
+{
+    rassert(player != NULL);
+    rassert(implies(!skip, !Event_buffer_is_full(player->event_buffer)));
+    rassert(ch_num >= 0);
+    rassert(ch_num < KQT_CHANNELS_MAX);
+    rassert(bound != NULL);
+
+    // Fall back to parsing the event description if it could not be compiled
+    if (!bound->has_literal_arg && (bound->arg_expr == NULL))
+    {
+        Player_process_expr_event(player, ch_num, bound->desc, meta, skip, external);
+        return;
+    }
+
+    Value* arg = VALUE_AUTO;
+
+    if (bound->has_literal_arg)
+    {
+        Value_copy(arg, &bound->literal_arg);
+    }
+    else if (!Compiled_expr_evaluate(
+                bound->arg_expr,
+                player->estate,
+                meta,
+                arg,
+                &player->channels[ch_num]->rand) ||
+            !convert_expr_result(bound->arg_type, arg))
+    {
+        fprintf(stderr, "Couldn't evaluate `%s`\n", bound->desc);
+        return;
+    }
+
+    if (!Event_is_control(bound->type) || player->master_params.is_infinite)
+        Player_process_event(player, ch_num, bound->event_name, arg, skip, external);
+
+    return;
+}
+
+
+static void Player_process_trigger_event(
+        Player* player, int ch_num, const Trigger* trigger, bool skip)
+{
+    rassert(player != NULL);
+    rassert(implies(!skip, !Event_buffer_is_full(player->event_buffer)));
+    rassert(ch_num >= 0);
+    rassert(ch_num < KQT_CHANNELS_MAX);
+    rassert(trigger != NULL);
+
+    const bool external = false;
+
+    // Fall back to parsing the trigger description if it could not be compiled
+    if (!trigger->has_literal_arg && (trigger->arg_expr == NULL))
+    {
+        Player_process_expr_event(
+                player, ch_num, trigger->desc, NULL, skip, external);
+        return;
+    }
+
+    Value* arg = VALUE_AUTO;
+
+    if (trigger->has_literal_arg)
+    {
+        Value_copy(arg, &trigger->literal_arg);
+    }
+    else if (!Compiled_expr_evaluate(
+                trigger->arg_expr,
+                player->estate,
+                NULL, // no meta value
+                arg,
+                &player->channels[ch_num]->rand) ||
+            !convert_expr_result(trigger->arg_type, arg))
+    {
+        fprintf(stderr, "Couldn't evaluate `%s`\n", trigger->desc);
+        return;
+    }
+
+    if (!Event_is_control(trigger->type) || player->master_params.is_infinite)
+        Player_process_event(
+                player, ch_num, trigger->event_name, arg, skip, external);
+
+    return;
+}
+
+
 void Player_reset_channels(Player* player)
 {
     // Reset channels
@@ -426,6 +516,7 @@ static void Player_start_pattern_playback_mode(Player* player)
     // Move cgiters to the new pattern
     for (int i = 0; i < KQT_CHANNELS_MAX; ++i)
         Cgiter_reset(&player->cgiters[i], &player->master_params.cur_pos);
+    Trigger_row_queue_invalidate(&player->row_queue);
 
     return;
 }
@@ -479,6 +570,7 @@ static void Player_set_new_playback_position(
 
         for (int k = 0; k < KQT_CHANNELS_MAX; ++k)
             Cgiter_reset(&player->cgiters[k], &target_pos);
+        Trigger_row_queue_invalidate(&player->row_queue);
 
         // Set the new position as a global reference
         player->master_params.cur_pos = target_pos;
@@ -514,6 +606,34 @@ bool Player_check_perform_goto(Player* player)
 }
 
 
+static void Player_queue_next_row(Player* player, int ch)
+{
+    rassert(player != NULL);
+    rassert(ch >= 0);
+    rassert(ch < KQT_CHANNELS_MAX);
+
+    Tstamp* row_pos = TSTAMP_AUTO;
+    if (Cgiter_get_next_row_pos(&player->cgiters[ch], row_pos))
+        Trigger_row_queue_push(&player->row_queue, ch, row_pos);
+
+    return;
+}
+
+
+static void Player_fill_row_queue(Player* player)
+{
+    rassert(player != NULL);
+
+    Trigger_row_queue_clear(
+            &player->row_queue, &player->cgiters[0].pos, player->module->data_version);
+
+    for (int i = 0; i < KQT_CHANNELS_MAX; ++i)
+        Player_queue_next_row(player, i);
+
+    return;
+}
+
+
 void Player_process_cgiters(Player* player, Tstamp* limit, bool skip)
 {
     rassert(player != NULL);
@@ -554,44 +674,47 @@ void Player_process_cgiters(Player* player, Tstamp* limit, bool skip)
         next_jump_trigger = next_jc->order;
     }
 
-    // Check the nearest upcoming trigger row of iterators that are otherwise skipped
-    for (int i = 0; i < player->master_params.cur_ch; ++i)
-    {
-        Cgiter* cgiter = &player->cgiters[i];
-
-        Tstamp* dist = Tstamp_copy(TSTAMP_AUTO, limit);
-        if (Cgiter_peek(cgiter, dist))
-            Tstamp_mina(limit, dist);
-    }
+    // Make sure we know the upcoming trigger rows in this pattern instance
+    Trigger_row_queue* queue = &player->row_queue;
+    if (Trigger_row_queue_is_valid(
+                queue, &player->master_params.cur_pos, player->module->data_version))
+        Trigger_row_queue_set_position(queue, &player->master_params.cur_pos);
+    else
+        Player_fill_row_queue(player);
 
     // Process trigger rows at current position
-    for (int i = player->master_params.cur_ch; i < KQT_CHANNELS_MAX; ++i)
+    const Trigger_row_queue_entry* next_row = Trigger_row_queue_peek(queue);
+    while ((next_row != NULL) &&
+            (Tstamp_cmp(&next_row->pos, &player->cgiters[0].pos.pat_pos) <= 0))
     {
+        const int i = next_row->ch;
         Cgiter* cgiter = &player->cgiters[i];
 
         if (Cgiter_has_finished(cgiter)) // implies empty playback
             break;
 
+        if (i < player->master_params.cur_ch)
+        {
+            // Already processed at this position
+            Trigger_row_queue_pop(queue);
+            cgiter->row_returned = true;
+            Player_queue_next_row(player, i);
+
+            next_row = Trigger_row_queue_peek(queue);
+            continue;
+        }
+
+        player->master_params.cur_ch = i;
+
         const Trigger_row* tr = Cgiter_get_trigger_row(cgiter);
         if (tr != NULL)
         {
-            // Process trigger row
-            rassert(tr->head->next != NULL);
-            Trigger_list* trl = tr->head->next;
-
-            // Skip triggers if resuming
-            int trigger_index = 0;
-            while (trigger_index < player->master_params.cur_trigger &&
-                    trl->trigger != NULL)
-            {
-                ++trigger_index;
-                trl = trl->next;
-            }
-
-            // Process triggers
-            while (trl->trigger != NULL)
+            // Process triggers, skipping the ones already processed if resuming
+            for (int trigger_index = player->master_params.cur_trigger;
+                    trigger_index < tr->trigger_count;
+                    ++trigger_index)
             {
-                const Event_type event_type = Trigger_get_type(trl->trigger);
+                const Event_type event_type = tr->types[trigger_index];
 
                 const bool at_active_jump =
                     Tstamp_cmp(next_jump_row, &cgiter->pos.pat_pos) == 0 &&
@@ -653,15 +776,8 @@ void Player_process_cgiters(Player* player, Tstamp* limit, bool skip)
                                 return;
                             }
 
-                            const bool external = false;
-
-                            Player_process_expr_event(
-                                    player,
-                                    i,
-                                    Trigger_get_desc(trl->trigger),
-                                    NULL, // no meta value
-                                    skip,
-                                    external);
+                            Player_process_trigger_event(
+                                    player, i, tr->triggers[trigger_index], skip);
 
                             // Break if started event skipping
                             if (Event_buffer_is_skipping(player->event_buffer))
@@ -737,25 +853,38 @@ void Player_process_cgiters(Player* player, Tstamp* limit, bool skip)
                     Cgiter_clear_returned_status(cgiter);
                     return;
                 }
-
-                trl = trl->next;
             }
         }
 
         // All triggers processed in this column
         player->master_params.cur_trigger = 0;
-        ++player->master_params.cur_ch;
+        player->master_params.cur_ch = i + 1;
 
-        // See how much we can move forwards
-        Tstamp* dist = Tstamp_copy(TSTAMP_AUTO, limit);
-        if (Cgiter_peek(cgiter, dist))
-            Tstamp_mina(limit, dist);
+        if (queue->is_valid)
+        {
+            Trigger_row_queue_pop(queue);
+            Player_queue_next_row(player, i);
+        }
+        else
+        {
+            // Pattern playback was started, continue from the new position
+            Player_fill_row_queue(player);
+        }
+
+        next_row = Trigger_row_queue_peek(queue);
     }
 
     // All trigger rows processed
     player->master_params.cur_ch = 0;
     player->master_params.cur_trigger = 0;
 
+    // See how much we can move forwards
+    next_row = Trigger_row_queue_peek(queue);
+    Tstamp* dist = Tstamp_copy(TSTAMP_AUTO, limit);
+    if (Cgiter_peek_row(
+                &player->cgiters[0], (next_row != NULL) ? &next_row->pos : NULL, dist))
+        Tstamp_mina(limit, dist);
+
     // Break if tempo settings changed
     if (player->master_params.tempo_settings_changed)
     {
@@ -795,6 +924,7 @@ void Player_process_cgiters(Player* player, Tstamp* limit, bool skip)
                         &player->cgiters[i],
                         &player->master_params.start_pos);
             }
+            Trigger_row_queue_invalidate(&player->row_queue);
         }
         else
         {
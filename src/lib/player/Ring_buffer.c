@@ -0,0 +1,203 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <player/Ring_buffer.h>
+
+#include <debug/assert.h>
+#include <mathnum/common.h>
+#include <memory.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+struct Ring_buffer
+{
+    int32_t size;
+
+    // Contains the buffer contents twice, i.e. contents[i] == contents[i + size]
+    float* contents;
+};
+
+
+Ring_buffer* new_Ring_buffer(int32_t size)
+{
+    rassert(size > 0);
+    rassert(size <= RING_BUFFER_SIZE_MAX);
+
+    Ring_buffer* rb = memory_alloc_item(Ring_buffer);
+    if (rb == NULL)
+        return NULL;
+
+    rb->size = size;
+    rb->contents = memory_alloc_items(float, size * 2);
+    if (rb->contents == NULL)
+    {
+        del_Ring_buffer(rb);
+        return NULL;
+    }
+
+    Ring_buffer_clear(rb);
+
+    return rb;
+}
+
+
+bool Ring_buffer_resize(Ring_buffer* rb, int32_t new_size)
+{
+    rassert(rb != NULL);
+    rassert(new_size > 0);
+    rassert(new_size <= RING_BUFFER_SIZE_MAX);
+
+    if (new_size == rb->size)
+        return true;
+
+    float* new_contents = memory_realloc_items(float, new_size * 2, rb->contents);
+    if (new_contents == NULL)
+        return false;
+
+    rb->size = new_size;
+    rb->contents = new_contents;
+    Ring_buffer_clear(rb);
+
+    return true;
+}
+
+
+int32_t Ring_buffer_get_size(const Ring_buffer* rb)
+{
+    rassert(rb != NULL);
+    return rb->size;
+}
+
+
+void Ring_buffer_clear(Ring_buffer* rb)
+{
+    rassert(rb != NULL);
+
+    const int32_t total_size = rb->size * 2;
+    for (int32_t i = 0; i < total_size; ++i)
+        rb->contents[i] = 0;
+
+    return;
+}
+
+
+const float* Ring_buffer_get_window(const Ring_buffer* rb, int32_t pos)
+{
+    rassert(rb != NULL);
+    rassert(pos >= 0);
+    rassert(pos <= rb->size);
+
+    return rb->contents + pos;
+}
+
+
+float* Ring_buffer_get_window_mut(Ring_buffer* rb, int32_t pos)
+{
+    rassert(rb != NULL);
+    rassert(pos >= 0);
+    rassert(pos <= rb->size);
+
+    return rb->contents + pos;
+}
+
+
+void Ring_buffer_sync(Ring_buffer* rb, int32_t pos, int32_t count)
+{
+    rassert(rb != NULL);
+    rassert(pos >= 0);
+    rassert(pos <= rb->size);
+    rassert(count >= 0);
+    rassert(count <= rb->size);
+
+    const int32_t size = rb->size;
+    const int32_t stop = pos + count;
+
+    // Copy the part in the first half forwards and the part in the second half back
+    if (pos < size)
+    {
+        const int32_t first_stop = min(stop, size);
+        memcpy(rb->contents + pos + size,
+                rb->contents + pos,
+                sizeof(float) * (size_t)(first_stop - pos));
+    }
+
+    if (stop > size)
+    {
+        const int32_t second_start = max(pos, size);
+        memcpy(rb->contents + second_start - size,
+                rb->contents + second_start,
+                sizeof(float) * (size_t)(stop - second_start));
+    }
+
+    return;
+}
+
+
+int32_t Ring_buffer_write(Ring_buffer* rb, int32_t pos, const float* src, int32_t count)
+{
+    rassert(rb != NULL);
+    rassert(pos >= 0);
+    rassert(pos < rb->size);
+    rassert(src != NULL);
+    rassert(count >= 0);
+
+    const int32_t size = rb->size;
+
+    // Skip the frames that would be overwritten within this call
+    if (count > size)
+    {
+        const int32_t skip = count - size;
+        src += skip;
+        count = size;
+        pos = (int32_t)((pos + (int64_t)skip) % size);
+    }
+
+    memcpy(rb->contents + pos, src, sizeof(float) * (size_t)count);
+    Ring_buffer_sync(rb, pos, count);
+
+    const int32_t next_pos = pos + count;
+    return (next_pos >= size) ? next_pos - size : next_pos;
+}
+
+
+void Ring_buffer_mix_frame(Ring_buffer* rb, int32_t pos, float value)
+{
+    rassert(rb != NULL);
+    rassert(pos >= 0);
+    rassert(pos < rb->size);
+
+    const float sum = rb->contents[pos] + value;
+    rb->contents[pos] = sum;
+    rb->contents[pos + rb->size] = sum;
+
+    return;
+}
+
+
+void del_Ring_buffer(Ring_buffer* rb)
+{
+    if (rb == NULL)
+        return;
+
+    memory_free(rb->contents);
+    memory_free(rb);
+
+    return;
+}
+
+
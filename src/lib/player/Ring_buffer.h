@@ -0,0 +1,162 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#ifndef KQT_RING_BUFFER_H
+#define KQT_RING_BUFFER_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+#define RING_BUFFER_SIZE_MAX (INT32_MAX / 8)
+
+
+/**
+ * A circular buffer of audio frames with mirrored storage.
+ *
+ * The contents are stored twice in consecutive memory so that any window of
+ * up to the buffer size can be accessed linearly regardless of where it
+ * wraps around.
+ */
+typedef struct Ring_buffer Ring_buffer;
+
+
+/**
+ * Create a new Ring buffer.
+ *
+ * \param size   The buffer size -- must be > \c 0 and
+ *               <= \c RING_BUFFER_SIZE_MAX.
+ *
+ * \return   The new Ring buffer if successful, or \c NULL if memory allocation
+ *           failed. The contents of the new buffer are cleared.
+ */
+Ring_buffer* new_Ring_buffer(int32_t size);
+
+
+/**
+ * Resize the Ring buffer.
+ *
+ * The contents of the buffer are cleared if the size changes.
+ *
+ * \param rb         The Ring buffer -- must not be \c NULL.
+ * \param new_size   The new buffer size -- must be > \c 0 and
+ *                   <= \c RING_BUFFER_SIZE_MAX.
+ *
+ * \return   \c true if successful, or \c false if memory allocation failed.
+ */
+bool Ring_buffer_resize(Ring_buffer* rb, int32_t new_size);
+
+
+/**
+ * Get the size of the Ring buffer.
+ *
+ * \param rb   The Ring buffer -- must not be \c NULL.
+ *
+ * \return   The size of the buffer.
+ */
+int32_t Ring_buffer_get_size(const Ring_buffer* rb);
+
+
+/**
+ * Clear the Ring buffer with floating-point zeroes.
+ *
+ * \param rb   The Ring buffer -- must not be \c NULL.
+ */
+void Ring_buffer_clear(Ring_buffer* rb);
+
+
+/**
+ * Get a linear view to the contents of the Ring buffer.
+ *
+ * The returned pointer may be used for reading the buffer size of frames
+ * starting at \a pos. In other words, if the size of \a rb is \c n, the
+ * element at index \c i of the view is the frame at (\a pos + \c i) % \c n
+ * for \c 0 <= \c i < \c n.
+ *
+ * \param rb    The Ring buffer -- must not be \c NULL.
+ * \param pos   The start position -- must be >= \c 0 and <= the buffer size.
+ *
+ * \return   The start of the view.
+ */
+const float* Ring_buffer_get_window(const Ring_buffer* rb, int32_t pos);
+
+
+/**
+ * Get a mutable linear view to the contents of the Ring buffer.
+ *
+ * Modifications made through the returned view must be committed with
+ * \a Ring_buffer_sync before the modified area is accessed through another
+ * view.
+ *
+ * \param rb    The Ring buffer -- must not be \c NULL.
+ * \param pos   The start position -- must be >= \c 0 and <= the buffer size.
+ *
+ * \return   The start of the view.
+ */
+float* Ring_buffer_get_window_mut(Ring_buffer* rb, int32_t pos);
+
+
+/**
+ * Commit modifications made through a mutable view of the Ring buffer.
+ *
+ * \param rb      The Ring buffer -- must not be \c NULL.
+ * \param pos     The start position of the modified area -- must be >= \c 0
+ *                and <= the buffer size.
+ * \param count   The number of modified frames -- must be >= \c 0 and <= the
+ *                buffer size.
+ */
+void Ring_buffer_sync(Ring_buffer* rb, int32_t pos, int32_t count);
+
+
+/**
+ * Write frames to the Ring buffer.
+ *
+ * If \a count exceeds the buffer size, only the last frames of \a src that
+ * fit in the buffer are retained.
+ *
+ * \param rb      The Ring buffer -- must not be \c NULL.
+ * \param pos     The write position -- must be >= \c 0 and less than the buffer
+ *                size.
+ * \param src     The source frames -- must not be \c NULL.
+ * \param count   The number of frames to write -- must be >= \c 0.
+ *
+ * \return   The write position following the written frames.
+ */
+int32_t Ring_buffer_write(Ring_buffer* rb, int32_t pos, const float* src, int32_t count);
+
+
+/**
+ * Add a value to a single frame in the Ring buffer.
+ *
+ * \param rb      The Ring buffer -- must not be \c NULL.
+ * \param pos     The frame position -- must be >= \c 0 and less than the buffer
+ *                size.
+ * \param value   The value to be added.
+ */
+void Ring_buffer_mix_frame(Ring_buffer* rb, int32_t pos, float value);
+
+
+/**
+ * Destroy an existing Ring buffer.
+ *
+ * \param rb   The Ring buffer, or \c NULL.
+ */
+void del_Ring_buffer(Ring_buffer* rb);
+
+
+#endif // KQT_RING_BUFFER_H
+
+
@@ -0,0 +1,179 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <player/Trigger_row_queue.h>
+
+#include <debug/assert.h>
+#include <Pat_inst_ref.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+Trigger_row_queue* Trigger_row_queue_init(Trigger_row_queue* queue)
+{
+    rassert(queue != NULL);
+
+    queue->is_valid = false;
+    queue->data_version = 0;
+    Position_init(&queue->pos);
+    queue->count = 0;
+
+    return queue;
+}
+
+
+void Trigger_row_queue_invalidate(Trigger_row_queue* queue)
+{
+    rassert(queue != NULL);
+    queue->is_valid = false;
+    return;
+}
+
+
+bool Trigger_row_queue_is_valid(
+        const Trigger_row_queue* queue, const Position* pos, uint64_t data_version)
+{
+    rassert(queue != NULL);
+    rassert(pos != NULL);
+
+    return queue->is_valid &&
+        (queue->data_version == data_version) &&
+        (queue->pos.track == pos->track) &&
+        (queue->pos.system == pos->system) &&
+        (Pat_inst_ref_cmp(&queue->pos.piref, &pos->piref) == 0) &&
+        (Tstamp_cmp(&queue->pos.pat_pos, &pos->pat_pos) <= 0);
+}
+
+
+void Trigger_row_queue_clear(
+        Trigger_row_queue* queue, const Position* pos, uint64_t data_version)
+{
+    rassert(queue != NULL);
+    rassert(pos != NULL);
+
+    queue->is_valid = true;
+    queue->data_version = data_version;
+    queue->pos = *pos;
+    queue->count = 0;
+
+    return;
+}
+
+
+void Trigger_row_queue_set_position(Trigger_row_queue* queue, const Position* pos)
+{
+    rassert(queue != NULL);
+    rassert(pos != NULL);
+    rassert(Tstamp_cmp(&queue->pos.pat_pos, &pos->pat_pos) <= 0);
+
+    queue->pos = *pos;
+
+    return;
+}
+
+
+static bool entry_less(
+        const Trigger_row_queue_entry* e1, const Trigger_row_queue_entry* e2)
+{
+    rassert(e1 != NULL);
+    rassert(e2 != NULL);
+
+    const int pos_cmp = Tstamp_cmp(&e1->pos, &e2->pos);
+    if (pos_cmp != 0)
+        return (pos_cmp < 0);
+
+    return (e1->ch < e2->ch);
+}
+
+
+void Trigger_row_queue_push(Trigger_row_queue* queue, int ch, const Tstamp* pos)
+{
+    rassert(queue != NULL);
+    rassert(queue->count < KQT_CHANNELS_MAX);
+    rassert(ch >= 0);
+    rassert(ch < KQT_CHANNELS_MAX);
+    rassert(pos != NULL);
+
+    Trigger_row_queue_entry* entries = queue->entries;
+
+    // Sift up
+    int index = queue->count;
+    Trigger_row_queue_entry new_entry = { .ch = ch };
+    Tstamp_copy(&new_entry.pos, pos);
+    while (index > 0)
+    {
+        const int parent = (index - 1) / 2;
+        if (!entry_less(&new_entry, &entries[parent]))
+            break;
+
+        entries[index] = entries[parent];
+        index = parent;
+    }
+
+    entries[index] = new_entry;
+    ++queue->count;
+
+    return;
+}
+
+
+const Trigger_row_queue_entry* Trigger_row_queue_peek(const Trigger_row_queue* queue)
+{
+    rassert(queue != NULL);
+
+    if (queue->count == 0)
+        return NULL;
+
+    return &queue->entries[0];
+}
+
+
+void Trigger_row_queue_pop(Trigger_row_queue* queue)
+{
+    rassert(queue != NULL);
+    rassert(queue->count > 0);
+
+    Trigger_row_queue_entry* entries = queue->entries;
+
+    --queue->count;
+    if (queue->count == 0)
+        return;
+
+    // Sift down the last entry from the root
+    const Trigger_row_queue_entry last = entries[queue->count];
+    int index = 0;
+    for (;;)
+    {
+        int child = index * 2 + 1;
+        if (child >= queue->count)
+            break;
+
+        if ((child + 1 < queue->count) && entry_less(&entries[child + 1], &entries[child]))
+            ++child;
+
+        if (!entry_less(&entries[child], &last))
+            break;
+
+        entries[index] = entries[child];
+        index = child;
+    }
+
+    entries[index] = last;
+
+    return;
+}
+
+
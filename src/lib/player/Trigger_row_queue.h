@@ -0,0 +1,141 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#ifndef KQT_TRIGGER_ROW_QUEUE_H
+#define KQT_TRIGGER_ROW_QUEUE_H
+
+
+#include <kunquat/limits.h>
+#include <mathnum/Tstamp.h>
+#include <player/Position.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+/**
+ * The position of an upcoming trigger row in a channel.
+ */
+typedef struct Trigger_row_queue_entry
+{
+    Tstamp pos;
+    int ch;
+} Trigger_row_queue_entry;
+
+
+/**
+ * A priority queue of upcoming trigger rows, ordered by position and channel.
+ *
+ * Each channel has at most one entry in the queue. The queue describes the
+ * rows of a single pattern instance and must be rebuilt whenever playback
+ * moves to another pattern instance or the Module is changed.
+ */
+typedef struct Trigger_row_queue
+{
+    bool is_valid;
+    uint64_t data_version;
+    Position pos;
+    int count;
+    Trigger_row_queue_entry entries[KQT_CHANNELS_MAX];
+} Trigger_row_queue;
+
+
+/**
+ * Initialise the Trigger row queue.
+ *
+ * \param queue   The Trigger row queue -- must not be \c NULL.
+ *
+ * \return   The parameter \a queue.
+ */
+Trigger_row_queue* Trigger_row_queue_init(Trigger_row_queue* queue);
+
+
+/**
+ * Mark the contents of the Trigger row queue as outdated.
+ *
+ * \param queue   The Trigger row queue -- must not be \c NULL.
+ */
+void Trigger_row_queue_invalidate(Trigger_row_queue* queue);
+
+
+/**
+ * Check whether the Trigger row queue is up to date.
+ *
+ * \param queue          The Trigger row queue -- must not be \c NULL.
+ * \param pos            The current playback position -- must not be \c NULL.
+ * \param data_version   The current data version of the Module.
+ *
+ * \return   \c true if \a queue can be used at \a pos, otherwise \c false.
+ */
+bool Trigger_row_queue_is_valid(
+        const Trigger_row_queue* queue, const Position* pos, uint64_t data_version);
+
+
+/**
+ * Clear the Trigger row queue for rebuilding.
+ *
+ * \param queue          The Trigger row queue -- must not be \c NULL.
+ * \param pos            The current playback position -- must not be \c NULL.
+ * \param data_version   The current data version of the Module.
+ */
+void Trigger_row_queue_clear(
+        Trigger_row_queue* queue, const Position* pos, uint64_t data_version);
+
+
+/**
+ * Update the playback position of the Trigger row queue.
+ *
+ * \param queue   The Trigger row queue -- must not be \c NULL.
+ * \param pos     The current playback position -- must not be \c NULL and
+ *                must not precede the previous position of \a queue.
+ */
+void Trigger_row_queue_set_position(Trigger_row_queue* queue, const Position* pos);
+
+
+/**
+ * Add the position of the next trigger row of a channel.
+ *
+ * \param queue   The Trigger row queue -- must not be \c NULL and must not
+ *                contain an entry for \a ch.
+ * \param ch      The channel number -- must be >= \c 0 and
+ *                < \c KQT_CHANNELS_MAX.
+ * \param pos     The trigger row position -- must not be \c NULL.
+ */
+void Trigger_row_queue_push(Trigger_row_queue* queue, int ch, const Tstamp* pos);
+
+
+/**
+ * Get the earliest upcoming trigger row.
+ *
+ * \param queue   The Trigger row queue -- must not be \c NULL.
+ *
+ * \return   The entry of the earliest row, or \c NULL if \a queue is empty.
+ *           Of rows at the same position, the one with the lowest channel
+ *           number is returned.
+ */
+const Trigger_row_queue_entry* Trigger_row_queue_peek(const Trigger_row_queue* queue);
+
+
+/**
+ * Remove the earliest upcoming trigger row.
+ *
+ * \param queue   The Trigger row queue -- must not be \c NULL or empty.
+ */
+void Trigger_row_queue_pop(Trigger_row_queue* queue);
+
+
+#endif // KQT_TRIGGER_ROW_QUEUE_H
+
+
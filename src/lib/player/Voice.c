@@ -120,7 +120,10 @@ const Processor* Voice_get_proc(const Voice* voice)
 void Voice_set_work_buffer(Voice* voice, Work_buffer* wb)
 {
     rassert(voice != NULL);
+
     voice->wb = wb;
+    Voice_state_set_work_buffer(voice->state, wb);
+
     return;
 }
 
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -15,6 +15,7 @@
 #include <player/Voice_pool.h>
 
 #include <debug/assert.h>
+#include <mathnum/common.h>
 #include <memory.h>
 #include <player/Voice_work_buffers.h>
 #include <threads/Mutex.h>
@@ -25,6 +26,12 @@
 #include <stdlib.h>
 
 
+// Only a fraction of the Voices play processors that need a Voice work buffer,
+// so the buffer slab is sized according to that instead of the pool size
+#define WORK_BUFFER_VOICE_RATIO 16
+#define WORK_BUFFER_COUNT_MIN 64
+
+
 struct Voice_pool
 {
     int size;
@@ -115,10 +122,11 @@ bool Voice_pool_reserve_state_space(Voice_pool* pool, int32_t state_size)
 }
 
 
-int32_t Voice_pool_get_work_buffer_size(const Voice_pool* pool)
+static int get_work_buffer_count(int voice_count)
 {
-    rassert(pool != NULL);
-    return Voice_work_buffers_get_buffer_size(pool->voice_wbs);
+    rassert(voice_count >= 0);
+    return min(voice_count,
+            max(WORK_BUFFER_COUNT_MIN, voice_count / WORK_BUFFER_VOICE_RATIO));
 }
 
 
@@ -128,17 +136,99 @@ bool Voice_pool_reserve_work_buffers(Voice_pool* pool, int32_t buf_size)
     rassert(buf_size >= 0);
     rassert(buf_size <= VOICE_WORK_BUFFER_SIZE_MAX);
 
-    if (!Voice_work_buffers_allocate_space(pool->voice_wbs, pool->size, buf_size))
-        return false;
+    if (buf_size == 0)
+        return true;
+
+    return Voice_work_buffers_reserve(
+            pool->voice_wbs, get_work_buffer_count(pool->size), buf_size);
+}
+
 
+void Voice_pool_remove_unused_work_buffers(Voice_pool* pool)
+{
+    rassert(pool != NULL);
+    Voice_work_buffers_remove_unused(pool->voice_wbs);
+    return;
+}
+
+
+static void Voice_pool_release_work_buffer(Voice_pool* pool, Voice* voice)
+{
+    rassert(pool != NULL);
+    rassert(voice != NULL);
+
+    if (voice->wb != NULL)
+    {
+        Voice_work_buffers_release(pool->voice_wbs, voice->wb);
+        Voice_set_work_buffer(voice, NULL);
+    }
+
+    return;
+}
+
+
+static Work_buffer* Voice_pool_steal_work_buffer(
+        Voice_pool* pool, const Voice* voice, int32_t size)
+{
+    rassert(pool != NULL);
+    rassert(voice != NULL);
+    rassert(size > 0);
+
+    // Find the oldest Voice of lowest priority that holds a sufficient buffer
+    Voice* victim = NULL;
     for (int i = 0; i < pool->size; ++i)
     {
-        Voice_set_work_buffer(
-                pool->voices[i],
-                Voice_work_buffers_get_buffer_mut(pool->voice_wbs, i));
+        Voice* cur_voice = pool->voices[i];
+        if ((cur_voice == voice) ||
+                (cur_voice->wb == NULL) ||
+                (Work_buffer_get_size(cur_voice->wb) < size))
+            continue;
+
+        if ((victim == NULL) ||
+                (Voice_cmp(cur_voice, victim) < 0) ||
+                ((Voice_cmp(cur_voice, victim) == 0) && (cur_voice->id < victim->id)))
+            victim = cur_voice;
     }
 
-    return true;
+    if (victim == NULL)
+        return NULL;
+
+    // The processor of the victim ends its Voice when it finds the buffer missing
+    Work_buffer* wb = victim->wb;
+    Voice_set_work_buffer(victim, NULL);
+
+    return wb;
+}
+
+
+bool Voice_pool_assign_work_buffer(Voice_pool* pool, Voice* voice, int32_t size)
+{
+    rassert(pool != NULL);
+    rassert(voice != NULL);
+    rassert(size >= 0);
+
+    Voice_pool_release_work_buffer(pool, voice);
+    if (size == 0)
+        return true;
+
+    // Reclaim buffers of finished Voices if we have run out
+    if (Voice_work_buffers_get_free_count(pool->voice_wbs, size) == 0)
+    {
+        for (int i = 0; i < pool->size; ++i)
+        {
+            Voice* cur_voice = pool->voices[i];
+            if (cur_voice->prio == VOICE_PRIO_INACTIVE)
+                Voice_pool_release_work_buffer(pool, cur_voice);
+        }
+    }
+
+    Work_buffer* wb = Voice_work_buffers_acquire(pool->voice_wbs, size);
+    if (wb == NULL)
+        wb = Voice_pool_steal_work_buffer(pool, voice, size);
+
+    Voice_set_work_buffer(voice, wb);
+
+    return (wb != NULL);
 }
 
 
@@ -154,6 +244,7 @@ bool Voice_pool_resize(Voice_pool* pool, int size)
     // Remove excess voices if any
     for (int i = new_size; i < pool->size; ++i)
     {
+        Voice_pool_release_work_buffer(pool, pool->voices[i]);
         del_Voice(pool->voices[i]);
         pool->voices[i] = NULL;
     }
@@ -196,21 +287,10 @@ bool Voice_pool_resize(Voice_pool* pool, int size)
         }
     }
 
-    // Allocate space for Voice work buffers if needed
-    const int32_t voice_wb_size = Voice_work_buffers_get_buffer_size(pool->voice_wbs);
-    if (voice_wb_size > 0)
-    {
-        if (!Voice_work_buffers_allocate_space(pool->voice_wbs, new_size, voice_wb_size))
-            return false;
-
-        for (int i = 0; i < new_size; ++i)
-            Voice_set_work_buffer(
-                    pool->voices[i],
-                    Voice_work_buffers_get_buffer_mut(pool->voice_wbs, i));
-    }
-
     pool->size = new_size;
-    return true;
+
+    return Voice_work_buffers_set_count(
+            pool->voice_wbs, get_work_buffer_count(pool->size));
 }
 
 
@@ -359,7 +439,10 @@ void Voice_pool_reset(Voice_pool* pool)
     rassert(pool != NULL);
 
     for (uint16_t i = 0; i < pool->size; ++i)
+    {
         Voice_reset(pool->voices[i]);
+        Voice_pool_release_work_buffer(pool, pool->voices[i]);
+    }
 
     return;
 }
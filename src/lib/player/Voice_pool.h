@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2016
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -56,25 +56,45 @@ bool Voice_pool_reserve_state_space(Voice_pool* pool, int32_t state_size);
 
 
 /**
- * Get the current Voice work buffer size.
+ * Reserve Work buffers of a given size for Voices.
  *
- * \param pool   The Voice pool -- must not be \c NULL.
+ * The buffers are shared by the Voices on demand, and only a fraction of the
+ * Voices may hold a buffer of each size at the same time. Buffers currently
+ * held by Voices remain valid.
+ *
+ * \param pool       The Voice pool -- must not be \c NULL.
+ * \param buf_size   The buffer size, or \c 0 for no buffers -- must be >= \c 0
+ *                   and <= \c VOICE_WORK_BUFFER_SIZE_MAX.
  *
- * \return   The Voice work buffer size.
+ * \return   \c true if successful, or \c false if memory allocation failed.
  */
-int32_t Voice_pool_get_work_buffer_size(const Voice_pool* pool);
+bool Voice_pool_reserve_work_buffers(Voice_pool* pool, int32_t buf_size);
 
 
 /**
- * Reserve Work buffers for Voices.
+ * Remove reserved Work buffers of sizes not currently held by any Voice.
  *
- * \param pool       The Voice pool -- must not be \c NULL.
- * \param buf_size   The buffer size -- must be >= \c 0 and
- *                   < \c VOICE_WORK_BUFFER_SIZE_MAX.
+ * \param pool   The Voice pool -- must not be \c NULL.
+ */
+void Voice_pool_remove_unused_work_buffers(Voice_pool* pool);
+
+
+/**
+ * Assign a reserved Work buffer to a Voice.
  *
- * \return   \c true if successful, or \c false if memory allocation failed.
+ * Any Work buffer previously held by \a voice is released first. If all
+ * buffers of sufficient size are in use, the buffer is taken from the Voice
+ * of lowest priority that holds one. This function does not allocate memory.
+ *
+ * \param pool    The Voice pool -- must not be \c NULL.
+ * \param voice   The Voice -- must not be \c NULL.
+ * \param size    The buffer size required, or \c 0 if \a voice does not
+ *                need a buffer -- must be >= \c 0.
+ *
+ * \return   \c true if \a voice received a buffer or \a size is \c 0, or
+ *           \c false if no buffer of sufficient size was available.
  */
-bool Voice_pool_reserve_work_buffers(Voice_pool* pool, int32_t buf_size);
+bool Voice_pool_assign_work_buffer(Voice_pool* pool, Voice* voice, int32_t size);
 
 
 /**
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -18,19 +18,27 @@
 #include <mathnum/common.h>
 #include <memory.h>
 #include <player/Work_buffer.h>
-#include <player/Work_buffer_private.h>
 
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 
 
-struct Voice_work_buffers
+typedef struct Size_class
 {
-    int count;
     int32_t buf_size;
-    Work_buffer* wbs;
-    void* space;
+    int count;
+
+    // Unused buffers are stored in [0, free_count), acquired ones after them
+    int free_count;
+    Work_buffer** wbs;
+} Size_class;
+
+
+struct Voice_work_buffers
+{
+    int class_count;
+    Size_class* classes;
 };
 
 
@@ -40,87 +48,206 @@ Voice_work_buffers* new_Voice_work_buffers(void)
     if (wbs == NULL)
         return NULL;
 
-    wbs->count = 0;
-    wbs->buf_size = 0;
-    wbs->wbs = NULL;
-    wbs->space = NULL;
+    wbs->class_count = 0;
+    wbs->classes = NULL;
 
     return wbs;
 }
 
 
-int32_t Voice_work_buffers_get_buffer_size(const Voice_work_buffers* wbs)
+static bool Size_class_set_count(Size_class* sc, int count)
 {
-    rassert(wbs != NULL);
-    return wbs->buf_size;
+    rassert(sc != NULL);
+    rassert(count >= 0);
+
+    // Remove unused buffers in excess; acquired buffers are kept until released
+    while ((sc->count > count) && (sc->free_count > 0))
+    {
+        --sc->free_count;
+        del_Work_buffer(sc->wbs[sc->free_count]);
+        sc->wbs[sc->free_count] = sc->wbs[sc->count - 1];
+        --sc->count;
+    }
+
+    if (sc->count >= count)
+        return true;
+
+    Work_buffer** new_wbs = memory_realloc_items(Work_buffer*, count, sc->wbs);
+    if (new_wbs == NULL)
+        return false;
+    sc->wbs = new_wbs;
+
+    // Add new buffers to the end of the unused range
+    while (sc->count < count)
+    {
+        Work_buffer* wb = new_Work_buffer_unbounded(sc->buf_size);
+        if (wb == NULL)
+            return false;
+
+        sc->wbs[sc->count] = sc->wbs[sc->free_count];
+        sc->wbs[sc->free_count] = wb;
+        ++sc->free_count;
+        ++sc->count;
+    }
+
+    return true;
+}
+
+
+static void Size_class_deinit(Size_class* sc)
+{
+    rassert(sc != NULL);
+
+    for (int i = 0; i < sc->count; ++i)
+        del_Work_buffer(sc->wbs[i]);
+
+    memory_free(sc->wbs);
+    sc->wbs = NULL;
+    sc->count = 0;
+    sc->free_count = 0;
+
+    return;
 }
 
 
-bool Voice_work_buffers_allocate_space(
-        Voice_work_buffers* wbs, int count, int32_t buf_size)
+bool Voice_work_buffers_reserve(Voice_work_buffers* wbs, int count, int32_t buf_size)
 {
     rassert(wbs != NULL);
     rassert(count >= 0);
     rassert(count <= KQT_VOICES_MAX);
-    rassert(buf_size >= 0);
+    rassert(buf_size > 0);
     rassert(buf_size <= VOICE_WORK_BUFFER_SIZE_MAX);
 
-    if ((wbs->count == count) && (wbs->buf_size == buf_size))
-        return true;
+    for (int i = 0; i < wbs->class_count; ++i)
+    {
+        if (wbs->classes[i].buf_size == buf_size)
+            return Size_class_set_count(&wbs->classes[i], count);
+    }
+
+    Size_class* new_classes =
+        memory_realloc_items(Size_class, wbs->class_count + 1, wbs->classes);
+    if (new_classes == NULL)
+        return false;
+    wbs->classes = new_classes;
 
-    if (count == 0 || buf_size == 0)
+    // Keep the size classes sorted so that acquisition finds the best fit first
+    int index = wbs->class_count;
+    while ((index > 0) && (wbs->classes[index - 1].buf_size > buf_size))
     {
-        wbs->count = count;
-        wbs->buf_size = buf_size;
+        wbs->classes[index] = wbs->classes[index - 1];
+        --index;
+    }
 
-        memory_free(wbs->wbs);
-        wbs->wbs = NULL;
-        memory_free(wbs->space);
-        wbs->space = NULL;
+    Size_class* sc = &wbs->classes[index];
+    sc->buf_size = buf_size;
+    sc->count = 0;
+    sc->free_count = 0;
+    sc->wbs = NULL;
+    ++wbs->class_count;
 
-        return true;
+    return Size_class_set_count(sc, count);
+}
+
+
+bool Voice_work_buffers_set_count(Voice_work_buffers* wbs, int count)
+{
+    rassert(wbs != NULL);
+    rassert(count >= 0);
+    rassert(count <= KQT_VOICES_MAX);
+
+    for (int i = 0; i < wbs->class_count; ++i)
+    {
+        if (!Size_class_set_count(&wbs->classes[i], count))
+            return false;
     }
 
-    const int32_t actual_buf_size = buf_size + 2;
+    return true;
+}
 
-    // Allocate memory
-    Work_buffer* new_wbs = memory_realloc_items(Work_buffer, count, wbs->wbs);
-    if (new_wbs == NULL)
-        return false;
-    wbs->wbs = new_wbs;
 
-    wbs->count = min(wbs->count, count);
+void Voice_work_buffers_remove_unused(Voice_work_buffers* wbs)
+{
+    rassert(wbs != NULL);
 
-    const int32_t total_space_size = count * actual_buf_size;
-    void* new_space = memory_realloc_items(float, total_space_size, wbs->space);
-    if (new_space == NULL)
-        return false;
-    wbs->space = new_space;
+    int kept_count = 0;
+    for (int i = 0; i < wbs->class_count; ++i)
+    {
+        Size_class* sc = &wbs->classes[i];
+        if (sc->free_count == sc->count)
+            Size_class_deinit(sc);
+        else
+            wbs->classes[kept_count++] = *sc;
+    }
 
-    wbs->count = count;
-    wbs->buf_size = buf_size;
+    wbs->class_count = kept_count;
 
-    // Initialise Work buffers
-    for (int i = 0; i < wbs->count; ++i)
-        Work_buffer_init_with_memory(
-                &wbs->wbs[i],
-                (float*)wbs->space + (i * actual_buf_size),
-                actual_buf_size);
+    return;
+}
 
-    return true;
+
+int Voice_work_buffers_get_free_count(const Voice_work_buffers* wbs, int32_t size)
+{
+    rassert(wbs != NULL);
+    rassert(size >= 0);
+
+    int free_count = 0;
+    for (int i = 0; i < wbs->class_count; ++i)
+    {
+        if (wbs->classes[i].buf_size >= size)
+            free_count += wbs->classes[i].free_count;
+    }
+
+    return free_count;
 }
 
 
-Work_buffer* Voice_work_buffers_get_buffer_mut(const Voice_work_buffers* wbs, int index)
+Work_buffer* Voice_work_buffers_acquire(Voice_work_buffers* wbs, int32_t size)
 {
     rassert(wbs != NULL);
-    rassert(index >= 0);
-    rassert(index < wbs->count);
+    rassert(size >= 0);
 
-    if (wbs->wbs == NULL)
-        return NULL;
+    for (int i = 0; i < wbs->class_count; ++i)
+    {
+        Size_class* sc = &wbs->classes[i];
+        if ((sc->buf_size >= size) && (sc->free_count > 0))
+        {
+            --sc->free_count;
+            return sc->wbs[sc->free_count];
+        }
+    }
+
+    return NULL;
+}
 
-    return &wbs->wbs[index];
+
+void Voice_work_buffers_release(Voice_work_buffers* wbs, Work_buffer* wb)
+{
+    rassert(wbs != NULL);
+    rassert(wb != NULL);
+
+    const int32_t buf_size = Work_buffer_get_size(wb);
+
+    for (int i = 0; i < wbs->class_count; ++i)
+    {
+        Size_class* sc = &wbs->classes[i];
+        if (sc->buf_size != buf_size)
+            continue;
+
+        for (int k = sc->free_count; k < sc->count; ++k)
+        {
+            if (sc->wbs[k] == wb)
+            {
+                // Move the buffer to the end of the unused range
+                sc->wbs[k] = sc->wbs[sc->free_count];
+                sc->wbs[sc->free_count] = wb;
+                ++sc->free_count;
+                return;
+            }
+        }
+    }
+
+    rassert(false);
+    return;
 }
 
 
@@ -129,8 +256,10 @@ void del_Voice_work_buffers(Voice_work_buffers* wbs)
     if (wbs == NULL)
         return;
 
-    memory_free(wbs->wbs);
-    memory_free(wbs->space);
+    for (int i = 0; i < wbs->class_count; ++i)
+        Size_class_deinit(&wbs->classes[i]);
+
+    memory_free(wbs->classes);
     memory_free(wbs);
 
     return;
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -40,44 +40,78 @@ Voice_work_buffers* new_Voice_work_buffers(void);
 
 
 /**
- * Get the buffer size of a Work buffer inside Voice work buffers.
+ * Reserve Work buffers of a given size in Voice work buffers.
  *
- * \param wbs   The Voice work buffers -- must not be \c NULL.
+ * Buffers of each reserved size are kept in a separate size class. Buffers
+ * that are currently acquired remain valid; if \a count is smaller than the
+ * current count of the size class, only unused buffers are removed.
+ *
+ * \param wbs        The Voice work buffers -- must not be \c NULL.
+ * \param count      The number of buffers -- must be >= \c 0 and
+ *                   <= \c KQT_VOICES_MAX.
+ * \param buf_size   The buffer size -- must be > \c 0 and
+ *                   <= \c VOICE_WORK_BUFFER_SIZE_MAX.
  *
- * \return   The size of a single Work buffer, or \c 0 if \a wbs is uninitialised.
+ * \return   \c true if successful, or \c false if memory allocation failed.
  */
-int32_t Voice_work_buffers_get_buffer_size(const Voice_work_buffers* wbs);
+bool Voice_work_buffers_reserve(Voice_work_buffers* wbs, int count, int32_t buf_size);
 
 
 /**
- * Allocate space for Voice work buffers.
+ * Set the number of buffers in all size classes of Voice work buffers.
  *
- * \param wbs        The Voice work buffers -- must not be \c NULL.
- * \param count      The number of buffers -- must be >= \c 0 and
- *                   <= \c KQT_VOICES_MAX.
- * \param buf_size   The new buffer size -- must be >= \c 0 and
- *                   <= \c VOICE_WORK_BUFFER_SIZE_MAX.
+ * \param wbs     The Voice work buffers -- must not be \c NULL.
+ * \param count   The number of buffers -- must be >= \c 0 and
+ *                <= \c KQT_VOICES_MAX.
  *
  * \return   \c true if successful, or \c false if memory allocation failed.
  */
-bool Voice_work_buffers_allocate_space(
-        Voice_work_buffers* wbs, int count, int32_t buf_size);
+bool Voice_work_buffers_set_count(Voice_work_buffers* wbs, int count);
 
 
 /**
- * Get a Work buffer in Voice work buffers.
+ * Remove size classes that have no acquired buffers from Voice work buffers.
  *
- * NOTE: \a Voice_work_buffers_allocate_space must be called before using this
- *       function.
+ * \param wbs   The Voice work buffers -- must not be \c NULL.
+ */
+void Voice_work_buffers_remove_unused(Voice_work_buffers* wbs);
+
+
+/**
+ * Get the number of unused Work buffers of sufficient size.
  *
- * \param wbs     The Voice work buffers -- must not be \c NULL.
- * \param index   The index of the buffer -- must be >= \c 0 and less than
- *                the number of buffers inside \a wbs.
+ * \param wbs    The Voice work buffers -- must not be \c NULL.
+ * \param size   The minimum buffer size required -- must be >= \c 0.
+ *
+ * \return   The number of Work buffers available for acquisition.
+ */
+int Voice_work_buffers_get_free_count(const Voice_work_buffers* wbs, int32_t size);
+
+
+/**
+ * Acquire an unused Work buffer from Voice work buffers.
+ *
+ * The buffer is taken from the smallest size class that fits \a size and
+ * has unused buffers left. This function does not allocate memory and is
+ * therefore safe to call during playback.
  *
- * \return   The Work buffer at \a index, or \c NULL if no buffer space has
- *           been allocated.
+ * \param wbs    The Voice work buffers -- must not be \c NULL.
+ * \param size   The minimum buffer size required -- must be >= \c 0.
+ *
+ * \return   An unused Work buffer, or \c NULL if all buffers of sufficient
+ *           size are in use.
+ */
+Work_buffer* Voice_work_buffers_acquire(Voice_work_buffers* wbs, int32_t size);
+
+
+/**
+ * Return a Work buffer back to Voice work buffers.
+ *
+ * \param wbs   The Voice work buffers -- must not be \c NULL.
+ * \param wb    The Work buffer -- must have been acquired from \a wbs and
+ *              not released since.
  */
-Work_buffer* Voice_work_buffers_get_buffer_mut(const Voice_work_buffers* wbs, int index);
+void Voice_work_buffers_release(Voice_work_buffers* wbs, Work_buffer* wb);
 
 
 /**
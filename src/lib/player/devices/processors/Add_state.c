@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2015-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2015-2018
  *
  * This file is part of Kunquat.
  *
@@ -23,13 +23,18 @@
 #include <player/devices/processors/Proc_state_utils.h>
 #include <player/Work_buffers.h>
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 
 
+// Tone phases are stored as 32-bit fixed-point fractions of a cycle
+#define ADD_PHASE_ONE 4294967296.0
+
+
 typedef struct Add_tone_state
 {
-    double phase[2];
+    uint32_t phase[2];
 } Add_tone_state;
 
 
@@ -71,6 +76,195 @@ static const int ADD_WORK_BUFFER_MOD_L = WORK_BUFFER_IMPL_3;
 //static const int ADD_WORK_BUFFER_MOD_R = WORK_BUFFER_IMPL_4;
 
 
+#define ADD_OSC_LANES 4
+
+
+typedef struct Add_osc_bank
+{
+    int tone_count;
+    int lane_count;
+    int tone_indices[ADD_TONES_MAX];
+    uint32_t phases[ADD_TONES_MAX];
+    float phase_incs[ADD_TONES_MAX];
+    double phase_shift_factors[ADD_TONES_MAX];
+    float gains[2][ADD_TONES_MAX];
+    const float* cur_bases[ADD_TONES_MAX];
+    int cur_pos_shifts[ADD_TONES_MAX];
+    uint32_t cur_size_masks[ADD_TONES_MAX];
+    uint32_t cur_lerp_masks[ADD_TONES_MAX];
+    float cur_lerp_scales[ADD_TONES_MAX];
+    int32_t res_slice_stops[ADD_TONES_MAX];
+} Add_osc_bank;
+
+
+static uint32_t get_fixed_phase(float cycles)
+{
+    // Note: direct cast of negative values to uint32_t is undefined
+    static const float cycles_max = 1073741824.0f;
+    return (uint32_t)(int64_t)(clamp(cycles, -cycles_max, cycles_max) * ADD_PHASE_ONE);
+}
+
+
+static void Add_osc_bank_update_resolution(
+        Add_osc_bank* bank,
+        int lane,
+        const float* base,
+        const float* freqs,
+        int32_t freqs_const_start,
+        const float* mod_values,
+        int32_t mod_const_start,
+        float prev_mod,
+        int32_t res_slice_start,
+        int32_t buf_stop)
+{
+    rassert(bank != NULL);
+    rassert(lane >= 0);
+    rassert(lane < bank->tone_count);
+    rassert(res_slice_start < buf_stop);
+
+    const double phase_shift_factor = bank->phase_shift_factors[lane];
+
+    // Get current pitch range
+    const float first_mod_shift = mod_values[res_slice_start] - prev_mod;
+    const float first_phase_shift_abs = (float)fabs(
+            first_mod_shift + (freqs[res_slice_start] * phase_shift_factor));
+    int shift_exp = 0;
+    const float shift_norm = frexpf(first_phase_shift_abs, &shift_exp);
+    const float min_phase_shift_abs = ldexpf(0.5f, shift_exp);
+    const float max_phase_shift_abs = min_phase_shift_abs * 2.0f;
+
+    // Choose appropriate waveform resolution for current pitch range
+    int cur_size_exp = ADD_BASE_FUNC_SIZE_EXP;
+    if (isfinite(shift_norm) && (shift_norm > 0.0f))
+        cur_size_exp = min(clamp(-shift_exp + 1, 3, 30), ADD_BASE_FUNC_SIZE_EXP + 1);
+    const int32_t cur_size = (int32_t)ipowi(2, cur_size_exp);
+    const int base_offset = (ADD_BASE_FUNC_SIZE * 4 - cur_size * 2);
+    rassert(base_offset >= 0);
+    rassert(base_offset < (ADD_BASE_FUNC_SIZE * 4) - 1);
+
+    // The table index is in the high bits and the lerp value in the low bits
+    const int cur_pos_shift = 32 - cur_size_exp;
+    bank->cur_bases[lane] = base + base_offset;
+    bank->cur_pos_shifts[lane] = cur_pos_shift;
+    bank->cur_size_masks[lane] = (uint32_t)cur_size - 1;
+    bank->cur_lerp_masks[lane] = ((uint32_t)1 << cur_pos_shift) - 1;
+    bank->cur_lerp_scales[lane] = ldexpf(1.0f, -cur_pos_shift);
+
+    // Get length of input compatible with current waveform resolution
+    int32_t res_slice_stop = buf_stop;
+    const int32_t res_check_stop =
+        min(res_slice_stop, max(freqs_const_start, mod_const_start) + 1);
+    for (int32_t i = res_slice_start + 1; i < res_check_stop; ++i)
+    {
+        const float cur_mod_shift = mod_values[i] - mod_values[i - 1];
+        const float cur_phase_shift_abs =
+            (float)fabs(cur_mod_shift + (freqs[i] * phase_shift_factor));
+        if (cur_phase_shift_abs < min_phase_shift_abs ||
+                cur_phase_shift_abs > max_phase_shift_abs)
+        {
+            res_slice_stop = i;
+            break;
+        }
+    }
+
+    bank->res_slice_stops[lane] = res_slice_stop;
+
+    return;
+}
+
+
+static void Add_osc_bank_render(
+        Add_osc_bank* bank,
+        float* out_bufs[2],
+        const float* freqs,
+        const float* scales,
+        const float* mod_values,
+        int32_t area_start,
+        int32_t area_stop)
+{
+    rassert(bank != NULL);
+    rassert(bank->lane_count % ADD_OSC_LANES == 0);
+    rassert(out_bufs != NULL);
+    rassert((out_bufs[0] != NULL) || (out_bufs[1] != NULL));
+
+    static const float phase_inc_max = (float)ADD_PHASE_ONE;
+
+    float* out_buf_l = out_bufs[0];
+    float* out_buf_r = out_bufs[1];
+
+    for (int group_start = 0; group_start < bank->lane_count;
+            group_start += ADD_OSC_LANES)
+    {
+        uint32_t phases[ADD_OSC_LANES];
+        float phase_incs[ADD_OSC_LANES];
+        float gains_l[ADD_OSC_LANES];
+        float gains_r[ADD_OSC_LANES];
+        const float* cur_bases[ADD_OSC_LANES];
+        int cur_pos_shifts[ADD_OSC_LANES];
+        uint32_t cur_size_masks[ADD_OSC_LANES];
+        uint32_t cur_lerp_masks[ADD_OSC_LANES];
+        float cur_lerp_scales[ADD_OSC_LANES];
+
+        for (int lane = 0; lane < ADD_OSC_LANES; ++lane)
+        {
+            const int bank_lane = group_start + lane;
+            phases[lane] = bank->phases[bank_lane];
+            phase_incs[lane] = bank->phase_incs[bank_lane];
+            gains_l[lane] = bank->gains[0][bank_lane];
+            gains_r[lane] = bank->gains[1][bank_lane];
+            cur_bases[lane] = bank->cur_bases[bank_lane];
+            cur_pos_shifts[lane] = bank->cur_pos_shifts[bank_lane];
+            cur_size_masks[lane] = bank->cur_size_masks[bank_lane];
+            cur_lerp_masks[lane] = bank->cur_lerp_masks[bank_lane];
+            cur_lerp_scales[lane] = bank->cur_lerp_scales[bank_lane];
+        }
+
+        for (int32_t i = area_start; i < area_stop; ++i)
+        {
+            const float freq = freqs[i];
+
+            // Note: mod_phase is specific to phase modulation
+            const uint32_t mod_phase = get_fixed_phase(mod_values[i]);
+
+            float mixed_l = 0;
+            float mixed_r = 0;
+
+            for (int lane = 0; lane < ADD_OSC_LANES; ++lane)
+            {
+                const uint32_t actual_phase = phases[lane] + mod_phase;
+
+                const uint32_t pos1 = actual_phase >> cur_pos_shifts[lane];
+                const uint32_t pos2 = (pos1 + 1) & cur_size_masks[lane];
+                const float lerp_val =
+                    (float)(actual_phase & cur_lerp_masks[lane]) * cur_lerp_scales[lane];
+
+                const float* cur_base = cur_bases[lane];
+                const float item1 = cur_base[pos1];
+                const float value = item1 + (lerp_val * (cur_base[pos2] - item1));
+
+                mixed_l += value * gains_l[lane];
+                mixed_r += value * gains_r[lane];
+
+                // Phase increments wrap around naturally in fixed-point representation
+                const float phase_inc = clamp(freq * phase_incs[lane], 0, phase_inc_max);
+                phases[lane] += (uint32_t)(int64_t)phase_inc;
+            }
+
+            const float vol_scale = scales[i];
+            if (out_buf_l != NULL)
+                out_buf_l[i] += mixed_l * vol_scale;
+            if (out_buf_r != NULL)
+                out_buf_r[i] += mixed_r * vol_scale;
+        }
+
+        for (int lane = 0; lane < ADD_OSC_LANES; ++lane)
+            bank->phases[group_start + lane] = phases[lane];
+    }
+
+    return;
+}
+
+
 int32_t Add_vstate_render_voice(
         Voice_state* vstate,
         Proc_state* proc_state,
@@ -135,6 +329,8 @@ int32_t Add_vstate_render_voice(
                 proc_ts, DEVICE_PORT_TYPE_RECV, PORT_IN_PHASE_MOD_R),
     };
 
+    const bool has_phase_mod = (mod_wbs[0] != NULL) || (mod_wbs[1] != NULL);
+
     for (int ch = 0; ch < 2; ++ch)
     {
         if (mod_wbs[ch] == NULL)
@@ -151,126 +347,135 @@ int32_t Add_vstate_render_voice(
 
     const float* base = Sample_get_buffer(add->base, 0);
 
-    for (int h = 0; h < add_state->tone_limit; ++h)
-    {
-        const Add_tone* tone = &add->tones[h];
-        const double pitch_factor = tone->pitch_factor;
-        const double volume_factor = tone->volume_factor;
+    const int32_t freqs_const_start = Work_buffer_get_const_start(freqs_wb);
 
-        if ((pitch_factor <= 0) || (volume_factor <= 0))
-            continue;
+    // Tone phases of both channels advance identically without phase modulation,
+    // so in that case we can run the stereo output with a single oscillator bank
+    bool share_phases =
+        !has_phase_mod && (out_bufs[0] != NULL) && (out_bufs[1] != NULL);
+    for (int h = 0; share_phases && (h < add_state->tone_limit); ++h)
+        share_phases = (add_state->tones[h].phase[0] == add_state->tones[h].phase[1]);
 
-        const double pannings[] =
-        {
-            -tone->panning,
-            tone->panning,
-        };
+    Add_osc_bank* bank = &(Add_osc_bank){ .tone_count = 0, .lane_count = 0 };
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        if (out_bufs[ch] == NULL)
+            continue;
 
-        const double pitch_factor_inv_audio_rate = pitch_factor * inv_audio_rate;
+        float* bank_out_bufs[2] = { NULL };
+        bank_out_bufs[ch] = out_bufs[ch];
+        if (share_phases)
+            bank_out_bufs[1] = out_bufs[1];
 
-        Add_tone_state* tone_state = &add_state->tones[h];
+        const float* mod_values_ch = Work_buffer_get_contents(mod_wbs[ch]);
+        const int32_t mod_const_start = Work_buffer_get_const_start(mod_wbs[ch]);
+        const float prev_mod = add_state->prev_mod[ch];
 
-        for (int32_t ch = 0; ch < 2; ++ch)
+        // Set up oscillators for the active tones
+        bank->tone_count = 0;
+        for (int h = 0; h < add_state->tone_limit; ++h)
         {
-            float* out_buf_ch = out_bufs[ch];
-            if (out_buf_ch == NULL)
+            const Add_tone* tone = &add->tones[h];
+            if ((tone->pitch_factor <= 0) || (tone->volume_factor <= 0))
                 continue;
 
-            const double panning_factor = 1 + pannings[ch];
-            const float* mod_values_ch = Work_buffer_get_contents(mod_wbs[ch]);
+            const int lane = bank->tone_count;
+            ++bank->tone_count;
+
+            const double phase_shift_factor = tone->pitch_factor * inv_audio_rate;
+
+            bank->tone_indices[lane] = h;
+            bank->phases[lane] = add_state->tones[h].phase[ch];
+            bank->phase_incs[lane] = (float)(phase_shift_factor * ADD_PHASE_ONE);
+            bank->phase_shift_factors[lane] = phase_shift_factor;
+            bank->gains[0][lane] = (float)(tone->volume_factor * (1 - tone->panning));
+            bank->gains[1][lane] = (float)(tone->volume_factor * (1 + tone->panning));
+
+            Add_osc_bank_update_resolution(
+                    bank,
+                    lane,
+                    base,
+                    freqs,
+                    freqs_const_start,
+                    mod_values_ch,
+                    mod_const_start,
+                    prev_mod,
+                    buf_start,
+                    buf_stop);
+        }
 
-            double phase = tone_state->phase[ch];
+        // Fill the last group of lanes with silent oscillators
+        bank->lane_count = bank->tone_count;
+        while (bank->lane_count % ADD_OSC_LANES != 0)
+        {
+            const int lane = bank->lane_count;
+            ++bank->lane_count;
+
+            bank->phases[lane] = 0;
+            bank->phase_incs[lane] = 0;
+            bank->gains[0][lane] = 0;
+            bank->gains[1][lane] = 0;
+            bank->cur_bases[lane] = base;
+            bank->cur_pos_shifts[lane] = 32 - ADD_BASE_FUNC_SIZE_EXP;
+            bank->cur_size_masks[lane] = ADD_BASE_FUNC_SIZE - 1;
+            bank->cur_lerp_masks[lane] = 0;
+            bank->cur_lerp_scales[lane] = 0;
+        }
 
-            int32_t res_slice_start = buf_start;
-            while (res_slice_start < buf_stop)
+        // Render in areas where every oscillator keeps its waveform resolution
+        int32_t area_start = buf_start;
+        while (area_start < buf_stop)
+        {
+            int32_t area_stop = buf_stop;
+            for (int lane = 0; lane < bank->tone_count; ++lane)
+                area_stop = min(area_stop, bank->res_slice_stops[lane]);
+
+            Add_osc_bank_render(
+                    bank,
+                    bank_out_bufs,
+                    freqs,
+                    scales,
+                    mod_values_ch,
+                    area_start,
+                    area_stop);
+
+            rassert(area_start < area_stop);
+            area_start = area_stop;
+
+            if (area_start < buf_stop)
             {
-                int32_t res_slice_stop = buf_stop;
-
-                // Get current pitch range
-                const float first_mod_shift =
-                    mod_values_ch[res_slice_start] - add_state->prev_mod[ch];
-                const float first_phase_shift_abs = (float)fabs(
-                        first_mod_shift +
-                        (freqs[res_slice_start] * pitch_factor_inv_audio_rate));
-                int shift_exp = 0;
-                const float shift_norm = frexpf(first_phase_shift_abs, &shift_exp);
-                const float min_phase_shift_abs = ldexpf(0.5f, shift_exp);
-                const float max_phase_shift_abs = min_phase_shift_abs * 2.0f;
-
-                // Choose appropriate waveform resolution for current pitch range
-                int32_t cur_size = ADD_BASE_FUNC_SIZE;
-                if (isfinite(shift_norm) && (shift_norm > 0.0f))
+                for (int lane = 0; lane < bank->tone_count; ++lane)
                 {
-                    cur_size = (int32_t)ipowi(2, clamp(-shift_exp + 1, 3, 30));
-                    cur_size = min(cur_size, ADD_BASE_FUNC_SIZE * 2);
-                    rassert(is_p2(cur_size));
+                    if (bank->res_slice_stops[lane] == area_start)
+                        Add_osc_bank_update_resolution(
+                                bank,
+                                lane,
+                                base,
+                                freqs,
+                                freqs_const_start,
+                                mod_values_ch,
+                                mod_const_start,
+                                mod_values_ch[area_start - 1],
+                                area_start,
+                                buf_stop);
                 }
-                const uint32_t cur_size_mask = (uint32_t)cur_size - 1;
-                const int base_offset = (ADD_BASE_FUNC_SIZE * 4 - cur_size * 2);
-                rassert(base_offset >= 0);
-                rassert(base_offset < (ADD_BASE_FUNC_SIZE * 4) - 1);
-                const float* cur_base = base + base_offset;
-
-                // Get length of input compatible with current waveform resolution
-                const int32_t res_check_stop = min(res_slice_stop,
-                        max(Work_buffer_get_const_start(freqs_wb),
-                            Work_buffer_get_const_start(mod_wbs[ch])) + 1);
-                for (int32_t i = res_slice_start + 1; i < res_check_stop; ++i)
-                {
-                    const float cur_mod_shift = mod_values_ch[i] - mod_values_ch[i - 1];
-                    const float cur_phase_shift_abs = (float)fabs(
-                            cur_mod_shift +
-                            (freqs[i] * pitch_factor_inv_audio_rate));
-                    if (cur_phase_shift_abs < min_phase_shift_abs ||
-                            cur_phase_shift_abs > max_phase_shift_abs)
-                    {
-                        res_slice_stop = i;
-                        break;
-                    }
-                }
-
-                for (int32_t i = res_slice_start; i < res_slice_stop; ++i)
-                {
-                    const float freq = freqs[i];
-                    const float vol_scale = scales[i];
-                    const float mod_val = mod_values_ch[i];
-
-                    // Note: + mod_val is specific to phase modulation
-                    const double actual_phase = phase + mod_val;
-                    const double pos = actual_phase * cur_size;
-
-                    // Note: direct cast of negative doubles to uint32_t is undefined
-                    const uint32_t pos1 = (uint32_t)(int32_t)floor(pos) & cur_size_mask;
-                    const uint32_t pos2 = (pos1 + 1) & cur_size_mask;
-
-                    const float item1 = cur_base[pos1];
-                    const float item_diff = cur_base[pos2] - item1;
-                    const double lerp_val = pos - floor(pos);
-                    const double value =
-                        (item1 + (lerp_val * item_diff)) * volume_factor * panning_factor;
-
-                    out_buf_ch[i] += (float)value * vol_scale;
-
-                    phase += freq * pitch_factor_inv_audio_rate;
-
-                    // Normalise to range [0, 1)
-                    if (phase >= 1)
-                    {
-                        phase -= 1;
-
-                        // Don't bother updating the phase if our frequency is too high
-                        if (phase >= 1)
-                            phase = tone_state->phase[ch];
-                    }
-                }
-
-                rassert(res_slice_start < res_slice_stop);
-                add_state->prev_mod[ch] = mod_values_ch[res_slice_stop - 1];
-
-                res_slice_start = res_slice_stop;
             }
+        }
 
-            tone_state->phase[ch] = phase;
+        for (int lane = 0; lane < bank->tone_count; ++lane)
+        {
+            Add_tone_state* tone_state = &add_state->tones[bank->tone_indices[lane]];
+            tone_state->phase[ch] = bank->phases[lane];
+            if (share_phases)
+                tone_state->phase[1] = bank->phases[lane];
+        }
+
+        add_state->prev_mod[ch] = mod_values_ch[buf_stop - 1];
+        if (share_phases)
+        {
+            add_state->prev_mod[1] = add_state->prev_mod[0];
+            break;
         }
     }
 
@@ -302,8 +507,8 @@ void Add_vstate_init(Voice_state* vstate, const Proc_state* proc_state)
 
         add_state->tone_limit = h + 1;
 
-        const double phase =
-            add->is_rand_phase_enabled ? Random_get_float_lb(vstate->rand_p) : 0;
+        const uint32_t phase = add->is_rand_phase_enabled
+            ? (uint32_t)(Random_get_float_lb(vstate->rand_p) * ADD_PHASE_ONE) : 0;
 
         for (int ch = 0; ch < 2; ++ch)
             add_state->tones[h].phase[ch] = phase;
@@ -19,6 +19,7 @@
 #include <init/devices/processors/Proc_bitcrusher.h>
 #include <mathnum/common.h>
 #include <mathnum/fast_exp2.h>
+#include <mathnum/kernels.h>
 #include <memory.h>
 #include <player/devices/Device_thread_state.h>
 #include <player/devices/Proc_state.h>
@@ -121,8 +122,7 @@ static void Bitcrusher_state_impl_render(
         else
         {
             float* holds = Work_buffer_get_contents_mut(holds_wb);
-            for (int32_t i = buf_start; i < buf_stop; ++i)
-                holds[i] = hold;
+            kernel_fill(holds + buf_start, hold, buf_stop - buf_start);
             Work_buffer_set_const_start(holds_wb, buf_start);
         }
     }
@@ -133,14 +133,14 @@ static void Bitcrusher_state_impl_render(
         const float* cutoffs = Work_buffer_get_contents(cutoff_wb);
         float* holds = Work_buffer_get_contents_mut(holds_wb);
 
-        for (int32_t i = buf_start; i < const_start; ++i)
+        const int32_t fast_stop = clamp(const_start, buf_start, buf_stop);
+        for (int32_t i = buf_start; i < fast_stop; ++i)
             holds[i] = (float)get_hold_fast(cutoffs[i], audio_rate);
 
-        if (const_start < buf_stop)
+        if (fast_stop < buf_stop)
         {
-            const float hold = (float)get_hold(cutoffs[const_start], audio_rate);
-            for (int32_t i = const_start; i < buf_stop; ++i)
-                holds[i] = hold;
+            const float hold = (float)get_hold(cutoffs[fast_stop], audio_rate);
+            kernel_fill(holds + fast_stop, hold, buf_stop - fast_stop);
         }
 
         Work_buffer_set_const_start(holds_wb, const_start);
@@ -161,33 +161,13 @@ static void Bitcrusher_state_impl_render(
             const float* in = Work_buffer_get_contents(in_wb);
             float* out = Work_buffer_get_contents_mut(out_wb);
 
-            double hold_timer = state->hold_timer[ch];
-            float hold_value = state->hold_value[ch];
-
-            for (int32_t i = buf_start; i < buf_stop; ++i)
-            {
-                hold_timer += 1.0;
-
-                const float hold = holds[i];
-                if (hold_timer >= hold)
-                {
-                    double excess = hold_timer - hold;
-                    excess = min(1.0, excess);
-
-                    const float value = lerp(hold_value, in[i], (float)excess);
-                    out[i] = value;
-
-                    hold_value = in[i];
-                    hold_timer = excess;
-
-                    continue;
-                }
-
-                out[i] = hold_value;
-            }
-
-            state->hold_timer[ch] = hold_timer;
-            state->hold_value[ch] = hold_value;
+            kernel_sample_hold(
+                    out + buf_start,
+                    in + buf_start,
+                    holds + buf_start,
+                    buf_stop - buf_start,
+                    &state->hold_timer[ch],
+                    &state->hold_value[ch]);
         }
     }
 
@@ -204,8 +184,7 @@ static void Bitcrusher_state_impl_render(
             const float mult = (float)exp2(bc->resolution);
 
             float* mults = Work_buffer_get_contents_mut(mults_wb);
-            for (int32_t i = buf_start; i < buf_stop; ++i)
-                mults[i] = mult;
+            kernel_fill(mults + buf_start, mult, buf_stop - buf_start);
 
             Work_buffer_set_const_start(mults_wb, buf_start);
         }
@@ -217,14 +196,14 @@ static void Bitcrusher_state_impl_render(
         const float* res_buf = Work_buffer_get_contents(resolution_wb);
         float* mults = Work_buffer_get_contents_mut(mults_wb);
 
-        for (int32_t i = buf_start; i < const_start; ++i)
+        const int32_t fast_stop = clamp(const_start, buf_start, buf_stop);
+        for (int32_t i = buf_start; i < fast_stop; ++i)
             mults[i] = (float)fast_exp2(max(1, res_buf[i]));
 
-        if (const_start < buf_stop)
+        if (fast_stop < buf_stop)
         {
-            const float mult = (float)exp2(max(1, res_buf[const_start]));
-            for (int32_t i = const_start; i < buf_stop; ++i)
-                mults[i] = mult;
+            const float mult = (float)exp2(max(1, res_buf[fast_stop]));
+            kernel_fill(mults + fast_stop, mult, buf_stop - fast_stop);
         }
 
         Work_buffer_set_const_start(mults_wb, const_start);
@@ -249,20 +228,12 @@ static void Bitcrusher_state_impl_render(
                 const float* in = Work_buffer_get_contents(in_wb);
                 float* out = Work_buffer_get_contents_mut(out_wb);
 
-                for (int32_t i = buf_start; i < buf_stop; ++i)
-                {
-                    const float mult = mults[i];
-                    if (mult < min_ignore_mult)
-                    {
-                        const float scaled = (((in[i] + 1) * 0.5f) * mult);
-                        const float floored = floorf(scaled);
-                        out[i] = ((floored / mult) * 2.0f) - 1;
-                    }
-                    else
-                    {
-                        out[i] = in[i];
-                    }
-                }
+                kernel_quantise(
+                        out + buf_start,
+                        in + buf_start,
+                        mults + buf_start,
+                        min_ignore_mult,
+                        buf_stop - buf_start);
             }
         }
         else
@@ -275,16 +246,12 @@ static void Bitcrusher_state_impl_render(
 
                 float* out = Work_buffer_get_contents_mut(wb);
 
-                for (int32_t i = buf_start; i < buf_stop; ++i)
-                {
-                    const float mult = mults[i];
-                    if (mult < min_ignore_mult)
-                    {
-                        const float scaled = (((out[i] + 1) * 0.5f) * mult);
-                        const float floored = floorf(scaled);
-                        out[i] = ((floored / mult) * 2.0f) - 1;
-                    }
-                }
+                kernel_quantise(
+                        out + buf_start,
+                        out + buf_start,
+                        mults + buf_start,
+                        min_ignore_mult,
+                        buf_stop - buf_start);
             }
         }
     }
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -19,13 +19,18 @@
 #include <init/devices/processors/Proc_compress.h>
 #include <mathnum/common.h>
 #include <mathnum/conversions.h>
+#include <mathnum/fast_exp2.h>
+#include <mathnum/fast_log2.h>
 #include <memory.h>
 #include <player/devices/Device_thread_state.h>
 #include <player/devices/Proc_state.h>
 #include <player/devices/processors/Proc_state_utils.h>
+#include <player/Ring_buffer.h>
 #include <player/Work_buffer.h>
 #include <player/Work_buffers.h>
 
+#include <math.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -48,6 +53,60 @@ static void Compress_state_init(Compress_state* cstate)
 }
 
 
+static float dB_to_log2(double dB)
+{
+    rassert(isfinite(dB));
+    return (float)log2(dB_to_scale(dB));
+}
+
+
+void Compress_get_gains(
+        const Proc_compress* compress,
+        float* gains,
+        const float* levels,
+        int32_t buf_start,
+        int32_t buf_stop)
+{
+    rassert(compress != NULL);
+    rassert(gains != NULL);
+    rassert(levels != NULL);
+    rassert(buf_start >= 0);
+    rassert(buf_stop >= buf_start);
+
+    // Get gains in the log2 domain, using the same dB scale as dB_to_scale
+    // NOTE: The upward threshold never exceeds the downward one,
+    //       so at most one of the two curves is active at a time
+    const float upward_threshold = dB_to_log2(
+            compress->downward_enabled
+                ? min(compress->upward_threshold, compress->downward_threshold)
+                : compress->upward_threshold);
+    const float upward_slope =
+        compress->upward_enabled ? (float)(1.0 - (1.0 / compress->upward_ratio)) : 0.0f;
+    const float max_gain =
+        compress->upward_enabled ? dB_to_log2(compress->upward_range) : 0.0f;
+
+    const float downward_threshold = dB_to_log2(compress->downward_threshold);
+    const float downward_slope = compress->downward_enabled
+        ? (float)((1.0 / compress->downward_ratio) - 1.0) : 0.0f;
+    const float min_gain =
+        compress->downward_enabled ? dB_to_log2(-compress->downward_range) : 0.0f;
+
+    for (int32_t i = buf_start; i < buf_stop; ++i)
+    {
+        const float level = fast_log2f(levels[i]);
+
+        const float upward_gain =
+            min(upward_slope * max(upward_threshold - level, 0.0f), max_gain);
+        const float downward_gain =
+            max(downward_slope * max(level - downward_threshold, 0.0f), min_gain);
+
+        gains[i] = fast_exp2f(upward_gain + downward_gain);
+    }
+
+    return;
+}
+
+
 static void Compress_states_update(
         Compress_state cstates[2],
         const Proc_compress* compress,
@@ -79,92 +138,50 @@ static void Compress_states_update(
         Compress_state* cstate = &cstates[ch];
         rassert(cstate != NULL);
 
-        if (in_wbs[ch] == NULL)
-            continue;
-
         float level = cstate->level;
 
         float* levels = Work_buffer_get_contents_mut(level_wbs[ch]);
-        const float* in = Work_buffer_get_contents(in_wbs[ch]);
 
-        for (int32_t i = buf_start; i < buf_stop; ++i)
+        if (in_wbs[ch] != NULL)
         {
-            const float in_abs = fabsf(in[i]);
-            if (in_abs > level)
+            const float* in = Work_buffer_get_contents(in_wbs[ch]);
+
+            for (int32_t i = buf_start; i < buf_stop; ++i)
             {
-                level *= attack_mul;
-                level = min(level, in_abs);
+                const float in_abs = fabsf(in[i]);
+                const float attack_level = min(level * attack_mul, in_abs);
+                const float release_level =
+                    max(level * release_mul, max((float)MIN_LEVEL, in_abs));
+                level = (in_abs > level) ? attack_level : release_level;
+
+                levels[i] = level;
             }
-            else
+        }
+        else
+        {
+            // Treat a missing input as silence
+            for (int32_t i = buf_start; i < buf_stop; ++i)
             {
-                level *= release_mul;
-                level = max(level, max((float)MIN_LEVEL, in_abs));
+                level = max(level * release_mul, (float)MIN_LEVEL);
+                levels[i] = level;
             }
-
-            levels[i] = level;
         }
 
         cstate->level = level;
     }
 
-    if ((in_wbs[0] != NULL) && (in_wbs[1] != NULL))
-    {
-        // Get maximum levels
-        for (int32_t i = buf_start; i < buf_stop; ++i)
-            level_wbs[0] = max(level_wbs[0], level_wbs[1]);
-    }
-
-    const Work_buffer* applied_levels_wb =
-        (in_wbs[0] == NULL) ? level_wbs[1] : level_wbs[0];
-    const float* applied_levels = Work_buffer_get_contents(applied_levels_wb);
-
-    Work_buffer_clear(gain_wb, buf_start, buf_stop);
-    float* gains = Work_buffer_get_contents_mut(gain_wb);
-
+    // Link the channels by following the louder one
+    float* applied_levels = Work_buffer_get_contents_mut(level_wbs[0]);
+    const float* levels_r = Work_buffer_get_contents(level_wbs[1]);
     for (int32_t i = buf_start; i < buf_stop; ++i)
-        gains[i] = 1.0f;
-
-    if (compress->upward_enabled)
-    {
-        // Apply upward compression
-        const double upward_threshold_dB =
-            compress->downward_enabled
-            ? min(compress->upward_threshold, compress->downward_threshold)
-            : compress->upward_threshold;
-        const float threshold = (float)dB_to_scale(upward_threshold_dB);
-        const float inv_ratio = (float)(1.0 / compress->upward_ratio);
-        const float max_gain = (float)dB_to_scale(compress->upward_range);
+        applied_levels[i] = max(applied_levels[i], levels_r[i]);
 
-        for (int32_t i = buf_start; i < buf_stop; ++i)
-        {
-            const float level = applied_levels[i];
-            if (level < threshold)
-            {
-                const float diff = threshold / level;
-                const float gain = threshold / (powf(diff, inv_ratio) * level);
-                gains[i] = min(gain, max_gain);
-            }
-        }
-    }
-
-    if (compress->downward_enabled)
-    {
-        // Apply downward compression
-        const float threshold = (float)dB_to_scale(compress->downward_threshold);
-        const float inv_ratio = (float)(1.0 / compress->downward_ratio);
-        const float min_gain = (float)dB_to_scale(-compress->downward_range);
-
-        for (int32_t i = buf_start; i < buf_stop; ++i)
-        {
-            const float level = applied_levels[i];
-            if (level > threshold)
-            {
-                const float diff = level / threshold;
-                const float gain = (threshold * powf(diff, inv_ratio)) / level;
-                gains[i] = max(gain, min_gain);
-            }
-        }
-    }
+    Compress_get_gains(
+            compress,
+            Work_buffer_get_contents_mut(gain_wb),
+            applied_levels,
+            buf_start,
+            buf_stop);
 
     return;
 }
@@ -206,6 +223,10 @@ typedef struct Compress_pstate
     Proc_state parent;
 
     Compress_state cstates[2];
+
+    int32_t lookahead_frames;
+    Ring_buffer* delay_bufs[2];
+    int32_t delay_buf_pos;
 } Compress_pstate;
 
 
@@ -214,12 +235,62 @@ static void del_Compress_pstate(Device_state* dstate)
     rassert(dstate != NULL);
 
     Compress_pstate* cpstate = (Compress_pstate*)dstate;
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        del_Ring_buffer(cpstate->delay_bufs[ch]);
+        cpstate->delay_bufs[ch] = NULL;
+    }
+
     memory_free(cpstate);
 
     return;
 }
 
 
+static bool Compress_pstate_update_lookahead(
+        Compress_pstate* cpstate, int32_t audio_rate)
+{
+    rassert(cpstate != NULL);
+    rassert(audio_rate > 0);
+
+    const Proc_compress* compress =
+        (const Proc_compress*)cpstate->parent.parent.device->dimpl;
+
+    const int32_t lookahead_frames =
+        (int32_t)(compress->lookahead * 0.001 * audio_rate + 0.5);
+
+    // The delay buffers are kept non-empty even if lookahead is disabled
+    const int32_t delay_buf_size = max(1, lookahead_frames);
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        Ring_buffer* buf = cpstate->delay_bufs[ch];
+
+        if (!Ring_buffer_resize(buf, delay_buf_size))
+            return false;
+
+        Ring_buffer_clear(buf);
+    }
+
+    cpstate->lookahead_frames = lookahead_frames;
+    cpstate->delay_buf_pos = 0;
+
+    return true;
+}
+
+
+static bool Compress_pstate_set_audio_rate(Device_state* dstate, int32_t audio_rate)
+{
+    rassert(dstate != NULL);
+    rassert(audio_rate > 0);
+
+    Compress_pstate* cpstate = (Compress_pstate*)dstate;
+
+    return Compress_pstate_update_lookahead(cpstate, audio_rate);
+}
+
+
 static void Compress_pstate_reset(Device_state* dstate)
 {
     rassert(dstate != NULL);
@@ -227,7 +298,79 @@ static void Compress_pstate_reset(Device_state* dstate)
     Compress_pstate* cpstate = (Compress_pstate*)dstate;
 
     for (int ch = 0; ch < 2; ++ch)
+    {
         Compress_state_init(&cpstate->cstates[ch]);
+        Ring_buffer_clear(cpstate->delay_bufs[ch]);
+    }
+
+    cpstate->delay_buf_pos = 0;
+
+    return;
+}
+
+
+static void Compress_pstate_clear_history(Proc_state* proc_state)
+{
+    rassert(proc_state != NULL);
+
+    Compress_pstate* cpstate = (Compress_pstate*)proc_state;
+
+    for (int ch = 0; ch < 2; ++ch)
+        Ring_buffer_clear(cpstate->delay_bufs[ch]);
+
+    cpstate->delay_buf_pos = 0;
+
+    return;
+}
+
+
+static void Compress_pstate_delay_audio(
+        Compress_pstate* cpstate,
+        Work_buffer* out_wbs[2],
+        const Work_buffer* in_wbs[2],
+        int32_t buf_start,
+        int32_t buf_stop)
+{
+    rassert(cpstate != NULL);
+    rassert(cpstate->lookahead_frames > 0);
+    rassert(out_wbs != NULL);
+    rassert(in_wbs != NULL);
+    rassert(buf_start >= 0);
+    rassert(buf_stop > buf_start);
+
+    const int32_t delay = cpstate->lookahead_frames;
+    const int32_t frame_count = buf_stop - buf_start;
+    const int32_t buffered_count = min(delay, frame_count);
+
+    int32_t next_pos = cpstate->delay_buf_pos;
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        if (in_wbs[ch] == NULL)
+            continue;
+
+        Ring_buffer* buf = cpstate->delay_bufs[ch];
+        rassert(Ring_buffer_get_size(buf) == delay);
+
+        const float* in = Work_buffer_get_contents(in_wbs[ch]) + buf_start;
+
+        if (out_wbs[ch] != NULL)
+        {
+            float* out = Work_buffer_get_contents_mut(out_wbs[ch]) + buf_start;
+
+            // The oldest buffered frame is exactly delay frames old
+            const float* history = Ring_buffer_get_window(buf, cpstate->delay_buf_pos);
+            for (int32_t i = 0; i < buffered_count; ++i)
+                out[i] = history[i];
+
+            for (int32_t i = buffered_count; i < frame_count; ++i)
+                out[i] = in[i - delay];
+        }
+
+        next_pos = Ring_buffer_write(buf, cpstate->delay_buf_pos, in, frame_count);
+    }
+
+    cpstate->delay_buf_pos = next_pos;
 
     return;
 }
@@ -313,7 +456,23 @@ static void Compress_pstate_render_mixed(
             buf_stop,
             dstate->audio_rate);
 
-    write_audio(out_wbs, gain_wb, in_wbs, buf_start, buf_stop);
+    if (cpstate->lookahead_frames > 0)
+    {
+        // Apply the gains to delayed input so that they react ahead of time
+        Compress_pstate_delay_audio(cpstate, out_wbs, in_wbs, buf_start, buf_stop);
+
+        const Work_buffer* delayed_wbs[2] =
+        {
+            (in_wbs[0] != NULL) ? out_wbs[0] : NULL,
+            (in_wbs[1] != NULL) ? out_wbs[1] : NULL,
+        };
+
+        write_audio(out_wbs, gain_wb, delayed_wbs, buf_start, buf_stop);
+    }
+    else
+    {
+        write_audio(out_wbs, gain_wb, in_wbs, buf_start, buf_stop);
+    }
 
     return;
 }
@@ -337,16 +496,53 @@ Device_state* new_Compress_pstate(
     }
 
     cpstate->parent.destroy = del_Compress_pstate;
+    cpstate->parent.set_audio_rate = Compress_pstate_set_audio_rate;
     cpstate->parent.reset = Compress_pstate_reset;
     cpstate->parent.render_mixed = Compress_pstate_render_mixed;
+    cpstate->parent.clear_history = Compress_pstate_clear_history;
+
+    cpstate->lookahead_frames = 0;
+    cpstate->delay_buf_pos = 0;
 
     for (int ch = 0; ch < 2; ++ch)
+    {
         Compress_state_init(&cpstate->cstates[ch]);
+        cpstate->delay_bufs[ch] = NULL;
+    }
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        cpstate->delay_bufs[ch] = new_Ring_buffer(1);
+        if (cpstate->delay_bufs[ch] == NULL)
+        {
+            del_Device_state((Device_state*)cpstate);
+            return NULL;
+        }
+    }
+
+    if (!Compress_pstate_update_lookahead(cpstate, audio_rate))
+    {
+        del_Device_state((Device_state*)cpstate);
+        return NULL;
+    }
 
     return (Device_state*)cpstate;
 }
 
 
+bool Compress_pstate_set_lookahead(
+        Device_state* dstate, const Key_indices indices, double value)
+{
+    rassert(dstate != NULL);
+    ignore(indices);
+    ignore(value);
+
+    Compress_pstate* cpstate = (Compress_pstate*)dstate;
+
+    return Compress_pstate_update_lookahead(cpstate, dstate->audio_rate);
+}
+
+
 typedef struct Compress_vstate
 {
     Voice_state parent;
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -16,12 +16,39 @@
 #define KQT_COMPRESS_STATE_H
 
 
+#include <init/devices/processors/Proc_compress.h>
 #include <player/devices/Device_state.h>
 #include <player/devices/Voice_state.h>
+#include <string/key_pattern.h>
+
+#include <stdbool.h>
+#include <stdint.h>
 
 
 Device_state_create_func new_Compress_pstate;
 
+bool Compress_pstate_set_lookahead(
+        Device_state* dstate, const Key_indices indices, double value);
+
+/**
+ * Calculate compressor gains for given signal levels.
+ *
+ * \param compress    The compressor parameters -- must not be \c NULL.
+ * \param gains       The output gains -- must not be \c NULL.
+ * \param levels      The detected signal levels -- must not be \c NULL and
+ *                    must contain positive finite values only.
+ * \param buf_start   The start index of the buffer area -- must be >= \c 0.
+ * \param buf_stop    The stop index of the buffer area -- must be
+ *                    >= \a buf_start.
+ */
+void Compress_get_gains(
+        const Proc_compress* compress,
+        float* gains,
+        const float* levels,
+        int32_t buf_start,
+        int32_t buf_stop);
+
+
 Voice_state_get_size_func Compress_vstate_get_size;
 Voice_state_init_func Compress_vstate_init;
 Voice_state_render_voice_func Compress_vstate_render_voice;
@@ -0,0 +1,326 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <player/devices/processors/Convolution_state.h>
+
+#include <debug/assert.h>
+#include <init/devices/Device.h>
+#include <init/devices/param_types/Sample.h>
+#include <init/devices/processors/Proc_convolution.h>
+#include <mathnum/common.h>
+#include <mathnum/Conv_engine.h>
+#include <mathnum/conversions.h>
+#include <memory.h>
+#include <player/devices/Device_thread_state.h>
+#include <player/devices/Proc_state.h>
+#include <player/devices/processors/Proc_state_utils.h>
+#include <player/Work_buffers.h>
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+#define CONV_PART_SIZE_MIN 64
+#define CONV_PART_SIZE_MAX 1024
+
+
+typedef struct Convolution_pstate
+{
+    Proc_state parent;
+
+    const Sample* ir;
+    double volume;
+    Conv_engine* engines[2];
+} Convolution_pstate;
+
+
+static int32_t get_part_size(int32_t audio_buffer_size)
+{
+    rassert(audio_buffer_size >= 0);
+
+    // Use the largest partition that fits in one buffer to minimise the latency
+    int32_t part_size = CONV_PART_SIZE_MIN;
+    while ((part_size < CONV_PART_SIZE_MAX) && (part_size * 2 <= audio_buffer_size))
+        part_size *= 2;
+
+    return part_size;
+}
+
+
+static bool Convolution_pstate_set_ir_data(Convolution_pstate* cpstate)
+{
+    rassert(cpstate != NULL);
+
+    const Sample* ir = cpstate->ir;
+    const int32_t ir_len = (ir != NULL)
+        ? (int32_t)min(Sample_get_len(ir), CONV_ENGINE_IR_LENGTH_MAX) : 0;
+
+    if ((ir == NULL) || (ir_len == 0) || (ir->data[0] == NULL))
+    {
+        for (int ch = 0; ch < 2; ++ch)
+            Conv_engine_set_ir(cpstate->engines[ch], NULL, 0);
+        return true;
+    }
+
+    float* ir_data = memory_alloc_items(float, Sample_get_len(ir));
+    if (ir_data == NULL)
+        return false;
+
+    bool success = true;
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        // A mono impulse response is used for both channels
+        Sample_get_float_data(ir, min(ch, ir->channels - 1), ir_data);
+        if (!Conv_engine_set_ir(cpstate->engines[ch], ir_data, ir_len))
+        {
+            success = false;
+            break;
+        }
+    }
+
+    memory_free(ir_data);
+
+    return success;
+}
+
+
+static bool Convolution_pstate_create_engines(
+        Convolution_pstate* cpstate, int32_t audio_buffer_size)
+{
+    rassert(cpstate != NULL);
+    rassert(audio_buffer_size >= 0);
+
+    const int32_t part_size = get_part_size(audio_buffer_size);
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        if ((cpstate->engines[ch] != NULL) &&
+                (Conv_engine_get_part_size(cpstate->engines[ch]) == part_size))
+            continue;
+
+        Conv_engine* engine = new_Conv_engine(part_size);
+        if (engine == NULL)
+            return false;
+
+        del_Conv_engine(cpstate->engines[ch]);
+        cpstate->engines[ch] = engine;
+    }
+
+    return Convolution_pstate_set_ir_data(cpstate);
+}
+
+
+bool Convolution_pstate_set_ir(
+        Device_state* dstate, const Key_indices indices, const Sample* value)
+{
+    rassert(dstate != NULL);
+    rassert(indices != NULL);
+
+    Convolution_pstate* cpstate = (Convolution_pstate*)dstate;
+    cpstate->ir = value;
+
+    return Convolution_pstate_set_ir_data(cpstate);
+}
+
+
+bool Convolution_pstate_set_volume(
+        Device_state* dstate, const Key_indices indices, double value)
+{
+    rassert(dstate != NULL);
+    rassert(indices != NULL);
+
+    Convolution_pstate* cpstate = (Convolution_pstate*)dstate;
+    cpstate->volume = isfinite(value) ? value : 0.0;
+
+    return true;
+}
+
+
+static void del_Convolution_pstate(Device_state* dstate)
+{
+    rassert(dstate != NULL);
+
+    Convolution_pstate* cpstate = (Convolution_pstate*)dstate;
+
+    for (int ch = 0; ch < 2; ++ch)
+        del_Conv_engine(cpstate->engines[ch]);
+
+    memory_free(cpstate);
+
+    return;
+}
+
+
+static bool Convolution_pstate_set_audio_buffer_size(
+        Device_state* dstate, int32_t buffer_size)
+{
+    rassert(dstate != NULL);
+    rassert(buffer_size >= 0);
+
+    Convolution_pstate* cpstate = (Convolution_pstate*)dstate;
+
+    return Convolution_pstate_create_engines(cpstate, buffer_size);
+}
+
+
+static void Convolution_pstate_reset(Device_state* dstate)
+{
+    rassert(dstate != NULL);
+
+    Convolution_pstate* cpstate = (Convolution_pstate*)dstate;
+
+    for (int ch = 0; ch < 2; ++ch)
+        Conv_engine_reset(cpstate->engines[ch]);
+
+    return;
+}
+
+
+static void Convolution_pstate_clear_history(Proc_state* proc_state)
+{
+    rassert(proc_state != NULL);
+
+    Convolution_pstate_reset((Device_state*)proc_state);
+
+    return;
+}
+
+
+enum
+{
+    PORT_IN_AUDIO_L = 0,
+    PORT_IN_AUDIO_R,
+    PORT_IN_COUNT
+};
+
+enum
+{
+    PORT_OUT_AUDIO_L = 0,
+    PORT_OUT_AUDIO_R,
+    PORT_OUT_COUNT
+};
+
+
+static const int CONVOLUTION_WB_SILENCE = WORK_BUFFER_IMPL_1;
+static const int CONVOLUTION_WB_DISCARD_L = WORK_BUFFER_IMPL_2;
+static const int CONVOLUTION_WB_DISCARD_R = WORK_BUFFER_IMPL_3;
+
+
+static void Convolution_pstate_render_mixed(
+        Device_state* dstate,
+        Device_thread_state* proc_ts,
+        const Work_buffers* wbs,
+        int32_t buf_start,
+        int32_t buf_stop,
+        double tempo)
+{
+    rassert(dstate != NULL);
+    rassert(proc_ts != NULL);
+    rassert(wbs != NULL);
+    rassert(buf_start >= 0);
+    rassert(isfinite(tempo));
+    rassert(tempo > 0);
+
+    Convolution_pstate* cpstate = (Convolution_pstate*)dstate;
+
+    float* in_bufs[2] = { NULL };
+    Proc_state_get_mixed_audio_in_buffers(
+            proc_ts, PORT_IN_AUDIO_L, PORT_IN_COUNT, in_bufs);
+
+    float* out_bufs[2] = { NULL };
+    Proc_state_get_mixed_audio_out_buffers(
+            proc_ts, PORT_OUT_AUDIO_L, PORT_OUT_COUNT, out_bufs);
+
+    // Feed the existing input to both channels if the other one is missing
+    if ((in_bufs[0] == NULL) != (in_bufs[1] == NULL))
+    {
+        const int missing = (in_bufs[0] == NULL) ? 0 : 1;
+        in_bufs[missing] = in_bufs[1 - missing];
+    }
+    else if (in_bufs[0] == NULL)
+    {
+        float* silence =
+            Work_buffers_get_buffer_contents_mut(wbs, CONVOLUTION_WB_SILENCE);
+        for (int32_t i = buf_start; i < buf_stop; ++i)
+            silence[i] = 0;
+
+        in_bufs[0] = silence;
+        in_bufs[1] = silence;
+    }
+
+    const float scale = (float)dB_to_scale(cpstate->volume);
+    const int32_t frame_count = buf_stop - buf_start;
+
+    const int discard_wb_types[] = { CONVOLUTION_WB_DISCARD_L, CONVOLUTION_WB_DISCARD_R };
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        // Keep processing with no output so that the history stays in sync
+        float* out = (out_bufs[ch] != NULL)
+            ? out_bufs[ch]
+            : Work_buffers_get_buffer_contents_mut(wbs, discard_wb_types[ch]);
+
+        Conv_engine_process(
+                cpstate->engines[ch], in_bufs[ch] + buf_start, out + buf_start, frame_count);
+
+        if (out_bufs[ch] != NULL)
+        {
+            for (int32_t i = buf_start; i < buf_stop; ++i)
+                out[i] *= scale;
+        }
+    }
+
+    return;
+}
+
+
+Device_state* new_Convolution_pstate(
+        const Device* device, int32_t audio_rate, int32_t audio_buffer_size)
+{
+    rassert(device != NULL);
+    rassert(audio_rate > 0);
+    rassert(audio_buffer_size >= 0);
+
+    Convolution_pstate* cpstate = memory_alloc_item(Convolution_pstate);
+    if ((cpstate == NULL) ||
+            !Proc_state_init(&cpstate->parent, device, audio_rate, audio_buffer_size))
+    {
+        memory_free(cpstate);
+        return NULL;
+    }
+
+    cpstate->parent.destroy = del_Convolution_pstate;
+    cpstate->parent.set_audio_buffer_size = Convolution_pstate_set_audio_buffer_size;
+    cpstate->parent.reset = Convolution_pstate_reset;
+    cpstate->parent.render_mixed = Convolution_pstate_render_mixed;
+    cpstate->parent.clear_history = Convolution_pstate_clear_history;
+
+    cpstate->ir = NULL;
+    cpstate->volume = 0.0;
+    cpstate->engines[0] = NULL;
+    cpstate->engines[1] = NULL;
+
+    if (!Convolution_pstate_create_engines(cpstate, audio_buffer_size))
+    {
+        del_Device_state(&cpstate->parent.parent);
+        return NULL;
+    }
+
+    return &cpstate->parent.parent;
+}
+
+
@@ -0,0 +1,30 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#ifndef KQT_CONVOLUTION_STATE_H
+#define KQT_CONVOLUTION_STATE_H
+
+
+#include <init/devices/Device_impl.h>
+#include <player/devices/Device_state.h>
+
+
+Device_state_create_func new_Convolution_pstate;
+Set_state_sample_func Convolution_pstate_set_ir;
+Set_state_float_func Convolution_pstate_set_volume;
+
+
+#endif // KQT_CONVOLUTION_STATE_H
+
+
@@ -23,7 +23,8 @@
 #include <player/devices/processors/Proc_state_utils.h>
 #include <player/Linear_controls.h>
 #include <player/Player.h>
-#include <player/Work_buffer.h>
+#include <player/Ring_buffer.h>
+#include <player/Work_buffers.h>
 
 #include <float.h>
 #include <math.h>
@@ -36,7 +37,7 @@ typedef struct Delay_pstate
 {
     Proc_state parent;
 
-    Work_buffer* bufs[KQT_BUFFERS_MAX];
+    Ring_buffer* bufs[KQT_BUFFERS_MAX];
     int32_t buf_pos;
 } Delay_pstate;
 
@@ -49,11 +50,8 @@ static void del_Delay_pstate(Device_state* dstate)
 
     for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
     {
-        if (dpstate->bufs[i] != NULL)
-        {
-            del_Work_buffer(dpstate->bufs[i]);
-            dpstate->bufs[i] = NULL;
-        }
+        del_Ring_buffer(dpstate->bufs[i]);
+        dpstate->bufs[i] = NULL;
     }
 
     memory_free(dpstate);
@@ -75,12 +73,12 @@ static bool Delay_pstate_set_audio_rate(Device_state* dstate, int32_t audio_rate
 
     for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
     {
-        Work_buffer* buf = dpstate->bufs[i];
+        Ring_buffer* buf = dpstate->bufs[i];
 
-        if (!Work_buffer_resize(buf, delay_buf_size))
+        if (!Ring_buffer_resize(buf, delay_buf_size))
             return false;
 
-        Work_buffer_clear(buf, 0, Work_buffer_get_size(buf));
+        Ring_buffer_clear(buf);
     }
 
     dpstate->buf_pos = 0;
@@ -96,10 +94,7 @@ static void Delay_pstate_reset(Device_state* dstate)
     Delay_pstate* dpstate = (Delay_pstate*)dstate;
 
     for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
-    {
-        Work_buffer* buf = dpstate->bufs[i];
-        Work_buffer_clear(buf, 0, Work_buffer_get_size(buf));
-    }
+        Ring_buffer_clear(dpstate->bufs[i]);
 
     dpstate->buf_pos = 0;
 
@@ -155,16 +150,18 @@ static void Delay_pstate_render_mixed(
     Proc_state_get_mixed_audio_out_buffers(
             proc_ts, PORT_OUT_AUDIO_L, PORT_OUT_COUNT, out_data);
 
-    float* history_data[] =
+    const int32_t delay_buf_size = Ring_buffer_get_size(dpstate->bufs[0]);
+    rassert(delay_buf_size == Ring_buffer_get_size(dpstate->bufs[1]));
+    const int32_t delay_max = delay_buf_size - 1;
+
+    // Get history views that end at the current buffer position,
+    // i.e. index -1 contains the most recent frame
+    const float* history_data[] =
     {
-        Work_buffer_get_contents_mut(dpstate->bufs[0]),
-        Work_buffer_get_contents_mut(dpstate->bufs[1]),
+        Ring_buffer_get_window(dpstate->bufs[0], dpstate->buf_pos) + delay_buf_size,
+        Ring_buffer_get_window(dpstate->bufs[1], dpstate->buf_pos) + delay_buf_size,
     };
 
-    const int32_t delay_buf_size = Work_buffer_get_size(dpstate->bufs[0]);
-    rassert(delay_buf_size == Work_buffer_get_size(dpstate->bufs[1]));
-    const int32_t delay_max = delay_buf_size - 1;
-
     float* total_offsets = Work_buffers_get_buffer_contents_mut(
             wbs, DELAY_WORK_BUFFER_TOTAL_OFFSETS);
 
@@ -180,8 +177,6 @@ static void Delay_pstate_render_mixed(
             delays[i] = init_delay;
     }
 
-    int32_t cur_dpstate_buf_pos = dpstate->buf_pos;
-
     const int32_t audio_rate = dstate->audio_rate;
 
     // Get total offsets
@@ -235,20 +230,13 @@ static void Delay_pstate_render_mixed(
             }
             else
             {
-                const int32_t cur_delay_buf_pos =
-                    (cur_dpstate_buf_pos + cur_pos + delay_buf_size) % delay_buf_size;
-                rassert(cur_delay_buf_pos >= 0);
+                rassert(cur_pos >= -delay_buf_size);
 
-                cur_val = history[cur_delay_buf_pos];
+                cur_val = history[cur_pos];
 
                 if (next_pos < 0)
                 {
-                    const int32_t next_delay_buf_pos =
-                        (cur_dpstate_buf_pos + next_pos + delay_buf_size) %
-                        delay_buf_size;
-                    rassert(next_delay_buf_pos >= 0);
-
-                    next_val = history[next_delay_buf_pos];
+                    next_val = history[next_pos];
                 }
                 else
                 {
@@ -267,31 +255,19 @@ static void Delay_pstate_render_mixed(
     }
 
     // Update the delay state buffers
+    int32_t next_dpstate_buf_pos = dpstate->buf_pos;
+
     for (int ch = 0; ch < 2; ++ch)
     {
         const float* in = in_data[ch];
         if (in == NULL)
             continue;
 
-        float* history = history_data[ch];
-        rassert(history != NULL);
-
-        cur_dpstate_buf_pos = dpstate->buf_pos;
-
-        for (int32_t i = buf_start; i < buf_stop; ++i)
-        {
-            history[cur_dpstate_buf_pos] = in[i];
-
-            ++cur_dpstate_buf_pos;
-            if (cur_dpstate_buf_pos >= delay_buf_size)
-            {
-                rassert(cur_dpstate_buf_pos == delay_buf_size);
-                cur_dpstate_buf_pos = 0;
-            }
-        }
+        next_dpstate_buf_pos = Ring_buffer_write(
+                dpstate->bufs[ch], dpstate->buf_pos, in + buf_start, buf_stop - buf_start);
     }
 
-    dpstate->buf_pos = cur_dpstate_buf_pos;
+    dpstate->buf_pos = next_dpstate_buf_pos;
 
     return;
 }
@@ -304,10 +280,7 @@ static void Delay_pstate_clear_history(Proc_state* proc_state)
     Delay_pstate* dpstate = (Delay_pstate*)proc_state;
 
     for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
-    {
-        Work_buffer* buf = dpstate->bufs[i];
-        Work_buffer_clear(buf, 0, Work_buffer_get_size(buf));
-    }
+        Ring_buffer_clear(dpstate->bufs[i]);
 
     dpstate->buf_pos = 0;
 
@@ -348,7 +321,7 @@ Device_state* new_Delay_pstate(
 
     for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
     {
-        dpstate->bufs[i] = new_Work_buffer_unbounded(delay_buf_size);
+        dpstate->bufs[i] = new_Ring_buffer(delay_buf_size);
         if (dpstate->bufs[i] == NULL)
         {
             del_Device_state(&dpstate->parent.parent);
@@ -375,12 +348,12 @@ bool Delay_pstate_set_max_delay(
 
     for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
     {
-        Work_buffer* buf = dpstate->bufs[i];
+        Ring_buffer* buf = dpstate->bufs[i];
 
-        if (!Work_buffer_resize(buf, delay_buf_size))
+        if (!Ring_buffer_resize(buf, delay_buf_size))
             return false;
 
-        Work_buffer_clear(buf, 0, Work_buffer_get_size(buf));
+        Ring_buffer_clear(buf);
     }
 
     dpstate->buf_pos = 0;
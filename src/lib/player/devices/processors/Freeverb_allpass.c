@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -18,6 +18,7 @@
 #include <intrinsics.h>
 #include <mathnum/common.h>
 #include <memory.h>
+#include <player/Ring_buffer.h>
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -27,8 +28,7 @@
 struct Freeverb_allpass
 {
     float feedback;
-    float* buffer;
-    int32_t buffer_size;
+    Ring_buffer* buffer;
     int32_t buffer_pos;
 };
 
@@ -43,15 +43,13 @@ Freeverb_allpass* new_Freeverb_allpass(int32_t buffer_size)
 
     allpass->feedback = 0;
     allpass->buffer = NULL;
-    allpass->buffer_size = 0;
     allpass->buffer_pos = 0;
-    allpass->buffer = memory_alloc_items(float, buffer_size);
+    allpass->buffer = new_Ring_buffer(buffer_size);
     if (allpass->buffer == NULL)
     {
         del_Freeverb_allpass(allpass);
         return NULL;
     }
-    allpass->buffer_size = buffer_size;
     Freeverb_allpass_clear(allpass);
 
     return allpass;
@@ -80,19 +78,37 @@ void Freeverb_allpass_process(
     dassert(_MM_GET_FLUSH_ZERO_MODE() == _MM_FLUSH_ZERO_ON);
 #endif
 
-    for (int32_t i = buf_start; i < buf_stop; ++i)
+    const float feedback = allpass->feedback;
+    const int32_t buffer_size = Ring_buffer_get_size(allpass->buffer);
+
+    int32_t cur_pos = buf_start;
+    while (cur_pos < buf_stop)
     {
-        float bufout = allpass->buffer[allpass->buffer_pos];
+        // The delay is not shorter than the area, and the buffer is mirrored,
+        // so the samples inside the area can be processed independently
+        const int32_t area_length = min(buf_stop - cur_pos, buffer_size);
+        float* restrict delay_buf =
+            Ring_buffer_get_window_mut(allpass->buffer, allpass->buffer_pos);
+        float* restrict area_buf = buffer + cur_pos;
+
+        for (int32_t i = 0; i < area_length; ++i)
+        {
+            float bufout = delay_buf[i];
 #ifndef KQT_SSE
-        bufout = undenormalise(bufout);
+            bufout = undenormalise(bufout);
 #endif
-        allpass->buffer[allpass->buffer_pos] = buffer[i] + (bufout * allpass->feedback);
+            delay_buf[i] = area_buf[i] + (bufout * feedback);
+
+            area_buf[i] = -area_buf[i] + bufout;
+        }
+
+        Ring_buffer_sync(allpass->buffer, allpass->buffer_pos, area_length);
 
-        buffer[i] = -buffer[i] + bufout;
+        allpass->buffer_pos += area_length;
+        if (allpass->buffer_pos >= buffer_size)
+            allpass->buffer_pos -= buffer_size;
 
-        ++allpass->buffer_pos;
-        if (allpass->buffer_pos >= allpass->buffer_size)
-            allpass->buffer_pos = 0;
+        cur_pos += area_length;
     }
 
     return;
@@ -104,15 +120,12 @@ bool Freeverb_allpass_resize_buffer(Freeverb_allpass* allpass, int32_t new_size)
     rassert(allpass != NULL);
     rassert(new_size > 0);
 
-    if (new_size == allpass->buffer_size)
+    if (new_size == Ring_buffer_get_size(allpass->buffer))
         return true;
 
-    float* buffer = memory_realloc_items(float, new_size, allpass->buffer);
-    if (buffer == NULL)
+    if (!Ring_buffer_resize(allpass->buffer, new_size))
         return false;
 
-    allpass->buffer = buffer;
-    allpass->buffer_size = new_size;
     Freeverb_allpass_clear(allpass);
     allpass->buffer_pos = 0;
 
@@ -125,8 +138,7 @@ void Freeverb_allpass_clear(Freeverb_allpass* allpass)
     rassert(allpass != NULL);
     rassert(allpass->buffer != NULL);
 
-    for (int32_t i = 0; i < allpass->buffer_size; ++i)
-        allpass->buffer[i] = 0;
+    Ring_buffer_clear(allpass->buffer);
 
     return;
 }
@@ -137,7 +149,7 @@ void del_Freeverb_allpass(Freeverb_allpass* allpass)
     if (allpass == NULL)
         return;
 
-    memory_free(allpass->buffer);
+    del_Ring_buffer(allpass->buffer);
     memory_free(allpass);
 
     return;
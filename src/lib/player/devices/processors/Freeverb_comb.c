@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -18,6 +18,7 @@
 #include <intrinsics.h>
 #include <mathnum/common.h>
 #include <memory.h>
+#include <player/Ring_buffer.h>
 
 #include <stdint.h>
 #include <stdio.h>
@@ -27,8 +28,7 @@
 struct Freeverb_comb
 {
     float filter_store;
-    float* buffer;
-    int32_t buffer_size;
+    Ring_buffer* buffer;
     int32_t buffer_pos;
 };
 
@@ -43,24 +43,22 @@ Freeverb_comb* new_Freeverb_comb(int32_t buffer_size)
 
     comb->filter_store = 0;
     comb->buffer = NULL;
-    comb->buffer_size = 0;
     comb->buffer_pos = 0;
 
-    comb->buffer = memory_alloc_items(float, buffer_size);
+    comb->buffer = new_Ring_buffer(buffer_size);
     if (comb->buffer == NULL)
     {
         del_Freeverb_comb(comb);
         return NULL;
     }
-    comb->buffer_size = buffer_size;
     Freeverb_comb_clear(comb);
 
     return comb;
 }
 
 
-void Freeverb_comb_process(
-        Freeverb_comb* comb,
+void Freeverb_comb_bank_process(
+        Freeverb_comb* const combs[FREEVERB_COMB_BANK_SIZE],
         float* out_buf,
         const float* in_buf,
         const float* refls,
@@ -68,7 +66,7 @@ void Freeverb_comb_process(
         int32_t buf_start,
         int32_t buf_stop)
 {
-    rassert(comb != NULL);
+    rassert(combs != NULL);
     rassert(out_buf != NULL);
     rassert(in_buf != NULL);
     rassert(refls != NULL);
@@ -80,27 +78,83 @@ void Freeverb_comb_process(
     dassert(_MM_GET_FLUSH_ZERO_MODE() == _MM_FLUSH_ZERO_ON);
 #endif
 
-    for (int32_t i = buf_start; i < buf_stop; ++i)
+    float filter_stores[FREEVERB_COMB_BANK_SIZE];
+    for (int lane = 0; lane < FREEVERB_COMB_BANK_SIZE; ++lane)
+    {
+        rassert(combs[lane] != NULL);
+        filter_stores[lane] = combs[lane]->filter_store;
+    }
+
+    // Frames written in one area must not be read within the same area
+    int32_t max_area_length = buf_stop - buf_start;
+    for (int lane = 0; lane < FREEVERB_COMB_BANK_SIZE; ++lane)
+        max_area_length = min(max_area_length, Ring_buffer_get_size(combs[lane]->buffer));
+
+    int32_t cur_pos = buf_start;
+    while (cur_pos < buf_stop)
     {
-        float output = comb->buffer[comb->buffer_pos];
+        // The comb buffers are mirrored, so each area is linear in all of them
+        const int32_t area_length = min(buf_stop - cur_pos, max_area_length);
+        float* bufs[FREEVERB_COMB_BANK_SIZE];
+        for (int lane = 0; lane < FREEVERB_COMB_BANK_SIZE; ++lane)
+        {
+            Freeverb_comb* comb = combs[lane];
+            bufs[lane] = Ring_buffer_get_window_mut(comb->buffer, comb->buffer_pos);
+        }
+
+        // The delays are not shorter than the area, so the lanes only depend
+        // on each other through the filter stores
+        for (int32_t i = 0; i < area_length; ++i)
+        {
+            const float input = in_buf[cur_pos + i];
+            const float damp1 = damps[cur_pos + i];
+            const float damp2 = 1 - damp1;
+            const float refl = refls[cur_pos + i];
+
+            float outputs[FREEVERB_COMB_BANK_SIZE];
+            for (int lane = 0; lane < FREEVERB_COMB_BANK_SIZE; ++lane)
+            {
+                outputs[lane] = bufs[lane][i];
 #ifndef KQT_SSE
-        output = undenormalise(output);
+                outputs[lane] = undenormalise(outputs[lane]);
 #endif
-        const float damp1 = damps[i];
-        const float damp2 = 1 - damp1;
-        comb->filter_store = (output * damp2) + (comb->filter_store * damp1);
+            }
+
+            for (int lane = 0; lane < FREEVERB_COMB_BANK_SIZE; ++lane)
+            {
+                filter_stores[lane] =
+                    (outputs[lane] * damp2) + (filter_stores[lane] * damp1);
 #ifndef KQT_SSE
-        comb->filter_store = undenormalise(comb->filter_store);
+                filter_stores[lane] = undenormalise(filter_stores[lane]);
 #endif
-        comb->buffer[comb->buffer_pos] = in_buf[i] + (comb->filter_store * refls[i]);
+            }
 
-        out_buf[i] += output;
+            for (int lane = 0; lane < FREEVERB_COMB_BANK_SIZE; ++lane)
+                bufs[lane][i] = input + (filter_stores[lane] * refl);
 
-        ++comb->buffer_pos;
-        if (comb->buffer_pos >= comb->buffer_size)
-            comb->buffer_pos = 0;
+            float mixed = out_buf[cur_pos + i];
+            for (int lane = 0; lane < FREEVERB_COMB_BANK_SIZE; ++lane)
+                mixed += outputs[lane];
+            out_buf[cur_pos + i] = mixed;
+        }
+
+        for (int lane = 0; lane < FREEVERB_COMB_BANK_SIZE; ++lane)
+        {
+            Freeverb_comb* comb = combs[lane];
+            Ring_buffer_sync(comb->buffer, comb->buffer_pos, area_length);
+
+            const int32_t buffer_size = Ring_buffer_get_size(comb->buffer);
+            comb->buffer_pos += area_length;
+            if (comb->buffer_pos >= buffer_size)
+                comb->buffer_pos -= buffer_size;
+        }
+
+        cur_pos += area_length;
     }
 
+    for (int lane = 0; lane < FREEVERB_COMB_BANK_SIZE; ++lane)
+        combs[lane]->filter_store = filter_stores[lane];
+
     return;
 }
 
@@ -110,15 +164,12 @@ bool Freeverb_comb_resize_buffer(Freeverb_comb* comb, int32_t new_size)
     rassert(comb != NULL);
     rassert(new_size > 0);
 
-    if (new_size == comb->buffer_size)
+    if (new_size == Ring_buffer_get_size(comb->buffer))
         return true;
 
-    float* buffer = memory_realloc_items(float, new_size, comb->buffer);
-    if (buffer == NULL)
+    if (!Ring_buffer_resize(comb->buffer, new_size))
         return false;
 
-    comb->buffer = buffer;
-    comb->buffer_size = new_size;
     Freeverb_comb_clear(comb);
     comb->buffer_pos = 0;
 
@@ -132,9 +183,7 @@ void Freeverb_comb_clear(Freeverb_comb* comb)
     rassert(comb->buffer != NULL);
 
     comb->filter_store = 0;
-
-    for (int32_t i = 0; i < comb->buffer_size; ++i)
-        comb->buffer[i] = 0;
+    Ring_buffer_clear(comb->buffer);
 
     return;
 }
@@ -145,7 +194,7 @@ void del_Freeverb_comb(Freeverb_comb* comb)
     if (comb == NULL)
         return;
 
-    memory_free(comb->buffer);
+    del_Ring_buffer(comb->buffer);
     memory_free(comb);
 
     return;
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2010-2016
+ * Author: Tomi Jylhä-Ollila, Finland 2010-2018
  *
  * This file is part of Kunquat.
  *
@@ -39,9 +39,19 @@ Freeverb_comb* new_Freeverb_comb(int32_t buffer_size);
 
 
 /**
- * Process data buffer.
+ * The number of comb filters processed together by \a Freeverb_comb_bank_process.
+ */
+#define FREEVERB_COMB_BANK_SIZE 8
+
+
+/**
+ * Process data buffer with a bank of comb filters.
+ *
+ * The comb filters are run in parallel lanes over the same input signal. The
+ * output of each comb filter is mixed to the output buffer in bank order.
  *
- * \param comb        The Freeverb comb filter -- must not be \c NULL.
+ * \param combs       The Freeverb comb filters -- must not be \c NULL and must
+ *                    contain \c FREEVERB_COMB_BANK_SIZE comb filters.
  * \param out_buf     The output buffer where the result is mixed -- must not be \c NULL.
  * \param in_buf      The input signal buffer -- must not be \c NULL.
  * \param refls       The reflectivity parameter buffer -- must not be \c NULL.
@@ -49,8 +59,8 @@ Freeverb_comb* new_Freeverb_comb(int32_t buffer_size);
  * \param buf_start   The buffer start position -- must be >= \c 0.
  * \param buf_stop    The buffer stop position -- must be > \a buf_start.
  */
-void Freeverb_comb_process(
-        Freeverb_comb* comb,
+void Freeverb_comb_bank_process(
+        Freeverb_comb* const combs[FREEVERB_COMB_BANK_SIZE],
         float* out_buf,
         const float* in_buf,
         const float* refls,
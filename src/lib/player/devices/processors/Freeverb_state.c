@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2015-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2015-2018
  *
  * This file is part of Kunquat.
  *
@@ -16,7 +16,6 @@
 
 #include <debug/assert.h>
 #include <init/devices/processors/Proc_freeverb.h>
-#include <intrinsics.h>
 #include <mathnum/common.h>
 #include <mathnum/fast_exp2.h>
 #include <memory.h>
@@ -27,7 +26,7 @@
 #include <player/Work_buffers.h>
 
 
-#define FREEVERB_COMBS 8
+#define FREEVERB_COMBS FREEVERB_COMB_BANK_SIZE
 #define FREEVERB_ALLPASSES 4
 
 
@@ -318,36 +317,26 @@ static void Freeverb_pstate_render_mixed(
         for (int32_t i = buf_start; i < buf_stop; ++i)
             comb_input[i] = (float)((ws[0][i] + ws[1][i]) * freeverb->gain);
 
-#ifdef KQT_SSE
-        const unsigned int old_ftoz = _MM_GET_FLUSH_ZERO_MODE();
-        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
-#endif
-
         for (int ch = 0; ch < 2; ++ch)
         {
             float* ws_buf = ws[ch];
             for (int32_t i = buf_start; i < buf_stop; ++i)
                 ws_buf[i] = 0;
 
-            for (int comb = 0; comb < FREEVERB_COMBS; ++comb)
-                Freeverb_comb_process(
-                        fstate->combs[ch][comb],
-                        ws_buf,
-                        comb_input,
-                        refls,
-                        damps,
-                        buf_start,
-                        buf_stop);
+            Freeverb_comb_bank_process(
+                    fstate->combs[ch],
+                    ws_buf,
+                    comb_input,
+                    refls,
+                    damps,
+                    buf_start,
+                    buf_stop);
 
             for (int allpass = 0; allpass < FREEVERB_ALLPASSES; ++allpass)
                 Freeverb_allpass_process(
                         fstate->allpasses[ch][allpass], ws_buf, buf_start, buf_stop);
         }
 
-#ifdef KQT_SSE
-        _MM_SET_FLUSH_ZERO_MODE(old_ftoz);
-#endif
-
         for (int32_t i = buf_start; i < buf_stop; ++i)
         {
             ws[0][i] = (float)(ws[0][i] * freeverb->wet1 + ws[1][i] * freeverb->wet2);
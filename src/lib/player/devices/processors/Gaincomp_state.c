@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2015-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2015-2018
  *
  * This file is part of Kunquat.
  *
@@ -18,6 +18,7 @@
 #include <init/devices/Device.h>
 #include <init/devices/processors/Proc_gaincomp.h>
 #include <mathnum/common.h>
+#include <mathnum/kernels.h>
 #include <memory.h>
 #include <player/devices/Device_state.h>
 #include <player/devices/Device_thread_state.h>
@@ -28,6 +29,49 @@
 #include <stdint.h>
 
 
+void Gaincomp_get_mapped_values(
+        const Envelope* map,
+        float* out_values,
+        const float* in_values,
+        int32_t buf_start,
+        int32_t buf_stop)
+{
+    rassert(map != NULL);
+    rassert(out_values != NULL);
+    rassert(in_values != NULL);
+    rassert(buf_start >= 0);
+    rassert(buf_stop >= buf_start);
+
+    const double* first = Envelope_get_node(map, 0);
+    if (first[0] == -1)
+    {
+        // Asymmetric distortion
+        for (int32_t i = buf_start; i < buf_stop; ++i)
+        {
+            const float clamped_in_value = clamp(in_values[i], -1.0f, 1.0f);
+            out_values[i] = (float)Envelope_get_value(map, clamped_in_value);
+        }
+    }
+    else
+    {
+        // Symmetric distortion
+        for (int32_t i = buf_start; i < buf_stop; ++i)
+        {
+            const float in_value = in_values[i];
+            const float abs_value = fabsf(in_value);
+
+            float out_value = (float)Envelope_get_value(map, min(abs_value, 1));
+            if (in_value < 0)
+                out_value = -out_value;
+
+            out_values[i] = out_value;
+        }
+    }
+
+    return;
+}
+
+
 static void distort(
         const Proc_gaincomp* gc,
         const Work_buffer* in_buffer,
@@ -41,40 +85,32 @@ static void distort(
     rassert(buf_start >= 0);
     rassert(buf_stop >= 0);
 
-    if (gc->is_map_enabled && (gc->map != NULL))
+    if (!gc->is_map_enabled || (gc->map == NULL))
     {
-        const float* in_values = Work_buffer_get_contents(in_buffer);
-        float* out_values = Work_buffer_get_contents_mut(out_buffer);
-
-        const double* first = Envelope_get_node(gc->map, 0);
-        if (first[0] == -1)
-        {
-            // Asymmetric distortion
-            for (int32_t i = buf_start; i < buf_stop; ++i)
-            {
-                const float clamped_in_value = clamp(in_values[i], -1.0f, 1.0f);
-                out_values[i] = (float)Envelope_get_value(gc->map, clamped_in_value);
-            }
-        }
-        else
-        {
-            // Symmetric distortion
-            for (int32_t i = buf_start; i < buf_stop; ++i)
-            {
-                const float in_value = in_values[i];
-                const float abs_value = fabsf(in_value);
-
-                float out_value = (float)Envelope_get_value(gc->map, min(abs_value, 1));
-                if (in_value < 0)
-                    out_value = -out_value;
-
-                out_values[i] = out_value;
-            }
-        }
+        Work_buffer_copy(out_buffer, in_buffer, buf_start, buf_stop);
+        return;
     }
-    else
+
+    if (buf_start >= buf_stop)
+        return;
+
+    const int32_t const_start =
+        clamp(Work_buffer_get_const_start(in_buffer), buf_start, buf_stop);
+
+    const float* in_values = Work_buffer_get_contents(in_buffer);
+    float* out_values = Work_buffer_get_contents_mut(out_buffer);
+
+    // Process the constant trail of the input as a single frame
+    const int32_t process_stop = min(const_start + 1, buf_stop);
+
+    Gaincomp_get_mapped_values(gc->map, out_values, in_values, buf_start, process_stop);
+
+    if (process_stop < buf_stop)
     {
-        Work_buffer_copy(out_buffer, in_buffer, buf_start, buf_stop);
+        kernel_fill(
+                out_values + process_stop,
+                out_values[const_start],
+                buf_stop - process_stop);
     }
 
     return;
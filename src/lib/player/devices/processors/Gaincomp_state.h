@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2015-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2015-2018
  *
  * This file is part of Kunquat.
  *
@@ -16,12 +16,34 @@
 #define KQT_GAINCOMP_STATE_H
 
 
+#include <init/devices/param_types/Envelope.h>
 #include <player/devices/Device_state.h>
 #include <player/devices/Voice_state.h>
 
+#include <stdint.h>
+
 
 Device_state_create_func new_Gaincomp_pstate;
 
+/**
+ * Map signal values through a gain compensation map.
+ *
+ * \param map          The map -- must not be \c NULL and must be valid as
+ *                     the map of a gain compensation processor.
+ * \param out_values   The output values -- must not be \c NULL.
+ * \param in_values    The input values -- must not be \c NULL.
+ * \param buf_start    The start index of the buffer area -- must be >= \c 0.
+ * \param buf_stop     The stop index of the buffer area -- must be
+ *                     >= \a buf_start.
+ */
+void Gaincomp_get_mapped_values(
+        const Envelope* map,
+        float* out_values,
+        const float* in_values,
+        int32_t buf_start,
+        int32_t buf_stop);
+
+
 Voice_state_get_size_func Gaincomp_vstate_get_size;
 Voice_state_render_voice_func Gaincomp_vstate_render_voice;
 
@@ -361,7 +361,13 @@ int32_t Ks_vstate_render_voice(
 
     // Get delay buffer
     Work_buffer* delay_wb = ks_vstate->parent.wb;
-    rassert(delay_wb != NULL);
+    if (delay_wb == NULL)
+    {
+        // All delay buffers are in use by other Voices
+        vstate->active = false;
+        return buf_start;
+    }
+
     const int32_t delay_wb_size = Work_buffer_get_size(delay_wb);
 
     const bool need_init =
@@ -488,8 +494,8 @@ void Ks_vstate_init(Voice_state* vstate, const Proc_state* proc_state)
     Read_state_clear(&ks_vstate->read_states[1]);
 
     Work_buffer* delay_wb = ks_vstate->parent.wb;
-    rassert(delay_wb != NULL);
-    Work_buffer_clear(delay_wb, 0, Work_buffer_get_size(delay_wb));
+    if (delay_wb != NULL)
+        Work_buffer_clear(delay_wb, 0, Work_buffer_get_size(delay_wb));
 
     return;
 }
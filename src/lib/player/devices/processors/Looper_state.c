@@ -22,6 +22,7 @@
 #include <player/devices/Device_thread_state.h>
 #include <player/devices/Proc_state.h>
 #include <player/devices/processors/Proc_state_utils.h>
+#include <player/Ring_buffer.h>
 #include <player/Work_buffer.h>
 #include <player/Work_buffers.h>
 #include <string/common.h>
@@ -382,10 +383,9 @@ static void Mode_context_render(
         Mode_context* context,
         float* out_bufs[2],
         float* in_bufs[2],
-        float* history_bufs[2],
+        Ring_buffer* history_bufs[2],
         const float* total_offsets,
         bool is_head_pos_moving,
-        int32_t history_buf_size,
         int32_t head_pos,
         int32_t buf_start,
         int32_t buf_stop,
@@ -403,6 +403,17 @@ static void Mode_context_render(
     if (!Mode_context_is_playback_enabled(context))
         return;
 
+    const int32_t history_buf_size = Ring_buffer_get_size(history_bufs[0]);
+    rassert(history_buf_size == Ring_buffer_get_size(history_bufs[1]));
+
+    // Get history views that end at the head position,
+    // i.e. index -1 contains the most recent frame
+    const float* history_data[] =
+    {
+        Ring_buffer_get_window(history_bufs[0], head_pos) + history_buf_size,
+        Ring_buffer_get_window(history_bufs[1], head_pos) + history_buf_size,
+    };
+
     if (context->mode == MODE_BYPASS)
     {
         for (int ch = 0; ch < 2; ++ch)
@@ -431,7 +442,7 @@ static void Mode_context_render(
             if (in == NULL)
                 continue;
 
-            float* history = history_bufs[ch];
+            Ring_buffer* history = history_bufs[ch];
             rassert(history != NULL);
 
             write_pos = context->write_pos;
@@ -440,7 +451,7 @@ static void Mode_context_render(
             {
                 const int32_t history_buf_pos =
                     (head_pos + write_pos + history_buf_size) % history_buf_size;
-                history[history_buf_pos] += in[i];
+                Ring_buffer_mix_frame(history, history_buf_pos, in[i]);
 
                 ++write_pos;
                 if (write_pos >= context->range.stop)
@@ -460,8 +471,7 @@ static void Mode_context_render(
         if ((in == NULL) || (out == NULL))
             continue;
 
-        const float* history = history_bufs[ch];
-        rassert(history != NULL);
+        const float* history = history_data[ch];
 
         for (int32_t i = buf_start; i < buf_stop; ++i)
         {
@@ -490,19 +500,13 @@ static void Mode_context_render(
             }
             else
             {
-                const int32_t cur_history_buf_pos =
-                    (head_pos + cur_pos + history_buf_size) % history_buf_size;
-                rassert(cur_history_buf_pos >= 0);
+                rassert(cur_pos >= -history_buf_size);
 
-                cur_val = history[cur_history_buf_pos];
+                cur_val = history[cur_pos];
 
                 if (next_pos < 0)
                 {
-                    const int32_t next_history_buf_pos =
-                        (head_pos + next_pos + history_buf_size) % history_buf_size;
-                    rassert(next_history_buf_pos >= 0);
-
-                    next_val = history[next_history_buf_pos];
+                    next_val = history[next_pos];
                 }
                 else
                 {
@@ -513,7 +517,9 @@ static void Mode_context_render(
                     }
                     else
                     {
-                        next_val = history[head_pos + context->range.start];
+                        const int32_t start_pos =
+                            clamp(context->range.start, -history_buf_size, -1);
+                        next_val = history[start_pos];
                     }
                 }
             }
@@ -541,8 +547,7 @@ static void Mode_context_render(
             if ((in == NULL) || (out == NULL))
                 continue;
 
-            const float* history = history_bufs[ch];
-            rassert(history != NULL);
+            const float* history = history_data[ch];
 
             for (int32_t i = buf_start; i < buf_stop; ++i)
             {
@@ -566,18 +571,10 @@ static void Mode_context_render(
                 rassert(fadein_next_pos < 0);
 
                 // Get audio frames
-                const int32_t cur_history_buf_pos =
-                    (head_pos + fadein_cur_pos + history_buf_size) % history_buf_size;
-                rassert(cur_history_buf_pos >= 0);
+                rassert(fadein_cur_pos >= -history_buf_size);
 
-                const float fadein_cur_val = history[cur_history_buf_pos];
-
-                const int32_t next_history_buf_pos =
-                    (head_pos + fadein_next_pos + history_buf_size) %
-                    history_buf_size;
-                rassert(next_history_buf_pos >= 0);
-
-                const float fadein_next_val = history[next_history_buf_pos];
+                const float fadein_cur_val = history[fadein_cur_pos];
+                const float fadein_next_val = history[fadein_next_pos];
 
                 // Mix crossfading frame with existing output
                 const float fadein_val =
@@ -606,7 +603,7 @@ typedef struct Looper_pstate
     Range ranges[RANGES_MAX];
 
     int32_t head_pos;
-    Work_buffer* bufs[KQT_BUFFERS_MAX];
+    Ring_buffer* bufs[KQT_BUFFERS_MAX];
 } Looper_pstate;
 
 
@@ -618,7 +615,7 @@ static void del_Looper_pstate(Device_state* dstate)
 
     for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
     {
-        del_Work_buffer(lpstate->bufs[i]);
+        del_Ring_buffer(lpstate->bufs[i]);
         lpstate->bufs[i] = NULL;
     }
 
@@ -649,10 +646,7 @@ static void Looper_pstate_reset(Device_state* dstate)
     lpstate->head_pos = 0;
 
     for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
-    {
-        Work_buffer* buf = lpstate->bufs[i];
-        Work_buffer_clear(buf, 0, Work_buffer_get_size(buf));
-    }
+        Ring_buffer_clear(lpstate->bufs[i]);
 
     return;
 }
@@ -742,14 +736,8 @@ static void Looper_pstate_render_mixed(
     }
     rassert(speeds != NULL);
 
-    float* history_data[] =
-    {
-        Work_buffer_get_contents_mut(lpstate->bufs[0]),
-        Work_buffer_get_contents_mut(lpstate->bufs[1]),
-    };
-
-    const int32_t history_buf_size = Work_buffer_get_size(lpstate->bufs[0]);
-    rassert(history_buf_size == Work_buffer_get_size(lpstate->bufs[1]));
+    const int32_t history_buf_size = Ring_buffer_get_size(lpstate->bufs[0]);
+    rassert(history_buf_size == Ring_buffer_get_size(lpstate->bufs[1]));
     const int32_t delay_max = history_buf_size - 1;
 
     float* total_offsets =
@@ -804,10 +792,9 @@ static void Looper_pstate_render_mixed(
             main_context,
             out_data,
             in_data,
-            history_data,
+            lpstate->bufs,
             total_offsets,
             is_head_pos_moving,
-            history_buf_size,
             cur_lpstate_head_pos,
             buf_start,
             buf_stop,
@@ -888,10 +875,9 @@ static void Looper_pstate_render_mixed(
                     fading_context,
                     xfade_out_data,
                     in_data,
-                    history_data,
+                    lpstate->bufs,
                     total_offsets,
                     is_head_pos_moving,
-                    history_buf_size,
                     cur_lpstate_head_pos,
                     buf_start,
                     xfade_buf_stop,
@@ -941,22 +927,11 @@ static void Looper_pstate_render_mixed(
             if (in == NULL)
                 continue;
 
-            float* history = history_data[ch];
-            rassert(history != NULL);
-
-            cur_lpstate_head_pos = lpstate->head_pos;
-
-            for (int32_t i = buf_start; i < buf_stop; ++i)
-            {
-                history[cur_lpstate_head_pos] = in[i];
-
-                ++cur_lpstate_head_pos;
-                if (cur_lpstate_head_pos >= history_buf_size)
-                {
-                    rassert(cur_lpstate_head_pos == history_buf_size);
-                    cur_lpstate_head_pos = 0;
-                }
-            }
+            cur_lpstate_head_pos = Ring_buffer_write(
+                    lpstate->bufs[ch],
+                    lpstate->head_pos,
+                    in + buf_start,
+                    buf_stop - buf_start);
         }
 
         lpstate->head_pos = cur_lpstate_head_pos;
@@ -1139,7 +1114,7 @@ Device_state* new_Looper_pstate(
     const int32_t buf_size = (int32_t)(looper->max_rec_time * audio_rate + 1);
     for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
     {
-        lpstate->bufs[i] = new_Work_buffer_unbounded(buf_size);
+        lpstate->bufs[i] = new_Ring_buffer(buf_size);
         if (lpstate->bufs[i] == NULL)
         {
             del_Device_state(&lpstate->parent.parent);
@@ -1166,7 +1141,7 @@ bool Looper_pstate_set_max_rec_time(
 
     for (int i = 0; i < KQT_BUFFERS_MAX; ++i)
     {
-        if (!Work_buffer_resize(lpstate->bufs[i], new_buf_size))
+        if (!Ring_buffer_resize(lpstate->bufs[i], new_buf_size))
             return false;
     }
 
@@ -17,12 +17,14 @@
 #include <debug/assert.h>
 #include <init/devices/processors/Proc_mult.h>
 #include <mathnum/common.h>
+#include <mathnum/kernels.h>
 #include <memory.h>
 #include <player/devices/Device_thread_state.h>
 #include <player/devices/processors/Proc_state_utils.h>
 
 #include <float.h>
 #include <math.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -60,26 +62,65 @@ static void multiply_signals(
     rassert(buf_start >= 0);
     rassert(buf_stop >= 0);
 
+    if (buf_start >= buf_stop)
+        return;
+
     for (int ch = 0; ch < 2; ++ch)
     {
         Work_buffer* in1_wb = in1_buffers[ch];
         Work_buffer* in2_wb = in2_buffers[ch];
         float* out_values = out_buffers[ch];
 
-        if ((in1_wb != NULL) && (in2_wb != NULL) && (out_values != NULL))
+        if ((in1_wb == NULL) || (in2_wb == NULL) || (out_values == NULL))
+            continue;
+
+        // Find the area where both inputs are constant
+        const int32_t in1_const_start = Work_buffer_get_const_start(in1_wb);
+        const int32_t in2_const_start = Work_buffer_get_const_start(in2_wb);
+        const bool is_in1_final = Work_buffer_is_final(in1_wb);
+        const bool is_in2_final = Work_buffer_is_final(in2_wb);
+        const int32_t const_start =
+            clamp(max(in1_const_start, in2_const_start), buf_start, buf_stop);
+        const int32_t var_count = const_start - buf_start;
+
+        float* in1_values = Work_buffer_get_contents_mut(in1_wb);
+        float* in2_values = Work_buffer_get_contents_mut(in2_wb);
+
+        // Clamp inputs to finite range (so that we don't accidentally produce NaNs)
+        kernel_clamp(
+                in1_values + buf_start,
+                in1_values + buf_start,
+                -FLT_MAX,
+                FLT_MAX,
+                var_count);
+        kernel_clamp(
+                in2_values + buf_start,
+                in2_values + buf_start,
+                -FLT_MAX,
+                FLT_MAX,
+                var_count);
+
+        kernel_mul(
+                out_values + buf_start,
+                in1_values + buf_start,
+                in2_values + buf_start,
+                var_count);
+
+        if (const_start < buf_stop)
         {
-            float* in1_values = Work_buffer_get_contents_mut(in1_wb);
-            float* in2_values = Work_buffer_get_contents_mut(in2_wb);
-
-            // Clamp inputs to finite range (so that we don't accidentally produce NaNs)
-            for (int32_t i = buf_start; i < buf_stop; ++i)
-                in1_values[i] = clamp(in1_values[i], -FLT_MAX, FLT_MAX);
-            for (int32_t i = buf_start; i < buf_stop; ++i)
-                in2_values[i] = clamp(in2_values[i], -FLT_MAX, FLT_MAX);
-
-            for (int32_t i = buf_start; i < buf_stop; ++i)
-                out_values[i] = in1_values[i] * in2_values[i];
+            const float in1_value = clamp(in1_values[const_start], -FLT_MAX, FLT_MAX);
+            const float in2_value = clamp(in2_values[const_start], -FLT_MAX, FLT_MAX);
+            kernel_fill(
+                    out_values + const_start,
+                    in1_value * in2_value,
+                    buf_stop - const_start);
         }
+
+        // Clamping does not affect the constant trails of the inputs
+        Work_buffer_set_const_start(in1_wb, in1_const_start);
+        Work_buffer_set_const_start(in2_wb, in2_const_start);
+        Work_buffer_set_final(in1_wb, is_in1_final);
+        Work_buffer_set_final(in2_wb, is_in2_final);
     }
 
     return;
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2015-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2015-2018
  *
  * This file is part of Kunquat.
  *
@@ -16,6 +16,7 @@
 
 #include <debug/assert.h>
 #include <init/devices/processors/Proc_noise.h>
+#include <mathnum/common.h>
 #include <mathnum/Random.h>
 #include <memory.h>
 #include <player/devices/Device_thread_state.h>
@@ -33,6 +34,8 @@
 
 #define NOISE_MAX 8
 
+#define NOISE_SOURCE_CHUNK_SIZE 256
+
 
 typedef struct Noise_pstate
 {
@@ -148,26 +151,39 @@ int32_t Noise_vstate_render_voice(
         if (out_buffer == NULL)
             continue;
 
-        if (noise_state->order >= 0)
+        // Generate the source values in chunks to keep them in double precision
+        double sources[NOISE_SOURCE_CHUNK_SIZE];
+
+        for (int32_t chunk_start = buf_start;
+                chunk_start < buf_stop;
+                chunk_start += NOISE_SOURCE_CHUNK_SIZE)
         {
-            for (int32_t i = buf_start; i < buf_stop; ++i)
+            const int32_t chunk_stop =
+                min(buf_stop, chunk_start + NOISE_SOURCE_CHUNK_SIZE);
+            Random_fill_double_signal(
+                    &noise_vstate->rands[ch], sources, chunk_stop - chunk_start);
+
+            if (noise_state->order >= 0)
             {
-                const double val = dc_zero_filter(
-                        noise_state->order,
-                        noise_vstate->buf[ch],
-                        Random_get_float_signal(&noise_vstate->rands[ch]));
-                out_buffer[i] = (float)val * scales[i];
+                for (int32_t i = chunk_start; i < chunk_stop; ++i)
+                {
+                    const double val = dc_zero_filter(
+                            noise_state->order,
+                            noise_vstate->buf[ch],
+                            sources[i - chunk_start]);
+                    out_buffer[i] = (float)val * scales[i];
+                }
             }
-        }
-        else
-        {
-            for (int32_t i = buf_start; i < buf_stop; ++i)
+            else
             {
-                const double val = dc_pole_filter(
-                        -noise_state->order,
-                        noise_vstate->buf[ch],
-                        Random_get_float_signal(&noise_vstate->rands[ch]));
-                out_buffer[i] = (float)val * scales[i];
+                for (int32_t i = chunk_start; i < chunk_stop; ++i)
+                {
+                    const double val = dc_pole_filter(
+                            -noise_state->order,
+                            noise_vstate->buf[ch],
+                            sources[i - chunk_start]);
+                    out_buffer[i] = (float)val * scales[i];
+                }
             }
         }
     }
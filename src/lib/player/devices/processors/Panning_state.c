@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -18,6 +18,7 @@
 #include <init/devices/Device.h>
 #include <init/devices/processors/Proc_panning.h>
 #include <mathnum/common.h>
+#include <mathnum/kernels.h>
 #include <memory.h>
 #include <player/devices/Device_thread_state.h>
 #include <player/devices/processors/Proc_state_utils.h>
@@ -45,18 +46,13 @@ enum
 };
 
 
-static const int CONTROL_WB_PANNING = WORK_BUFFER_IMPL_1;
-
-
 static void apply_panning(
-        const Work_buffers* wbs,
-        const float* pan_values,
+        const Work_buffer* pan_wb,
         float def_pan,
         float* in_buffers[2],
         float* out_buffers[2],
         int32_t buf_start,
-        int32_t buf_stop,
-        int32_t audio_rate)
+        int32_t buf_stop)
 {
     rassert(isfinite(def_pan));
     rassert(def_pan >= -1);
@@ -65,54 +61,51 @@ static void apply_panning(
     rassert(out_buffers != NULL);
     rassert(buf_start >= 0);
     rassert(buf_stop >= 0);
-    rassert(audio_rate > 0);
 
-    float* pannings = Work_buffers_get_buffer_contents_mut(wbs, CONTROL_WB_PANNING);
+    if (buf_start >= buf_stop)
+        return;
 
-    if (pan_values != NULL)
-    {
-        // Get clamped panning input
-        for (int32_t i = buf_start; i < buf_stop; ++i)
-        {
-            float pan_value = pan_values[i];
-            pan_value = clamp(pan_value, -1, 1);
-            pannings[i] = pan_value;
-        }
-    }
-    else
-    {
-        // Get our default panning
-        for (int32_t i = buf_start; i < buf_stop; ++i)
-            pannings[i] = def_pan;
-    }
+    // Get the part of the panning input that is not constant
+    const int32_t const_start = (pan_wb != NULL)
+        ? clamp(Work_buffer_get_const_start(pan_wb), buf_start, buf_stop)
+        : buf_start;
+    const float* pan_values =
+        (pan_wb != NULL) ? Work_buffer_get_contents(pan_wb) : NULL;
 
-    // Clamp the input values
-    for (int32_t i = buf_start; i < buf_stop; ++i)
-    {
-        float panning = pannings[i];
-        panning = clamp(panning, -1, 1);
-        pannings[i] = panning;
-    }
+    const float const_pan = ((const_start < buf_stop) && (pan_values != NULL))
+        ? clamp(pan_values[const_start], -1.0f, 1.0f)
+        : def_pan;
 
     // Apply panning
     // TODO: revisit panning formula
+    static const float sides[2] = { -1, 1 };
+
+    for (int ch = 0; ch < 2; ++ch)
     {
-        const float* in_buf = in_buffers[0];
-        float* out_buf = out_buffers[0];
-        if ((in_buf != NULL) && (out_buf != NULL))
+        const float* in_buf = in_buffers[ch];
+        float* out_buf = out_buffers[ch];
+        if ((in_buf == NULL) || (out_buf == NULL))
+            continue;
+
+        const float side = sides[ch];
+
+        if (const_start > buf_start)
         {
-            for (int32_t i = buf_start; i < buf_stop; ++i)
-                out_buf[i] = in_buf[i] * (1 - pannings[i]);
+            kernel_pan(
+                    out_buf + buf_start,
+                    in_buf + buf_start,
+                    pan_values + buf_start,
+                    side,
+                    const_start - buf_start);
         }
-    }
 
-    {
-        const float* in_buf = in_buffers[1];
-        float* out_buf = out_buffers[1];
-        if ((in_buf != NULL) && (out_buf != NULL))
+        if (const_start < buf_stop)
         {
-            for (int32_t i = buf_start; i < buf_stop; ++i)
-                out_buf[i] = in_buf[i] * (1 + pannings[i]);
+            kernel_scale(
+                    out_buf + const_start,
+                    in_buf + const_start,
+                    1 + (side * const_pan),
+                    buf_stop - const_start);
         }
     }
 
@@ -144,7 +137,7 @@ static void Panning_pstate_render_mixed(
     Panning_pstate* ppstate = (Panning_pstate*)dstate;
 
     // Get panning values
-    const float* pan_values = Device_thread_state_get_mixed_buffer_contents_mut(
+    const Work_buffer* pan_wb = Device_thread_state_get_mixed_buffer(
             proc_ts, DEVICE_PORT_TYPE_RECV, PORT_IN_PANNING);
 
     // Get input
@@ -158,14 +151,12 @@ static void Panning_pstate_render_mixed(
             proc_ts, PORT_OUT_AUDIO_L, PORT_OUT_COUNT, out_buffers);
 
     apply_panning(
-            wbs,
-            pan_values,
+            pan_wb,
             (float)ppstate->def_panning,
             in_buffers,
             out_buffers,
             buf_start,
-            buf_stop,
-            dstate->audio_rate);
+            buf_stop);
 
     return;
 }
@@ -236,7 +227,7 @@ int32_t Panning_vstate_render_voice(
     const Proc_panning* panning = (const Proc_panning*)dstate->device->dimpl;
 
     // Get panning values
-    const float* pan_values = Device_thread_state_get_voice_buffer_contents(
+    const Work_buffer* pan_wb = Device_thread_state_get_voice_buffer(
             proc_ts, DEVICE_PORT_TYPE_RECV, PORT_IN_PANNING);
 
     // Get input
@@ -252,14 +243,12 @@ int32_t Panning_vstate_render_voice(
             proc_ts, PORT_OUT_AUDIO_L, PORT_OUT_COUNT, out_buffers);
 
     apply_panning(
-            wbs,
-            pan_values,
+            pan_wb,
             (float)panning->panning,
             in_buffers,
             out_buffers,
             buf_start,
-            buf_stop,
-            dstate->audio_rate);
+            buf_stop);
 
     return buf_stop;
 }
@@ -18,6 +18,7 @@
 #include <init/devices/Device.h>
 #include <init/devices/processors/Proc_rangemap.h>
 #include <mathnum/common.h>
+#include <mathnum/kernels.h>
 #include <memory.h>
 #include <player/devices/Device_thread_state.h>
 #include <player/devices/processors/Proc_state_utils.h>
@@ -75,22 +76,25 @@ static void apply_range(
     rassert(isfinite(add));
     rassert(min_val < max_val);
 
+    const int32_t const_start =
+        clamp(Work_buffer_get_const_start(in_wb), buf_start, buf_stop);
+
     const float* in = Work_buffer_get_contents(in_wb);
     float* out = Work_buffer_get_contents_mut(out_wb);
 
-    for (int32_t i = buf_start; i < buf_stop; ++i)
-        out[i] = (mul * in[i]) + add;
-
-    if (isfinite(min_val))
-    {
-        for (int32_t i = buf_start; i < buf_stop; ++i)
-            out[i] = max(out[i], min_val);
-    }
+    kernel_range_map(
+            out + buf_start,
+            in + buf_start,
+            mul,
+            add,
+            min_val,
+            max_val,
+            const_start - buf_start);
 
-    if (isfinite(max_val))
+    if (const_start < buf_stop)
     {
-        for (int32_t i = buf_start; i < buf_stop; ++i)
-            out[i] = min(out[i], max_val);
+        const float mapped = clamp((mul * in[const_start]) + add, min_val, max_val);
+        kernel_fill(out + const_start, mapped, buf_stop - const_start);
     }
 
     return;
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2015-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2015-2018
  *
  * This file is part of Kunquat.
  *
@@ -26,6 +26,8 @@
 #include <string/common.h>
 #include <string/Streader.h>
 
+#include <math.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -71,82 +73,242 @@ static const int SAMPLE_WB_FIXED_PITCH = WORK_BUFFER_IMPL_4;
 static const int SAMPLE_WB_FIXED_FORCE = WORK_BUFFER_IMPL_5;
 
 
-static int32_t Sample_render(
+static void Sample_render_frames(
         const Sample* sample,
-        const Sample_params* params,
-        Voice_state* vstate,
-        Proc_state* proc_state,
-        const Device_thread_state* proc_ts,
-        const Work_buffers* wbs,
-        float* out_buffers[2],
+        float* abufs[KQT_BUFFERS_MAX],
+        const int32_t* positions,
+        const int32_t* next_positions,
+        const float* positions_rem,
+        const float* force_scales,
         int32_t buf_start,
-        int32_t buf_stop,
-        int32_t audio_rate,
-        double tempo,
-        double middle_tone,
-        double middle_freq,
+        int32_t new_buf_stop,
         double vol_scale)
 {
     rassert(sample != NULL);
-    rassert(params != NULL);
-    rassert(vstate != NULL);
-    rassert(proc_state != NULL);
-    rassert(proc_ts != NULL);
-    rassert(wbs != NULL);
-    rassert(audio_rate > 0);
-    rassert(tempo > 0);
-    rassert(vol_scale >= 0);
-    ignore(tempo);
+    rassert(abufs != NULL);
+    rassert(positions != NULL);
+    rassert(next_positions != NULL);
+    rassert(positions_rem != NULL);
+    rassert(force_scales != NULL);
 
-    // This implementation does not support larger sample lengths :-P
-    rassert(sample->len < INT32_MAX - 1);
+#define get_item(out_value)                             \
+    if (true)                                           \
+    {                                                   \
+        const int32_t cur_pos = positions[i];           \
+        const int32_t next_pos = next_positions[i];     \
+        const float lerp_value = positions_rem[i];      \
+                                                        \
+        const float cur_value = (float)data[cur_pos];   \
+        const float next_value = (float)data[next_pos]; \
+        const float diff = next_value - cur_value;      \
+        (out_value) = cur_value + (lerp_value * diff);  \
+    }                                                   \
+    else ignore(0)
 
-    if (sample->len == 0)
+    if (!sample->is_float)
     {
-        vstate->active = false;
-        return buf_start;
-    }
+        switch (sample->bits)
+        {
+            case 8:
+            {
+                const double scale = 1.0 / 0x80;
+                const float fixed_scale = (float)(vol_scale * scale);
+                for (int ch = 0; ch < sample->channels; ++ch)
+                {
+                    const int8_t* data = sample->data[ch];
+                    float* audio_buffer = abufs[ch];
+                    if (audio_buffer == NULL)
+                        continue;
 
-    if (buf_start == buf_stop)
-        return buf_stop;
+                    for (int32_t i = buf_start; i < new_buf_stop; ++i)
+                    {
+                        const float force_scale = force_scales[i];
 
-    // Get frequencies
-    Work_buffer* freqs_wb = Device_thread_state_get_voice_buffer(
-            proc_ts, DEVICE_PORT_TYPE_RECV, PORT_IN_PITCH);
-    Work_buffer* pitches_wb = freqs_wb;
-    if (freqs_wb == NULL)
-        freqs_wb = Work_buffers_get_buffer_mut(wbs, SAMPLE_WB_FIXED_PITCH);
-    Proc_fill_freq_buffer(freqs_wb, pitches_wb, buf_start, buf_stop);
-    const float* freqs = Work_buffer_get_contents(freqs_wb);
+                        float item = 0;
+                        get_item(item);
+                        audio_buffer[i] = item * fixed_scale * force_scale;
+                    }
+                }
+            }
+            break;
 
-    // Get force input
-    Work_buffer* force_scales_wb = Device_thread_state_get_voice_buffer(
-            proc_ts, DEVICE_PORT_TYPE_RECV, PORT_IN_FORCE);
-    Work_buffer* dBs_wb = force_scales_wb;
-    if ((dBs_wb != NULL) &&
-            Work_buffer_is_final(dBs_wb) &&
-            (Work_buffer_get_const_start(dBs_wb) <= buf_start) &&
-            (Work_buffer_get_contents(dBs_wb)[buf_start] == -INFINITY))
+            case 16:
+            {
+                const double scale = 1.0 / 0x8000UL;
+                const float fixed_scale = (float)(vol_scale * scale);
+                for (int ch = 0; ch < sample->channels; ++ch)
+                {
+                    const int16_t* data = sample->data[ch];
+                    float* audio_buffer = abufs[ch];
+                    if (audio_buffer == NULL)
+                        continue;
+
+                    for (int32_t i = buf_start; i < new_buf_stop; ++i)
+                    {
+                        const float force_scale = force_scales[i];
+
+                        float item = 0;
+                        get_item(item);
+                        audio_buffer[i] = item * fixed_scale * force_scale;
+                    }
+                }
+            }
+            break;
+
+            case 32:
+            {
+                const double scale = 1.0 / 0x80000000UL;
+                const float fixed_scale = (float)(vol_scale * scale);
+                for (int ch = 0; ch < sample->channels; ++ch)
+                {
+                    const int32_t* data = sample->data[ch];
+                    float* audio_buffer = abufs[ch];
+                    if (audio_buffer == NULL)
+                        continue;
+
+                    for (int32_t i = buf_start; i < new_buf_stop; ++i)
+                    {
+                        const float force_scale = force_scales[i];
+
+                        float item = 0;
+                        get_item(item);
+                        audio_buffer[i] = item * fixed_scale * force_scale;
+                    }
+                }
+            }
+            break;
+
+            default:
+                rassert(false);
+        }
+    }
+    else
     {
-        // We are only getting silent force from this point onwards
-        vstate->active = false;
-        return buf_start;
+        for (int ch = 0; ch < sample->channels; ++ch)
+        {
+            const float* data = sample->data[ch];
+            float* audio_buffer = abufs[ch];
+            if (audio_buffer == NULL)
+                continue;
+
+            for (int32_t i = buf_start; i < new_buf_stop; ++i)
+            {
+                const float force_scale = force_scales[i];
+
+                float item = 0;
+                get_item(item);
+                audio_buffer[i] = (float)(item * vol_scale * force_scale);
+            }
+        }
     }
 
-    if (force_scales_wb == NULL)
-        force_scales_wb = Work_buffers_get_buffer_mut(wbs, SAMPLE_WB_FIXED_FORCE);
-    Proc_fill_scale_buffer(force_scales_wb, dBs_wb, buf_start, buf_stop);
-    const float* force_scales = Work_buffer_get_contents(force_scales_wb);
+#undef get_item
 
-    float* abufs[KQT_BUFFERS_MAX] = { out_buffers[0], out_buffers[1] };
-    if ((sample->channels == 1) && (out_buffers[0] == NULL))
+    return;
+}
+
+
+static void Sample_render_mip_level(
+        const Sample* sample,
+        int level,
+        float* abufs[KQT_BUFFERS_MAX],
+        const int32_t* positions,
+        const int32_t* next_positions,
+        const float* positions_rem,
+        const float* force_scales,
+        int32_t buf_start,
+        int32_t new_buf_stop,
+        double vol_scale,
+        bool add)
+{
+    rassert(sample != NULL);
+    rassert(level > 0);
+    rassert(level <= Sample_get_mip_level_count(sample));
+    rassert(abufs != NULL);
+    rassert(positions != NULL);
+    rassert(next_positions != NULL);
+    rassert(positions_rem != NULL);
+    rassert(force_scales != NULL);
+
+    const int32_t level_len = (int32_t)Sample_get_mip_level_len(sample, level);
+    const int32_t pos_rem_mask = ((int32_t)1 << level) - 1;
+    const float pos_rem_scale = 1.0f / (float)((int32_t)1 << level);
+
+    for (int ch = 0; ch < sample->channels; ++ch)
     {
-        // Make sure that mono sample is rendered to right channel
-        // if the left one does not exist
-        out_buffers[0] = out_buffers[1];
-        out_buffers[1] = NULL;
+        const float* data = Sample_get_mip_level_buffer(sample, level, ch);
+        float* audio_buffer = abufs[ch];
+        if (audio_buffer == NULL)
+            continue;
+
+        for (int32_t i = buf_start; i < new_buf_stop; ++i)
+        {
+            const int32_t pos = positions[i];
+            const int32_t next_pos = next_positions[i];
+            rassert(pos >= 0);
+            rassert(next_pos >= 0);
+
+            // When reading backwards in a bidirectional loop, the position
+            // is between the previous item and the current one
+            const bool is_reversed = (next_pos == pos - 1);
+            const int32_t base_pos = is_reversed ? next_pos : pos;
+            const float base_rem =
+                is_reversed ? (1.0f - positions_rem[i]) : positions_rem[i];
+
+            // Map the positions to the decimated level, following loop jumps
+            const int32_t cur_level_pos = base_pos >> level;
+            const int32_t next_level_pos = ((next_pos == pos + 1) || is_reversed)
+                ? min(cur_level_pos + 1, level_len - 1) : (next_pos >> level);
+            const float lerp_value =
+                ((float)(base_pos & pos_rem_mask) + base_rem) * pos_rem_scale;
+
+            const float cur_value = data[cur_level_pos];
+            const float diff = data[next_level_pos] - cur_value;
+            const float item = cur_value + (lerp_value * diff);
+
+            const float force_scale = force_scales[i];
+            const float value = (float)(item * vol_scale * force_scale);
+            if (add)
+                audio_buffer[i] += value;
+            else
+                audio_buffer[i] = value;
+        }
     }
 
+    return;
+}
+
+
+int32_t Sample_render_data(
+        const Sample* sample,
+        const Sample_params* params,
+        float* abufs[KQT_BUFFERS_MAX],
+        const Work_buffers* wbs,
+        const float* freqs,
+        const float* force_scales,
+        double shift_factor,
+        double vol_scale,
+        int32_t* inout_pos,
+        double* inout_pos_rem,
+        int32_t buf_start,
+        int32_t buf_stop)
+{
+    rassert(sample != NULL);
+    rassert(params != NULL);
+    rassert(abufs != NULL);
+    rassert(wbs != NULL);
+    rassert(freqs != NULL);
+    rassert(force_scales != NULL);
+    rassert(shift_factor > 0);
+    rassert(vol_scale >= 0);
+    rassert(inout_pos != NULL);
+    rassert(*inout_pos >= 0);
+    rassert(inout_pos_rem != NULL);
+    rassert(buf_start < buf_stop);
+
+    // This implementation does not support larger sample lengths :-P
+    rassert(sample->len < INT32_MAX - 1);
+
     int32_t* positions = Work_buffers_get_buffer_contents_int_mut(
             wbs, SAMPLE_WORK_BUFFER_POSITIONS);
     int32_t* next_positions = Work_buffers_get_buffer_contents_int_mut(
@@ -155,18 +317,20 @@ static int32_t Sample_render(
             wbs, SAMPLE_WORK_BUFFER_POSITIONS_REM);
 
     // Position information to be updated
-    int32_t new_pos = (int32_t)vstate->pos;
-    double new_pos_rem = vstate->pos_rem;
+    int32_t new_pos = *inout_pos;
+    double new_pos_rem = *inout_pos_rem;
 
     // Get sample positions (assuming no loop at this point)
-    const double shift_factor = middle_freq / (middle_tone * audio_rate);
     positions[buf_start] = new_pos;
     positions_rem[buf_start] = (float)new_pos_rem;
 
+    double max_shift_total = 0;
+
     for (int32_t i = buf_start; i < buf_stop; ++i)
     {
         const float freq = freqs[i];
         const double shift_total = freq * shift_factor;
+        max_shift_total = max(max_shift_total, shift_total);
 
         const int32_t shift_floor = (int32_t)floor(shift_total);
         const double shift_rem = shift_total - shift_floor;
@@ -195,10 +359,7 @@ static int32_t Sample_render(
             const int32_t length = (int32_t)sample->len;
 
             if (positions[buf_start] >= length)
-            {
-                vstate->active = false;
                 return buf_start;
-            }
 
             // Current positions
             for (int32_t i = buf_start; i < buf_stop; ++i)
@@ -301,131 +462,180 @@ static int32_t Sample_render(
             rassert(false);
     }
 
-    // Get sample frames
-#define get_item(out_value)                             \
-    if (true)                                           \
-    {                                                   \
-        const int32_t cur_pos = positions[i];           \
-        const int32_t next_pos = next_positions[i];     \
-        const float lerp_value = positions_rem[i];      \
-                                                        \
-        const float cur_value = (float)data[cur_pos];   \
-        const float next_value = (float)data[next_pos]; \
-        const float diff = next_value - cur_value;      \
-        (out_value) = cur_value + (lerp_value * diff);  \
-    }                                                   \
-    else ignore(0)
+    // Crossfade between the two band-limited levels around the maximum step so
+    // that the timbre changes smoothly with pitch
+    int lower_level = 0;
+    float upper_weight = 0;
+    if (max_shift_total > 1)
+    {
+        const int level_count = Sample_get_mip_level_count(sample);
+        const double level_pos = min(log2(max_shift_total), (double)level_count);
+        lower_level = (int)floor(level_pos);
+        if (lower_level < level_count)
+            upper_weight = (float)(level_pos - lower_level);
+    }
 
-    if (!sample->is_float)
+    const double lower_vol_scale = vol_scale * (1.0 - upper_weight);
+    if (lower_level > 0)
     {
-        switch (sample->bits)
-        {
-            case 8:
-            {
-                const double scale = 1.0 / 0x80;
-                const float fixed_scale = (float)(vol_scale * scale);
-                for (int ch = 0; ch < sample->channels; ++ch)
-                {
-                    const int8_t* data = sample->data[ch];
-                    float* audio_buffer = abufs[ch];
-                    if (audio_buffer == NULL)
-                        continue;
+        Sample_render_mip_level(
+                sample,
+                lower_level,
+                abufs,
+                positions,
+                next_positions,
+                positions_rem,
+                force_scales,
+                buf_start,
+                new_buf_stop,
+                lower_vol_scale,
+                false);
+    }
+    else
+    {
+        Sample_render_frames(
+                sample,
+                abufs,
+                positions,
+                next_positions,
+                positions_rem,
+                force_scales,
+                buf_start,
+                new_buf_stop,
+                lower_vol_scale);
+    }
 
-                    for (int32_t i = buf_start; i < new_buf_stop; ++i)
-                    {
-                        const float force_scale = force_scales[i];
+    if (upper_weight > 0)
+    {
+        Sample_render_mip_level(
+                sample,
+                lower_level + 1,
+                abufs,
+                positions,
+                next_positions,
+                positions_rem,
+                force_scales,
+                buf_start,
+                new_buf_stop,
+                vol_scale * upper_weight,
+                true);
+    }
 
-                        float item = 0;
-                        get_item(item);
-                        audio_buffer[i] = item * fixed_scale * force_scale;
-                    }
-                }
-            }
-            break;
+    // Copy mono signal to the right channel
+    if ((sample->channels == 1) && (abufs[0] != NULL) && (abufs[1] != NULL))
+    {
+        const int32_t frame_count = new_buf_stop - buf_start;
+        rassert(frame_count >= 0);
+        memcpy(abufs[1] + buf_start,
+                abufs[0] + buf_start,
+                sizeof(float) * (size_t)frame_count);
+    }
 
-            case 16:
-            {
-                const double scale = 1.0 / 0x8000UL;
-                const float fixed_scale = (float)(vol_scale * scale);
-                for (int ch = 0; ch < sample->channels; ++ch)
-                {
-                    const int16_t* data = sample->data[ch];
-                    float* audio_buffer = abufs[ch];
-                    if (audio_buffer == NULL)
-                        continue;
+    // Update position information
+    *inout_pos = new_pos;
+    *inout_pos_rem = new_pos_rem;
 
-                    for (int32_t i = buf_start; i < new_buf_stop; ++i)
-                    {
-                        const float force_scale = force_scales[i];
+    return new_buf_stop;
+}
 
-                        float item = 0;
-                        get_item(item);
-                        audio_buffer[i] = item * fixed_scale * force_scale;
-                    }
-                }
-            }
-            break;
 
-            case 32:
-            {
-                const double scale = 1.0 / 0x80000000UL;
-                const float fixed_scale = (float)(vol_scale * scale);
-                for (int ch = 0; ch < sample->channels; ++ch)
-                {
-                    const int32_t* data = sample->data[ch];
-                    float* audio_buffer = abufs[ch];
-                    if (audio_buffer == NULL)
-                        continue;
+static int32_t Sample_render(
+        const Sample* sample,
+        const Sample_params* params,
+        Voice_state* vstate,
+        Proc_state* proc_state,
+        const Device_thread_state* proc_ts,
+        const Work_buffers* wbs,
+        float* out_buffers[2],
+        int32_t buf_start,
+        int32_t buf_stop,
+        int32_t audio_rate,
+        double tempo,
+        double middle_tone,
+        double middle_freq,
+        double vol_scale)
+{
+    rassert(sample != NULL);
+    rassert(params != NULL);
+    rassert(vstate != NULL);
+    rassert(proc_state != NULL);
+    rassert(proc_ts != NULL);
+    rassert(wbs != NULL);
+    rassert(audio_rate > 0);
+    rassert(tempo > 0);
+    rassert(vol_scale >= 0);
+    ignore(tempo);
 
-                    for (int32_t i = buf_start; i < new_buf_stop; ++i)
-                    {
-                        const float force_scale = force_scales[i];
+    if (sample->len == 0)
+    {
+        vstate->active = false;
+        return buf_start;
+    }
 
-                        float item = 0;
-                        get_item(item);
-                        audio_buffer[i] = item * fixed_scale * force_scale;
-                    }
-                }
-            }
-            break;
+    if (buf_start == buf_stop)
+        return buf_stop;
 
-            default:
-                rassert(false);
-        }
-    }
-    else
+    // Get frequencies
+    Work_buffer* freqs_wb = Device_thread_state_get_voice_buffer(
+            proc_ts, DEVICE_PORT_TYPE_RECV, PORT_IN_PITCH);
+    Work_buffer* pitches_wb = freqs_wb;
+    if (freqs_wb == NULL)
+        freqs_wb = Work_buffers_get_buffer_mut(wbs, SAMPLE_WB_FIXED_PITCH);
+    Proc_fill_freq_buffer(freqs_wb, pitches_wb, buf_start, buf_stop);
+    const float* freqs = Work_buffer_get_contents(freqs_wb);
+
+    // Get force input
+    Work_buffer* force_scales_wb = Device_thread_state_get_voice_buffer(
+            proc_ts, DEVICE_PORT_TYPE_RECV, PORT_IN_FORCE);
+    Work_buffer* dBs_wb = force_scales_wb;
+    if ((dBs_wb != NULL) &&
+            Work_buffer_is_final(dBs_wb) &&
+            (Work_buffer_get_const_start(dBs_wb) <= buf_start) &&
+            (Work_buffer_get_contents(dBs_wb)[buf_start] == -INFINITY))
     {
-        for (int ch = 0; ch < sample->channels; ++ch)
-        {
-            const float* data = sample->data[ch];
-            float* audio_buffer = abufs[ch];
-            if (audio_buffer == NULL)
-                continue;
+        // We are only getting silent force from this point onwards
+        vstate->active = false;
+        return buf_start;
+    }
 
-            for (int32_t i = buf_start; i < new_buf_stop; ++i)
-            {
-                const float force_scale = force_scales[i];
+    if (force_scales_wb == NULL)
+        force_scales_wb = Work_buffers_get_buffer_mut(wbs, SAMPLE_WB_FIXED_FORCE);
+    Proc_fill_scale_buffer(force_scales_wb, dBs_wb, buf_start, buf_stop);
+    const float* force_scales = Work_buffer_get_contents(force_scales_wb);
 
-                float item = 0;
-                get_item(item);
-                audio_buffer[i] = (float)(item * vol_scale * force_scale);
-            }
-        }
+    float* abufs[KQT_BUFFERS_MAX] = { out_buffers[0], out_buffers[1] };
+    if ((sample->channels == 1) && (out_buffers[0] == NULL))
+    {
+        // Make sure that mono sample is rendered to right channel
+        // if the left one does not exist
+        out_buffers[0] = out_buffers[1];
+        out_buffers[1] = NULL;
     }
 
-#undef get_item
+    int32_t new_pos = (int32_t)vstate->pos;
+    double new_pos_rem = vstate->pos_rem;
 
-    // Copy mono signal to the right channel
-    if ((sample->channels == 1) && (abufs[0] != NULL) && (abufs[1] != NULL))
+    const double shift_factor = middle_freq / (middle_tone * audio_rate);
+    const int32_t new_buf_stop = Sample_render_data(
+            sample,
+            params,
+            abufs,
+            wbs,
+            freqs,
+            force_scales,
+            shift_factor,
+            vol_scale,
+            &new_pos,
+            &new_pos_rem,
+            buf_start,
+            buf_stop);
+    if (new_buf_stop == buf_start)
     {
-        const int32_t frame_count = new_buf_stop - buf_start;
-        rassert(frame_count >= 0);
-        memcpy(abufs[1] + buf_start,
-                abufs[0] + buf_start,
-                sizeof(float) * (size_t)frame_count);
+        // We have reached the end of the sample
+        vstate->active = false;
+        return buf_start;
     }
 
-    // Update position information
     vstate->pos = new_pos;
     vstate->pos_rem = new_pos_rem;
 
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2015-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2015-2018
  *
  * This file is part of Kunquat.
  *
@@ -16,7 +16,13 @@
 #define KQT_SAMPLE_STATE_H
 
 
+#include <init/devices/param_types/Sample.h>
+#include <init/devices/param_types/Sample_params.h>
+#include <kunquat/limits.h>
 #include <player/devices/Voice_state.h>
+#include <player/Work_buffers.h>
+
+#include <stdint.h>
 
 
 Voice_state_get_size_func Sample_vstate_get_size;
@@ -24,6 +30,44 @@ Voice_state_init_func Sample_vstate_init;
 Voice_state_render_voice_func Sample_vstate_render_voice;
 
 
+/**
+ * Render Sample data at given playback frequencies.
+ *
+ * \param sample         The Sample -- must not be \c NULL.
+ * \param params         The Sample parameters -- must not be \c NULL.
+ * \param abufs          The output buffers, or \c NULL for channels that are
+ *                       not rendered.
+ * \param wbs            The Work buffers -- must not be \c NULL.
+ * \param freqs          The playback frequencies -- must not be \c NULL.
+ * \param force_scales   The force scales -- must not be \c NULL.
+ * \param shift_factor   The Sample position step per frame and Hz -- must be
+ *                       > \c 0.
+ * \param vol_scale      The volume scale -- must be >= \c 0.
+ * \param inout_pos      The Sample position, updated by this function -- must
+ *                       not be \c NULL.
+ * \param inout_pos_rem  The fractional part of \a inout_pos, updated by this
+ *                       function -- must not be \c NULL.
+ * \param buf_start      The start index of rendering.
+ * \param buf_stop       The stop index of rendering -- must be > \a buf_start.
+ *
+ * \return   The stop index of the rendered area, or \a buf_start if the end
+ *           of a non-looping Sample has been reached.
+ */
+int32_t Sample_render_data(
+        const Sample* sample,
+        const Sample_params* params,
+        float* abufs[KQT_BUFFERS_MAX],
+        const Work_buffers* wbs,
+        const float* freqs,
+        const float* force_scales,
+        double shift_factor,
+        double vol_scale,
+        int32_t* inout_pos,
+        double* inout_pos_rem,
+        int32_t buf_start,
+        int32_t buf_stop);
+
+
 #endif // KQT_SAMPLE_STATE_H
 
 
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2017
+ * Author: Tomi Jylhä-Ollila, Finland 2017-2018
  *
  * This file is part of Kunquat.
  *
@@ -18,6 +18,7 @@
 #include <init/devices/Device.h>
 #include <init/devices/processors/Proc_slope.h>
 #include <mathnum/common.h>
+#include <mathnum/kernels.h>
 #include <memory.h>
 #include <player/devices/Device_thread_state.h>
 #include <player/Work_buffer.h>
@@ -39,8 +40,12 @@ static void clamp_buffer(Work_buffer* buffer, int32_t buf_start, int32_t buf_sto
 
     const float bound = 20000000000.0f;
 
-    for (int32_t i = buf_start; i < buf_stop; ++i)
-        buf[i] = clamp(buf[i], -bound, bound);
+    // Values in the constant trail are equal, so we only need to clamp the first one
+    const int32_t clamp_stop =
+        (const_start < buf_stop) ? max(const_start, buf_start) + 1 : buf_stop;
+    kernel_clamp(buf + buf_start, buf + buf_start, -bound, bound, clamp_stop - buf_start);
+    if (clamp_stop < buf_stop)
+        kernel_fill(buf + clamp_stop, buf[clamp_stop - 1], buf_stop - clamp_stop);
 
     Work_buffer_set_const_start(buffer, const_start);
 
@@ -78,16 +83,19 @@ static void process(
     float prev_value = *inout_prev_value;
     float prev_slope = *inout_prev_slope;
 
+    // Get immediate slopes
+    out[buf_start] = (in[buf_start] - prev_value) * (float)audio_rate;
+    for (int32_t i = buf_start + 1; i < buf_stop; ++i)
+        out[i] = (in[i] - in[i - 1]) * (float)audio_rate;
+
+    prev_value = in[buf_stop - 1];
+
+    // Smooth the slopes
     for (int32_t i = buf_start; i < buf_stop; ++i)
     {
-        const float in_value = in[i];
-
-        const float imm_slope = (in_value - prev_value) * (float)audio_rate;
-        const float cur_slope = lerp(prev_slope, imm_slope, smooth_lerp);
+        const float cur_slope = lerp(prev_slope, out[i], smooth_lerp);
         out[i] = cur_slope;
         prev_slope = cur_slope;
-
-        prev_value = in_value;
     }
 
     *inout_prev_value = prev_value;
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2015-2017
+ * Author: Tomi Jylhä-Ollila, Finland 2015-2018
  *
  * This file is part of Kunquat.
  *
@@ -17,7 +17,9 @@
 #include <debug/assert.h>
 #include <init/devices/Device.h>
 #include <init/devices/processors/Proc_volume.h>
+#include <mathnum/common.h>
 #include <mathnum/conversions.h>
+#include <mathnum/kernels.h>
 #include <memory.h>
 #include <player/devices/Device_thread_state.h>
 #include <player/devices/Proc_state.h>
@@ -63,9 +65,35 @@ static void apply_volume(
     rassert(isfinite(global_vol));
     rassert(buf_start >= 0);
 
+    if (buf_start >= buf_stop)
+        return;
+
     const float global_scale = (float)dB_to_scale(global_vol);
 
-    // Copy input to output with global volume adjustment
+    if (vol_wb == NULL)
+    {
+        // Copy input to output with global volume adjustment
+        for (int ch = 0; ch < buf_count; ++ch)
+        {
+            const float* in = in_buffers[ch];
+            float* out = out_buffers[ch];
+            if ((in == NULL) || (out == NULL))
+                continue;
+
+            kernel_scale(
+                    out + buf_start, in + buf_start, global_scale, buf_stop - buf_start);
+        }
+
+        return;
+    }
+
+    // Get volume scales
+    Proc_fill_scale_buffer(vol_wb, vol_wb, buf_start, buf_stop);
+    const float* scales = Work_buffer_get_contents(vol_wb);
+    const int32_t const_start =
+        clamp(Work_buffer_get_const_start(vol_wb), buf_start, buf_stop);
+
+    // Apply global volume and the volume buffer
     for (int ch = 0; ch < buf_count; ++ch)
     {
         const float* in = in_buffers[ch];
@@ -73,24 +101,21 @@ static void apply_volume(
         if ((in == NULL) || (out == NULL))
             continue;
 
-        for (int32_t frame = buf_start; frame < buf_stop; ++frame)
-            out[frame] = in[frame] * global_scale;
-    }
+        kernel_scale_mul(
+                out + buf_start,
+                in + buf_start,
+                global_scale,
+                scales + buf_start,
+                const_start - buf_start);
 
-    // Adjust output based on volume buffer
-    if (vol_wb != NULL)
-    {
-        Proc_fill_scale_buffer(vol_wb, vol_wb, buf_start, buf_stop);
-        const float* scales = Work_buffer_get_contents(vol_wb);
-
-        for (int ch = 0; ch < buf_count; ++ch)
+        if (const_start < buf_stop)
         {
-            float* out = out_buffers[ch];
-            if (out == NULL)
-                continue;
+            const int32_t const_count = buf_stop - const_start;
+            kernel_scale(out + const_start, in + const_start, global_scale, const_count);
 
-            for (int32_t i = buf_start; i < buf_stop; ++i)
-                out[i] *= scales[i];
+            const float scale = scales[const_start];
+            if (scale != 1.0f)
+                kernel_scale(out + const_start, out + const_start, scale, const_count);
         }
     }
 
@@ -19,12 +19,13 @@
 #include <init/devices/Audio_unit.h>
 #include <init/devices/Device_impl.h>
 #include <init/Module.h>
+#include <kunquat/limits.h>
 #include <player/Channel.h>
 #include <player/devices/Voice_state.h>
-#include <player/events/Event_common.h>
 #include <player/events/Event_params.h>
 #include <player/events/set_active_name.h>
 #include <player/Voice.h>
+#include <player/Voice_pool.h>
 #include <Value.h>
 
 #include <stdbool.h>
@@ -86,18 +87,19 @@ bool Event_channel_fire_device_event_process(
             const Device* device = (const Device*)proc;
             if ((proc != NULL) && (device->dimpl != NULL))
             {
-                // Find the Voice associated with our Processor
+                // Foreground Voices are indexed by their Processor
+                const int proc_index = result->dev_index;
+                rassert(proc_index >= 0);
+                rassert(proc_index < KQT_PROCESSORS_MAX);
+
                 Voice* voice = NULL;
-                for (int i = 0; i < KQT_PROCESSORS_MAX; ++i)
+                if (ch->fg[proc_index] != NULL)
                 {
-                    Event_check_voice(ch, i);
-                    Voice* cur_voice = ch->fg[i];
-
-                    if (cur_voice->proc == proc)
-                    {
+                    ch->fg[proc_index] = Voice_pool_get_voice(
+                            ch->pool, ch->fg[proc_index], ch->fg_id[proc_index]);
+                    Voice* cur_voice = ch->fg[proc_index];
+                    if ((cur_voice != NULL) && (cur_voice->proc == proc))
                         voice = cur_voice;
-                        break;
-                    }
                 }
 
                 if (voice != NULL)
@@ -22,6 +22,7 @@
 #include <kunquat/limits.h>
 #include <player/Channel.h>
 #include <player/devices/Voice_state.h>
+#include <player/Voice_pool.h>
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -70,6 +71,11 @@ bool reserve_voice(
     rassert(strlen(ch_expr) <= KQT_VAR_NAME_MAX);
     rassert(strlen(note_expr) <= KQT_VAR_NAME_MAX);
 
+    // Processors that cannot get a work buffer end their Voices by themselves
+    const int32_t voice_wb_size = Device_impl_get_voice_wb_size(
+            proc_state->parent.device->dimpl, ch->audio_rate);
+    Voice_pool_assign_work_buffer(ch->pool, voice, voice_wb_size);
+
     Voice_init(
             voice,
             Audio_unit_get_proc(au, proc_num),
@@ -0,0 +1,95 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#ifndef KQT_ATOMIC_H
+#define KQT_ATOMIC_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * Atomic operations on 64-bit integers.
+ *
+ * C99 does not provide atomics, so these wrap the builtins supported by GCC
+ * and Clang. Loads use acquire semantics and stores use release semantics.
+ */
+
+
+#if !defined(__GNUC__) && !defined(__clang__)
+#error "Atomic operations are not supported by this compiler"
+#endif
+
+
+/**
+ * Load an integer atomically.
+ *
+ * \param src   The source address -- must not be \c NULL.
+ *
+ * \return   The loaded value.
+ */
+static inline int64_t atomic_load_i64(const int64_t* src)
+{
+    return __atomic_load_n(src, __ATOMIC_ACQUIRE);
+}
+
+
+/**
+ * Store an integer atomically.
+ *
+ * \param dest    The destination address -- must not be \c NULL.
+ * \param value   The value to be stored.
+ */
+static inline void atomic_store_i64(int64_t* dest, int64_t value)
+{
+    __atomic_store_n(dest, value, __ATOMIC_RELEASE);
+    return;
+}
+
+
+/**
+ * Replace an integer atomically if it has the expected value.
+ *
+ * \param dest            The destination address -- must not be \c NULL.
+ * \param inout_expected  The expected value -- must not be \c NULL. If the
+ *                        comparison fails, the current value is stored here.
+ * \param value           The new value.
+ *
+ * \return   \c true if \a value was stored, otherwise \c false.
+ */
+static inline bool atomic_cas_i64(int64_t* dest, int64_t* inout_expected, int64_t value)
+{
+    return __atomic_compare_exchange_n(
+            dest, inout_expected, value, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+
+/**
+ * Add to an integer atomically.
+ *
+ * \param dest    The destination address -- must not be \c NULL.
+ * \param value   The value to be added.
+ *
+ * \return   The new value.
+ */
+static inline int64_t atomic_add_i64(int64_t* dest, int64_t value)
+{
+    return __atomic_add_fetch(dest, value, __ATOMIC_ACQ_REL);
+}
+
+
+#endif // KQT_ATOMIC_H
+
+
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -15,6 +15,7 @@
 #include <threads/Mutex.h>
 
 #include <debug/assert.h>
+#include <debug/Render_checks.h>
 
 #ifdef WITH_PTHREAD
 #include <errno.h>
@@ -52,6 +53,10 @@ void Mutex_lock(Mutex* mutex)
     rassert(mutex != NULL);
     rassert(mutex->initialised);
 
+#ifdef ENABLE_RENDER_CHECKS
+    Render_checks_report(RENDER_CHECK_LOCK);
+#endif
+
 #ifdef WITH_PTHREAD
     const int status = pthread_mutex_lock(&mutex->mutex);
     rassert(status != EINVAL);
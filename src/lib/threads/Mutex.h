@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -36,6 +36,19 @@ typedef struct Mutex
 #define MUTEX_AUTO (&(Mutex){ .initialised = false })
 
 
+/**
+ * Initialiser for a Mutex with static storage duration.
+ *
+ * A Mutex initialised this way is ready for use and must not be passed to
+ * \a Mutex_init or \a Mutex_deinit.
+ */
+#ifdef WITH_PTHREAD
+#define MUTEX_STATIC_INIT { .initialised = true, .mutex = PTHREAD_MUTEX_INITIALIZER }
+#else
+#define MUTEX_STATIC_INIT { .initialised = true }
+#endif
+
+
 /**
  * Initialise the Mutex.
  *
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -12,17 +12,26 @@
  */
 
 
+#if defined(WITH_PTHREAD) && defined(__linux__)
+// Required for pthread_setaffinity_np
+#define _GNU_SOURCE
+#define THREAD_AFFINITY_SUPPORTED
+#endif
+
 #include <threads/Thread.h>
 
+#include <common.h>
 #include <debug/assert.h>
 #include <Error.h>
 
 #ifdef WITH_PTHREAD
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
 #endif
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 
@@ -130,6 +139,129 @@ bool Thread_is_initialised(const Thread* thread)
 }
 
 
+bool Thread_set_scheduling(
+        Thread* thread, Thread_sched_policy policy, int priority, Error* error)
+{
+    rassert(thread != NULL);
+    rassert(thread->initialised);
+    rassert(policy >= THREAD_SCHED_DEFAULT);
+    rassert(policy <= THREAD_SCHED_RR);
+    rassert(error != NULL);
+
+#ifdef WITH_PTHREAD
+    static const int policies[] = { SCHED_OTHER, SCHED_FIFO, SCHED_RR };
+    const int sched_policy = policies[policy];
+
+    if (policy == THREAD_SCHED_DEFAULT)
+    {
+        priority = 0;
+    }
+    else
+    {
+        const int min_priority = sched_get_priority_min(sched_policy);
+        const int max_priority = sched_get_priority_max(sched_policy);
+        if ((priority < min_priority) || (priority > max_priority))
+        {
+            Error_set(
+                    error,
+                    ERROR_ARGUMENT,
+                    "Thread priority must be within [%d, %d]",
+                    min_priority,
+                    max_priority);
+            return false;
+        }
+    }
+
+    const struct sched_param param = { .sched_priority = priority };
+    const int status = pthread_setschedparam(thread->thread, sched_policy, &param);
+    rassert(status != ESRCH);
+
+    switch (status)
+    {
+        case 0:
+            break;
+
+        case EPERM:
+        {
+            Error_set(
+                    error,
+                    ERROR_RESOURCE,
+                    "No required permissions to set thread scheduling");
+            return false;
+        }
+        break;
+
+        default:
+        {
+            Error_set(
+                    error,
+                    ERROR_RESOURCE,
+                    "Unexpected error when setting thread scheduling: %d",
+                    status);
+            return false;
+        }
+        break;
+    }
+
+#else
+    ignore(priority);
+    rassert(false);
+
+#endif
+
+    return true;
+}
+
+
+bool Thread_set_affinity(Thread* thread, uint64_t cpu_mask, Error* error)
+{
+    rassert(thread != NULL);
+    rassert(thread->initialised);
+    rassert(error != NULL);
+
+#ifdef THREAD_AFFINITY_SUPPORTED
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (size_t i = 0; i < CPU_SETSIZE; ++i)
+    {
+        if ((cpu_mask == 0) || ((i < 64) && ((cpu_mask >> i) & 1)))
+            CPU_SET(i, &cpus);
+    }
+
+    const int status = pthread_setaffinity_np(thread->thread, sizeof(cpus), &cpus);
+    rassert(status != ESRCH);
+    if (status == EINVAL)
+    {
+        Error_set(
+                error,
+                ERROR_ARGUMENT,
+                "CPU affinity mask does not contain any available CPUs");
+        return false;
+    }
+    else if (status != 0)
+    {
+        Error_set(
+                error,
+                ERROR_RESOURCE,
+                "Unexpected error when setting thread affinity: %d",
+                status);
+        return false;
+    }
+
+#else
+    ignore(cpu_mask);
+    Error_set(
+            error,
+            ERROR_RESOURCE,
+            "Setting thread affinity is not supported on this platform");
+    return false;
+
+#endif
+
+    return true;
+}
+
+
 void Thread_join(Thread* thread)
 {
     rassert(thread != NULL);
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -23,6 +23,7 @@
 #endif
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 
@@ -39,6 +40,14 @@ typedef struct Thread
 #define THREAD_AUTO (&(Thread){ .initialised = false })
 
 
+typedef enum
+{
+    THREAD_SCHED_DEFAULT = 0,
+    THREAD_SCHED_FIFO,
+    THREAD_SCHED_RR,
+} Thread_sched_policy;
+
+
 /**
  * Initialise the Thread.
  *
@@ -62,6 +71,38 @@ bool Thread_init(Thread* thread, void* (*func)(void*), void* arg, Error* error);
 bool Thread_is_initialised(const Thread* thread);
 
 
+/**
+ * Set the scheduling policy of the Thread.
+ *
+ * Realtime policies usually require privileges that ordinary processes do not
+ * have. In that case the scheduling of \a thread is left unchanged and an
+ * \c ERROR_RESOURCE is set.
+ *
+ * \param thread     The Thread -- must not be \c NULL and must be initialised.
+ * \param policy     The scheduling policy -- must be valid.
+ * \param priority   The priority used with a realtime \a policy. Ignored if
+ *                   \a policy is \c THREAD_SCHED_DEFAULT.
+ * \param error      Destination for error information -- must not be \c NULL.
+ *
+ * \return   \c true if successful, otherwise \c false.
+ */
+bool Thread_set_scheduling(
+        Thread* thread, Thread_sched_policy policy, int priority, Error* error);
+
+
+/**
+ * Set the CPU affinity of the Thread.
+ *
+ * \param thread     The Thread -- must not be \c NULL and must be initialised.
+ * \param cpu_mask   The set of allowed CPUs with bit \a n set for CPU \a n,
+ *                   or \c 0 for all CPUs.
+ * \param error      Destination for error information -- must not be \c NULL.
+ *
+ * \return   \c true if successful, otherwise \c false.
+ */
+bool Thread_set_affinity(Thread* thread, uint64_t cpu_mask, Error* error);
+
+
 /**
  * Join the Thread.
  *
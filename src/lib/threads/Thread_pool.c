@@ -0,0 +1,271 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <threads/Thread_pool.h>
+
+#include <debug/assert.h>
+#include <Error.h>
+#include <kunquat/limits.h>
+#include <mathnum/denormals.h>
+#include <memory.h>
+#include <threads/Condition.h>
+#include <threads/Mutex.h>
+#include <threads/Thread.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+
+typedef struct Batch
+{
+    int tasks_left;
+} Batch;
+
+
+typedef struct Task
+{
+    Thread_pool_task_func* func;
+    void* arg;
+    int index;
+    Batch* batch;
+    struct Task* next;
+} Task;
+
+
+struct Thread_pool
+{
+    int thread_count;
+    Thread threads[KQT_THREAD_POOL_SIZE_MAX];
+
+    // Protects all fields below, signalled when tasks are added or finished
+    Condition cond;
+    bool stop_threads;
+    Task* first_task;
+    Task* last_task;
+};
+
+
+static Task* Thread_pool_pop_task(Thread_pool* pool)
+{
+    rassert(pool != NULL);
+
+    Task* task = pool->first_task;
+    if (task != NULL)
+    {
+        pool->first_task = task->next;
+        if (pool->first_task == NULL)
+            pool->last_task = NULL;
+    }
+
+    return task;
+}
+
+
+static void Thread_pool_execute_task(Thread_pool* pool, Task* task)
+{
+    rassert(pool != NULL);
+    rassert(task != NULL);
+
+    Mutex* mutex = Condition_get_mutex(&pool->cond);
+
+    // Called with the mutex locked
+    Mutex_unlock(mutex);
+    task->func(task->arg, task->index);
+    Mutex_lock(mutex);
+
+    Batch* batch = task->batch;
+    --batch->tasks_left;
+    if (batch->tasks_left == 0)
+        Condition_broadcast(&pool->cond);
+
+    return;
+}
+
+
+#ifdef ENABLE_THREADS
+static void* pool_thread_func(void* arg)
+{
+    rassert(arg != NULL);
+
+    Thread_pool* pool = arg;
+    Mutex* mutex = Condition_get_mutex(&pool->cond);
+
+    denormals_flush_enable();
+
+    Mutex_lock(mutex);
+
+    while (true)
+    {
+        Task* task = Thread_pool_pop_task(pool);
+        if (task != NULL)
+        {
+            Thread_pool_execute_task(pool, task);
+            continue;
+        }
+
+        if (pool->stop_threads)
+            break;
+
+        Condition_wait(&pool->cond);
+    }
+
+    Mutex_unlock(mutex);
+
+    return NULL;
+}
+#endif
+
+
+Thread_pool* new_Thread_pool(int thread_count, Error* error)
+{
+    rassert(thread_count > 0);
+    rassert(thread_count <= KQT_THREAD_POOL_SIZE_MAX);
+    rassert(error != NULL);
+
+#ifndef ENABLE_THREADS
+    rassert(false);
+#endif
+
+    Thread_pool* pool = memory_alloc_item(Thread_pool);
+    if (pool == NULL)
+    {
+        Error_set(error, ERROR_MEMORY, "Could not allocate memory for thread pool");
+        return NULL;
+    }
+
+    pool->thread_count = 0;
+    for (int i = 0; i < KQT_THREAD_POOL_SIZE_MAX; ++i)
+        pool->threads[i] = *THREAD_AUTO;
+    pool->cond = *CONDITION_AUTO;
+    pool->stop_threads = false;
+    pool->first_task = NULL;
+    pool->last_task = NULL;
+
+#ifdef ENABLE_THREADS
+    Condition_init(&pool->cond);
+
+    for (int i = 0; i < thread_count; ++i)
+    {
+        if (!Thread_init(&pool->threads[i], pool_thread_func, pool, error))
+        {
+            del_Thread_pool(pool);
+            return NULL;
+        }
+
+        ++pool->thread_count;
+    }
+#endif
+
+    return pool;
+}
+
+
+int Thread_pool_get_thread_count(const Thread_pool* pool)
+{
+    rassert(pool != NULL);
+    return pool->thread_count;
+}
+
+
+void Thread_pool_run(
+        Thread_pool* pool, Thread_pool_task_func* func, void* arg, int task_count)
+{
+    rassert(pool != NULL);
+    rassert(func != NULL);
+    rassert(task_count > 0);
+    rassert(task_count <= KQT_THREADS_MAX);
+
+    Batch* batch = &(Batch){ .tasks_left = task_count - 1 };
+
+    Task tasks[KQT_THREADS_MAX];
+    for (int i = 1; i < task_count; ++i)
+    {
+        Task* task = &tasks[i];
+        task->func = func;
+        task->arg = arg;
+        task->index = i;
+        task->batch = batch;
+        task->next = NULL;
+    }
+
+    Mutex* mutex = Condition_get_mutex(&pool->cond);
+
+    // Queue all tasks except the first one
+    if (task_count > 1)
+    {
+        Mutex_lock(mutex);
+
+        for (int i = 1; i < task_count; ++i)
+        {
+            if (pool->last_task != NULL)
+                pool->last_task->next = &tasks[i];
+            else
+                pool->first_task = &tasks[i];
+            pool->last_task = &tasks[i];
+        }
+
+        Condition_broadcast(&pool->cond);
+        Mutex_unlock(mutex);
+    }
+
+    func(arg, 0);
+
+    if (task_count == 1)
+        return;
+
+    // Help with pending tasks until our batch is finished
+    Mutex_lock(mutex);
+
+    while (batch->tasks_left > 0)
+    {
+        Task* task = Thread_pool_pop_task(pool);
+        if (task != NULL)
+            Thread_pool_execute_task(pool, task);
+        else
+            Condition_wait(&pool->cond);
+    }
+
+    Mutex_unlock(mutex);
+
+    return;
+}
+
+
+void del_Thread_pool(Thread_pool* pool)
+{
+    if (pool == NULL)
+        return;
+
+    rassert(pool->first_task == NULL);
+
+    if (pool->thread_count > 0)
+    {
+        Mutex* mutex = Condition_get_mutex(&pool->cond);
+        Mutex_lock(mutex);
+        pool->stop_threads = true;
+        Condition_broadcast(&pool->cond);
+        Mutex_unlock(mutex);
+
+        for (int i = 0; i < pool->thread_count; ++i)
+            Thread_join(&pool->threads[i]);
+    }
+
+    Condition_deinit(&pool->cond);
+
+    memory_free(pool);
+
+    return;
+}
+
+
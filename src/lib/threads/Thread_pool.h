@@ -0,0 +1,96 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#ifndef KQT_THREAD_POOL_H
+#define KQT_THREAD_POOL_H
+
+
+#include <Error.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+
+/**
+ * A pool of worker threads that can be shared between several Players.
+ *
+ * Each call of \a Thread_pool_run executes a batch of tasks and returns when
+ * all of them have finished. Batches from different callers are executed
+ * concurrently, and the pool threads sleep when there are no tasks.
+ */
+typedef struct Thread_pool Thread_pool;
+
+
+/**
+ * A task function executed by the Thread pool.
+ *
+ * \param arg     The user argument passed to \a Thread_pool_run.
+ * \param index   The index of the task in its batch.
+ */
+typedef void Thread_pool_task_func(void* arg, int index);
+
+
+/**
+ * Create a new Thread pool.
+ *
+ * This function must not be called unless ENABLE_THREADS is defined.
+ *
+ * \param thread_count   The number of worker threads -- must be > \c 0 and
+ *                       <= \c KQT_THREAD_POOL_SIZE_MAX.
+ * \param error          Destination for error information -- must not be
+ *                       \c NULL.
+ *
+ * \return   The new Thread pool if successful, otherwise \c NULL.
+ */
+Thread_pool* new_Thread_pool(int thread_count, Error* error);
+
+
+/**
+ * Get the number of worker threads in the Thread pool.
+ *
+ * \param pool   The Thread pool -- must not be \c NULL.
+ *
+ * \return   The number of worker threads.
+ */
+int Thread_pool_get_thread_count(const Thread_pool* pool);
+
+
+/**
+ * Execute a batch of tasks in the Thread pool.
+ *
+ * The task with index \c 0 is executed by the calling thread, which also
+ * helps with other pending tasks while waiting for the batch to finish.
+ *
+ * \param pool         The Thread pool -- must not be \c NULL.
+ * \param func         The task function -- must not be \c NULL.
+ * \param arg          The argument passed to \a func.
+ * \param task_count   The number of tasks -- must be > \c 0 and
+ *                     <= \c KQT_THREADS_MAX.
+ */
+void Thread_pool_run(
+        Thread_pool* pool, Thread_pool_task_func* func, void* arg, int task_count);
+
+
+/**
+ * Destroy an existing Thread pool.
+ *
+ * \param pool   The Thread pool, or \c NULL. The pool must not have any
+ *               unfinished batches.
+ */
+void del_Thread_pool(Thread_pool* pool);
+
+
+#endif // KQT_THREAD_POOL_H
+
+
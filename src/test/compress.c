@@ -0,0 +1,225 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <test_common.h>
+
+#include <init/devices/processors/Proc_compress.h>
+#include <mathnum/common.h>
+#include <mathnum/conversions.h>
+#include <player/devices/processors/Compress_state.h>
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+
+#define LEVEL_COUNT 1024
+
+#define LEVEL_MIN_DB -60.0
+#define LEVEL_MAX_DB 12.0
+
+#define GAIN_TOLERANCE_DB 0.0001
+
+
+static void init_compress(
+        Proc_compress* compress,
+        bool upward_enabled,
+        double upward_threshold,
+        double upward_ratio,
+        double upward_range,
+        bool downward_enabled,
+        double downward_threshold,
+        double downward_ratio,
+        double downward_range)
+{
+    compress->attack = 1;
+    compress->release = 100;
+    compress->lookahead = 0;
+
+    compress->upward_enabled = upward_enabled;
+    compress->upward_threshold = upward_threshold;
+    compress->upward_ratio = upward_ratio;
+    compress->upward_range = upward_range;
+
+    compress->downward_enabled = downward_enabled;
+    compress->downward_threshold = downward_threshold;
+    compress->downward_ratio = downward_ratio;
+    compress->downward_range = downward_range;
+
+    return;
+}
+
+
+// The gain curve used before the gains were calculated in the log2 domain
+static float get_reference_gain(const Proc_compress* compress, float level)
+{
+    float gain = 1.0f;
+
+    if (compress->upward_enabled)
+    {
+        const double upward_threshold_dB =
+            compress->downward_enabled
+            ? min(compress->upward_threshold, compress->downward_threshold)
+            : compress->upward_threshold;
+        const float threshold = (float)dB_to_scale(upward_threshold_dB);
+        const float inv_ratio = (float)(1.0 / compress->upward_ratio);
+        const float max_gain = (float)dB_to_scale(compress->upward_range);
+
+        if (level < threshold)
+        {
+            const float diff = threshold / level;
+            const float upward_gain = threshold / (powf(diff, inv_ratio) * level);
+            gain = min(upward_gain, max_gain);
+        }
+    }
+
+    if (compress->downward_enabled)
+    {
+        const float threshold = (float)dB_to_scale(compress->downward_threshold);
+        const float inv_ratio = (float)(1.0 / compress->downward_ratio);
+        const float min_gain = (float)dB_to_scale(-compress->downward_range);
+
+        if (level > threshold)
+        {
+            const float diff = level / threshold;
+            const float downward_gain = (threshold * powf(diff, inv_ratio)) / level;
+            gain = max(downward_gain, min_gain);
+        }
+    }
+
+    return gain;
+}
+
+
+static void check_gains(const Proc_compress* compress)
+{
+    float levels[LEVEL_COUNT] = { 0 };
+    for (int i = 0; i < LEVEL_COUNT; ++i)
+    {
+        const double level_dB = LEVEL_MIN_DB +
+            (LEVEL_MAX_DB - LEVEL_MIN_DB) * i / (LEVEL_COUNT - 1);
+        levels[i] = (float)dB_to_scale(level_dB);
+    }
+
+    float gains[LEVEL_COUNT] = { 0 };
+    Compress_get_gains(compress, gains, levels, 0, LEVEL_COUNT);
+
+    for (int i = 0; i < LEVEL_COUNT; ++i)
+    {
+        const double expected = scale_to_dB(get_reference_gain(compress, levels[i]));
+        const double actual = scale_to_dB(gains[i]);
+        fail_unless(fabs(actual - expected) < GAIN_TOLERANCE_DB,
+                "Gain at level %.4f dB was %.6f dB instead of %.6f dB",
+                scale_to_dB(levels[i]), actual, expected);
+    }
+
+    return;
+}
+
+
+START_TEST(Downward_gains_match_reference_curve)
+{
+    static const double ratios[] = { 1.5, 4, 20 };
+    for (int i = 0; i < (int)(sizeof(ratios) / sizeof(*ratios)); ++i)
+    {
+        Proc_compress* compress = &(Proc_compress){ .attack = 0 };
+        init_compress(compress, false, -60, 1, 0, true, -20, ratios[i], 24);
+        check_gains(compress);
+    }
+}
+END_TEST
+
+
+START_TEST(Upward_gains_match_reference_curve)
+{
+    static const double ratios[] = { 1.5, 2, 20 };
+    for (int i = 0; i < (int)(sizeof(ratios) / sizeof(*ratios)); ++i)
+    {
+        Proc_compress* compress = &(Proc_compress){ .attack = 0 };
+        init_compress(compress, true, -30, ratios[i], 12, false, 0, 1, 0);
+        check_gains(compress);
+    }
+}
+END_TEST
+
+
+START_TEST(Combined_gains_match_reference_curve)
+{
+    Proc_compress* compress = &(Proc_compress){ .attack = 0 };
+    init_compress(compress, true, -40, 3, 18, true, -12, 6, 30);
+    check_gains(compress);
+}
+END_TEST
+
+
+START_TEST(Gains_follow_ratios_exactly)
+{
+    // Downward: 10 dB above the threshold at 4:1 is attenuated by 7.5 dB
+    {
+        Proc_compress* compress = &(Proc_compress){ .attack = 0 };
+        init_compress(compress, false, -60, 1, 0, true, -20, 4, 24);
+        const float level = (float)dB_to_scale(-10);
+        float gain = 0;
+        Compress_get_gains(compress, &gain, &level, 0, 1);
+        fail_unless(fabs(scale_to_dB(gain) - -7.5) < GAIN_TOLERANCE_DB,
+                "Downward gain was %.6f dB instead of -7.5 dB", scale_to_dB(gain));
+    }
+
+    // Upward: 10 dB below the threshold at 2:1 is amplified by 5 dB
+    {
+        Proc_compress* compress = &(Proc_compress){ .attack = 0 };
+        init_compress(compress, true, -60, 2, 12, false, 0, 1, 0);
+        const float level = (float)dB_to_scale(-70);
+        float gain = 0;
+        Compress_get_gains(compress, &gain, &level, 0, 1);
+        fail_unless(fabs(scale_to_dB(gain) - 5.0) < GAIN_TOLERANCE_DB,
+                "Upward gain was %.6f dB instead of 5 dB", scale_to_dB(gain));
+    }
+}
+END_TEST
+
+
+static Suite* Compress_suite(void)
+{
+    Suite* s = suite_create("Compress");
+
+    static const int timeout = DEFAULT_TIMEOUT;
+
+    TCase* tc_gains = tcase_create("gains");
+    suite_add_tcase(s, tc_gains);
+    tcase_set_timeout(tc_gains, timeout);
+
+    tcase_add_test(tc_gains, Downward_gains_match_reference_curve);
+    tcase_add_test(tc_gains, Upward_gains_match_reference_curve);
+    tcase_add_test(tc_gains, Combined_gains_match_reference_curve);
+    tcase_add_test(tc_gains, Gains_follow_ratios_exactly);
+
+    return s;
+}
+
+
+int main(void)
+{
+    Suite* suite = Compress_suite();
+    SRunner* sr = srunner_create(suite);
+#ifdef K_MEM_DEBUG
+    srunner_set_fork_status(sr, CK_NOFORK);
+#endif
+    srunner_run_all(sr, CK_NORMAL);
+    const int fail_count = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    exit(fail_count > 0);
+}
+
+
@@ -0,0 +1,160 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <test_common.h>
+
+#include <mathnum/Conv_engine.h>
+#include <mathnum/Random.h>
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+#define SIGNAL_LEN 3000
+#define IR_LEN_MAX 700
+
+
+static const int32_t part_sizes[] = { 16, 64, 256 };
+static const int32_t ir_lengths[] = { 1, 16, 100, IR_LEN_MAX };
+static const int32_t chunk_sizes[] = { 1, 37, 64, 500 };
+
+
+#define arr_size(arr) ((int)(sizeof(arr) / sizeof(*(arr))))
+
+
+START_TEST(Output_matches_direct_convolution)
+{
+    const int32_t part_size = part_sizes[_i % arr_size(part_sizes)];
+    const int32_t ir_len =
+        ir_lengths[(_i / arr_size(part_sizes)) % arr_size(ir_lengths)];
+    const int32_t chunk_size =
+        chunk_sizes[_i / (arr_size(part_sizes) * arr_size(ir_lengths))];
+
+    Random* random = Random_init(RANDOM_AUTO, "conv");
+    Random_set_seed(random, 1 + (uint64_t)_i);
+
+    static float ir[IR_LEN_MAX] = { 0 };
+    for (int32_t i = 0; i < ir_len; ++i)
+        ir[i] = (float)Random_get_float_signal(random) / (float)(i + 1);
+
+    static float signal[SIGNAL_LEN] = { 0 };
+    for (int32_t i = 0; i < SIGNAL_LEN; ++i)
+        signal[i] = (float)Random_get_float_signal(random);
+
+    Conv_engine* engine = new_Conv_engine(part_size);
+    fail_if(engine == NULL, "Could not allocate memory for convolution engine");
+    fail_unless(Conv_engine_set_ir(engine, ir, ir_len),
+            "Could not allocate memory for impulse response");
+
+    // Process in place to check that shared buffers are supported
+    static float output[SIGNAL_LEN] = { 0 };
+    for (int32_t i = 0; i < SIGNAL_LEN; ++i)
+        output[i] = signal[i];
+
+    for (int32_t start = 0; start < SIGNAL_LEN; start += chunk_size)
+    {
+        const int32_t count =
+            (SIGNAL_LEN - start < chunk_size) ? SIGNAL_LEN - start : chunk_size;
+        Conv_engine_process(engine, output + start, output + start, count);
+    }
+
+    for (int32_t i = 0; i < SIGNAL_LEN; ++i)
+    {
+        double expected = 0;
+        const int32_t in_pos = i - part_size;
+        for (int32_t k = 0; k < ir_len && k <= in_pos; ++k)
+            expected += ir[k] * signal[in_pos - k];
+
+        fail_unless(fabs(output[i] - expected) < 1e-4,
+                "Output at index %" PRId32 " was %.6f instead of %.6f"
+                " (partition size %" PRId32 ", IR length %" PRId32
+                ", chunk size %" PRId32 ")",
+                i, (double)output[i], expected, part_size, ir_len, chunk_size);
+    }
+
+    del_Conv_engine(engine);
+}
+END_TEST
+
+
+START_TEST(Reset_clears_history)
+{
+    static float ir[IR_LEN_MAX] = { 0 };
+    for (int32_t i = 0; i < IR_LEN_MAX; ++i)
+        ir[i] = 1.0f;
+
+    Conv_engine* engine = new_Conv_engine(64);
+    fail_if(engine == NULL, "Could not allocate memory for convolution engine");
+    fail_unless(Conv_engine_set_ir(engine, ir, IR_LEN_MAX),
+            "Could not allocate memory for impulse response");
+
+    static float buf[SIGNAL_LEN] = { 0 };
+    for (int32_t i = 0; i < SIGNAL_LEN; ++i)
+        buf[i] = 1.0f;
+    Conv_engine_process(engine, buf, buf, SIGNAL_LEN);
+
+    Conv_engine_reset(engine);
+
+    for (int32_t i = 0; i < SIGNAL_LEN; ++i)
+        buf[i] = 0.0f;
+    Conv_engine_process(engine, buf, buf, SIGNAL_LEN);
+
+    for (int32_t i = 0; i < SIGNAL_LEN; ++i)
+    {
+        fail_unless(buf[i] == 0.0f,
+                "Output at index %" PRId32 " was %.6f after reset",
+                i, (double)buf[i]);
+    }
+
+    del_Conv_engine(engine);
+}
+END_TEST
+
+
+static Suite* Conv_engine_suite(void)
+{
+    Suite* s = suite_create("Conv_engine");
+
+    static const int timeout = DEFAULT_TIMEOUT;
+
+    TCase* tc_process = tcase_create("process");
+    suite_add_tcase(s, tc_process);
+    tcase_set_timeout(tc_process, timeout);
+
+    tcase_add_loop_test(
+            tc_process,
+            Output_matches_direct_convolution,
+            0, arr_size(part_sizes) * arr_size(ir_lengths) * arr_size(chunk_sizes));
+    tcase_add_test(tc_process, Reset_clears_history);
+
+    return s;
+}
+
+
+int main(void)
+{
+    Suite* suite = Conv_engine_suite();
+    SRunner* sr = srunner_create(suite);
+#ifdef K_MEM_DEBUG
+    srunner_set_fork_status(sr, CK_NOFORK);
+#endif
+    srunner_run_all(sr, CK_NORMAL);
+    const int fail_count = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    exit(fail_count > 0);
+}
+
+
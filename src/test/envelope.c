@@ -0,0 +1,315 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <test_common.h>
+
+#include <init/devices/param_types/Envelope.h>
+#include <string/Streader.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+
+#define NODES_MAX 32
+
+#define MIN_X 0.0
+#define MAX_X 10.0
+#define MIN_Y -10.0
+#define MAX_Y 10.0
+
+#define SEGMENT_STEPS 64
+
+#define JSON_SIZE_MAX 4096
+
+#define arr_size(arr) (sizeof(arr) / sizeof(*(arr)))
+
+
+static Envelope* create_empty_env(void)
+{
+    Envelope* env = new_Envelope(NODES_MAX, MIN_X, MAX_X, 0, MIN_Y, MAX_Y, 0);
+    fail_if(env == NULL, "Could not allocate memory for envelope");
+
+    return env;
+}
+
+
+// Envelope_read builds the lookup used by Envelope_get_value
+static Envelope* create_lookup_env(const double nodes[][2], int node_count)
+{
+    char json[JSON_SIZE_MAX] = "{\"nodes\": [";
+    for (int i = 0; i < node_count; ++i)
+    {
+        char node_str[128] = "";
+        snprintf(node_str, sizeof(node_str), "%s[%.17g, %.17g]",
+                (i > 0) ? ", " : "", nodes[i][0], nodes[i][1]);
+        strcat(json, node_str);
+    }
+    strcat(json, "]}");
+
+    Envelope* env = create_empty_env();
+    Streader* sr = Streader_init(STREADER_AUTO, json, (int64_t)strlen(json));
+    fail_unless(Envelope_read(env, sr),
+            "Could not read envelope: %s", Streader_get_error_desc(sr));
+    fail_unless(Envelope_node_count(env) == node_count,
+            "Envelope has %d nodes instead of %d",
+            Envelope_node_count(env), node_count);
+
+    return env;
+}
+
+
+// Envelopes built from individual node edits are evaluated without the lookup
+static Envelope* create_direct_env(const double nodes[][2], int node_count)
+{
+    Envelope* env = create_empty_env();
+    Envelope_set_interp(env, ENVELOPE_INT_LINEAR);
+
+    for (int i = 0; i < node_count; ++i)
+        fail_unless(Envelope_set_node(env, nodes[i][0], nodes[i][1]) == i,
+                "Could not set node %d of envelope", i);
+
+    return env;
+}
+
+
+static void check_value(const Envelope* lookup_env, const Envelope* direct_env, double x)
+{
+    const double expected = Envelope_get_value(direct_env, x);
+    const double actual = Envelope_get_value(lookup_env, x);
+
+    if (isnan(expected))
+    {
+        fail_unless(isnan(actual),
+                "Value at %.17g was %.17g instead of NAN", x, actual);
+        return;
+    }
+
+    fail_unless(actual == expected,
+            "Value at %.17g was %.17g instead of %.17g", x, actual, expected);
+
+    return;
+}
+
+
+static void check_values(const Envelope* lookup_env, const Envelope* direct_env)
+{
+    const int node_count = Envelope_node_count(direct_env);
+    fail_unless(Envelope_node_count(lookup_env) == node_count,
+            "Envelopes have different node counts (%d and %d)",
+            Envelope_node_count(lookup_env), node_count);
+
+    for (int i = 0; i < node_count; ++i)
+    {
+        const double x = Envelope_get_node(direct_env, i)[0];
+
+        // At and right next to the node
+        check_value(lookup_env, direct_env, x);
+        check_value(lookup_env, direct_env, nextafter(x, -INFINITY));
+        check_value(lookup_env, direct_env, nextafter(x, INFINITY));
+
+        // Between the node and the next one
+        if (i + 1 < node_count)
+        {
+            const double next_x = Envelope_get_node(direct_env, i + 1)[0];
+            for (int k = 1; k < SEGMENT_STEPS; ++k)
+                check_value(
+                        lookup_env,
+                        direct_env,
+                        x + (next_x - x) * k / SEGMENT_STEPS);
+        }
+    }
+
+    // Past the ends
+    const double first_x = Envelope_get_node(direct_env, 0)[0];
+    const double last_x = Envelope_get_node(direct_env, node_count - 1)[0];
+    check_value(lookup_env, direct_env, first_x - 1);
+    check_value(lookup_env, direct_env, last_x + 1);
+    check_value(lookup_env, direct_env, last_x + 1000);
+
+    return;
+}
+
+
+static const double regular_nodes[][2] =
+{
+    { 0, 0 },
+    { 1.5, 3 },
+    { 2.25, -4.125 },
+    { 7, 9.75 },
+    { 10, 1 },
+};
+
+static const double clustered_nodes[][2] =
+{
+    { 0.5, 1 },
+    { 0.501, -2 },
+    { 0.5015, 6.5 },
+    { 0.502, 0.1 },
+    { 0.50201, -0.3 },
+    { 0.50203, 2 },
+    { 0.5021, 10 },
+    { 0.50212, -10 },
+    { 0.6, 0 },
+    { 9.9, 5 },
+};
+
+static const double flat_nodes[][2] =
+{
+    { 0.1, 2.5 },
+    { 0.3, 2.5 },
+    { 5.5, 2.5 },
+};
+
+
+static const struct
+{
+    const double (*nodes)[2];
+    int node_count;
+} node_sets[] =
+{
+    { regular_nodes, (int)arr_size(regular_nodes) },
+    { clustered_nodes, (int)arr_size(clustered_nodes) },
+    { flat_nodes, (int)arr_size(flat_nodes) },
+};
+
+
+START_TEST(Linear_lookup_matches_direct_evaluation)
+{
+    const double (*nodes)[2] = node_sets[_i].nodes;
+    const int node_count = node_sets[_i].node_count;
+
+    Envelope* lookup_env = create_lookup_env(nodes, node_count);
+    Envelope* direct_env = create_direct_env(nodes, node_count);
+
+    check_values(lookup_env, direct_env);
+
+    for (int i = 0; i < node_count; ++i)
+    {
+        const double value = Envelope_get_value(lookup_env, nodes[i][0]);
+        fail_unless(value == nodes[i][1],
+                "Value at node %d was %.17g instead of %.17g",
+                i, value, nodes[i][1]);
+    }
+
+    del_Envelope(lookup_env);
+    del_Envelope(direct_env);
+}
+END_TEST
+
+
+START_TEST(Nearest_lookup_matches_direct_evaluation)
+{
+    const double (*nodes)[2] = node_sets[_i].nodes;
+    const int node_count = node_sets[_i].node_count;
+
+    Envelope* lookup_env = create_lookup_env(nodes, node_count);
+    Envelope* direct_env = create_direct_env(nodes, node_count);
+    Envelope_set_interp(lookup_env, ENVELOPE_INT_NEAREST);
+    Envelope_set_interp(direct_env, ENVELOPE_INT_NEAREST);
+
+    check_values(lookup_env, direct_env);
+
+    del_Envelope(lookup_env);
+    del_Envelope(direct_env);
+}
+END_TEST
+
+
+START_TEST(Values_follow_node_edits)
+{
+    Envelope* lookup_env = create_lookup_env(regular_nodes, (int)arr_size(regular_nodes));
+    Envelope* direct_env = create_direct_env(regular_nodes, (int)arr_size(regular_nodes));
+
+    // Add a node
+    fail_unless(Envelope_set_node(lookup_env, 4, -8) == 3,
+            "Could not add a node to the envelope");
+    fail_unless(Envelope_set_node(direct_env, 4, -8) == 3,
+            "Could not add a node to the reference envelope");
+    check_values(lookup_env, direct_env);
+    fail_unless(Envelope_get_value(lookup_env, 4) == -8,
+            "Value at an added node was %.17g instead of -8",
+            Envelope_get_value(lookup_env, 4));
+
+    // Move a node
+    fail_if(Envelope_move_node(lookup_env, 1, 0.75, 5) == NULL,
+            "Could not move a node in the envelope");
+    fail_if(Envelope_move_node(direct_env, 1, 0.75, 5) == NULL,
+            "Could not move a node in the reference envelope");
+    check_values(lookup_env, direct_env);
+    fail_unless(Envelope_get_value(lookup_env, 0.75) == 5,
+            "Value at a moved node was %.17g instead of 5",
+            Envelope_get_value(lookup_env, 0.75));
+
+    // Move the last node so that the x range changes
+    fail_if(Envelope_move_node(lookup_env, 5, 8, 2) == NULL,
+            "Could not move the last node in the envelope");
+    fail_if(Envelope_move_node(direct_env, 5, 8, 2) == NULL,
+            "Could not move the last node in the reference envelope");
+    check_values(lookup_env, direct_env);
+    fail_unless(isnan(Envelope_get_value(lookup_env, 9)),
+            "Value past the moved last node was %.17g instead of NAN",
+            Envelope_get_value(lookup_env, 9));
+
+    // Remove a node
+    fail_unless(Envelope_del_node(lookup_env, 2),
+            "Could not remove a node from the envelope");
+    fail_unless(Envelope_del_node(direct_env, 2),
+            "Could not remove a node from the reference envelope");
+    check_values(lookup_env, direct_env);
+
+    del_Envelope(lookup_env);
+    del_Envelope(direct_env);
+}
+END_TEST
+
+
+static Suite* Envelope_suite(void)
+{
+    Suite* s = suite_create("Envelope");
+
+    static const int timeout = DEFAULT_TIMEOUT;
+
+    TCase* tc_lookup = tcase_create("lookup");
+    suite_add_tcase(s, tc_lookup);
+    tcase_set_timeout(tc_lookup, timeout);
+
+    tcase_add_loop_test(
+            tc_lookup,
+            Linear_lookup_matches_direct_evaluation,
+            0, (int)arr_size(node_sets));
+    tcase_add_loop_test(
+            tc_lookup,
+            Nearest_lookup_matches_direct_evaluation,
+            0, (int)arr_size(node_sets));
+    tcase_add_test(tc_lookup, Values_follow_node_edits);
+
+    return s;
+}
+
+
+int main(void)
+{
+    Suite* suite = Envelope_suite();
+    SRunner* sr = srunner_create(suite);
+#ifdef K_MEM_DEBUG
+    srunner_set_fork_status(sr, CK_NOFORK);
+#endif
+    srunner_run_all(sr, CK_NORMAL);
+    const int fail_count = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    exit(fail_count > 0);
+}
+
+
@@ -0,0 +1,176 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <test_common.h>
+
+#include <expr.h>
+#include <mathnum/Random.h>
+#include <mathnum/Tstamp.h>
+#include <string/Streader.h>
+#include <Value.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#define arr_size(arr) (sizeof(arr) / sizeof(*(arr)))
+
+
+static const char* test_exprs[] =
+{
+    "\"1\"",
+    "\"-1.5\"",
+    "\"1 + 2 * 3\"",
+    "\"(1 + 2) * 3\"",
+    "\"2 ^ 3 ^ 2\"",
+    "\"10 - 4 - 3\"",
+    "\"7 % 3 + 1.5 / 2\"",
+    "\"-(3 - 5) * 2\"",
+    "\"!true | false & true\"",
+    "\"1 < 2 = true\"",
+    "\"2 >= 2.0 & 3 != 4\"",
+    "\"'abc' = 'abc'\"",
+    "\"\\\"abc\\\" = 'abd'\"",
+    "\"$\"",
+    "\"$ * 2 + 1\"",
+    "\"-$\"",
+    "\"$ = 4\"",
+    "\"($ + 1) * ($ - 1)\"",
+    "\"rand(1)\"",
+    "\"rand(10) + rand(10) * $\"",
+    "\"ts(1, 2) + ts(0.5)\"",
+    "\"ts()\"",
+    "\"pat(3, 1)\"",
+    "\"ts($)\"",
+    "\"true + 1\"",
+    "\"'a' < 'b'\"",
+    "\"unknown_var + 1\"",
+    "\"1 +\"",
+    "\"(1 + 2\"",
+    "\"1 + 2)\"",
+    "\"1 2\"",
+    "\"\"",
+};
+
+
+static bool values_equal(const Value* v1, const Value* v2)
+{
+    if (v1->type != v2->type)
+        return false;
+
+    switch (v1->type)
+    {
+        case VALUE_TYPE_NONE:
+            return true;
+
+        case VALUE_TYPE_BOOL:
+            return v1->value.bool_type == v2->value.bool_type;
+
+        case VALUE_TYPE_INT:
+            return v1->value.int_type == v2->value.int_type;
+
+        case VALUE_TYPE_FLOAT:
+            return v1->value.float_type == v2->value.float_type;
+
+        case VALUE_TYPE_TSTAMP:
+            return Tstamp_cmp(&v1->value.Tstamp_type, &v2->value.Tstamp_type) == 0;
+
+        case VALUE_TYPE_STRING:
+            return strcmp(v1->value.string_type, v2->value.string_type) == 0;
+
+        case VALUE_TYPE_PAT_INST_REF:
+            return (v1->value.Pat_inst_ref_type.pat == v2->value.Pat_inst_ref_type.pat) &&
+                (v1->value.Pat_inst_ref_type.inst == v2->value.Pat_inst_ref_type.inst);
+
+        default:
+            break;
+    }
+
+    return false;
+}
+
+
+START_TEST(Compiled_expression_matches_interpreted_result)
+{
+    const char* expr = test_exprs[_i];
+    const int64_t len = (int64_t)strlen(expr);
+
+    Value* meta = VALUE_AUTO;
+    meta->type = VALUE_TYPE_INT;
+    meta->value.int_type = 4;
+
+    Random* rand1 = Random_init(RANDOM_AUTO, "expr");
+    Random* rand2 = Random_init(RANDOM_AUTO, "expr");
+
+    Value* expected = VALUE_AUTO;
+    Streader* sr = Streader_init(STREADER_AUTO, expr, len);
+    const bool expected_success = evaluate_expr(sr, NULL, meta, expected, rand1);
+
+    Value* actual = VALUE_AUTO;
+    Streader* csr = Streader_init(STREADER_AUTO, expr, len);
+    Compiled_expr* cexpr = new_Compiled_expr(csr);
+    const bool actual_success = (cexpr != NULL) &&
+        Compiled_expr_evaluate(cexpr, NULL, meta, actual, rand2);
+    del_Compiled_expr(cexpr);
+
+    fail_unless(expected_success == actual_success,
+            "Expression %s was %s by the compiled version",
+            expr, expected_success ? "rejected" : "accepted");
+    if (!expected_success)
+        return;
+
+    fail_unless(values_equal(expected, actual),
+            "Compiled version of expression %s yielded a different result",
+            expr);
+    fail_unless(rand1->state == rand2->state,
+            "Compiled version of expression %s used the random source differently",
+            expr);
+}
+END_TEST
+
+
+static Suite* Expr_suite(void)
+{
+    Suite* s = suite_create("Expr");
+
+    static const int timeout = DEFAULT_TIMEOUT;
+
+    TCase* tc_compiled = tcase_create("compiled");
+    suite_add_tcase(s, tc_compiled);
+    tcase_set_timeout(tc_compiled, timeout);
+
+    tcase_add_loop_test(
+            tc_compiled,
+            Compiled_expression_matches_interpreted_result,
+            0, (int)arr_size(test_exprs));
+
+    return s;
+}
+
+
+int main(void)
+{
+    Suite* suite = Expr_suite();
+    SRunner* sr = srunner_create(suite);
+#ifdef K_MEM_DEBUG
+    srunner_set_fork_status(sr, CK_NOFORK);
+#endif
+    srunner_run_all(sr, CK_NORMAL);
+    const int fail_count = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    exit(fail_count > 0);
+}
+
+
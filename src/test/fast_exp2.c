@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -41,6 +41,38 @@ START_TEST(Maximum_relative_error_is_small)
 END_TEST
 
 
+START_TEST(Single_precision_maximum_relative_error_is_small)
+{
+    static const double small = 0.00001;
+    static const int32_t test_count = 1048577;
+
+    for (int32_t i = 0; i < test_count; ++i)
+    {
+        const float x = (float)((252.0 * i / test_count) - 126.0);
+        const double result = fast_exp2f(x);
+        const double std_exp2 = exp2(x);
+        const double rel_error = fabs((result / std_exp2) - 1);
+
+        fail_unless(rel_error <= small,
+                "fast_exp2f(%.9g) yields %.17g, which is too far from %.17g",
+                (double)x, result, std_exp2);
+    }
+}
+END_TEST
+
+
+START_TEST(Single_precision_input_is_clamped)
+{
+    fail_unless(fast_exp2f(-1000.0f) == exp2f(-126.0f),
+            "fast_exp2f(-1000) yields %.9g instead of %.9g",
+            (double)fast_exp2f(-1000.0f), (double)exp2f(-126.0f));
+    fail_unless(fast_exp2f(1000.0f) == exp2f(126.0f),
+            "fast_exp2f(1000) yields %.9g instead of %.9g",
+            (double)fast_exp2f(1000.0f), (double)exp2f(126.0f));
+}
+END_TEST
+
+
 static Suite* Fast_exp2_suite(void)
 {
     Suite* s = suite_create("Fast_exp2");
@@ -52,6 +84,8 @@ static Suite* Fast_exp2_suite(void)
     tcase_set_timeout(tc_correctness, timeout);
 
     tcase_add_test(tc_correctness, Maximum_relative_error_is_small);
+    tcase_add_test(tc_correctness, Single_precision_maximum_relative_error_is_small);
+    tcase_add_test(tc_correctness, Single_precision_input_is_clamped);
 
     return s;
 }
@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -41,6 +41,26 @@ START_TEST(Maximum_absolute_error_is_small)
 END_TEST
 
 
+START_TEST(Single_precision_maximum_absolute_error_is_small)
+{
+    static const double small = 0.00001;
+    static const int32_t test_count = 1048574;
+
+    for (int32_t i = 1; i < test_count + 1; ++i)
+    {
+        const float x = (float)(i / (double)test_count) * 1024.0f;
+        const double result = fast_log2f(x);
+        const double std_log2 = log2(x);
+        const double abs_error = fabs(result - std_log2);
+
+        fail_unless(abs_error <= small,
+                "fast_log2f(%.9g) yields %.17g, which is %.17g from %.17g",
+                (double)x, result, abs_error, std_log2);
+    }
+}
+END_TEST
+
+
 static Suite* Fast_log2_suite(void)
 {
     Suite* s = suite_create("Fast_log2");
@@ -52,6 +72,7 @@ static Suite* Fast_log2_suite(void)
     tcase_set_timeout(tc_correctness, timeout);
 
     tcase_add_test(tc_correctness, Maximum_absolute_error_is_small);
+    tcase_add_test(tc_correctness, Single_precision_maximum_absolute_error_is_small);
 
     return s;
 }
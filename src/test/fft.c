@@ -1,7 +1,7 @@
 
 
 /*
- * Author: Tomi Jylhä-Ollila, Finland 2016
+ * Author: Tomi Jylhä-Ollila, Finland 2016-2018
  *
  * This file is part of Kunquat.
  *
@@ -19,6 +19,7 @@
 #include <mathnum/Random.h>
 
 #include <math.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -135,6 +136,40 @@ START_TEST(Forward_and_inverse_transform_return_scaled_original)
 END_TEST
 
 
+START_TEST(Forward_transform_matches_definition)
+{
+    const int test_length = _i;
+
+    float orig_data[max_test_length] = { 0 };
+    float data[max_test_length] = { 0 };
+
+    fill_data_noise(orig_data, test_length);
+    memcpy(data, orig_data, sizeof(data));
+
+    FFT_worker_rfft(fw, data, test_length);
+
+    // Output contains the real part of the DC component followed by
+    // interleaved real and imaginary parts of the positive frequencies
+    for (int i = 0; i < test_length; ++i)
+    {
+        const int freq = (i + 1) / 2;
+        const bool is_imag = (i > 0) && (i % 2 == 0);
+
+        double expected = 0;
+        for (int k = 0; k < test_length; ++k)
+        {
+            const double phase = 2 * PI * freq * k / (double)test_length;
+            expected += orig_data[k] * (is_imag ? -sin(phase) : cos(phase));
+        }
+
+        fail_if(fabs(data[i] - expected) > 0.001 * test_length,
+                "Transform value at index %d of length %d is %.7g instead of %.7g",
+                i, test_length, data[i], expected);
+    }
+}
+END_TEST
+
+
 static Suite* FFT_suite(void)
 {
     Suite* s = suite_create("FFT");
@@ -152,6 +187,11 @@ static Suite* FFT_suite(void)
             Forward_and_inverse_transform_return_scaled_original,
             1,
             max_test_length + 1);
+    tcase_add_loop_test(
+            tc_correctness,
+            Forward_transform_matches_definition,
+            1,
+            max_test_length + 1);
 
     return s;
 }
@@ -0,0 +1,152 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <test_common.h>
+
+#include <init/devices/param_types/Envelope.h>
+#include <player/devices/processors/Gaincomp_state.h>
+
+#include <math.h>
+#include <stdint.h>
+
+
+#define INPUT_COUNT 4096
+
+// Covers the values outside the map domain as well
+#define INPUT_MIN -1.25
+#define INPUT_MAX 1.25
+
+
+static Envelope* create_map(const double nodes[][2], int node_count)
+{
+    Envelope* map = new_Envelope(node_count, -1, 1, 0, -1, 1, 0);
+    fail_if(map == NULL, "Could not allocate memory for map");
+
+    for (int i = 0; i < node_count; ++i)
+        fail_unless(Envelope_set_node(map, nodes[i][0], nodes[i][1]) == i,
+                "Could not set node %d of map", i);
+
+    return map;
+}
+
+
+static float get_reference_value(const Envelope* map, float in_value)
+{
+    if (Envelope_get_node(map, 0)[0] == -1)
+        return (float)Envelope_get_value(map, fmin(fmax(in_value, -1.0), 1.0));
+
+    const float out_value = (float)Envelope_get_value(map, fmin(fabs(in_value), 1.0));
+    return (in_value < 0) ? -out_value : out_value;
+}
+
+
+static void check_mapped_values(const Envelope* map)
+{
+    static float in_values[INPUT_COUNT] = { 0 };
+    int32_t count = 0;
+
+    // Include the nodes and their immediate neighbourhoods
+    for (int i = 0; i < Envelope_node_count(map); ++i)
+    {
+        const float x = (float)Envelope_get_node(map, i)[0];
+        in_values[count++] = x;
+        in_values[count++] = nextafterf(x, -INFINITY);
+        in_values[count++] = nextafterf(x, INFINITY);
+        in_values[count++] = -x;
+    }
+
+    const int32_t grid_start = count;
+    for (int32_t i = grid_start; i < INPUT_COUNT; ++i)
+        in_values[i] = (float)(INPUT_MIN +
+                (INPUT_MAX - INPUT_MIN) * (i - grid_start) / (INPUT_COUNT - grid_start - 1));
+
+    static float out_values[INPUT_COUNT] = { 0 };
+    Gaincomp_get_mapped_values(map, out_values, in_values, 0, INPUT_COUNT);
+
+    for (int32_t i = 0; i < INPUT_COUNT; ++i)
+    {
+        const float expected = get_reference_value(map, in_values[i]);
+        fail_unless(out_values[i] == expected,
+                "Input value %.9g was mapped to %.9g instead of %.9g",
+                (double)in_values[i], (double)out_values[i], (double)expected);
+    }
+
+    return;
+}
+
+
+START_TEST(Asymmetric_map_matches_envelope_values)
+{
+    static const double nodes[][2] =
+    {
+        { -1, -0.8 },
+        { -0.3137, -0.61 },
+        { 0.1234567, 0.05 },
+        { 0.71, 0.93 },
+        { 1, 1 },
+    };
+    Envelope* map = create_map(nodes, (int)(sizeof(nodes) / sizeof(*nodes)));
+    check_mapped_values(map);
+    del_Envelope(map);
+}
+END_TEST
+
+
+START_TEST(Symmetric_map_matches_envelope_values)
+{
+    static const double nodes[][2] =
+    {
+        { 0, 0 },
+        { 0.0421, 0.3 },
+        { 0.61803, 0.55 },
+        { 1, 0.7 },
+    };
+    Envelope* map = create_map(nodes, (int)(sizeof(nodes) / sizeof(*nodes)));
+    check_mapped_values(map);
+    del_Envelope(map);
+}
+END_TEST
+
+
+static Suite* Gaincomp_suite(void)
+{
+    Suite* s = suite_create("Gaincomp");
+
+    static const int timeout = DEFAULT_TIMEOUT;
+
+    TCase* tc_map = tcase_create("map");
+    suite_add_tcase(s, tc_map);
+    tcase_set_timeout(tc_map, timeout);
+
+    tcase_add_test(tc_map, Asymmetric_map_matches_envelope_values);
+    tcase_add_test(tc_map, Symmetric_map_matches_envelope_values);
+
+    return s;
+}
+
+
+int main(void)
+{
+    Suite* suite = Gaincomp_suite();
+    SRunner* sr = srunner_create(suite);
+#ifdef K_MEM_DEBUG
+    srunner_set_fork_status(sr, CK_NOFORK);
+#endif
+    srunner_run_all(sr, CK_NORMAL);
+    const int fail_count = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    exit(fail_count > 0);
+}
+
+
@@ -18,9 +18,15 @@
 #include <kunquat/Handle.h>
 #include <kunquat/Player.h>
 
+#include <stdbool.h>
+#include <stdio.h>
+
 
 #define buf_len 128
 
+// The number of delay buffers available with the default voice count
+#define KS_DELAY_BUFFER_COUNT 64
+
 
 static void setup_single_pulse_without_instrument_manifest(void)
 {
@@ -286,6 +292,150 @@ START_TEST(Read_audio_unit_control_vars)
 END_TEST
 
 
+static void set_au_data(int au_index, const char* subkey, const char* data)
+{
+    char key[64] = "";
+    snprintf(key, sizeof(key), "au_%02x/%s", au_index, subkey);
+    set_data(key, data);
+
+    return;
+}
+
+
+static void setup_ks_instrument(int au_index)
+{
+    assert(au_index >= 0);
+    assert(au_index < 2);
+
+    set_au_data(au_index, "p_manifest.json", "[0, { \"type\": \"instrument\" }]");
+    set_au_data(au_index, "out_00/p_manifest.json", "[0, {}]");
+    set_au_data(au_index, "p_connections.json",
+            "[0,"
+            "[ [\"proc_00/C/out_00\", \"proc_02/C/in_00\"]"
+            ", [\"proc_01/C/out_00\", \"proc_02/C/in_02\"]"
+            ", [\"proc_02/C/out_00\", \"out_00\"] ]"
+            "]");
+
+    set_au_data(au_index, "proc_00/p_manifest.json", "[0, { \"type\": \"pitch\" }]");
+    set_au_data(au_index, "proc_00/p_signal_type.json", "[0, \"voice\"]");
+    set_au_data(au_index, "proc_00/out_00/p_manifest.json", "[0, {}]");
+
+    set_au_data(au_index, "proc_01/p_manifest.json", "[0, { \"type\": \"debug\" }]");
+    set_au_data(au_index, "proc_01/p_signal_type.json", "[0, \"voice\"]");
+    set_au_data(au_index, "proc_01/out_00/p_manifest.json", "[0, {}]");
+
+    set_au_data(au_index, "proc_02/p_manifest.json", "[0, { \"type\": \"ks\" }]");
+    set_au_data(au_index, "proc_02/p_signal_type.json", "[0, \"voice\"]");
+    set_au_data(au_index, "proc_02/in_00/p_manifest.json", "[0, {}]");
+    set_au_data(au_index, "proc_02/in_02/p_manifest.json", "[0, {}]");
+    set_au_data(au_index, "proc_02/out_00/p_manifest.json", "[0, {}]");
+
+    return;
+}
+
+
+static void setup_ks_instruments(void)
+{
+    assert(handle != 0);
+
+    set_data("p_dc_blocker_enabled.json", "[0, false]");
+
+    set_data("out_00/p_manifest.json", "[0, {}]");
+    set_data("out_01/p_manifest.json", "[0, {}]");
+    set_data("p_connections.json",
+            "[0,"
+            "[ [\"au_00/out_00\", \"out_00\"]"
+            ", [\"au_01/out_00\", \"out_01\"] ]"
+            "]");
+
+    set_data("p_control_map.json", "[0, [[0, 0], [1, 1]]]");
+    set_data("control_00/p_manifest.json", "[0, {}]");
+    set_data("control_01/p_manifest.json", "[0, {}]");
+
+    setup_ks_instrument(0);
+    setup_ks_instrument(1);
+
+    validate();
+    check_unexpected_error();
+
+    return;
+}
+
+
+static bool is_output_audible(int index, long nframes)
+{
+    assert(handle != 0);
+    assert(index >= 0);
+    assert(index < 2);
+    assert(nframes >= 0);
+
+    kqt_Handle_play(handle, nframes);
+    check_unexpected_error();
+
+    const long frames_available = kqt_Handle_get_frames_available(handle);
+    const float* buf = kqt_Handle_get_audio(handle, index);
+    check_unexpected_error();
+
+    for (long i = 0; i < frames_available; ++i)
+    {
+        if (buf[i] != 0)
+            return true;
+    }
+
+    return false;
+}
+
+
+START_TEST(Karplus_Strong_note_survives_audio_rate_change)
+{
+    set_audio_rate(8000);
+    set_mix_volume(0);
+    pause();
+
+    setup_ks_instruments();
+
+    kqt_Handle_fire_event(handle, 0, "[\".a\", 0]");
+    kqt_Handle_fire_event(handle, 0, Note_On_55_Hz);
+    check_unexpected_error();
+
+    fail_unless(is_output_audible(0, buf_len),
+            "Karplus-Strong note did not produce sound");
+
+    // The note keeps its delay buffer while buffers for the new rate are reserved
+    set_audio_rate(16000);
+    fail_unless(is_output_audible(0, buf_len),
+            "Karplus-Strong note went silent after changing the audio rate");
+}
+END_TEST
+
+
+START_TEST(Newest_Karplus_Strong_note_gets_a_delay_buffer)
+{
+    set_audio_rate(8000);
+    set_mix_volume(0);
+    pause();
+
+    setup_ks_instruments();
+
+    // Fill all reserved delay buffers with notes in the first audio unit
+    kqt_Handle_fire_event(handle, 0, "[\".a\", 0]");
+    for (int i = 0; i < KS_DELAY_BUFFER_COUNT; ++i)
+        kqt_Handle_fire_event(handle, 0, Note_On_55_Hz);
+    check_unexpected_error();
+
+    fail_unless(is_output_audible(0, 16),
+            "Karplus-Strong notes did not produce sound");
+
+    kqt_Handle_fire_event(handle, 1, "[\".a\", 1]");
+    kqt_Handle_fire_event(handle, 1, Note_On_55_Hz);
+    check_unexpected_error();
+
+    fail_unless(is_output_audible(1, buf_len),
+            "Karplus-Strong note did not get a delay buffer");
+}
+END_TEST
+
+
 static Suite* Instrument_suite(void)
 {
     Suite* s = suite_create("Instrument");
@@ -303,6 +453,8 @@ static Suite* Instrument_suite(void)
     tcase_add_test(tc_general, Input_map_maintains_indices);
     tcase_add_test(tc_general, Add_and_remove_internal_effect_and_render);
     tcase_add_test(tc_general, Read_audio_unit_control_vars);
+    tcase_add_test(tc_general, Karplus_Strong_note_survives_audio_rate_change);
+    tcase_add_test(tc_general, Newest_Karplus_Strong_note_gets_a_delay_buffer);
 
     return s;
 }
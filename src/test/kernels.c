@@ -0,0 +1,411 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <test_common.h>
+
+#include <mathnum/common.h>
+#include <mathnum/kernels.h>
+#include <mathnum/Random.h>
+
+#include <float.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdint.h>
+
+
+#define BUF_SIZE_MAX 1031
+
+
+static const int32_t test_counts[] = { 0, 1, 7, 8, 9, 64, 1000, BUF_SIZE_MAX };
+
+
+static void fill_signal(float* buf, int32_t count, float amplitude, uint64_t seed)
+{
+    Random* random = Random_init(RANDOM_AUTO, "kernels");
+    Random_set_seed(random, seed);
+
+    Random_fill_float_signal(random, buf, count);
+    for (int32_t i = 0; i < count; ++i)
+        buf[i] *= amplitude;
+
+    return;
+}
+
+
+static void check_guard(const float* buf, int32_t count, const char* kernel_name)
+{
+    fail_unless(buf[count] == 2.0f,
+            "%s modified the buffer beyond %" PRId32 " frames",
+            kernel_name, count);
+
+    return;
+}
+
+
+START_TEST(Arithmetic_kernels_match_scalar_results)
+{
+    const int32_t count = test_counts[_i];
+
+    float in1[BUF_SIZE_MAX] = { 0 };
+    float in2[BUF_SIZE_MAX] = { 0 };
+    fill_signal(in1, count, 4.0f, 1);
+    fill_signal(in2, count, 4.0f, 2);
+    if (count > 1)
+    {
+        in1[0] = NAN;
+        in1[1] = FLT_MAX;
+    }
+
+    float out[BUF_SIZE_MAX + 1] = { 0 };
+    out[count] = 2.0f;
+
+    kernel_fill(out, 0.5f, count);
+    for (int32_t i = 0; i < count; ++i)
+        fail_unless(out[i] == 0.5f,
+                "Filled value at index %" PRId32 " was %.9g",
+                i, (double)out[i]);
+    check_guard(out, count, "kernel_fill");
+
+    kernel_scale(out, in1, 0.25f, count);
+    for (int32_t i = 1; i < count; ++i)
+        fail_unless(out[i] == in1[i] * 0.25f,
+                "Scaled value at index %" PRId32 " was %.9g instead of %.9g",
+                i, (double)out[i], (double)(in1[i] * 0.25f));
+    check_guard(out, count, "kernel_scale");
+
+    kernel_mul(out, in1, in2, count);
+    for (int32_t i = 1; i < count; ++i)
+        fail_unless(out[i] == in1[i] * in2[i],
+                "Product at index %" PRId32 " was %.9g instead of %.9g",
+                i, (double)out[i], (double)(in1[i] * in2[i]));
+    check_guard(out, count, "kernel_mul");
+
+    kernel_scale_mul(out, in1, 0.25f, in2, count);
+    for (int32_t i = 1; i < count; ++i)
+    {
+        const float expected = (in1[i] * 0.25f) * in2[i];
+        fail_unless(out[i] == expected,
+                "Scaled product at index %" PRId32 " was %.9g instead of %.9g",
+                i, (double)out[i], (double)expected);
+    }
+    check_guard(out, count, "kernel_scale_mul");
+
+    kernel_clamp(out, in1, -1.0f, 2.0f, count);
+    for (int32_t i = 0; i < count; ++i)
+    {
+        if (isnan(in1[i]))
+        {
+            fail_unless(isnan(out[i]), "Clamping did not preserve NaN");
+            continue;
+        }
+
+        const float expected = clamp(in1[i], -1.0f, 2.0f);
+        fail_unless(out[i] == expected,
+                "Clamped value at index %" PRId32 " was %.9g instead of %.9g",
+                i, (double)out[i], (double)expected);
+    }
+    check_guard(out, count, "kernel_clamp");
+
+    kernel_range_map(out, in1, -0.5f, 1.0f, -INFINITY, 1.5f, count);
+    for (int32_t i = 1; i < count; ++i)
+    {
+        const float expected = min((-0.5f * in1[i]) + 1.0f, 1.5f);
+        fail_unless(out[i] == expected,
+                "Mapped value at index %" PRId32 " was %.9g instead of %.9g",
+                i, (double)out[i], (double)expected);
+    }
+    check_guard(out, count, "kernel_range_map");
+
+    // Pan in place to test aliasing
+    float panned[BUF_SIZE_MAX + 1] = { 0 };
+    panned[count] = 2.0f;
+    for (int32_t i = 0; i < count; ++i)
+        panned[i] = in1[i];
+    kernel_pan(panned, panned, in2, -1, count);
+    for (int32_t i = 1; i < count; ++i)
+    {
+        const float expected = in1[i] * (1 - clamp(in2[i], -1.0f, 1.0f));
+        fail_unless(panned[i] == expected,
+                "Panned value at index %" PRId32 " was %.9g instead of %.9g",
+                i, (double)panned[i], (double)expected);
+    }
+    check_guard(panned, count, "kernel_pan");
+}
+END_TEST
+
+
+START_TEST(Measurements_match_scalar_results)
+{
+    const int32_t count = test_counts[_i];
+
+    float in[BUF_SIZE_MAX] = { 0 };
+    fill_signal(in, count, 2.0f, 3);
+    if (count > 0)
+        in[0] = NAN;
+
+    float out[BUF_SIZE_MAX + 1] = { 0 };
+    out[count] = 2.0f;
+
+    // Measure on top of existing values to check accumulation
+    float peak = 0.125f;
+    double sum_squares = 1.0;
+    int32_t clipped = 3;
+    kernel_scale_measure(out, in, 0.75f, count, &peak, &sum_squares, &clipped);
+
+    float expected_peak = 0.125f;
+    double expected_sum_squares = 1.0;
+    int32_t expected_clipped = 3;
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const float expected = in[i] * 0.75f;
+        if (isnan(expected))
+        {
+            fail_unless(isnan(out[i]), "Measuring did not preserve NaN");
+            continue;
+        }
+
+        fail_unless(out[i] == expected,
+                "Scaled value at index %" PRId32 " was %.9g instead of %.9g",
+                i, (double)out[i], (double)expected);
+
+        expected_peak = max(expected_peak, fabsf(expected));
+        expected_sum_squares += (double)expected * expected;
+        expected_clipped += (fabsf(expected) > 1.0f) ? 1 : 0;
+    }
+    check_guard(out, count, "kernel_scale_measure");
+
+    fail_unless(peak == expected_peak,
+            "Peak of %" PRId32 " values was %.9g instead of %.9g",
+            count, (double)peak, (double)expected_peak);
+    fail_unless(fabs(sum_squares - expected_sum_squares) <= expected_sum_squares * 1e-12,
+            "Sum of squares of %" PRId32 " values was %.9g instead of %.9g",
+            count, sum_squares, expected_sum_squares);
+    fail_unless(clipped == expected_clipped,
+            "%" PRId32 " of %" PRId32 " values were clipped instead of %" PRId32,
+            clipped, count, expected_clipped);
+}
+END_TEST
+
+
+START_TEST(Exponentials_are_accurate)
+{
+    const int32_t count = test_counts[_i];
+
+    float in[BUF_SIZE_MAX] = { 0 };
+    fill_signal(in, count, 60.0f, 3);
+
+    float out[BUF_SIZE_MAX + 1] = { 0 };
+    out[count] = 2.0f;
+
+    kernel_exp2(out, in, -1.0f / 12.0f, 200.0f, count);
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const double expected = 200.0 * exp2(-in[i] / 12.0);
+        const double rel_error = fabs((out[i] / expected) - 1);
+        fail_unless(rel_error < 0.0001,
+                "Exponential at index %" PRId32 " was %.9g instead of %.9g",
+                i, (double)out[i], expected);
+    }
+    check_guard(out, count, "kernel_exp2");
+}
+END_TEST
+
+
+START_TEST(Table_lookup_interpolates_linearly)
+{
+    const int32_t count = test_counts[_i];
+
+    // Table of x^2 + 1 with x in [-1, 1]
+    static const int32_t table_size = 9;
+    float table[9] = { 0 };
+    for (int32_t i = 0; i < table_size; ++i)
+    {
+        const float x = -1.0f + (2.0f * (float)i / (float)(table_size - 1));
+        table[i] = (x * x) + 1;
+    }
+
+    float in[BUF_SIZE_MAX] = { 0 };
+    fill_signal(in, count, 1.5f, 4);
+    if (count > 1)
+        in[0] = NAN;
+
+    float out[BUF_SIZE_MAX + 1] = { 0 };
+    out[count] = 2.0f;
+
+    kernel_table_lookup(out, in, table, table_size, -1.0f, 1.0f, count);
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const float x = isnan(in[i]) ? -1.0f : clamp(in[i], -1.0f, 1.0f);
+        const float pos = (x + 1) * 0.5f * (float)(table_size - 1);
+        const int32_t index = min((int32_t)pos, table_size - 2);
+        const float expected =
+            table[index] + (pos - (float)index) * (table[index + 1] - table[index]);
+        fail_unless(fabsf(out[i] - expected) < 0.00001f,
+                "Looked up value at index %" PRId32 " was %.9g instead of %.9g",
+                i, (double)out[i], (double)expected);
+    }
+    check_guard(out, count, "kernel_table_lookup");
+
+    // Use the upper half of the table as an odd-symmetric map
+    const float* half_table = table + (table_size / 2);
+    const int32_t half_size = (table_size / 2) + 1;
+    kernel_table_lookup_odd(out, in, half_table, half_size, count);
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const float x = isnan(in[i]) ? 1.0f : min(fabsf(in[i]), 1.0f);
+        const float pos = x * (float)(half_size - 1);
+        const int32_t index = min((int32_t)pos, half_size - 2);
+        const float abs_expected = half_table[index] +
+            (pos - (float)index) * (half_table[index + 1] - half_table[index]);
+        const float expected = (in[i] < 0) ? -abs_expected : abs_expected;
+        fail_unless(fabsf(out[i] - expected) < 0.00001f,
+                "Looked up odd value at index %" PRId32 " was %.9g instead of %.9g",
+                i, (double)out[i], (double)expected);
+    }
+    check_guard(out, count, "kernel_table_lookup_odd");
+}
+END_TEST
+
+
+START_TEST(Quantisation_matches_floor)
+{
+    const int32_t count = test_counts[_i];
+
+    float in[BUF_SIZE_MAX] = { 0 };
+    float mults[BUF_SIZE_MAX] = { 0 };
+    fill_signal(in, count, 1.0f, 5);
+    fill_signal(mults, count, 1.0f, 6);
+    for (int32_t i = 0; i < count; ++i)
+        mults[i] = exp2f(12.0f + 12.0f * mults[i]);
+    if (count > 2)
+    {
+        in[0] = NAN;
+        in[1] = -1e30f;
+        in[2] = 1e30f;
+    }
+
+    static const float mult_limit = 1048576.0f;
+
+    float out[BUF_SIZE_MAX + 1] = { 0 };
+    out[count] = 2.0f;
+
+    kernel_quantise(out, in, mults, mult_limit, count);
+    for (int32_t i = 0; i < count; ++i)
+    {
+        float expected = in[i];
+        if (mults[i] < mult_limit)
+        {
+            const float scaled = (((in[i] + 1) * 0.5f) * mults[i]);
+            expected = ((floorf(scaled) / mults[i]) * 2.0f) - 1;
+        }
+
+        if (isnan(expected))
+        {
+            fail_unless(isnan(out[i]), "Quantisation did not preserve NaN");
+            continue;
+        }
+
+        fail_unless(out[i] == expected,
+                "Quantised value at index %" PRId32 " was %.9g instead of %.9g",
+                i, (double)out[i], (double)expected);
+    }
+    check_guard(out, count, "kernel_quantise");
+}
+END_TEST
+
+
+START_TEST(Sample_hold_continues_across_calls)
+{
+    const int32_t count = test_counts[_i];
+
+    float in[BUF_SIZE_MAX] = { 0 };
+    float holds[BUF_SIZE_MAX] = { 0 };
+    fill_signal(in, count, 1.0f, 7);
+    fill_signal(holds, count, 2.0f, 8);
+    for (int32_t i = 0; i < count; ++i)
+        holds[i] += 3.5f;
+
+    float expected[BUF_SIZE_MAX] = { 0 };
+    double hold_timer = INFINITY;
+    float hold_value = 0;
+    kernel_sample_hold(expected, in, holds, count, &hold_timer, &hold_value);
+
+    float out[BUF_SIZE_MAX + 1] = { 0 };
+    out[count] = 2.0f;
+    double split_hold_timer = INFINITY;
+    float split_hold_value = 0;
+    const int32_t split_pos = count / 3;
+    kernel_sample_hold(
+            out, in, holds, split_pos, &split_hold_timer, &split_hold_value);
+    kernel_sample_hold(
+            out + split_pos,
+            in + split_pos,
+            holds + split_pos,
+            count - split_pos,
+            &split_hold_timer,
+            &split_hold_value);
+
+    for (int32_t i = 0; i < count; ++i)
+        fail_unless(out[i] == expected[i],
+                "Held value at index %" PRId32 " was %.9g instead of %.9g",
+                i, (double)out[i], (double)expected[i]);
+    check_guard(out, count, "kernel_sample_hold");
+
+    fail_unless((split_hold_timer == hold_timer) && (split_hold_value == hold_value),
+            "Sample hold state differs after processing in two parts");
+}
+END_TEST
+
+
+static Suite* Kernels_suite(void)
+{
+    Suite* s = suite_create("Kernels");
+
+    static const int timeout = DEFAULT_TIMEOUT;
+
+    TCase* tc_correctness = tcase_create("correctness");
+    suite_add_tcase(s, tc_correctness);
+    tcase_set_timeout(tc_correctness, timeout);
+
+    const int count_count = (int)(sizeof(test_counts) / sizeof(*test_counts));
+
+    tcase_add_loop_test(
+            tc_correctness, Arithmetic_kernels_match_scalar_results, 0, count_count);
+    tcase_add_loop_test(
+            tc_correctness, Measurements_match_scalar_results, 0, count_count);
+    tcase_add_loop_test(tc_correctness, Exponentials_are_accurate, 0, count_count);
+    tcase_add_loop_test(
+            tc_correctness, Table_lookup_interpolates_linearly, 0, count_count);
+    tcase_add_loop_test(tc_correctness, Quantisation_matches_floor, 0, count_count);
+    tcase_add_loop_test(
+            tc_correctness, Sample_hold_continues_across_calls, 0, count_count);
+
+    return s;
+}
+
+
+int main(void)
+{
+    Suite* suite = Kernels_suite();
+    SRunner* sr = srunner_create(suite);
+#ifdef K_MEM_DEBUG
+    srunner_set_fork_status(sr, CK_NOFORK);
+#endif
+    srunner_run_all(sr, CK_NORMAL);
+    const int fail_count = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    exit(fail_count > 0);
+}
+
+
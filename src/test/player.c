@@ -16,8 +16,11 @@
 #include <test_common.h>
 
 #include <kunquat/Handle.h>
+#include <kunquat/testing.h>
 #include <string/Streader.h>
 
+#include <float.h>
+#include <math.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -176,6 +179,315 @@ START_TEST(Independent_notes_mix_correctly)
 END_TEST
 
 
+static void setup_pooled(void)
+{
+    fail_unless(kqt_set_global_thread_pool(2),
+            "Couldn't create thread pool:\n%s\n", kqt_Handle_get_error(0));
+    setup_empty();
+    return;
+}
+
+
+static void pooled_teardown(void)
+{
+    handle_teardown();
+    fail_unless(kqt_set_global_thread_pool(0),
+            "Couldn't remove thread pool:\n%s\n", kqt_Handle_get_error(0));
+    return;
+}
+
+
+START_TEST(Notes_mix_correctly_in_thread_pool)
+{
+    set_audio_rate(220);
+    set_mix_volume(0);
+    setup_debug_instrument();
+    pause();
+
+    kqt_Handle_set_thread_count(handle, 4);
+    check_unexpected_error();
+
+    float actual_buf[buf_len] = { 0.0f };
+    const int note_2_frame = 2;
+
+    kqt_Handle_fire_event(handle, 0, Note_On_55_Hz);
+    check_unexpected_error();
+    mix_and_fill(actual_buf, note_2_frame);
+
+    kqt_Handle_fire_event(handle, 1, Note_On_55_Hz);
+    check_unexpected_error();
+    mix_and_fill(actual_buf + note_2_frame, buf_len - note_2_frame);
+
+    float expected_buf[buf_len] = { 0.0f };
+    float single_seq[] = { 1.0f, 0.5f, 0.5f, 0.5f };
+    repeat_seq_local(expected_buf, 10, single_seq);
+    for (int i = 40; i >= 0; --i)
+        expected_buf[i + note_2_frame] += expected_buf[i];
+
+    check_buffers_equal(expected_buf, actual_buf, buf_len, 0.0f);
+}
+END_TEST
+
+
+START_TEST(Thread_pool_cannot_be_changed_with_existing_handles)
+{
+    fail_if(kqt_set_global_thread_pool(2),
+            "Thread pool was changed while a Handle exists");
+    fail_if(strlen(kqt_Handle_get_error(0)) == 0,
+            "Changing thread pool with an existing Handle did not set an error");
+    kqt_Handle_clear_error(0);
+}
+END_TEST
+
+
+START_TEST(Notes_mix_correctly_with_thread_settings)
+{
+    set_audio_rate(220);
+    set_mix_volume(0);
+    setup_debug_instrument();
+    pause();
+
+    kqt_Handle_set_thread_count(handle, 2);
+    check_unexpected_error();
+
+    // Realtime scheduling may not be permitted, but the Handle must remain usable
+    if (!kqt_Handle_set_thread_scheduling(handle, "fifo", 1))
+        kqt_Handle_clear_error(handle);
+
+    kqt_Handle_set_thread_affinity(handle, 0, 0);
+    check_unexpected_error();
+    kqt_Handle_set_thread_affinity(handle, 3, 0);
+    check_unexpected_error();
+    kqt_Handle_set_thread_count(handle, 4);
+    check_unexpected_error();
+
+    float actual_buf[buf_len] = { 0.0f };
+    const int note_2_frame = 2;
+
+    kqt_Handle_fire_event(handle, 0, Note_On_55_Hz);
+    check_unexpected_error();
+    mix_and_fill(actual_buf, note_2_frame);
+
+    kqt_Handle_fire_event(handle, 1, Note_On_55_Hz);
+    check_unexpected_error();
+    mix_and_fill(actual_buf + note_2_frame, buf_len - note_2_frame);
+
+    float expected_buf[buf_len] = { 0.0f };
+    float single_seq[] = { 1.0f, 0.5f, 0.5f, 0.5f };
+    repeat_seq_local(expected_buf, 10, single_seq);
+    for (int i = 40; i >= 0; --i)
+        expected_buf[i + note_2_frame] += expected_buf[i];
+
+    check_buffers_equal(expected_buf, actual_buf, buf_len, 0.0f);
+
+    kqt_Handle_set_thread_scheduling(handle, "default", 0);
+    check_unexpected_error();
+}
+END_TEST
+
+
+START_TEST(Invalid_thread_settings_are_rejected)
+{
+    fail_if(kqt_Handle_set_thread_scheduling(handle, "idle", 1),
+            "Unsupported scheduling policy was accepted");
+    kqt_Handle_clear_error(handle);
+
+    fail_if(kqt_Handle_set_thread_scheduling(handle, "rr", 0),
+            "Realtime priority 0 was accepted");
+    kqt_Handle_clear_error(handle);
+
+    fail_if(kqt_Handle_set_thread_affinity(handle, KQT_THREADS_MAX, 0),
+            "Thread index %d was accepted", KQT_THREADS_MAX);
+    kqt_Handle_clear_error(handle);
+}
+END_TEST
+
+
+START_TEST(Floating_point_state_of_caller_is_restored)
+{
+    set_audio_rate(220);
+    setup_debug_instrument();
+
+    kqt_Handle_fire_event(handle, 0, Note_On_55_Hz);
+    check_unexpected_error();
+    kqt_Handle_play(handle, buf_len);
+    check_unexpected_error();
+
+    volatile float tiny = FLT_MIN;
+    volatile float denormal = tiny * 0.5f;
+    fail_if(denormal == 0.0f, "Denormal values are flushed after rendering");
+}
+END_TEST
+
+
+START_TEST(Rendering_does_not_allocate_memory_or_lock)
+{
+    set_audio_rate(220);
+    setup_debug_instrument();
+
+    kqt_Handle_fire_event(handle, 0, Note_On_55_Hz);
+    check_unexpected_error();
+    kqt_Handle_play(handle, buf_len);
+    check_unexpected_error();
+
+    static const char* types[] = { "alloc", "free", "lock" };
+    for (int i = 0; i < (int)(sizeof(types) / sizeof(*types)); ++i)
+    {
+        const long long count = kqt_Handle_get_render_check_count(handle, types[i]);
+#ifdef ENABLE_RENDER_CHECKS
+        check_unexpected_error();
+        fail_unless(count == 0,
+                "Rendering made %lld operations of type %s", count, types[i]);
+#else
+        fail_unless(count == -1,
+                "Render check count %lld was returned without render checks", count);
+        kqt_Handle_clear_error(handle);
+#endif
+    }
+
+    fail_unless(kqt_Handle_get_render_check_count(handle, "sleep") == -1,
+            "Unsupported operation type was accepted");
+    kqt_Handle_clear_error(handle);
+}
+END_TEST
+
+
+START_TEST(Stems_are_rendered_in_the_same_pass)
+{
+    set_audio_rate(220);
+    set_mix_volume(-6);
+    setup_debug_instrument();
+    pause();
+
+    static const char* sources[] = { "au_00", "out_00", "au_01", "out_02" };
+    static const int stem_count = (int)(sizeof(sources) / sizeof(*sources));
+    for (int stem = 0; stem < stem_count; ++stem)
+    {
+        kqt_Handle_set_stem(handle, stem, sources[stem]);
+        check_unexpected_error();
+    }
+
+    kqt_Handle_fire_event(handle, 0, Note_On_55_Hz);
+    check_unexpected_error();
+    kqt_Handle_play(handle, buf_len);
+    check_unexpected_error();
+
+    const long frames_available = kqt_Handle_get_frames_available(handle);
+    fail_unless(frames_available == buf_len,
+            "Wrong number of frames rendered"
+            KT_VALUES("%ld", (long)buf_len, frames_available));
+
+    const float silence[buf_len] = { 0.0f };
+
+    for (int ch = 0; ch < KQT_BUFFERS_MAX; ++ch)
+    {
+        const float* main_buf = kqt_Handle_get_audio(handle, ch);
+        check_unexpected_error();
+        fail_if(main_buf[0] == 0.0f, "Main output contains silence");
+
+        for (int stem = 0; stem < stem_count; ++stem)
+        {
+            const float* stem_buf = kqt_Handle_get_stem_audio(handle, stem, ch);
+            check_unexpected_error();
+
+            const float* expected_buf = (stem < 2) ? main_buf : silence;
+            check_buffers_equal(expected_buf, stem_buf, buf_len, 0.0f);
+        }
+    }
+
+    kqt_Handle_set_stem(handle, 0, NULL);
+    check_unexpected_error();
+    fail_if(kqt_Handle_get_stem_audio(handle, 0, 0) != NULL,
+            "Disabled stem returned a buffer");
+    kqt_Handle_clear_error(handle);
+}
+END_TEST
+
+
+START_TEST(Invalid_stem_settings_are_rejected)
+{
+    fail_if(kqt_Handle_set_stem(handle, KQT_STEMS_MAX, "au_00"),
+            "Stem number %d was accepted", KQT_STEMS_MAX);
+    kqt_Handle_clear_error(handle);
+
+    static const char* sources[] = { "au_0", "au_000", "in_00", "out_ff", "master" };
+    for (int i = 0; i < (int)(sizeof(sources) / sizeof(*sources)); ++i)
+    {
+        fail_if(kqt_Handle_set_stem(handle, 0, sources[i]),
+                "Stem source %s was accepted", sources[i]);
+        kqt_Handle_clear_error(handle);
+    }
+}
+END_TEST
+
+
+START_TEST(Audio_levels_match_rendered_output)
+{
+    set_audio_rate(220);
+    set_mix_volume(6);
+    setup_debug_instrument();
+    pause();
+
+    kqt_Handle_set_stem(handle, 0, "au_00");
+    check_unexpected_error();
+
+    kqt_Handle_fire_event(handle, 0, Note_On_55_Hz);
+    check_unexpected_error();
+    kqt_Handle_play(handle, buf_len);
+    check_unexpected_error();
+
+    const long frames_available = kqt_Handle_get_frames_available(handle);
+
+    for (int ch = 0; ch < KQT_BUFFERS_MAX; ++ch)
+    {
+        const float* buf = kqt_Handle_get_audio(handle, ch);
+        check_unexpected_error();
+
+        double expected_peak = 0;
+        double sum_squares = 0;
+        long expected_clipped = 0;
+        for (long i = 0; i < frames_available; ++i)
+        {
+            const double abs_value = fabs(buf[i]);
+            expected_peak = (abs_value > expected_peak) ? abs_value : expected_peak;
+            sum_squares += abs_value * abs_value;
+            expected_clipped += (abs_value > 1.0) ? 1 : 0;
+        }
+        const double expected_rms = sqrt(sum_squares / (double)frames_available);
+
+        kqt_Audio_levels levels = { .peak = -1, .rms = -1, .clipped = -1 };
+        kqt_Audio_levels stem_levels = { .peak = -1, .rms = -1, .clipped = -1 };
+        kqt_Handle_get_audio_levels(handle, ch, &levels);
+        check_unexpected_error();
+        kqt_Handle_get_stem_audio_levels(handle, 0, ch, &stem_levels);
+        check_unexpected_error();
+
+        fail_unless(levels.peak == expected_peak,
+                "Wrong peak level in channel %d"
+                KT_VALUES("%.6f", expected_peak, levels.peak), ch);
+        fail_unless(fabs(levels.rms - expected_rms) < 0.0001,
+                "Wrong RMS level in channel %d"
+                KT_VALUES("%.6f", expected_rms, levels.rms), ch);
+        fail_unless(levels.clipped == expected_clipped,
+                "Wrong number of clipped samples in channel %d"
+                KT_VALUES("%ld", expected_clipped, levels.clipped), ch);
+        fail_if(levels.clipped == 0, "No clipped samples in channel %d", ch);
+
+        fail_unless((stem_levels.peak == levels.peak) &&
+                    (stem_levels.rms == levels.rms) &&
+                    (stem_levels.clipped == levels.clipped),
+                "Stem levels differ from the main output levels in channel %d", ch);
+    }
+
+    kqt_Handle_set_stem(handle, 0, NULL);
+    check_unexpected_error();
+    fail_if(kqt_Handle_get_stem_audio_levels(handle, 0, 0, &(kqt_Audio_levels){ 0 }),
+            "Disabled stem returned audio levels");
+    kqt_Handle_clear_error(handle);
+}
+END_TEST
+
+
 START_TEST(Debug_single_shot_renders_one_pulse)
 {
     set_mix_volume(0);
@@ -196,6 +508,74 @@ START_TEST(Debug_single_shot_renders_one_pulse)
 END_TEST
 
 
+START_TEST(Queued_events_are_fired_at_their_frames)
+{
+    set_audio_rate(1000);
+    set_mix_volume(0);
+    setup_debug_instrument();
+    setup_debug_single_pulse();
+    pause();
+
+    // At 1000 frames per second, a millisecond equals one frame
+    static const long long ms = 1000000LL;
+    kqt_Handle_queue_event(handle, 0, "[\"n+\", 0]", 10 * ms);
+    check_unexpected_error();
+    kqt_Handle_queue_event(handle, 1, "[\"n+\", 0]", 100 * ms);
+    check_unexpected_error();
+    kqt_Handle_queue_event(handle, 2, "[\"n+\", 0]", 200 * ms);
+    check_unexpected_error();
+
+    float actual_buf[buf_len] = { 0.0f };
+    float expected_buf[buf_len] = { 0.0f };
+
+    mix_and_fill(actual_buf, buf_len);
+    expected_buf[10] = 1.0f;
+    expected_buf[100] = 1.0f;
+    check_buffers_equal(expected_buf, actual_buf, buf_len, 0.0f);
+
+    mix_and_fill(actual_buf, buf_len);
+    memset(expected_buf, 0, sizeof(expected_buf));
+    expected_buf[200 - buf_len] = 1.0f;
+    check_buffers_equal(expected_buf, actual_buf, buf_len, 0.0f);
+}
+END_TEST
+
+
+START_TEST(Late_queued_event_is_fired_at_block_start)
+{
+    set_audio_rate(1000);
+    set_mix_volume(0);
+    setup_debug_instrument();
+    setup_debug_single_pulse();
+    pause();
+
+    float actual_buf[buf_len] = { 0.0f };
+    mix_and_fill(actual_buf, buf_len);
+
+    kqt_Handle_queue_event(handle, 0, "[\"n+\", 0]", 0);
+    check_unexpected_error();
+
+    mix_and_fill(actual_buf, buf_len);
+
+    float expected_buf[buf_len] = { 1.0f };
+    check_buffers_equal(expected_buf, actual_buf, buf_len, 0.0f);
+}
+END_TEST
+
+
+START_TEST(Queueing_invalid_event_fails)
+{
+    setup_debug_instrument();
+
+    fail_if(kqt_Handle_queue_event(handle, 0, "[\"nonexistent\", 0]", 0),
+            "Queueing an invalid event succeeded");
+    const char* error = kqt_Handle_get_error(handle);
+    fail_if(strlen(error) == 0, "Queueing an invalid event did not set an error");
+    kqt_Handle_clear_error(handle);
+}
+END_TEST
+
+
 START_TEST(Empty_pattern_contains_silence)
 {
     set_audio_rate(mixing_rates[_i]);
@@ -1415,6 +1795,11 @@ static Suite* Player_suite(void)
 
 #undef BUILD_TCASE
 
+    TCase* tc_pool = tcase_create("pool");
+    suite_add_tcase(s, tc_pool);
+    tcase_set_timeout(tc_pool, timeout);
+    tcase_add_checked_fixture(tc_pool, setup_pooled, pooled_teardown);
+
     // Note mixing
     tcase_add_test(tc_notes, Complete_debug_note_renders_correctly);
     tcase_add_test(tc_notes, Note_off_stops_the_note_correctly);
@@ -1422,6 +1807,20 @@ static Suite* Player_suite(void)
     tcase_add_test(tc_notes, Implicit_note_off_is_triggered_correctly);
     tcase_add_test(tc_notes, Independent_notes_mix_correctly);
     tcase_add_test(tc_notes, Debug_single_shot_renders_one_pulse);
+    tcase_add_test(tc_notes, Queued_events_are_fired_at_their_frames);
+    tcase_add_test(tc_notes, Late_queued_event_is_fired_at_block_start);
+    tcase_add_test(tc_notes, Queueing_invalid_event_fails);
+    tcase_add_test(tc_notes, Thread_pool_cannot_be_changed_with_existing_handles);
+    tcase_add_test(tc_notes, Notes_mix_correctly_with_thread_settings);
+    tcase_add_test(tc_notes, Invalid_thread_settings_are_rejected);
+    tcase_add_test(tc_notes, Floating_point_state_of_caller_is_restored);
+    tcase_add_test(tc_notes, Rendering_does_not_allocate_memory_or_lock);
+    tcase_add_test(tc_notes, Stems_are_rendered_in_the_same_pass);
+    tcase_add_test(tc_notes, Invalid_stem_settings_are_rejected);
+    tcase_add_test(tc_notes, Audio_levels_match_rendered_output);
+
+    // Shared thread pool
+    tcase_add_test(tc_pool, Notes_mix_correctly_in_thread_pool);
 
     // Patterns
     tcase_add_loop_test(
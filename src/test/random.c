@@ -0,0 +1,143 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <test_common.h>
+
+#include <mathnum/Random.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+
+
+#define BUF_SIZE_MAX 1031
+
+
+static const int32_t fill_counts[] = { 0, 1, 7, 8, 9, 64, 1000, BUF_SIZE_MAX };
+
+
+START_TEST(Filled_signal_matches_single_values)
+{
+    const int32_t count = fill_counts[_i];
+
+    Random* rand1 = Random_init(RANDOM_AUTO, "fill");
+    Random* rand2 = Random_init(RANDOM_AUTO, "fill");
+    Random_set_seed(rand1, 5 + (uint64_t)_i);
+    Random_set_seed(rand2, 5 + (uint64_t)_i);
+
+    float buf[BUF_SIZE_MAX + 1] = { 0 };
+    buf[count] = 2.0f;
+
+    // Fill twice to make sure that the state is left in the correct position
+    for (int round = 0; round < 2; ++round)
+    {
+        Random_fill_float_signal(rand2, buf, count);
+
+        for (int32_t i = 0; i < count; ++i)
+        {
+            const float expected = (float)Random_get_float_signal(rand1);
+            fail_unless(buf[i] == expected,
+                    "Filled value at index %" PRId32 " of %" PRId32
+                    " was %.9f instead of %.9f",
+                    i, count, (double)buf[i], (double)expected);
+            fail_if(buf[i] < -1.0f || buf[i] > 1.0f,
+                    "Filled value at index %" PRId32 " was %.9f",
+                    i, (double)buf[i]);
+        }
+
+        fail_unless(buf[count] == 2.0f,
+                "Filling %" PRId32 " values modified the buffer beyond the range",
+                count);
+        fail_unless(rand1->state == rand2->state,
+                "Filling %" PRId32 " values left the generator in a different state",
+                count);
+    }
+}
+END_TEST
+
+
+START_TEST(Filled_double_signal_matches_single_values)
+{
+    const int32_t count = fill_counts[_i];
+
+    Random* rand1 = Random_init(RANDOM_AUTO, "fill");
+    Random* rand2 = Random_init(RANDOM_AUTO, "fill");
+    Random_set_seed(rand1, 5 + (uint64_t)_i);
+    Random_set_seed(rand2, 5 + (uint64_t)_i);
+
+    double buf[BUF_SIZE_MAX + 1] = { 0 };
+    buf[count] = 2.0;
+
+    // Fill twice to make sure that the state is left in the correct position
+    for (int round = 0; round < 2; ++round)
+    {
+        Random_fill_double_signal(rand2, buf, count);
+
+        for (int32_t i = 0; i < count; ++i)
+        {
+            const double expected = Random_get_float_signal(rand1);
+            fail_unless(buf[i] == expected,
+                    "Filled value at index %" PRId32 " of %" PRId32
+                    " was %.17f instead of %.17f",
+                    i, count, buf[i], expected);
+        }
+
+        fail_unless(buf[count] == 2.0,
+                "Filling %" PRId32 " values modified the buffer beyond the range",
+                count);
+        fail_unless(rand1->state == rand2->state,
+                "Filling %" PRId32 " values left the generator in a different state",
+                count);
+    }
+}
+END_TEST
+
+
+static Suite* Random_suite(void)
+{
+    Suite* s = suite_create("Random");
+
+    static const int timeout = DEFAULT_TIMEOUT;
+
+    TCase* tc_fill = tcase_create("fill");
+    suite_add_tcase(s, tc_fill);
+    tcase_set_timeout(tc_fill, timeout);
+
+    tcase_add_loop_test(
+            tc_fill,
+            Filled_signal_matches_single_values,
+            0, (int)(sizeof(fill_counts) / sizeof(*fill_counts)));
+    tcase_add_loop_test(
+            tc_fill,
+            Filled_double_signal_matches_single_values,
+            0, (int)(sizeof(fill_counts) / sizeof(*fill_counts)));
+
+    return s;
+}
+
+
+int main(void)
+{
+    Suite* suite = Random_suite();
+    SRunner* sr = srunner_create(suite);
+#ifdef K_MEM_DEBUG
+    srunner_set_fork_status(sr, CK_NOFORK);
+#endif
+    srunner_run_all(sr, CK_NORMAL);
+    const int fail_count = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    exit(fail_count > 0);
+}
+
+
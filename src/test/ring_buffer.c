@@ -0,0 +1,150 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <test_common.h>
+
+#include <player/Ring_buffer.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+#define RING_SIZE 37
+#define WRITE_LEN_MAX 100
+
+
+static const int32_t write_lengths[] = { 1, 5, 36, 37, 38, WRITE_LEN_MAX };
+
+
+static void check_window(const Ring_buffer* rb, const float* expected, int32_t pos)
+{
+    const float* window = Ring_buffer_get_window(rb, pos);
+
+    for (int32_t i = 0; i < RING_SIZE; ++i)
+    {
+        const float exp_value = expected[(pos + i) % RING_SIZE];
+        fail_unless(window[i] == exp_value,
+                "Window at position %" PRId32 " contains %.1f at index %" PRId32
+                " instead of %.1f",
+                pos, (double)window[i], i, (double)exp_value);
+    }
+
+    return;
+}
+
+
+START_TEST(Windows_match_written_frames)
+{
+    const int32_t write_len = write_lengths[_i];
+
+    Ring_buffer* rb = new_Ring_buffer(RING_SIZE);
+    fail_if(rb == NULL, "Could not allocate memory for ring buffer");
+
+    float expected[RING_SIZE] = { 0 };
+    float src[WRITE_LEN_MAX] = { 0 };
+    int32_t pos = 0;
+    float next_value = 1;
+
+    for (int round = 0; round < 10; ++round)
+    {
+        for (int32_t i = 0; i < write_len; ++i)
+        {
+            src[i] = next_value;
+            expected[(pos + i) % RING_SIZE] = next_value;
+            next_value += 1;
+        }
+
+        const int32_t next_pos = Ring_buffer_write(rb, pos, src, write_len);
+        fail_unless(next_pos == (pos + write_len) % RING_SIZE,
+                "Writing %" PRId32 " frames at position %" PRId32
+                " returned position %" PRId32,
+                write_len, pos, next_pos);
+        pos = next_pos;
+
+        for (int32_t window_pos = 0; window_pos <= RING_SIZE; ++window_pos)
+            check_window(rb, expected, window_pos);
+    }
+
+    del_Ring_buffer(rb);
+}
+END_TEST
+
+
+START_TEST(Synced_modifications_are_visible_in_all_windows)
+{
+    Ring_buffer* rb = new_Ring_buffer(RING_SIZE);
+    fail_if(rb == NULL, "Could not allocate memory for ring buffer");
+
+    float expected[RING_SIZE] = { 0 };
+
+    for (int32_t pos = 0; pos <= RING_SIZE; ++pos)
+    {
+        const int32_t count = (pos * 7) % (RING_SIZE + 1);
+
+        float* window = Ring_buffer_get_window_mut(rb, pos);
+        for (int32_t i = 0; i < count; ++i)
+        {
+            window[i] += 1;
+            expected[(pos + i) % RING_SIZE] += 1;
+        }
+
+        Ring_buffer_sync(rb, pos, count);
+
+        Ring_buffer_mix_frame(rb, pos % RING_SIZE, 0.5f);
+        expected[pos % RING_SIZE] += 0.5f;
+
+        for (int32_t window_pos = 0; window_pos <= RING_SIZE; ++window_pos)
+            check_window(rb, expected, window_pos);
+    }
+
+    del_Ring_buffer(rb);
+}
+END_TEST
+
+
+static Suite* Ring_buffer_suite(void)
+{
+    Suite* s = suite_create("Ring_buffer");
+
+    static const int timeout = DEFAULT_TIMEOUT;
+
+    TCase* tc_access = tcase_create("access");
+    suite_add_tcase(s, tc_access);
+    tcase_set_timeout(tc_access, timeout);
+
+    tcase_add_loop_test(
+            tc_access,
+            Windows_match_written_frames,
+            0, (int)(sizeof(write_lengths) / sizeof(*write_lengths)));
+    tcase_add_test(tc_access, Synced_modifications_are_visible_in_all_windows);
+
+    return s;
+}
+
+
+int main(void)
+{
+    Suite* suite = Ring_buffer_suite();
+    SRunner* sr = srunner_create(suite);
+#ifdef K_MEM_DEBUG
+    srunner_set_fork_status(sr, CK_NOFORK);
+#endif
+    srunner_run_all(sr, CK_NORMAL);
+    const int fail_count = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    exit(fail_count > 0);
+}
+
+
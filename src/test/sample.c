@@ -0,0 +1,327 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <test_common.h>
+
+#include <init/devices/param_types/Sample.h>
+#include <init/devices/param_types/Sample_params.h>
+#include <mathnum/common.h>
+#include <memory.h>
+#include <player/devices/processors/Sample_state.h>
+#include <player/Work_buffers.h>
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+#define TEST_SAMPLE_LEN 4096
+
+// Skip the areas where the filter sees the sample boundaries
+#define TEST_EDGE_LEN 32
+
+#define TEST_SINE_FREQ 0.01
+
+#define TEST_RENDER_LEN 2048
+
+// Reads the sample from the level of every 4th frame
+#define TEST_RENDER_STEP 3.7
+
+// Whole sine periods so that the unidirectional loop is continuous
+#define TEST_LOOP_START 1000
+#define TEST_LOOP_END 3000
+
+// Allows the interpolation error of the level but not a frame of the level
+#define TEST_RENDER_TOLERANCE 0.02
+
+// Above the passband of the first level but below the output Nyquist frequency
+#define TEST_HIGH_SINE_FREQ 0.3
+#define TEST_SMALL_STEP 1.05
+
+// Allows the attenuation of linear interpolation but not the removal of the sine
+#define TEST_HIGH_SINE_RMS_MIN 0.4
+
+
+static Sample* create_sine_sample(double freq)
+{
+    float* buf = memory_alloc_items(float, TEST_SAMPLE_LEN);
+    fail_if(buf == NULL, "Could not allocate memory for sample data");
+
+    for (int i = 0; i < TEST_SAMPLE_LEN; ++i)
+        buf[i] = (float)sin(2 * PI * freq * i);
+
+    float* bufs[] = { buf };
+    Sample* sample = new_Sample_from_buffers(bufs, 1, TEST_SAMPLE_LEN);
+    fail_if(sample == NULL, "Could not allocate memory for sample");
+
+    fail_unless(Sample_build_mip_levels(sample),
+            "Could not allocate memory for sample levels");
+
+    return sample;
+}
+
+
+START_TEST(Level_lengths_are_halved)
+{
+    Sample* sample = create_sine_sample(TEST_SINE_FREQ);
+
+    fail_unless(Sample_get_mip_level_count(sample) == SAMPLE_MIP_LEVELS_MAX,
+            "Sample of %d frames has %d levels instead of %d",
+            TEST_SAMPLE_LEN,
+            Sample_get_mip_level_count(sample),
+            SAMPLE_MIP_LEVELS_MAX);
+
+    for (int level = 1; level <= SAMPLE_MIP_LEVELS_MAX; ++level)
+    {
+        const int64_t expected = TEST_SAMPLE_LEN >> level;
+        const int64_t actual = Sample_get_mip_level_len(sample, level);
+        fail_unless(actual == expected,
+                "Level %d has length %d instead of %d",
+                level, (int)actual, (int)expected);
+    }
+
+    del_Sample(sample);
+}
+END_TEST
+
+
+START_TEST(Low_frequencies_are_preserved)
+{
+    Sample* sample = create_sine_sample(TEST_SINE_FREQ);
+    const float* orig = Sample_get_buffer(sample, 0);
+    const float* level_data = Sample_get_mip_level_buffer(sample, 1, 0);
+
+    for (int i = TEST_EDGE_LEN; i < (TEST_SAMPLE_LEN / 2) - TEST_EDGE_LEN; ++i)
+    {
+        const double diff = fabs(level_data[i] - orig[i * 2]);
+        fail_unless(diff < 0.001,
+                "Level value at index %d differs from the original by %.6f",
+                i, diff);
+    }
+
+    del_Sample(sample);
+}
+END_TEST
+
+
+START_TEST(High_frequencies_are_removed)
+{
+    Sample* sample = create_sine_sample(0.4);
+    const float* level_data = Sample_get_mip_level_buffer(sample, 1, 0);
+
+    for (int i = TEST_EDGE_LEN; i < (TEST_SAMPLE_LEN / 2) - TEST_EDGE_LEN; ++i)
+    {
+        fail_unless(fabs(level_data[i]) < 0.001,
+                "Level value at index %d has amplitude %.6f",
+                i, fabs(level_data[i]));
+    }
+
+    del_Sample(sample);
+}
+END_TEST
+
+
+static double get_expected_pos(const Sample_params* params, double virtual_pos)
+{
+    if ((params->loop == SAMPLE_LOOP_OFF) || (virtual_pos <= (double)params->loop_start))
+        return virtual_pos;
+
+    const double loop_start = (double)params->loop_start;
+    const double loop_pos = virtual_pos - loop_start;
+
+    if (params->loop == SAMPLE_LOOP_UNI)
+    {
+        const double loop_length = (double)(params->loop_end - params->loop_start);
+        return loop_start + fmod(loop_pos, loop_length);
+    }
+
+    const double uni_loop_length =
+        (double)(params->loop_end - params->loop_start - 1);
+    const double bi_loop_pos = fmod(loop_pos, uni_loop_length * 2);
+    if (bi_loop_pos <= uni_loop_length)
+        return loop_start + bi_loop_pos;
+
+    return loop_start + (uni_loop_length * 2) - bi_loop_pos;
+}
+
+
+static int32_t render_sample(
+        const Sample* sample, const Sample_params* params, double step, float* out_buf)
+{
+    Work_buffers* wbs = new_Work_buffers(TEST_RENDER_LEN);
+    fail_if(wbs == NULL, "Could not allocate memory for work buffers");
+
+    static float freqs[TEST_RENDER_LEN] = { 0 };
+    static float force_scales[TEST_RENDER_LEN] = { 0 };
+    for (int i = 0; i < TEST_RENDER_LEN; ++i)
+    {
+        freqs[i] = (float)step;
+        force_scales[i] = 1;
+        out_buf[i] = NAN;
+    }
+
+    float* abufs[KQT_BUFFERS_MAX] = { out_buf, NULL };
+    int32_t pos = 0;
+    double pos_rem = 0;
+    const int32_t stop = Sample_render_data(
+            sample,
+            params,
+            abufs,
+            wbs,
+            freqs,
+            force_scales,
+            1.0,
+            1.0,
+            &pos,
+            &pos_rem,
+            0,
+            TEST_RENDER_LEN);
+
+    del_Work_buffers(wbs);
+
+    return stop;
+}
+
+
+static void check_render(Sample_loop loop)
+{
+    Sample* sample = create_sine_sample(TEST_SINE_FREQ);
+
+    Sample_params params;
+    Sample_params_init(&params);
+    params.loop = loop;
+    params.loop_start = TEST_LOOP_START;
+    params.loop_end = TEST_LOOP_END;
+
+    static float out_buf[TEST_RENDER_LEN] = { 0 };
+    const int32_t stop = render_sample(sample, &params, TEST_RENDER_STEP, out_buf);
+
+    const int32_t expected_stop = (loop == SAMPLE_LOOP_OFF)
+        ? (int32_t)ceil(TEST_SAMPLE_LEN / TEST_RENDER_STEP) : TEST_RENDER_LEN;
+    fail_unless(stop == expected_stop,
+            "Rendering stopped at frame %d instead of %d",
+            (int)stop, (int)expected_stop);
+
+    for (int32_t i = 0; i < stop; ++i)
+    {
+        const double expected_pos = get_expected_pos(&params, i * TEST_RENDER_STEP);
+        if ((expected_pos < TEST_EDGE_LEN * 4) ||
+                (expected_pos > TEST_SAMPLE_LEN - (TEST_EDGE_LEN * 4)))
+            continue;
+
+        const double expected = sin(2 * PI * TEST_SINE_FREQ * expected_pos);
+        const double diff = fabs(out_buf[i] - expected);
+        fail_unless(diff < TEST_RENDER_TOLERANCE,
+                "Rendered value at frame %d (sample position %.2f) was %.6f"
+                    " instead of %.6f",
+                (int)i, expected_pos, out_buf[i], expected);
+    }
+
+    del_Sample(sample);
+
+    return;
+}
+
+
+START_TEST(Render_without_loop_from_level)
+{
+    check_render(SAMPLE_LOOP_OFF);
+}
+END_TEST
+
+
+START_TEST(Render_unidirectional_loop_from_level)
+{
+    check_render(SAMPLE_LOOP_UNI);
+}
+END_TEST
+
+
+START_TEST(Render_bidirectional_loop_from_level)
+{
+    check_render(SAMPLE_LOOP_BI);
+}
+END_TEST
+
+
+START_TEST(High_frequencies_survive_steps_slightly_above_one)
+{
+    Sample* sample = create_sine_sample(TEST_HIGH_SINE_FREQ);
+
+    Sample_params params;
+    Sample_params_init(&params);
+
+    static float out_buf[TEST_RENDER_LEN] = { 0 };
+    const int32_t stop = render_sample(sample, &params, TEST_SMALL_STEP, out_buf);
+    fail_unless(stop == TEST_RENDER_LEN,
+            "Rendering stopped at frame %d instead of %d",
+            (int)stop, TEST_RENDER_LEN);
+
+    double sum_squares = 0;
+    for (int32_t i = TEST_EDGE_LEN; i < stop - TEST_EDGE_LEN; ++i)
+        sum_squares += out_buf[i] * out_buf[i];
+    const double rms = sqrt(sum_squares / (stop - (TEST_EDGE_LEN * 2)));
+
+    fail_unless(rms > TEST_HIGH_SINE_RMS_MIN,
+            "RMS level of a sine at %.2f cycles per frame read at step %.2f"
+                " was %.6f",
+            TEST_HIGH_SINE_FREQ, TEST_SMALL_STEP, rms);
+
+    del_Sample(sample);
+}
+END_TEST
+
+
+static Suite* Sample_suite(void)
+{
+    Suite* s = suite_create("Sample");
+
+    static const int timeout = DEFAULT_TIMEOUT;
+
+    TCase* tc_levels = tcase_create("levels");
+    suite_add_tcase(s, tc_levels);
+    tcase_set_timeout(tc_levels, timeout);
+
+    tcase_add_test(tc_levels, Level_lengths_are_halved);
+    tcase_add_test(tc_levels, Low_frequencies_are_preserved);
+    tcase_add_test(tc_levels, High_frequencies_are_removed);
+
+    TCase* tc_render = tcase_create("render");
+    suite_add_tcase(s, tc_render);
+    tcase_set_timeout(tc_render, timeout);
+
+    tcase_add_test(tc_render, Render_without_loop_from_level);
+    tcase_add_test(tc_render, Render_unidirectional_loop_from_level);
+    tcase_add_test(tc_render, Render_bidirectional_loop_from_level);
+    tcase_add_test(tc_render, High_frequencies_survive_steps_slightly_above_one);
+
+    return s;
+}
+
+
+int main(void)
+{
+    Suite* suite = Sample_suite();
+    SRunner* sr = srunner_create(suite);
+#ifdef K_MEM_DEBUG
+    srunner_set_fork_status(sr, CK_NOFORK);
+#endif
+    srunner_run_all(sr, CK_NORMAL);
+    const int fail_count = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    exit(fail_count > 0);
+}
+
+
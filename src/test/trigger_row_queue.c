@@ -0,0 +1,337 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <test_common.h>
+
+#include <kunquat/limits.h>
+#include <mathnum/Tstamp.h>
+#include <player/Position.h>
+#include <player/Trigger_row_queue.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+static Position* init_pattern_pos(Position* pos, int64_t beats, int32_t rem)
+{
+    Position_init(pos);
+    pos->track = 0;
+    pos->system = 0;
+    pos->piref.pat = 0;
+    pos->piref.inst = 0;
+    Tstamp_set(&pos->pat_pos, beats, rem);
+
+    return pos;
+}
+
+
+static void init_queue(Trigger_row_queue* queue, uint64_t data_version)
+{
+    Trigger_row_queue_init(queue);
+
+    Position pos;
+    init_pattern_pos(&pos, 0, 0);
+    Trigger_row_queue_clear(queue, &pos, data_version);
+
+    return;
+}
+
+
+static void push_row(Trigger_row_queue* queue, int ch, int64_t beats, int32_t rem)
+{
+    Tstamp* row_pos = Tstamp_set(TSTAMP_AUTO, beats, rem);
+    Trigger_row_queue_push(queue, ch, row_pos);
+    return;
+}
+
+
+// Produces a fixed scattering of row positions with plenty of duplicates
+static Tstamp* get_scattered_pos(Tstamp* pos, int ch)
+{
+    const int32_t step = (int32_t)((ch * 7919) % 23);
+    return Tstamp_set(pos, step / 4, (step % 4) * (KQT_TSTAMP_BEAT / 4));
+}
+
+
+static void check_popped_entry(
+        Trigger_row_queue* queue, const Tstamp* expected_pos, int expected_ch)
+{
+    const Trigger_row_queue_entry* entry = Trigger_row_queue_peek(queue);
+    fail_if(entry == NULL,
+            "Queue was empty when expecting channel %d", expected_ch);
+    fail_unless(entry->ch == expected_ch,
+            "Popped channel %d instead of %d", entry->ch, expected_ch);
+    fail_unless(Tstamp_cmp(&entry->pos, expected_pos) == 0,
+            "Channel %d was popped with position " PRIts " instead of " PRIts,
+            entry->ch, PRIVALts(entry->pos), PRIVALts(*expected_pos));
+
+    Trigger_row_queue_pop(queue);
+
+    return;
+}
+
+
+START_TEST(Empty_queue_has_no_entries)
+{
+    Trigger_row_queue* queue = &(Trigger_row_queue){ .count = 0 };
+    init_queue(queue, 0);
+
+    fail_unless(Trigger_row_queue_peek(queue) == NULL,
+            "Empty queue returned an entry");
+}
+END_TEST
+
+
+START_TEST(Entries_are_popped_in_position_order)
+{
+    Trigger_row_queue* queue = &(Trigger_row_queue){ .count = 0 };
+    init_queue(queue, 0);
+
+    static const int chs[] = { 5, 2, 9, 0, 13, 7 };
+    static const int64_t beats[] = { 3, 0, 1, 4, 2, 0 };
+    static const int32_t rems[] = { 0, 100, 5, 0, 77, 99 };
+    static const int order[] = { 5, 1, 2, 4, 0, 3 };
+    const int count = (int)(sizeof(chs) / sizeof(*chs));
+
+    for (int i = 0; i < count; ++i)
+        push_row(queue, chs[i], beats[i], rems[i]);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const int index = order[i];
+        Tstamp* expected_pos = Tstamp_set(TSTAMP_AUTO, beats[index], rems[index]);
+        check_popped_entry(queue, expected_pos, chs[index]);
+    }
+
+    fail_unless(Trigger_row_queue_peek(queue) == NULL,
+            "Queue contains entries after popping all of them");
+}
+END_TEST
+
+
+START_TEST(Tied_positions_are_popped_in_channel_order)
+{
+    Trigger_row_queue* queue = &(Trigger_row_queue){ .count = 0 };
+    init_queue(queue, 0);
+
+    for (int ch = KQT_CHANNELS_MAX - 1; ch >= 0; ch -= 2)
+        push_row(queue, ch, 1, 0);
+    for (int ch = 0; ch < KQT_CHANNELS_MAX; ch += 2)
+        push_row(queue, ch, 1, 0);
+
+    Tstamp* expected_pos = Tstamp_set(TSTAMP_AUTO, 1, 0);
+    for (int ch = 0; ch < KQT_CHANNELS_MAX; ++ch)
+        check_popped_entry(queue, expected_pos, ch);
+
+    fail_unless(Trigger_row_queue_peek(queue) == NULL,
+            "Queue contains entries after popping all of them");
+}
+END_TEST
+
+
+START_TEST(Full_queue_is_popped_in_position_and_channel_order)
+{
+    Trigger_row_queue* queue = &(Trigger_row_queue){ .count = 0 };
+    init_queue(queue, 0);
+
+    for (int ch = 0; ch < KQT_CHANNELS_MAX; ++ch)
+        Trigger_row_queue_push(queue, ch, get_scattered_pos(TSTAMP_AUTO, ch));
+
+    Tstamp* prev_pos = Tstamp_set(TSTAMP_AUTO, -1, 0);
+    int prev_ch = -1;
+    bool popped[KQT_CHANNELS_MAX] = { false };
+
+    for (int i = 0; i < KQT_CHANNELS_MAX; ++i)
+    {
+        const Trigger_row_queue_entry* entry = Trigger_row_queue_peek(queue);
+        fail_if(entry == NULL, "Queue ran out of entries after %d pops", i);
+
+        const int pos_cmp = Tstamp_cmp(prev_pos, &entry->pos);
+        fail_unless((pos_cmp < 0) || ((pos_cmp == 0) && (prev_ch < entry->ch)),
+                "Channel %d at " PRIts " was popped after channel %d at " PRIts,
+                entry->ch, PRIVALts(entry->pos), prev_ch, PRIVALts(*prev_pos));
+        const Tstamp* expected_pos = get_scattered_pos(TSTAMP_AUTO, entry->ch);
+        fail_unless(Tstamp_cmp(&entry->pos, expected_pos) == 0,
+                "Channel %d was popped with a wrong position", entry->ch);
+        fail_if(popped[entry->ch], "Channel %d was popped twice", entry->ch);
+
+        popped[entry->ch] = true;
+        Tstamp_copy(prev_pos, &entry->pos);
+        prev_ch = entry->ch;
+
+        Trigger_row_queue_pop(queue);
+    }
+
+    fail_unless(Trigger_row_queue_peek(queue) == NULL,
+            "Queue contains entries after popping all of them");
+}
+END_TEST
+
+
+START_TEST(Rows_pushed_after_pops_are_ordered_correctly)
+{
+    Trigger_row_queue* queue = &(Trigger_row_queue){ .count = 0 };
+    init_queue(queue, 0);
+
+    // Emulate playback: each popped channel pushes its next row
+    static const int ch_count = 8;
+    for (int ch = 0; ch < ch_count; ++ch)
+        push_row(queue, ch, 0, 0);
+
+    Tstamp* prev_pos = Tstamp_set(TSTAMP_AUTO, 0, 0);
+    int prev_ch = -1;
+
+    for (int i = 0; i < ch_count * 10; ++i)
+    {
+        const Trigger_row_queue_entry* entry = Trigger_row_queue_peek(queue);
+        fail_if(entry == NULL, "Queue ran out of entries after %d pops", i);
+
+        const int pos_cmp = Tstamp_cmp(prev_pos, &entry->pos);
+        fail_unless((pos_cmp < 0) || ((pos_cmp == 0) && (prev_ch < entry->ch)),
+                "Channel %d at " PRIts " was popped after channel %d at " PRIts,
+                entry->ch, PRIVALts(entry->pos), prev_ch, PRIVALts(*prev_pos));
+
+        const int ch = entry->ch;
+        Tstamp_copy(prev_pos, &entry->pos);
+        prev_ch = ch;
+        Trigger_row_queue_pop(queue);
+
+        // Channels advance with different row lengths
+        Tstamp* next_pos = Tstamp_set(
+                TSTAMP_AUTO, 0, (int32_t)(ch + 1) * (KQT_TSTAMP_BEAT / 16));
+        Tstamp_add(next_pos, next_pos, prev_pos);
+        Trigger_row_queue_push(queue, ch, next_pos);
+    }
+}
+END_TEST
+
+
+START_TEST(Queue_is_valid_only_for_matching_data_version)
+{
+    Trigger_row_queue* queue = &(Trigger_row_queue){ .count = 0 };
+    init_queue(queue, 3);
+
+    Position pos;
+    init_pattern_pos(&pos, 0, 0);
+    fail_unless(Trigger_row_queue_is_valid(queue, &pos, 3),
+            "Queue was not valid after clearing");
+    fail_if(Trigger_row_queue_is_valid(queue, &pos, 4),
+            "Queue was valid after a data version change");
+
+    Trigger_row_queue_clear(queue, &pos, 4);
+    fail_unless(Trigger_row_queue_is_valid(queue, &pos, 4),
+            "Queue was not valid after rebuilding with a new data version");
+}
+END_TEST
+
+
+START_TEST(Queue_is_not_valid_after_invalidation)
+{
+    Trigger_row_queue* queue = &(Trigger_row_queue){ .count = 0 };
+
+    Position pos;
+    init_pattern_pos(&pos, 0, 0);
+
+    Trigger_row_queue_init(queue);
+    fail_if(Trigger_row_queue_is_valid(queue, &pos, 0),
+            "Queue was valid before it was built");
+
+    Trigger_row_queue_clear(queue, &pos, 0);
+    push_row(queue, 0, 1, 0);
+    Trigger_row_queue_invalidate(queue);
+    fail_if(Trigger_row_queue_is_valid(queue, &pos, 0),
+            "Queue was valid after invalidation");
+}
+END_TEST
+
+
+START_TEST(Queue_is_valid_only_at_same_or_later_pattern_position)
+{
+    Trigger_row_queue* queue = &(Trigger_row_queue){ .count = 0 };
+    Trigger_row_queue_init(queue);
+
+    Position pos;
+    init_pattern_pos(&pos, 2, 0);
+    Trigger_row_queue_clear(queue, &pos, 0);
+
+    Position later_pos;
+    init_pattern_pos(&later_pos, 3, 0);
+    fail_unless(Trigger_row_queue_is_valid(queue, &later_pos, 0),
+            "Queue was not valid at a later position");
+
+    Position earlier_pos;
+    init_pattern_pos(&earlier_pos, 1, 0);
+    fail_if(Trigger_row_queue_is_valid(queue, &earlier_pos, 0),
+            "Queue was valid at an earlier position");
+
+    Trigger_row_queue_set_position(queue, &later_pos);
+    fail_if(Trigger_row_queue_is_valid(queue, &pos, 0),
+            "Queue was valid at a position preceding its updated position");
+
+    Position other_pos;
+    init_pattern_pos(&other_pos, 3, 0);
+    other_pos.piref.inst = 1;
+    fail_if(Trigger_row_queue_is_valid(queue, &other_pos, 0),
+            "Queue was valid in another pattern instance");
+
+    init_pattern_pos(&other_pos, 3, 0);
+    other_pos.system = 1;
+    fail_if(Trigger_row_queue_is_valid(queue, &other_pos, 0),
+            "Queue was valid in another system");
+}
+END_TEST
+
+
+static Suite* Trigger_row_queue_suite(void)
+{
+    Suite* s = suite_create("Trigger_row_queue");
+
+    static const int timeout = DEFAULT_TIMEOUT;
+
+    TCase* tc_order = tcase_create("order");
+    TCase* tc_validity = tcase_create("validity");
+    suite_add_tcase(s, tc_order);
+    suite_add_tcase(s, tc_validity);
+    tcase_set_timeout(tc_order, timeout);
+    tcase_set_timeout(tc_validity, timeout);
+
+    tcase_add_test(tc_order, Empty_queue_has_no_entries);
+    tcase_add_test(tc_order, Entries_are_popped_in_position_order);
+    tcase_add_test(tc_order, Tied_positions_are_popped_in_channel_order);
+    tcase_add_test(tc_order, Full_queue_is_popped_in_position_and_channel_order);
+    tcase_add_test(tc_order, Rows_pushed_after_pops_are_ordered_correctly);
+
+    tcase_add_test(tc_validity, Queue_is_valid_only_for_matching_data_version);
+    tcase_add_test(tc_validity, Queue_is_not_valid_after_invalidation);
+    tcase_add_test(tc_validity, Queue_is_valid_only_at_same_or_later_pattern_position);
+
+    return s;
+}
+
+
+int main(void)
+{
+    Suite* suite = Trigger_row_queue_suite();
+    SRunner* sr = srunner_create(suite);
+#ifdef K_MEM_DEBUG
+    srunner_set_fork_status(sr, CK_NOFORK);
+#endif
+    srunner_run_all(sr, CK_NORMAL);
+    const int fail_count = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    exit(fail_count > 0);
+}
+
+
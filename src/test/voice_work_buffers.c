@@ -0,0 +1,275 @@
+
+
+/*
+ * Author: Tomi Jylhä-Ollila, Finland 2018
+ *
+ * This file is part of Kunquat.
+ *
+ * CC0 1.0 Universal, http://creativecommons.org/publicdomain/zero/1.0/
+ *
+ * To the extent possible under law, Kunquat Affirmers have waived all
+ * copyright and related or neighboring rights to Kunquat.
+ */
+
+
+#include <test_common.h>
+
+#include <player/Voice.h>
+#include <player/Voice_pool.h>
+#include <player/Voice_work_buffers.h>
+#include <player/Work_buffer.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+
+#define TEST_BUF_COUNT 8
+#define TEST_BUF_SIZE 1000
+
+
+static Voice_work_buffers* create_voice_wbs(void)
+{
+    Voice_work_buffers* wbs = new_Voice_work_buffers();
+    fail_if(wbs == NULL, "Could not allocate memory for Voice work buffers");
+
+    fail_unless(Voice_work_buffers_reserve(wbs, TEST_BUF_COUNT, TEST_BUF_SIZE),
+            "Could not allocate memory for Voice work buffer space");
+
+    return wbs;
+}
+
+
+START_TEST(Acquired_buffers_are_distinct_until_exhausted)
+{
+    Voice_work_buffers* wbs = create_voice_wbs();
+
+    Work_buffer* acquired[TEST_BUF_COUNT] = { NULL };
+    for (int i = 0; i < TEST_BUF_COUNT; ++i)
+    {
+        acquired[i] = Voice_work_buffers_acquire(wbs, TEST_BUF_SIZE);
+        fail_if(acquired[i] == NULL, "Could not acquire buffer #%d", i);
+        fail_if(Work_buffer_get_size(acquired[i]) < TEST_BUF_SIZE,
+                "Buffer #%d has size %d instead of at least %d",
+                i, (int)Work_buffer_get_size(acquired[i]), TEST_BUF_SIZE);
+
+        for (int k = 0; k < i; ++k)
+            fail_if(acquired[i] == acquired[k],
+                    "Buffers #%d and #%d are the same buffer", k, i);
+    }
+
+    fail_unless(Voice_work_buffers_get_free_count(wbs, 0) == 0,
+            "%d buffers are free after acquiring all buffers",
+            Voice_work_buffers_get_free_count(wbs, 0));
+    fail_unless(Voice_work_buffers_acquire(wbs, 1) == NULL,
+            "Acquired a buffer beyond the reserved count");
+
+    del_Voice_work_buffers(wbs);
+}
+END_TEST
+
+
+START_TEST(Released_buffers_can_be_acquired_again)
+{
+    Voice_work_buffers* wbs = create_voice_wbs();
+
+    Work_buffer* acquired[TEST_BUF_COUNT] = { NULL };
+    for (int i = 0; i < TEST_BUF_COUNT; ++i)
+        acquired[i] = Voice_work_buffers_acquire(wbs, TEST_BUF_SIZE);
+
+    Voice_work_buffers_release(wbs, acquired[3]);
+    Voice_work_buffers_release(wbs, acquired[5]);
+    fail_unless(Voice_work_buffers_get_free_count(wbs, 0) == 2,
+            "%d buffers are free instead of 2 after releasing 2 buffers",
+            Voice_work_buffers_get_free_count(wbs, 0));
+
+    Work_buffer* first = Voice_work_buffers_acquire(wbs, TEST_BUF_SIZE);
+    Work_buffer* second = Voice_work_buffers_acquire(wbs, TEST_BUF_SIZE);
+    fail_unless(((first == acquired[3]) && (second == acquired[5])) ||
+            ((first == acquired[5]) && (second == acquired[3])),
+            "Reacquired buffers do not match the released buffers");
+
+    del_Voice_work_buffers(wbs);
+}
+END_TEST
+
+
+START_TEST(Buffers_are_not_given_for_larger_sizes)
+{
+    Voice_work_buffers* wbs = create_voice_wbs();
+
+    fail_unless(Voice_work_buffers_acquire(wbs, TEST_BUF_SIZE + 1) == NULL,
+            "Acquired a buffer smaller than requested");
+    fail_unless(Voice_work_buffers_get_free_count(wbs, 0) == TEST_BUF_COUNT,
+            "Failed acquisition changed the number of free buffers");
+
+    del_Voice_work_buffers(wbs);
+}
+END_TEST
+
+
+START_TEST(Reserving_keeps_acquired_buffers_valid)
+{
+    Voice_work_buffers* wbs = create_voice_wbs();
+
+    Work_buffer* acquired[TEST_BUF_COUNT] = { NULL };
+    for (int i = 0; i < 3; ++i)
+        acquired[i] = Voice_work_buffers_acquire(wbs, TEST_BUF_SIZE);
+
+    fail_unless(Voice_work_buffers_reserve(wbs, TEST_BUF_COUNT, TEST_BUF_SIZE * 2),
+            "Could not reserve buffers of another size");
+    fail_unless(Voice_work_buffers_reserve(wbs, 1, TEST_BUF_SIZE),
+            "Could not reduce the number of buffers");
+
+    // Only unused buffers are removed, so the acquired ones are still counted
+    fail_unless(Voice_work_buffers_get_free_count(wbs, TEST_BUF_SIZE * 2) ==
+                TEST_BUF_COUNT,
+            "%d large buffers are free instead of %d",
+            Voice_work_buffers_get_free_count(wbs, TEST_BUF_SIZE * 2),
+            TEST_BUF_COUNT);
+    fail_unless(Voice_work_buffers_get_free_count(wbs, 0) == TEST_BUF_COUNT,
+            "%d buffers are free instead of %d after reducing the small buffers",
+            Voice_work_buffers_get_free_count(wbs, 0), TEST_BUF_COUNT);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        fail_unless(Work_buffer_get_size(acquired[i]) == TEST_BUF_SIZE,
+                "Acquired buffer #%d has size %d instead of %d",
+                i, (int)Work_buffer_get_size(acquired[i]), TEST_BUF_SIZE);
+        Work_buffer_clear(acquired[i], 0, TEST_BUF_SIZE);
+        Voice_work_buffers_release(wbs, acquired[i]);
+    }
+
+    fail_unless(Voice_work_buffers_get_free_count(wbs, 0) == TEST_BUF_COUNT + 3,
+            "%d buffers are free instead of %d after releasing",
+            Voice_work_buffers_get_free_count(wbs, 0), TEST_BUF_COUNT + 3);
+
+    Voice_work_buffers_remove_unused(wbs);
+    fail_unless(Voice_work_buffers_get_free_count(wbs, 0) == 0,
+            "%d buffers are left after removing unused sizes",
+            Voice_work_buffers_get_free_count(wbs, 0));
+
+    del_Voice_work_buffers(wbs);
+}
+END_TEST
+
+
+START_TEST(Buffers_are_acquired_from_best_fitting_size)
+{
+    Voice_work_buffers* wbs = new_Voice_work_buffers();
+    fail_if(wbs == NULL, "Could not allocate memory for Voice work buffers");
+
+    fail_unless(Voice_work_buffers_reserve(wbs, 1, TEST_BUF_SIZE * 4) &&
+                Voice_work_buffers_reserve(wbs, 1, TEST_BUF_SIZE),
+            "Could not allocate memory for Voice work buffer space");
+
+    Work_buffer* small = Voice_work_buffers_acquire(wbs, TEST_BUF_SIZE / 2);
+    fail_if(small == NULL, "Could not acquire a small buffer");
+    fail_unless(Work_buffer_get_size(small) == TEST_BUF_SIZE,
+            "Small buffer has size %d instead of %d",
+            (int)Work_buffer_get_size(small), TEST_BUF_SIZE);
+
+    // Smaller requests fall back to larger buffers when needed
+    Work_buffer* large = Voice_work_buffers_acquire(wbs, TEST_BUF_SIZE / 2);
+    fail_if(large == NULL, "Could not acquire a larger buffer for a small size");
+    fail_unless(Work_buffer_get_size(large) == TEST_BUF_SIZE * 4,
+            "Large buffer has size %d instead of %d",
+            (int)Work_buffer_get_size(large), TEST_BUF_SIZE * 4);
+
+    Voice_work_buffers_release(wbs, large);
+    Voice_work_buffers_release(wbs, small);
+
+    del_Voice_work_buffers(wbs);
+}
+END_TEST
+
+
+#define TEST_POOL_SIZE 256
+#define TEST_POOL_BUF_COUNT 64
+
+
+static Voice* get_voice(Voice_pool* pool, Voice_prio prio, int32_t buf_size)
+{
+    Voice* voice = Voice_pool_get_voice(pool, NULL, 0);
+    fail_if(voice == NULL, "Could not get a Voice from the Voice pool");
+    fail_unless(Voice_pool_assign_work_buffer(pool, voice, buf_size),
+            "Could not assign a work buffer to Voice %d", (int)Voice_id(voice));
+    voice->prio = prio;
+
+    return voice;
+}
+
+
+START_TEST(Buffers_of_lowest_priority_voices_are_reassigned)
+{
+    Voice_pool* pool = new_Voice_pool(TEST_POOL_SIZE);
+    fail_if(pool == NULL, "Could not allocate memory for the Voice pool");
+    fail_unless(Voice_pool_reserve_work_buffers(pool, TEST_BUF_SIZE),
+            "Could not allocate memory for Voice work buffers");
+
+    Voice* bg_voice = get_voice(pool, VOICE_PRIO_BG, TEST_BUF_SIZE);
+    Voice* fg_voices[TEST_POOL_BUF_COUNT] = { NULL };
+    for (int i = 1; i < TEST_POOL_BUF_COUNT; ++i)
+        fg_voices[i] = get_voice(pool, VOICE_PRIO_FG, TEST_BUF_SIZE);
+
+    // All buffers are in use, so the newest Voice takes the background buffer
+    Voice* new_voice = get_voice(pool, VOICE_PRIO_NEW, TEST_BUF_SIZE);
+    fail_if(new_voice->wb == NULL, "New Voice did not receive a buffer");
+    fail_unless(bg_voice->wb == NULL,
+            "Background Voice kept its buffer when buffers ran out");
+    for (int i = 1; i < TEST_POOL_BUF_COUNT; ++i)
+        fail_if(fg_voices[i]->wb == NULL,
+                "Foreground Voice #%d lost its buffer", i);
+
+    // Reserving more buffers must not take buffers from playing Voices
+    fail_unless(Voice_pool_reserve_work_buffers(pool, TEST_BUF_SIZE * 2),
+            "Could not allocate memory for larger Voice work buffers");
+    fail_if(new_voice->wb == NULL, "New Voice lost its buffer on reservation");
+    for (int i = 1; i < TEST_POOL_BUF_COUNT; ++i)
+        fail_if(fg_voices[i]->wb == NULL,
+                "Foreground Voice #%d lost its buffer on reservation", i);
+
+    del_Voice_pool(pool);
+}
+END_TEST
+
+
+static Suite* Voice_work_buffers_suite(void)
+{
+    Suite* s = suite_create("Voice_work_buffers");
+
+    static const int timeout = DEFAULT_TIMEOUT;
+
+    TCase* tc_slab = tcase_create("slab");
+    suite_add_tcase(s, tc_slab);
+    tcase_set_timeout(tc_slab, timeout);
+
+    tcase_add_test(tc_slab, Acquired_buffers_are_distinct_until_exhausted);
+    tcase_add_test(tc_slab, Released_buffers_can_be_acquired_again);
+    tcase_add_test(tc_slab, Buffers_are_not_given_for_larger_sizes);
+    tcase_add_test(tc_slab, Reserving_keeps_acquired_buffers_valid);
+    tcase_add_test(tc_slab, Buffers_are_acquired_from_best_fitting_size);
+
+    TCase* tc_pool = tcase_create("pool");
+    suite_add_tcase(s, tc_pool);
+    tcase_set_timeout(tc_pool, timeout);
+
+    tcase_add_test(tc_pool, Buffers_of_lowest_priority_voices_are_reassigned);
+
+    return s;
+}
+
+
+int main(void)
+{
+    Suite* suite = Voice_work_buffers_suite();
+    SRunner* sr = srunner_create(suite);
+#ifdef K_MEM_DEBUG
+    srunner_set_fork_status(sr, CK_NOFORK);
+#endif
+    srunner_run_all(sr, CK_NORMAL);
+    const int fail_count = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    exit(fail_count > 0);
+}
+
+